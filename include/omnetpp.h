@@ -71,6 +71,8 @@
 #include "omnetpp/cmodelchange.h"
 #include "omnetpp/cmodule.h"
 #include "omnetpp/ceventheap.h"
+#include "omnetpp/cdaryeventheap.h"
+#include "omnetpp/cladderqueue.h"
 #include "omnetpp/cmatchexpression.h"
 #include "omnetpp/cpatternmatcher.h"
 #include "omnetpp/cnedfunction.h"
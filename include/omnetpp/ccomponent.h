@@ -105,6 +105,15 @@ class SIM_API cComponent : public cDefaultOwner //implies noncopyable
     typedef std::vector<SignalListenerList> SignalTable;
     SignalTable *signalTable; // ordered by signalID so we can do binary search
 
+    // for fire(): listener lists of this component and its ancestors for a signal, so that
+    // emit() need not look up the signal at every level of the module hierarchy
+    struct ListenerChain {
+        simsignal_t signalID;
+        uint64_t generation = 0; // value of listenerGeneration when levels[] was computed
+        std::vector<std::pair<cComponent*,cIListener**>> levels; // components with listeners for the signal, from this component upwards
+    };
+    std::vector<ListenerChain*> *listenerChains = nullptr; // created on the first emit with listeners
+
     std::unordered_set<void**> *selfPointers = nullptr;
 
     // string-to-simsignal_t mapping
@@ -121,6 +130,9 @@ class SIM_API cComponent : public cDefaultOwner //implies noncopyable
     static cIListener **notificationStack[];
     static int notificationSP;
 
+    // incremented on every change that may invalidate a ListenerChain: subscribe, unsubscribe, module moves
+    static uint64_t listenerGeneration;
+
     // whether only signals declared in NED via @signal are allowed to be emitted
     static bool checkSignals;
 
@@ -139,7 +151,10 @@ class SIM_API cComponent : public cDefaultOwner //implies noncopyable
     void throwInvalidSignalID(simsignal_t signalID) const;
     void removeListenerList(simsignal_t signalID);
     void checkNotFiring(simsignal_t, cIListener **listenerList);
+    ListenerChain *getListenerChain(simsignal_t signalID);
     template<typename T> void fire(cComponent *src, simsignal_t signalID, T x, cObject *details);
+    template<typename T> void fireRecursively(cComponent *src, simsignal_t signalID, T x, cObject *details);
+    template<typename T> static void notifyListeners(cComponent *component, cIListener **listeners, cComponent *src, simsignal_t signalID, T x, cObject *details);
     void fireFinish();
     void releaseLocalListeners();
     const SignalListenerList& getListenerList(int k) const {return (*signalTable)[k];} // for inspectors
@@ -464,6 +479,43 @@ class SIM_API cComponent : public cDefaultOwner //implies noncopyable
     virtual void callFinish() = 0;
     //@}
 
+    /** @name Checkpointing.
+     * A simulation checkpoint saves the state of all components at some
+     * simulation time, so that later runs can continue from there instead
+     * of simulating the warm-up period again (see the checkpoint-time and
+     * restore-checkpoint configuration options). Components are restored
+     * after the network has been set up and initialized, so only state that
+     * changes during the simulation needs to be saved.
+     *
+     * Simple modules are only accepted into a checkpoint if their NED type
+     * has the @checkpointable property, which declares that checkpointPack()
+     * and checkpointUnpack() save all state of the module, not only its
+     * parameters. Scheduled messages that have a context pointer or control
+     * info attached cannot be saved.
+     */
+    //@{
+
+    /**
+     * Saves the state of the component into the buffer. The default
+     * implementation saves the values of non-volatile parameters. Components
+     * with state should redefine this method to call the base class version
+     * then pack their data members; member objects such as queues and
+     * statistics can be saved with their parsimPack() methods.
+     *
+     * Scheduled messages are saved separately, not by this method. When
+     * restoring a self-message, the module's own unscheduled message with
+     * the same class and name is reused if there is one (e.g. a timer created
+     * in initialize()), so that pointers to such timers remain valid.
+     */
+    virtual void checkpointPack(cCommBuffer *buffer) const;
+
+    /**
+     * Restores the state saved by checkpointPack(). The method is invoked on
+     * an initialized component, before the future events are restored.
+     */
+    virtual void checkpointUnpack(cCommBuffer *buffer);
+    //@}
+
     /** @name Parameters. */
     //@{
 
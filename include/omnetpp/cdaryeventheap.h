@@ -0,0 +1,208 @@
+//==========================================================================
+//  CDARYEVENTHEAP.H - part of
+//                     OMNeT++/OMNEST
+//            Discrete System Simulation in C++
+//
+//==========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 1992-2017 Andras Varga
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#ifndef __OMNETPP_CDARYEVENTHEAP_H
+#define __OMNETPP_CDARYEVENTHEAP_H
+
+#include "cfutureeventset.h"
+
+namespace omnetpp {
+
+/**
+ * @brief A cache-friendly, 4-ary heap based implementation of the future
+ * event set.
+ *
+ * This class is functionally equivalent to cEventHeap (including the circular
+ * buffer optimization for events scheduled for the current simulation time),
+ * but it is laid out for better memory locality. The heap array stores the
+ * sort key (raw arrival time, scheduling priority and insertion order) inline
+ * next to the event pointer, so comparisons do not need to dereference the
+ * events, and the four children of a node occupy two adjacent cache lines.
+ * The sort key is captured when the event is inserted, so the scheduling
+ * priority of an event must not be changed while it is in the FES.
+ *
+ * To use this class, add the following line to omnetpp.ini:
+ *
+ * <pre>
+ * futureeventset-class = "omnetpp::cDaryEventHeap"
+ * </pre>
+ *
+ * @ingroup SimSupport
+ */
+class SIM_API cDaryEventHeap : public cFutureEventSet
+{
+  private:
+    struct Entry {
+        int64_t arrivalTime;       // raw simtime
+        eventnumber_t insertOrder;
+        cEvent *event;
+        short priority;
+        bool operator<(const Entry& other) const;  // same as cEvent::shouldPrecede()
+    };
+
+    // heap data structure (0-based; children of node i are 4i+1..4i+4)
+    Entry *heap;              // heap array, aligned so that children groups do not straddle cache lines
+    void *heapAlloc;          // the allocated memory block that contains heap[]
+    int heapLength;           // number of elements on the heap
+    int heapCapacity;         // allocated size of the heap[] array
+    eventnumber_t insertCount; // counts insertions; needed because heap's insert is not stable (does not keep order)
+
+    // circular buffer for events scheduled for the current simtime (quite frequent); acts as FIFO
+    cEvent **cb;              // size of the circular buffer
+    int cbsize;               // always power of 2
+    int cbhead, cbtail;       // cbhead is inclusive, cbtail is exclusive
+    bool useCb;               // for disabling cb
+
+  private:
+    void copy(const cDaryEventHeap& other);
+    void allocateHeap(int capacity);
+    static Entry makeEntry(cEvent *event);
+
+    // internal: restore heap
+    void siftUp(int pos, const Entry& entry);
+    void siftDown(int pos, const Entry& entry);
+
+    int cblength() const  {return (cbtail-cbhead) & (cbsize-1);}
+    cEvent *cbget(int k)  {return cb[(cbhead+k) & (cbsize-1)];}
+    void cbgrow();
+
+    void heapInsert(cEvent *event);
+    void cbInsert(cEvent *event);
+    void flushCb();
+
+  public:
+    // internal:
+    bool getUseCb() const {return useCb;}
+    void setUseCb(bool b) {ASSERT(cbhead==cbtail); useCb = b;}
+
+  public:
+    /** @name Constructors, destructor, assignment */
+    //@{
+
+    /**
+     * Copy constructor.
+     */
+    cDaryEventHeap(const cDaryEventHeap& other);
+
+    /**
+     * Constructor.
+     */
+    cDaryEventHeap(const char *name=nullptr, int initialCapacity=128);
+
+    /**
+     * Destructor.
+     */
+    virtual ~cDaryEventHeap();
+
+    /**
+     * Assignment operator. The name member is not copied;
+     * see cOwnedObject's operator=() for more details.
+     */
+    cDaryEventHeap& operator=(const cDaryEventHeap& other);
+    //@}
+
+    /** @name Redefined cObject member functions. */
+    //@{
+
+    /**
+     * Creates and returns an exact copy of this object.
+     * See cObject for more details.
+     */
+    virtual cDaryEventHeap *dup() const override  {return new cDaryEventHeap(*this);}
+
+    /**
+     * Produces a one-line description of the object's contents.
+     * See cObject for more details.
+     */
+    virtual std::string str() const override;
+
+    /**
+     * Calls v->visit(this) for each contained object.
+     * See cObject for more details.
+     */
+    virtual void forEachChild(cVisitor *v) override;
+
+    // no parsimPack() and parsimUnpack()
+    //@}
+
+    /** @name Simulation-related operations. */
+    //@{
+    /**
+     * Insert an event into the FES.
+     */
+    virtual void insert(cEvent *event) override;
+
+    /**
+     * Peek the first event in the FES (the one with the smallest timestamp.)
+     * If the FES is empty, it returns nullptr.
+     */
+    virtual cEvent *peekFirst() const override;
+
+    /**
+     * Removes and return the first event in the FES (the one with the
+     * smallest timestamp.) If the FES is empty, it returns nullptr.
+     */
+    virtual cEvent *removeFirst() override;
+
+    /**
+     * Undo for removeFirst(): it puts back an event to the front of the FES.
+     */
+    virtual void putBackFirst(cEvent *event) override;
+
+    /**
+     * Removes and returns the given event in the FES. If the event is
+     * not in the FES, returns nullptr.
+     */
+    virtual cEvent *remove(cEvent *event) override;
+
+    /**
+     * Returns true if the FES is empty.
+     */
+    virtual bool isEmpty() const override {return cbhead==cbtail && heapLength==0;}
+
+    /**
+     * Deletes all events in the FES.
+     */
+    virtual void clear() override;
+    //@}
+
+    /** @name Random access. */
+    //@{
+
+    /**
+     * Returns the number of events in the FES.
+     */
+    virtual int getLength() const override {return cblength() + heapLength;}
+
+    /**
+     * Returns the kth event in the FES if 0 <= k < getLength(), and nullptr
+     * otherwise. Note that iteration does not necessarily return events
+     * in increasing timestamp (getArrivalTime()) order unless you called
+     * sort() before.
+     */
+    virtual cEvent *get(int k) override;
+
+    /**
+     * Sorts the contents of the FES. This is only necessary if one wants
+     * to iterate through in the FES in strict timestamp order.
+     */
+    virtual void sort() override;
+};
+
+}  // namespace omnetpp
+
+
+#endif
+
@@ -174,6 +174,20 @@ class SIM_API cDatarateChannel : public cChannel //implies noncopyable
     virtual std::string str() const override;
     //@}
 
+    /** @name Redefined cComponent member functions. */
+    //@{
+    /**
+     * Saves the state of the ongoing transmissions, in addition to the
+     * parameters.
+     */
+    virtual void checkpointPack(cCommBuffer *buffer) const override;
+
+    /**
+     * Restores the state saved by checkpointPack().
+     */
+    virtual void checkpointUnpack(cCommBuffer *buffer) override;
+    //@}
+
     /** @name Setting and getting channel parameters. */
     //@{
     /**
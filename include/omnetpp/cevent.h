@@ -23,6 +23,8 @@ namespace omnetpp {
 class cMessage;
 class cPacket;
 class cEventHeap;
+class cLadderQueue;
+class cDaryEventHeap;
 
 /**
  * @brief Represents an event in the discrete event simulator.
@@ -47,10 +49,12 @@ class SIM_API cEvent : public cOwnedObject
 {
     friend class cMessage;     // getArrivalTime()
     friend class cEventHeap;   // heapIndex
+    friend class cLadderQueue; // heapIndex
+    friend class cDaryEventHeap; // heapIndex
   private:
     simtime_t arrivalTime;     // time of delivery -- set internally
     short priority;            // priority -- used for scheduling events with equal arrival times
-    int heapIndex;             // used by cEventHeap (-1 if not on heap; all other values, including negative ones, means "on the heap")
+    int heapIndex;             // used by the FES (-1 if not on heap; all other values, including negative ones, means "on the heap")
     eventnumber_t insertOrder; // used by the FES to keep order of events with equal time and priority
     eventnumber_t previousEventNumber; // most recent event number when envir was notified about this event object (e.g. creating/cloning/sending/scheduling/deleting of this event object)
 
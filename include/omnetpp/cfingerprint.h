@@ -196,6 +196,10 @@ class SIM_API cSingleFingerprintCalculator : public cFingerprintCalculator
 
     virtual bool checkFingerprint() const override;
 
+    /** Saves the current hash value, so that the computation can be continued later. */
+    virtual void parsimPack(cCommBuffer *buffer) const override;
+    /** Restores the hash value saved by parsimPack(). The ingredients must be the same. */
+    virtual void parsimUnpack(cCommBuffer *buffer) override;
 };
 
 
@@ -242,6 +246,9 @@ class SIM_API cMultiFingerprintCalculator : public cFingerprintCalculator
     virtual void addExtraData(const char *data) override { for (auto element: elements) element->addExtraData(data); }
 
     virtual bool checkFingerprint() const override;
+
+    virtual void parsimPack(cCommBuffer *buffer) const override;
+    virtual void parsimUnpack(cCommBuffer *buffer) override;
 };
 
 } // namespace omnetpp
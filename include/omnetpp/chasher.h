@@ -81,6 +81,12 @@ class SIM_API cHasher : noncopyable
      */
     uint32_t getHash() const {return value;}
 
+    /**
+     * Sets the hash value, so that hashing can continue from a value
+     * obtained earlier via getHash().
+     */
+    void setHash(uint32_t hash) {value = hash;}
+
     /**
      * Converts the given string to a numeric hash value. The object is
      * not changed. Throws an error if the string does not contain a valid
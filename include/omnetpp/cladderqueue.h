@@ -0,0 +1,218 @@
+//==========================================================================
+//  CLADDERQUEUE.H - part of
+//                     OMNeT++/OMNEST
+//            Discrete System Simulation in C++
+//
+//==========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 1992-2017 Andras Varga
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#ifndef __OMNETPP_CLADDERQUEUE_H
+#define __OMNETPP_CLADDERQUEUE_H
+
+#include <vector>
+#include <deque>
+#include "cfutureeventset.h"
+
+namespace omnetpp {
+
+/**
+ * @brief Ladder queue based implementation of the future event set.
+ *
+ * The ladder queue (W. T. Tang, R. S. M. Goh, I. L.-J. Thng: "Ladder Queue:
+ * An O(1) Priority Queue Structure for Large-Scale Discrete Event Simulation",
+ * ACM TOMACS 2005) offers amortized O(1) insertion and removal, and it is
+ * preferable to cEventHeap for models that keep a very large number (millions)
+ * of events in the FES.
+ *
+ * The data structure consists of three tiers. Far-future events are collected
+ * in the unsorted "top" list. When needed, they are distributed into the
+ * buckets of a "rung" according to arrival time; buckets that contain too
+ * many events are recursively split into finer-grained rungs, and finally the
+ * first bucket is sorted into the "bottom" list where events are taken from.
+ * Buckets are split by arrival time only, and all sorting is done with
+ * cEvent::shouldPrecede(), so the event order is exactly the same as with
+ * cEventHeap (arrival time, scheduling priority, insertion order), and
+ * simulation fingerprints are not affected by the choice of the FES class.
+ *
+ * To use this class, add the following line to omnetpp.ini:
+ *
+ * <pre>
+ * futureeventset-class = "omnetpp::cLadderQueue"
+ * </pre>
+ *
+ * @ingroup SimSupport
+ */
+class SIM_API cLadderQueue : public cFutureEventSet
+{
+  private:
+    typedef std::vector<cEvent *> Bucket;
+
+    struct Rung {
+        int64_t start;             // raw arrival time where bucket 0 begins
+        uint64_t bucketWidth;      // in raw simtime units, >= 1
+        int numBuckets;            // only the first numBuckets elements of buckets[] are in use
+        int currentBucket;         // buckets before this one have already been consumed
+        std::vector<Bucket> buckets;
+    };
+
+    eventnumber_t insertCount;  // counts insertions; the ladder's insert is not stable either
+    int length;                 // total number of events
+
+    // top: unsorted list of events with arrival time > topLimit
+    Bucket top;
+    int64_t topLimit;           // the rungs and the bottom cover arrival times up to (and including) topLimit
+    int64_t topMin, topMax;     // bounds of arrival times in top (may be loose after removals)
+
+    // ladder
+    std::vector<Rung> rungs;    // rung objects are reused to preserve bucket capacities
+    int numRungs;               // number of rungs in use
+
+    // bottom: events sorted in scheduling order
+    std::deque<cEvent *> bottom;
+
+    // for get(k): events collected in scheduling order; rebuilt after every change
+    std::vector<cEvent *> snapshot;
+    bool snapshotValid;
+
+  private:
+    void copy(const cLadderQueue& other);
+    void collectEvents(std::vector<cEvent *>& result) const;
+
+    void doInsert(cEvent *event);
+    bool findRung(int64_t t, int& rungIndex, int& bucketIndex) const;
+    void insertIntoBucket(Bucket& bucket, cEvent *event);
+    void removeFromBucket(Bucket& bucket, cEvent *event);
+    void insertIntoBottom(cEvent *event);
+
+    bool refillBottom();
+    void transferTopToRung();
+    void spawnRung(Bucket& events, int64_t start, uint64_t width);
+    Rung& addRung(int64_t start, uint64_t bucketWidth, int numBuckets);
+
+  public:
+    /** @name Constructors, destructor, assignment */
+    //@{
+
+    /**
+     * Copy constructor.
+     */
+    cLadderQueue(const cLadderQueue& other);
+
+    /**
+     * Constructor.
+     */
+    cLadderQueue(const char *name=nullptr);
+
+    /**
+     * Destructor.
+     */
+    virtual ~cLadderQueue();
+
+    /**
+     * Assignment operator. The name member is not copied;
+     * see cOwnedObject's operator=() for more details.
+     */
+    cLadderQueue& operator=(const cLadderQueue& other);
+    //@}
+
+    /** @name Redefined cObject member functions. */
+    //@{
+
+    /**
+     * Creates and returns an exact copy of this object.
+     * See cObject for more details.
+     */
+    virtual cLadderQueue *dup() const override  {return new cLadderQueue(*this);}
+
+    /**
+     * Produces a one-line description of the object's contents.
+     * See cObject for more details.
+     */
+    virtual std::string str() const override;
+
+    /**
+     * Calls v->visit(this) for each contained object.
+     * See cObject for more details.
+     */
+    virtual void forEachChild(cVisitor *v) override;
+
+    // no parsimPack() and parsimUnpack()
+    //@}
+
+    /** @name Simulation-related operations. */
+    //@{
+    /**
+     * Insert an event into the FES.
+     */
+    virtual void insert(cEvent *event) override;
+
+    /**
+     * Peek the first event in the FES (the one with the smallest timestamp.)
+     * If the FES is empty, it returns nullptr.
+     */
+    virtual cEvent *peekFirst() const override;
+
+    /**
+     * Removes and return the first event in the FES (the one with the
+     * smallest timestamp.) If the FES is empty, it returns nullptr.
+     */
+    virtual cEvent *removeFirst() override;
+
+    /**
+     * Undo for removeFirst(): it puts back an event to the front of the FES.
+     */
+    virtual void putBackFirst(cEvent *event) override;
+
+    /**
+     * Removes and returns the given event in the FES. If the event is
+     * not in the FES, returns nullptr.
+     */
+    virtual cEvent *remove(cEvent *event) override;
+
+    /**
+     * Returns true if the FES is empty.
+     */
+    virtual bool isEmpty() const override {return length == 0;}
+
+    /**
+     * Deletes all events in the FES.
+     */
+    virtual void clear() override;
+    //@}
+
+    /** @name Random access. */
+    //@{
+
+    /**
+     * Returns the number of events in the FES.
+     */
+    virtual int getLength() const override {return length;}
+
+    /**
+     * Returns the kth event in the FES if 0 <= k < getLength(), and nullptr
+     * otherwise. This class always returns events in scheduling order;
+     * note that get() has to collect and sort all events after every change
+     * in the FES, so it is considerably slower than with cEventHeap.
+     */
+    virtual cEvent *get(int k) override;
+
+    /**
+     * Sorts the contents of the FES. In this class it is a no-op, as get()
+     * already returns events in scheduling order.
+     */
+    virtual void sort() override {}
+    //@}
+};
+
+}  // namespace omnetpp
+
+
+#endif
+
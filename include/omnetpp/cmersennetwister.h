@@ -55,6 +55,12 @@ class SIM_API cMersenneTwister : public cRNG
     /** Tests correctness of the RNG */
     virtual void selfTest() override;
 
+    /** Saves the state of the RNG, including the number of values drawn. */
+    virtual void parsimPack(cCommBuffer *buffer) const override;
+
+    /** Restores the state saved by parsimPack(). */
+    virtual void parsimUnpack(cCommBuffer *buffer) override;
+
     /** Random integer in the range [0,intRandMax()] */
     virtual unsigned long intRand() override;
 
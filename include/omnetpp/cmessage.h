@@ -16,6 +16,7 @@
 #ifndef __OMNETPP_CMESSAGE_H
 #define __OMNETPP_CMESSAGE_H
 
+#include <new>
 #include <vector>
 #include "cevent.h"
 #include "carray.h"
@@ -121,6 +122,13 @@ class SIM_API cMessage : public cEvent
     static long totalMsgCount;
     static long liveMsgCount;
 
+    // optional recycling of message storage; see setPoolingEnabled()
+    static bool poolingEnabled;
+    static void *freeBlocks[];  // free lists, indexed by size class
+    static long poolHitCount;
+    static long poolMissCount;
+    static long pooledBlockCount;
+
   private:
     // internal: create parlist
     void _createparlist();
@@ -148,6 +156,17 @@ class SIM_API cMessage : public cEvent
     // internal: returns the parameter list object, or nullptr if it hasn't been used yet
     cArray *getParListPtr()  {return parList;}
 
+    // internal: allocation functions that implement message pooling; they are
+    // inherited by cPacket and all message classes generated from .msg files.
+    // Declaring them hides the global placement and nothrow forms, so those
+    // are redeclared here as well.
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+    static void *operator new(size_t size, const std::nothrow_t&) noexcept;
+    static void operator delete(void *p, const std::nothrow_t&) noexcept;
+    static void *operator new(size_t size, void *place) noexcept {return place;}
+    static void operator delete(void *, void *) noexcept {}
+
   protected: // hide cEvent methods from the cMessage API
 
     // overridden from cEvent: return true
@@ -635,9 +654,55 @@ class SIM_API cMessage : public cEvent
     static long getLiveMessageCount() {return liveMsgCount;}
 
     /**
-     * Reset counters used by getTotalMessageCount() and getLiveMessageCount().
+     * Reset counters used by getTotalMessageCount() and getLiveMessageCount(),
+     * and the message pool statistics.
+     */
+    static void resetMessageCounters()  {totalMsgCount=liveMsgCount=0; poolHitCount=poolMissCount=0;}
+    //@}
+
+    /** @name Message pooling. */
+    //@{
+    /**
+     * Enables or disables message pooling. When pooling is enabled, the memory
+     * of deleted message objects (cMessage, cPacket and their subclasses,
+     * including classes generated from .msg files) is kept on per-size free
+     * lists, and reused for new message objects of the same size. This
+     * saves calls to the global memory allocator in simulations that create
+     * and delete a large number of messages. Only the storage is recycled:
+     * constructors and destructors run as usual, so message IDs, ownership
+     * and the message counters are not affected. Very large message classes
+     * are not pooled. Disabling pooling releases the memory held by the pool.
+     * Pooling is controlled by the message-pooling configuration option.
+     */
+    static void setPoolingEnabled(bool enabled);
+
+    /**
+     * Returns true if message pooling is enabled.
+     */
+    static bool isPoolingEnabled()  {return poolingEnabled;}
+
+    /**
+     * Releases the memory of the message objects currently held by the pool.
+     */
+    static void purgePool();
+
+    /**
+     * Returns the number of message allocations served from the pool since
+     * the last reset (see resetMessageCounters()).
+     */
+    static long getPoolHitCount()  {return poolHitCount;}
+
+    /**
+     * Returns the number of message allocations (for which the pool was
+     * consulted) that had to be served by the global memory allocator, since
+     * the last reset (see resetMessageCounters()).
+     */
+    static long getPoolMissCount()  {return poolMissCount;}
+
+    /**
+     * Returns the number of free message blocks currently held by the pool.
      */
-    static void resetMessageCounters()  {totalMsgCount=liveMsgCount=0;}
+    static long getPooledBlockCount()  {return pooledBlockCount;}
     //@}
 };
 
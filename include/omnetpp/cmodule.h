@@ -285,6 +285,9 @@ class SIM_API cModule : public cComponent //implies noncopyable
     cChannel *firstChannel;  // pointer to first channel in this compound module (list is needed for ChannelIterator)
     cChannel *lastChannel;   // pointer to last channel (needed for efficient append operation)
 
+    struct SubmoduleIndex;
+    mutable SubmoduleIndex *submoduleIndex; // submodules by name and index, for getSubmodule(); built on first lookup, nullptr until then
+
     typedef std::set<cGate::Name> NamePool;
     static NamePool namePool;
     int gateDescArraySize;    // size of the descv array
@@ -335,6 +338,14 @@ class SIM_API cModule : public cComponent //implies noncopyable
     // internal: removes a submodule
     void removeSubmodule(cModule *mod);
 
+    // internal: keep submoduleIndex up to date when a submodule is renamed
+    void submoduleRenaming(cModule *mod);
+    void submoduleRenamed(cModule *mod);
+
+    // internal: builds submoduleIndex, or discards it if it cannot be updated incrementally
+    void buildSubmoduleIndex() const;
+    void discardSubmoduleIndex();
+
     // internal: inserts a channel. Called from cGate::connectTo()
     void insertChannel(cChannel *channel);
 
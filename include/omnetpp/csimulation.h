@@ -398,6 +398,12 @@ class SIM_API cSimulation : public cNamedObject, noncopyable
      */
     eventnumber_t getEventNumber() const  {return currentEventNumber;}
 
+    /**
+     * INTERNAL USE ONLY. This method should NEVER be invoked from
+     * simulation models; it is used when restoring a simulation checkpoint.
+     */
+    void setEventNumber(eventnumber_t e)  {currentEventNumber = e;}
+
     /**
      * Returns the length of the initial warm-up period from the configuration.
      * Modules that compute and record scalar results manually (via recordScalar(),
@@ -4,15 +4,19 @@ import subprocess
 from math import inf
 import numpy as np
 import pandas as pd
+from . import scavelib
 
 """
 This module implements the same result querying API that is provided by the IDE to chart scripts,
-using the opp_scavetool program to load the .sca and .vec files.
+using the opp_scavetool program to load the .sca and .vec files. Scalars and vectors are loaded
+in-process through liboppscave instead (see scavelib), if the library is available.
 """
 
 # TODO: document
 inputfiles = list()
 
+_loaders = dict()
+
 
 def _parse_int(s):
     return int(s) if s else None
@@ -75,6 +79,21 @@ def _get_results(filter_expression, file_extensions, result_type, *additional_ar
 
     return df
 
+def _get_results_native(filter_expression, file_extensions, result_type, start_time=-inf, end_time=inf):
+    if not scavelib.available():
+        return None
+
+    filelist = tuple(i for i in inputfiles if any([i.endswith(e) for e in file_extensions]))
+    if filelist not in _loaders:
+        _loaders[filelist] = scavelib.ResultLoader(filelist)
+
+    df = _loaders[filelist].query(filter_expression, result_type, start_time, end_time)
+
+    if df.empty:
+        print("<!> HINT: the query returned an empty result. Consider adding a project name to directory mapping, for example: -p /aloha=../aloha")
+
+    return df
+
 def _split_by_types(df, types):
     result = list()
     for t in types:
@@ -126,12 +145,16 @@ def get_results(filter_expression="", row_types=['runattr', 'itervar', 'config',
 
 def get_scalars(filter_expression="", include_attrs=False, include_runattrs=False, include_itervars=False, include_param_assignments=False, include_config_entries=False, merge_module_and_name=False):
     # TODO filter row types based on include_ args, as optimization
-    df = _get_results(filter_expression, ['.sca'], 's')
+    df = _get_results_native(filter_expression, ['.sca'], scavelib.SCALAR)
+    if df is None:
+        df = _get_results(filter_expression, ['.sca'], 's')
     df = _pivot_results(df, include_attrs, include_runattrs, include_itervars, include_param_assignments, include_config_entries, merge_module_and_name)
     return df
 
 def get_vectors(filter_expression="", include_attrs=False, include_runattrs=False, include_itervars=False, include_param_assignments=False, include_config_entries=False, merge_module_and_name=False, start_time=-inf, end_time=inf):
-    df = _get_results(filter_expression, ['.vec'], 'v', '--start-time', str(start_time), '--end-time', str(end_time))
+    df = _get_results_native(filter_expression, ['.vec'], scavelib.VECTOR, start_time, end_time)
+    if df is None:
+        df = _get_results(filter_expression, ['.vec'], 'v', '--start-time', str(start_time), '--end-time', str(end_time))
     df = _pivot_results(df, include_attrs, include_runattrs, include_itervars, include_param_assignments, include_config_entries, merge_module_and_name)
     return df
 
@@ -21,6 +21,12 @@
 #include <cstring>
 #include <csignal>
 #include <algorithm>
+#include <map>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 
 #include "common/opp_ctype.h"
 #include "common/commonutil.h"
@@ -62,6 +68,7 @@ namespace cmdenv {
 
 Register_GlobalConfigOption(CFGID_CMDENV_CONFIG_NAME, "cmdenv-config-name", CFG_STRING, nullptr, "Specifies the name of the configuration to be run (for a value `Foo`, section `[Config Foo]` will be used from the ini file). See also `cmdenv-runs-to-execute`. The `-c` command line option overrides this setting.")
 Register_GlobalConfigOption(CFGID_CMDENV_RUNS_TO_EXECUTE, "cmdenv-runs-to-execute", CFG_STRING, nullptr, "Specifies which runs to execute from the selected configuration (see `cmdenv-config-name` option). It accepts a filter expression of iteration variables such as `$numHosts>10 && $iatime==1s`, or a comma-separated list of run numbers or run number ranges, e.g. `1,3..4,7..9`. If the value is missing, Cmdenv executes all runs in the selected configuration. The `-r` command line option overrides this setting.")
+Register_GlobalConfigOption(CFGID_CMDENV_NUM_WORKERS, "cmdenv-num-workers", CFG_INT, "1", "Specifies the number of runs Cmdenv executes in parallel. When greater than one, each run is executed in a separate worker process forked from Cmdenv, and the output of each run is redirected to a file (see `cmdenv-output-file`). Only supported on POSIX systems. The `-j` command line option overrides this setting.")
 Register_GlobalConfigOptionU(CFGID_CMDENV_EXTRA_STACK, "cmdenv-extra-stack", "B", "8KiB", "Specifies the extra amount of stack that is reserved for each `activity()` simple module when the simulation is run under Cmdenv.")
 Register_PerRunConfigOption(CFGID_CMDENV_STOP_BATCH_ON_ERROR, "cmdenv-stop-batch-on-error", CFG_BOOL, "true", "Decides whether Cmdenv should skip the rest of the runs when an error occurs during the execution of one run.")
 Register_PerRunConfigOption(CFGID_CMDENV_INTERACTIVE, "cmdenv-interactive", CFG_BOOL, "false", "Defines what Cmdenv should do when the model contains unassigned parameters. In interactive mode, it asks the user. In non-interactive mode (which is more suitable for batch execution), Cmdenv stops with an error.")
@@ -74,6 +81,7 @@ Register_PerRunConfigOption(CFGID_CMDENV_EVENT_BANNER_DETAILS, "cmdenv-event-ban
 Register_PerRunConfigOptionU(CFGID_CMDENV_STATUS_FREQUENCY, "cmdenv-status-frequency", "s", "2s", "When `cmdenv-express-mode=true`: print status update every n seconds.")
 Register_PerRunConfigOption(CFGID_CMDENV_PERFORMANCE_DISPLAY, "cmdenv-performance-display", CFG_BOOL, "true", "When `cmdenv-express-mode=true`: print detailed performance information. Turning it on results in a 3-line entry printed on each update, containing ev/sec, simsec/sec, ev/simsec, number of messages created/still present/currently scheduled in FES.")
 Register_PerRunConfigOption(CFGID_CMDENV_LOG_PREFIX, "cmdenv-log-prefix", CFG_STRING, "[%l]\t", "Specifies the format string that determines the prefix of each log line. The format string may contain format directives in the syntax `%x` (a `%` followed by a single format character).  For example `%l` stands for log level, and `%J` for source component. See the manual for the list of available format characters.");
+Register_PerRunConfigOptionU(CFGID_CMDENV_FORK_TIME, "cmdenv-fork-time", "s", nullptr, "When specified, the runs that only differ in the repetition (see `repeat`) share the simulation up to the given simulation time: the first run of the group is executed up to that time, then a process is forked for each run in the group to continue the simulation as that run. The first run continues unchanged; the others reseed the RNGs according to their own `seed-set`, and write their own result files. The parent process waits for the forked processes; `cmdenv-num-workers` limits how many of them run concurrently. No results may be recorded before the fork time (use `warmup-period`), and eventlog recording is not supported. Only supported on POSIX systems.");
 Register_PerRunConfigOption(CFGID_CMDENV_FAKE_GUI, "cmdenv-fake-gui", CFG_BOOL, "false", "Causes Cmdenv to lie to simulations that is a GUI (isGui()=true), and to periodically invoke refreshDisplay() during simulation execution.");
 Register_PerObjectConfigOption(CFGID_CMDENV_LOGLEVEL, "cmdenv-log-level", KIND_MODULE, CFG_STRING, "TRACE", "Specifies the per-component level of detail recorded by log statements, output below the specified level is omitted. Available values are (case insensitive): `off`, `fatal`, `error`, `warn`, `info`, `detail`, `debug` or `trace`. Note that the level of detail is also controlled by the globally specified runtime log level and the `COMPILETIME_LOGLEVEL` macro that is used to completely remove log statements from the executable.")
 
@@ -113,6 +121,7 @@ CmdenvOptions::CmdenvOptions()
 {
     // note: these values will be overwritten in setup()/readOptions() before taking effect
     stopBatchOnError = true;
+    numWorkers = 1;
     extraStack = 0;
     redirectOutput = false;
     autoflush = true;
@@ -152,6 +161,7 @@ void Cmdenv::readOptions()
     opt->configName = cfg->getAsString(CFGID_CMDENV_CONFIG_NAME);
     opt->runFilter = cfg->getAsString(CFGID_CMDENV_RUNS_TO_EXECUTE);
     opt->extraStack = (size_t)cfg->getAsDouble(CFGID_CMDENV_EXTRA_STACK);
+    opt->numWorkers = cfg->getAsInt(CFGID_CMDENV_NUM_WORKERS);
 }
 
 void Cmdenv::readPerRunOptions()
@@ -171,6 +181,7 @@ void Cmdenv::readPerRunOptions()
     opt->outputFile = cfg->getAsFilename(CFGID_CMDENV_OUTPUT_FILE).c_str();
     opt->redirectOutput = cfg->getAsBool(CFGID_CMDENV_REDIRECT_OUTPUT);
     opt->fakeGUI = cfg->getAsBool(CFGID_CMDENV_FAKE_GUI);
+    opt->forkTime = cfg->getAsDouble(CFGID_CMDENV_FORK_TIME, -1);
     delete fakeGUI;
     fakeGUI = nullptr;
     if (opt->fakeGUI) {
@@ -197,6 +208,8 @@ void Cmdenv::doRun()
 
         std::vector<int> runNumbers;
         try {
+            if (args->optionGiven('j'))  // overrides cmdenv-num-workers
+                opt->numWorkers = (int)opp_atol(args->optionValue('j'));
             runNumbers = resolveRunFilter(opt->configName.c_str(), opt->runFilter.c_str());
         }
         catch (std::exception& e) {
@@ -207,143 +220,525 @@ void Cmdenv::doRun()
 
         numRuns = (int)runNumbers.size();
         runsTried = 0;
-        int numErrors = 0;
-        for (int runNumber : runNumbers) {
-            runsTried++;
-            bool finishedOK = false;
-            bool networkSetupDone = false;
-            bool endRunRequired = false;
-            try {
-                if (opt->verbose)
-                    out << "\nPreparing for running configuration " << opt->configName << ", run #" << runNumber << "..." << endl;
+        numErrors = 0;
 
-                cfg->activateConfig(opt->configName.c_str(), runNumber);
-                readPerRunOptions();
+        std::vector<std::vector<int>> runGroups;
+        bool forking = groupRunsForForking(runNumbers, runGroups);
 
-                const char *iterVars = cfg->getVariable(CFGVAR_ITERATIONVARS);
-                const char *runId = cfg->getVariable(CFGVAR_RUNID);
-                const char *repetition = cfg->getVariable(CFGVAR_REPETITION);
-                if (!opt->verbose)
-                    out << opt->configName << " run " << runNumber << ": " << iterVars << ", $repetition=" << repetition << endl; // print before redirection; useful as progress indication from opp_runall
-
-                if (opt->redirectOutput) {
-                    processFileName(opt->outputFile);
-                    if (opt->verbose)
-                        out << "Redirecting output to file \"" << opt->outputFile << "\"..." << endl;
-                    startOutputRedirection(opt->outputFile.c_str());
-                    if (opt->verbose)
-                        out << "\nRunning configuration " << opt->configName << ", run #" << runNumber << "..." << endl;
-                }
+        if (opt->numWorkers > 1 && numRuns > 1 && !forking) {
+            runInWorkerProcesses(runNumbers);
+        }
+        else {
+            for (const std::vector<int>& runGroup : runGroups) {
+                runsTried += runGroup.size();
+                bool finishedOK = runSimulation(runGroup.front(), runGroup);
 
-                if (opt->verbose) {
-                    if (iterVars && strlen(iterVars) > 0)
-                        out << "Scenario: " << iterVars << ", $repetition=" << repetition << endl;
-                    out << "Assigned runID=" << runId << endl;
+#ifndef _WIN32
+                if (isForkedProcess) {
+                    // child forked at cmdenv-fork-time: report the outcome in the exit code
+                    out.flush();
+                    fflush(stdout);
+                    fflush(stderr);
+                    _exit(numErrors > 0 ? 1 : sigintReceived ? 2 : 0);
                 }
+#endif
 
-                // find network
-                if (opt->networkName.empty())
-                    throw cRuntimeError("No network specified (missing or empty network= configuration option)");
-                cModuleType *network = resolveNetwork(opt->networkName.c_str());
-                ASSERT(network);
+                // skip further runs if signal was caught
+                if (sigintReceived)
+                    break;
 
-                endRunRequired = true;
+                if (!finishedOK && opt->stopBatchOnError)
+                    break;
+            }
+        }
 
-                // set up network
-                if (opt->verbose)
-                    out << "Setting up network \"" << opt->networkName.c_str() << "\"..." << endl;
+        if (numRuns > 1 && opt->verbose) {
+            int numSkipped = numRuns - runsTried;
+            int numSuccess = runsTried - numErrors;
+            out << "\nRun statistics: total " << numRuns;
+            if (numSuccess > 0)
+                out << ", successful " << numSuccess;
+            if (numErrors > 0)
+                out << ", errors " << numErrors;
+            if (numSkipped > 0)
+                out << ", skipped " << numSkipped;
+            out << endl;
+        }
+
+        exitCode = numErrors > 0 ? 1 : sigintReceived ? 2 : 0;
+    }
+}
 
-                setupNetwork(network);
-                networkSetupDone = true;
+bool Cmdenv::runSimulation(int runNumber, const std::vector<int>& runGroup)
+{
+    bool finishedOK = false;
+    bool networkSetupDone = false;
+    bool endRunRequired = false;
+    forkRunNumbers.clear();
+    forkPending = forkDone = false;
+    numForkErrors = 0;
+    try {
+        if (opt->verbose)
+            out << "\nPreparing for running configuration " << opt->configName << ", run #" << runNumber << "..." << endl;
+
+        cfg->activateConfig(opt->configName.c_str(), runNumber);
+        readPerRunOptions();
+
+        if (opt->forkTime >= 0 && !runGroup.empty()) {
+            forkRunNumbers = runGroup;
+#ifdef _WIN32
+            throw cRuntimeError("Forking runs (cmdenv-fork-time) is not supported on this platform");
+#endif
+            if (recordEventlog)
+                throw cRuntimeError("Eventlog recording cannot be combined with cmdenv-fork-time");
+            if (opt->parsim)
+                throw cRuntimeError("Parallel simulation cannot be combined with cmdenv-fork-time");
+            if (opt->simtimeLimit >= 0 && opt->forkTime >= opt->simtimeLimit)
+                throw cRuntimeError("cmdenv-fork-time must be less than sim-time-limit");
+            forkPending = true;
+        }
 
-                // prepare for simulation run
-                if (opt->verbose)
-                    out << "Initializing..." << endl;
+        const char *iterVars = cfg->getVariable(CFGVAR_ITERATIONVARS);
+        const char *runId = cfg->getVariable(CFGVAR_RUNID);
+        const char *repetition = cfg->getVariable(CFGVAR_REPETITION);
+        if (isWorkerProcess)
+            opt->redirectOutput = true;  // output of concurrent runs would get mixed up on the console
+        else if (!opt->verbose)
+            out << opt->configName << " run " << runNumber << ": " << iterVars << ", $repetition=" << repetition << endl; // print before redirection; useful as progress indication from opp_runall
+
+        if (opt->redirectOutput) {
+            processFileName(opt->outputFile);
+            if (opt->verbose)
+                out << "Redirecting output to file \"" << opt->outputFile << "\"..." << endl;
+            startOutputRedirection(opt->outputFile.c_str());
+            if (opt->verbose)
+                out << "\nRunning configuration " << opt->configName << ", run #" << runNumber << "..." << endl;
+        }
+
+        if (opt->verbose) {
+            if (iterVars && strlen(iterVars) > 0)
+                out << "Scenario: " << iterVars << ", $repetition=" << repetition << endl;
+            out << "Assigned runID=" << runId << endl;
+        }
 
-                loggingEnabled = !opt->expressMode;
+        // find network
+        if (opt->networkName.empty())
+            throw cRuntimeError("No network specified (missing or empty network= configuration option)");
+        cModuleType *network = resolveNetwork(opt->networkName.c_str());
+        ASSERT(network);
 
-                prepareForRun();
+        endRunRequired = true;
 
-                // run the simulation
-                if (opt->verbose)
-                    out << "\nRunning simulation..." << endl;
+        // set up network
+        if (opt->verbose)
+            out << "Setting up network \"" << opt->networkName.c_str() << "\"..." << endl;
 
-                // simulate() should only throw exception if error occurred and
-                // finish() should not be called.
-                notifyLifecycleListeners(LF_ON_SIMULATION_START);
-                simulate();
-                loggingEnabled = true;
+        setupNetwork(network);
+        networkSetupDone = true;
 
-                if (opt->verbose)
-                    out << "\nCalling finish() at end of Run #" << runNumber << "..." << endl;
-                getSimulation()->callFinish();
-                cLogProxy::flushLastLine();
+        // prepare for simulation run
+        if (opt->verbose)
+            out << "Initializing..." << endl;
+
+        loggingEnabled = !opt->expressMode;
+
+        prepareForRun();
+
+        // run the simulation
+        if (opt->verbose)
+            out << "\nRunning simulation..." << endl;
+
+        // simulate() should only throw exception if error occurred and
+        // finish() should not be called.
+        notifyLifecycleListeners(LF_ON_SIMULATION_START);
+        simulate();
+        loggingEnabled = true;
+
+        // in the parent of the forked processes, the runs have been completed by them
+        if (!forkDone) {
+            if (forkPending && forkRunNumbers.size() > 1) {
+                out << "Warning: Simulation ended before cmdenv-fork-time, skipping the other runs of the group" << endl;
+                runsTried -= forkRunNumbers.size() - 1;
+                forkRunNumbers.resize(1);
+            }
+            forkPending = false;
+
+            if (opt->verbose)
+                out << "\nCalling finish() at end of Run #" << cfg->getActiveRunNumber() << "..." << endl;
+            getSimulation()->callFinish();
+            cLogProxy::flushLastLine();
+
+            checkFingerprint();
+
+            notifyLifecycleListeners(LF_ON_SIMULATION_SUCCESS);
+        }
+
+        finishedOK = true;
+    }
+    catch (std::exception& e) {
+        loggingEnabled = true;
+        stoppedWithException(e);
+        notifyLifecycleListeners(LF_ON_SIMULATION_ERROR);
+        displayException(e);
+    }
+
+    // send LF_ON_RUN_END notification
+    if (endRunRequired) {
+        try {
+            notifyLifecycleListeners(LF_ON_RUN_END);
+        }
+        catch (std::exception& e) {
+            finishedOK = false;
+            notifyLifecycleListeners(LF_ON_SIMULATION_ERROR);
+            displayException(e);
+        }
+    }
+
+    // delete network
+    if (networkSetupDone) {
+        try {
+            getSimulation()->deleteNetwork();
+        }
+        catch (std::exception& e) {
+            numErrors++;
+            notifyLifecycleListeners(LF_ON_SIMULATION_ERROR);
+            displayException(e);
+        }
+    }
+
+    // stop redirecting into file
+    stopOutputRedirection();
+
+    if (forkDone) {
+        // the outcome of the forked runs has been counted when they finished
+        if (!finishedOK)
+            numErrors++;
+        return finishedOK && numForkErrors == 0;
+    }
+    if (!finishedOK)
+        numErrors += isForkedProcess ? 1 : std::max((int)forkRunNumbers.size(), 1);  // if failed before the fork, the whole group failed
+    return finishedOK;
+}
+
+#ifndef _WIN32
+// prints the outcome of a run executed in a child process, from the status returned
+// by waitpid(); returns false if the run failed
+static bool printExitStatus(std::ostream& out, int status, bool& interrupted)
+{
+    interrupted = false;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        out << "OK";
+        return true;
+    }
+    else if (WIFEXITED(status) && WEXITSTATUS(status) == 2) {
+        out << "interrupted";
+        interrupted = true;
+        return true;
+    }
+    else if (WIFEXITED(status))
+        out << "error (exit code " << WEXITSTATUS(status) << ")";
+    else if (WIFSIGNALED(status))
+        out << "terminated by signal " << WTERMSIG(status);
+    else
+        out << "unknown status";
+    return false;
+}
+#endif
 
-                checkFingerprint();
+void Cmdenv::runInWorkerProcesses(const std::vector<int>& runNumbers)
+{
+#ifdef _WIN32
+    out << "Warning: Parallel execution of runs (cmdenv-num-workers > 1) is not supported on this platform, executing runs sequentially" << endl;
+    for (int runNumber : runNumbers) {
+        runsTried++;
+        bool finishedOK = runSimulation(runNumber);
+        if (sigintReceived)
+            break;
+        if (!finishedOK && opt->stopBatchOnError)
+            break;
+    }
+#else
+    struct WorkerInfo {
+        int runNumber;
+        bool stopBatchOnError;
+    };
+    std::map<pid_t, WorkerInfo> workers;
+    int numWorkers = std::min(opt->numWorkers, (int)runNumbers.size());
+    int numFinished = 0;
+    bool stopLaunching = false;
+
+    if (opt->verbose)
+        out << "\nExecuting " << runNumbers.size() << " runs in " << numWorkers << " worker processes..." << endl;
+
+    // let the workers finish their current runs on Ctrl-C, and stop launching new ones
+    installSignalHandler();
+    sigintReceived = false;
 
-                notifyLifecycleListeners(LF_ON_SIMULATION_SUCCESS);
+    auto it = runNumbers.begin();
+    while (!workers.empty() || (it != runNumbers.end() && !stopLaunching)) {
+        // launch workers for the next runs in the queue
+        while ((int)workers.size() < numWorkers && it != runNumbers.end() && !stopLaunching && !sigintReceived) {
+            int runNumber = *it++;
+            runsTried++;
 
-                finishedOK = true;
+            // the batch-related per-run settings are needed here in the parent as well
+            WorkerInfo info;
+            info.runNumber = runNumber;
+            try {
+                cfg->activateConfig(opt->configName.c_str(), runNumber);
+                readPerRunOptions();
+                info.stopBatchOnError = opt->stopBatchOnError;
+                const char *iterVars = cfg->getVariable(CFGVAR_ITERATIONVARS);
+                const char *repetition = cfg->getVariable(CFGVAR_REPETITION);
+                out << opt->configName << " run " << runNumber << ": " << iterVars << ", $repetition=" << repetition << endl;
             }
             catch (std::exception& e) {
-                loggingEnabled = true;
-                stoppedWithException(e);
-                notifyLifecycleListeners(LF_ON_SIMULATION_ERROR);
                 displayException(e);
+                numErrors++;
+                numFinished++;
+                if (opt->stopBatchOnError)
+                    stopLaunching = true;
+                continue;
             }
 
-            // send LF_ON_RUN_END notification
-            if (endRunRequired) {
-                try {
-                    notifyLifecycleListeners(LF_ON_RUN_END);
-                }
-                catch (std::exception& e) {
-                    finishedOK = false;
-                    notifyLifecycleListeners(LF_ON_SIMULATION_ERROR);
-                    displayException(e);
-                }
+            // flush buffers so that their contents do not get printed by the child process too
+            out.flush();
+            fflush(stdout);
+            fflush(stderr);
+
+            pid_t pid = fork();
+            if (pid == 0) {
+                // child: execute the run, and report the outcome in the exit code
+                isWorkerProcess = true;
+                numErrors = 0;
+                runSimulation(runNumber);
+                out.flush();
+                fflush(stdout);
+                fflush(stderr);
+                _exit(numErrors > 0 ? 1 : sigintReceived ? 2 : 0);
             }
+            else if (pid < 0) {
+                err() << "Cannot fork worker process for run #" << runNumber << ": " << strerror(errno) << endl;
+                numErrors++;
+                numFinished++;
+                stopLaunching = true;
+            }
+            else {
+                workers[pid] = info;
+            }
+        }
 
-            // delete network
-            if (networkSetupDone) {
-                try {
-                    getSimulation()->deleteNetwork();
-                }
-                catch (std::exception& e) {
-                    numErrors++;
-                    notifyLifecycleListeners(LF_ON_SIMULATION_ERROR);
-                    displayException(e);
-                }
+        if (workers.empty())
+            break;
+
+        // wait for any of the workers to finish
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR)
+                continue;
+            err() << "Error waiting for worker processes: " << strerror(errno) << endl;
+            numErrors += workers.size();
+            break;
+        }
+        auto workerIt = workers.find(pid);
+        if (workerIt == workers.end())
+            continue;  // not one of ours
+        WorkerInfo info = workerIt->second;
+        workers.erase(workerIt);
+        numFinished++;
+
+        bool interrupted;
+        out << "Run #" << info.runNumber << " finished (" << numFinished << "/" << runNumbers.size() << "): ";
+        bool failed = !printExitStatus(out, status, interrupted);
+        out << endl;
+        if (interrupted)
+            stopLaunching = true;
+
+        if (failed) {
+            numErrors++;
+            if (info.stopBatchOnError) {
+                if (!stopLaunching && it != runNumbers.end())
+                    out << "Skipping remaining runs because of error (cmdenv-stop-batch-on-error=true)" << endl;
+                stopLaunching = true;
             }
+        }
+        if (sigintReceived)
+            stopLaunching = true;
+    }
 
-            // stop redirecting into file
-            stopOutputRedirection();
+    deinstallSignalHandler();
+#endif
+}
 
-            if (!finishedOK)
-                numErrors++;
+bool Cmdenv::groupRunsForForking(const std::vector<int>& runNumbers, std::vector<std::vector<int>>& runGroups)
+{
+    // runs with cmdenv-fork-time that differ only in the repetition form a group;
+    // all other runs are executed individually
+    bool forking = false;
+    std::map<std::string, size_t> groupIndex;  // iteration variables -> index in runGroups
+    for (int runNumber : runNumbers) {
+        bool forkingRun = false;
+        std::string iterVars;
+        try {
+            cfg->activateConfig(opt->configName.c_str(), runNumber);
+            forkingRun = cfg->getAsDouble(CFGID_CMDENV_FORK_TIME, -1) >= 0;
+            iterVars = cfg->getVariable(CFGVAR_ITERATIONVARS);  // does not contain the repetition
+        }
+        catch (std::exception& e) {
+            // ignore, the error will be reported when the run is attempted
+        }
+        if (forkingRun) {
+            forking = true;
+            auto it = groupIndex.find(iterVars);
+            if (it != groupIndex.end()) {
+                runGroups[it->second].push_back(runNumber);
+                continue;
+            }
+            groupIndex[iterVars] = runGroups.size();
+        }
+        runGroups.push_back(std::vector<int>(1, runNumber));
+    }
+    return forking;
+}
 
-            // skip further runs if signal was caught
-            if (sigintReceived)
-                break;
+bool Cmdenv::forkRunsIfDue()
+{
+#ifdef _WIN32
+    return false;
+#else
+    // fork before the first event past the fork time
+    cSimulation *simulation = getSimulation();
+    simtime_t nextEventTime = simulation->guessNextSimtime();
+    if (nextEventTime >= SIMTIME_ZERO && nextEventTime <= opt->forkTime)
+        return false;
+    forkPending = false;
+
+    // Result files must not have been opened yet, not even by the first run: all
+    // processes would share them, and the writer threads (output-async-writing=true)
+    // would not exist in the child processes, as fork() only copies the calling thread.
+    // Restarting the result managers throws if a file has already been opened.
+    outvectorManager->startRun();
+    outScalarManager->startRun();
+
+    int numProcesses = std::max(1, opt->numWorkers);
+    if (opt->verbose)
+        out << "\nForking " << forkRunNumbers.size() << " runs at t=" << simulation->getSimTime() << " (event #" << simulation->getEventNumber() << ")..." << endl;
+
+    // flush buffers so that their contents do not get written by the child processes too
+    cLogProxy::flushLastLine();
+
+    std::map<pid_t, int> children;  // pid -> run number
+    int numFinished = 0;
+    bool stopLaunching = false;
+    auto it = forkRunNumbers.begin();
+    while (!children.empty() || (it != forkRunNumbers.end() && !stopLaunching)) {
+        // launch child processes for the next runs
+        while ((int)children.size() < numProcesses && it != forkRunNumbers.end() && !stopLaunching && !sigintReceived) {
+            int runNumber = *it++;
 
-            if (!finishedOK && opt->stopBatchOnError)
-                break;
+            out.flush();
+            fflush(stdout);
+            fflush(stderr);
+
+            pid_t pid = fork();
+            if (pid == 0) {
+                // child: continue the simulation as the given run
+                isForkedProcess = true;
+                numErrors = 0;
+                continueAsForkedRun(runNumber);
+                return false;
+            }
+            else if (pid < 0) {
+                err() << "Cannot fork process for run #" << runNumber << ": " << strerror(errno) << endl;
+                numForkErrors++;
+                numFinished++;
+                stopLaunching = true;
+            }
+            else {
+                children[pid] = runNumber;
+            }
         }
 
-        if (numRuns > 1 && opt->verbose) {
-            int numSkipped = numRuns - runsTried;
-            int numSuccess = runsTried - numErrors;
-            out << "\nRun statistics: total " << numRuns;
-            if (numSuccess > 0)
-                out << ", successful " << numSuccess;
-            if (numErrors > 0)
-                out << ", errors " << numErrors;
-            if (numSkipped > 0)
-                out << ", skipped " << numSkipped;
-            out << endl;
+        if (children.empty())
+            break;
+
+        // wait for any of the children to finish
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR)
+                continue;
+            err() << "Error waiting for forked processes: " << strerror(errno) << endl;
+            numForkErrors += children.size();
+            break;
+        }
+        auto childIt = children.find(pid);
+        if (childIt == children.end())
+            continue;  // not one of ours
+        int runNumber = childIt->second;
+        children.erase(childIt);
+        numFinished++;
+
+        bool interrupted;
+        out << "Run #" << runNumber << " finished (" << numFinished << "/" << forkRunNumbers.size() << "): ";
+        bool failed = !printExitStatus(out, status, interrupted);
+        out << endl;
+        if (failed) {
+            numForkErrors++;
+            if (opt->stopBatchOnError) {
+                if (!stopLaunching && it != forkRunNumbers.end())
+                    out << "Skipping remaining runs because of error (cmdenv-stop-batch-on-error=true)" << endl;
+                stopLaunching = true;
+            }
         }
+        if (interrupted || sigintReceived)
+            stopLaunching = true;
+    }
 
-        exitCode = numErrors > 0 ? 1 : sigintReceived ? 2 : 0;
+    // runs not launched count as skipped
+    runsTried -= forkRunNumbers.end() - it;
+    numErrors += numForkErrors;
+    forkDone = true;
+    return true;
+#endif
+}
+
+void Cmdenv::continueAsForkedRun(int runNumber)
+{
+    // the run executed so far simply continues; the other runs of the group differ
+    // from it only in the repetition, i.e. in the seeds and the result files
+    bool isOtherRun = runNumber != cfg->getActiveRunNumber();
+    if (isOtherRun) {
+        cfg->activateConfig(opt->configName.c_str(), runNumber);
+        reseedRNGs();
+        if (!opt->verbose)
+            out << opt->configName << " run " << runNumber << ": " << cfg->getVariable(CFGVAR_ITERATIONVARS) << ", $repetition=" << cfg->getVariable(CFGVAR_REPETITION) << endl;
+    }
+
+    // output of concurrent runs would get mixed up on the console
+    bool redirect = opt->redirectOutput || opt->numWorkers > 1;
+    if (redirect && (isOtherRun || !isOutputRedirected())) {
+        stopOutputRedirection();
+        opt->outputFile = cfg->getAsFilename(CFGID_CMDENV_OUTPUT_FILE).c_str();
+        processFileName(opt->outputFile);
+        if (opt->verbose)
+            out << "Redirecting output of run #" << runNumber << " to file \"" << opt->outputFile << "\"..." << endl;
+        startOutputRedirection(opt->outputFile.c_str());
+    }
+
+    if (opt->verbose) {
+        out << "\nContinuing run #" << runNumber << " in a forked process";
+        if (isOtherRun)
+            out << ", with seed-set=" << cfg->getVariable(CFGVAR_SEEDSET) << "\nAssigned runID=" << cfg->getVariable(CFGVAR_RUNID);
+        out << endl;
+    }
+
+    // result files are named after the new run
+    if (isOtherRun) {
+        outvectorManager->startRun();
+        outScalarManager->startRun();
+        snapshotManager->startRun();
     }
 }
 
@@ -374,6 +769,11 @@ void Cmdenv::simulate()
     try {
         if (!opt->expressMode) {
             while (true) {
+                if (checkpointPending)
+                    writeCheckpointIfDue();
+                if (forkPending && forkRunsIfDue())
+                    break;  // in the parent process, after the forked runs have finished
+
                 cEvent *event = simulation->takeNextEvent();
                 if (!event)
                     throw cTerminationException("Scheduler interrupted while waiting");
@@ -409,6 +809,11 @@ void Cmdenv::simulate()
             doStatusUpdate(speedometer);
 
             while (true) {
+                if (checkpointPending)
+                    writeCheckpointIfDue();
+                if (forkPending && forkRunsIfDue())
+                    break;  // in the parent process, after the forked runs have finished
+
                 cEvent *event = simulation->takeNextEvent();
                 if (!event)
                     throw cTerminationException("Scheduler interrupted while waiting");
@@ -502,6 +907,15 @@ void Cmdenv::doStatusUpdate(Speedometer& speedometer)
         out << "     Messages:  created: " << cMessage::getTotalMessageCount()
             << "   present: " << cMessage::getLiveMessageCount()
             << "   in FES: " << getSimulation()->getFES()->getLength() << endl;
+
+        if (cMessage::isPoolingEnabled()) {
+            long hits = cMessage::getPoolHitCount();
+            long requests = hits + cMessage::getPoolMissCount();
+            out << "     Msg pool:  hits: " << hits
+                << "   misses: " << cMessage::getPoolMissCount()
+                << "   hit rate: " << (requests == 0 ? 0 : 100.0 * hits / requests) << "%"
+                << "   pooled: " << cMessage::getPooledBlockCount() << endl;
+        }
     }
     else {
         out << "** Event #" << getSimulation()->getEventNumber() << "   t=" << getSimulation()->getSimTime()
@@ -751,7 +1165,8 @@ void Cmdenv::printUISpecificHelp()
     out << "Cmdenv-specific information:\n";
     out << "    Cmdenv executes all runs denoted by the -c and -r options. The number\n";
     out << "    of runs executed and the number of runs that ended with an error are\n";
-    out << "    reported at the end.\n";
+    out << "    reported at the end. With -j <numworkers>, runs are executed in\n";
+    out << "    parallel, in separate worker processes.\n";
     out << endl;
 }
 
@@ -35,6 +35,7 @@ struct CMDENV_API CmdenvOptions : public EnvirOptions
     std::string configName;
     std::string runFilter;
     bool stopBatchOnError;
+    int numWorkers;
     size_t extraStack;
     std::string outputFile;
     bool redirectOutput;
@@ -47,6 +48,7 @@ struct CMDENV_API CmdenvOptions : public EnvirOptions
     long statusFrequencyMs; // if express mode
     bool printPerformanceData; // if express mode
     bool fakeGUI; // all modes
+    simtime_t forkTime; // negative if runs are not forked
 };
 
 /**
@@ -63,6 +65,19 @@ class CMDENV_API Cmdenv : public EnvirBase
      // the number of runs already started (>1 if multiple runs are running in the same process)
      int runsTried = 0;
      int numRuns = 0;
+     int numErrors = 0;
+
+     // true in the child processes forked by runInWorkerProcesses()
+     bool isWorkerProcess = false;
+
+     // cmdenv-fork-time: the runs to be continued in forked processes at the fork time
+     std::vector<int> forkRunNumbers;
+     bool forkPending = false;
+     bool forkDone = false;  // in the parent process, after the forked processes have finished
+     int numForkErrors = 0;
+
+     // true in the child processes forked at cmdenv-fork-time
+     bool isForkedProcess = false;
 
      // logging
      bool logging = true;
@@ -113,6 +128,11 @@ class CMDENV_API Cmdenv : public EnvirBase
      virtual void askParameter(cPar *par, bool unassigned) override;
 
      void help();
+     bool runSimulation(int runNumber, const std::vector<int>& runGroup=std::vector<int>());
+     void runInWorkerProcesses(const std::vector<int>& runNumbers);
+     bool groupRunsForForking(const std::vector<int>& runNumbers, std::vector<std::vector<int>>& runGroups);
+     bool forkRunsIfDue();
+     void continueAsForkedRun(int runNumber);
      void simulate();
      const char *progressPercentage();
 
@@ -0,0 +1,581 @@
+//=========================================================================
+//  ARROWFILEWRITER.CC - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#include <cstring>
+#include <memory>
+#include <algorithm>
+#include "commonutil.h"
+#include "arrowfilewriter.h"
+
+namespace omnetpp {
+namespace common {
+
+namespace {
+
+// constants from the Arrow format definition (Schema.fbs, Message.fbs)
+enum { METADATA_V5 = 4 };
+enum { HEADER_SCHEMA = 1, HEADER_DICTIONARYBATCH = 2, HEADER_RECORDBATCH = 3 };
+enum { TYPE_FLOATINGPOINT = 3, TYPE_UTF8 = 5, TYPE_LIST = 12 };
+enum { PRECISION_DOUBLE = 2 };
+
+const char MAGIC[8] = "ARROW1"; // padded to 8 bytes with zeroes
+const uint32_t CONTINUATION = 0xFFFFFFFF;
+
+// structs in the Arrow metadata; the layout must match the FlatBuffers struct layout
+struct FieldNode { int64_t length; int64_t nullCount; };
+struct Buffer { int64_t offset; int64_t length; };
+struct BlockStruct { int64_t offset; int32_t metadataLength; int32_t padding; int64_t bodyLength; };
+
+inline size_t padded(size_t size) { return (size + 7) & ~(size_t)7; }
+
+/**
+ * A minimal FlatBuffers serializer, sufficient for producing the Arrow
+ * metadata. Objects are first assembled into a tree, then serialized front
+ * to back: every object precedes its children, so all offsets point forward
+ * as the format requires. Values are stored in host byte order, which is
+ * assumed to be little endian.
+ */
+class FlatBufferBuilder
+{
+  public:
+    struct Object;
+
+  protected:
+    struct Field {
+        int slot;
+        int size;       // size of the scalar, or 4 for an offset
+        uint64_t value; // scalar value
+        Object *child;  // target of an offset field
+    };
+
+  public:
+    struct Object {
+        enum Kind { TABLE, STRING, TABLE_VECTOR, STRUCT_VECTOR } kind;
+        std::vector<Field> fields;      // TABLE
+        std::string bytes;              // STRING, STRUCT_VECTOR
+        std::vector<Object *> elements; // TABLE_VECTOR
+        int count = 0;                  // STRUCT_VECTOR
+    };
+
+  protected:
+    std::vector<std::unique_ptr<Object>> objects;
+    std::vector<uint8_t> buf;
+
+  protected:
+    Object *create(Object::Kind kind) {
+        objects.push_back(std::unique_ptr<Object>(new Object()));
+        objects.back()->kind = kind;
+        return objects.back().get();
+    }
+
+    void alignTo(size_t alignment) {
+        while (buf.size() % alignment != 0)
+            buf.push_back(0);
+    }
+
+    template<typename T> void put(size_t pos, T value) {
+        memcpy(&buf[pos], &value, sizeof(T));
+    }
+
+    template<typename T> size_t append(T value) {
+        size_t pos = buf.size();
+        buf.resize(pos + sizeof(T));
+        put(pos, value);
+        return pos;
+    }
+
+    void addField(Object *table, int slot, int size, uint64_t value, Object *child) {
+        Assert(table->kind == Object::TABLE);
+        table->fields.push_back(Field {slot, size, value, child});
+    }
+
+    uint32_t serialize(Object *object);
+
+  public:
+    Object *createTable() {return create(Object::TABLE);}
+
+    Object *createString(const std::string& s) {
+        Object *object = create(Object::STRING);
+        object->bytes = s;
+        return object;
+    }
+
+    Object *createTableVector(const std::vector<Object *>& elements) {
+        Object *object = create(Object::TABLE_VECTOR);
+        object->elements = elements;
+        return object;
+    }
+
+    template<typename T> Object *createStructVector(const std::vector<T>& elements) {
+        static_assert(sizeof(T) % 8 == 0, "structs are assumed to be 8-byte aligned");
+        Object *object = create(Object::STRUCT_VECTOR);
+        object->bytes.assign((const char *)elements.data(), elements.size() * sizeof(T));
+        object->count = elements.size();
+        return object;
+    }
+
+    void addBool(Object *table, int slot, bool value) {addField(table, slot, 1, value, nullptr);}
+    void addUInt8(Object *table, int slot, uint8_t value) {addField(table, slot, 1, value, nullptr);}
+    void addInt16(Object *table, int slot, int16_t value) {addField(table, slot, 2, (uint16_t)value, nullptr);}
+    void addInt32(Object *table, int slot, int32_t value) {addField(table, slot, 4, (uint32_t)value, nullptr);}
+    void addInt64(Object *table, int slot, int64_t value) {addField(table, slot, 8, (uint64_t)value, nullptr);}
+    void addOffset(Object *table, int slot, Object *child) {addField(table, slot, 4, 0, child);}
+
+    std::vector<uint8_t> finish(Object *root);
+};
+
+uint32_t FlatBufferBuilder::serialize(Object *object)
+{
+    switch (object->kind) {
+        case Object::TABLE: {
+            // vtable: vtable size, table size, then the offset of each field within the table
+            int numSlots = 0;
+            bool hasInt64 = false;
+            for (const Field& field : object->fields) {
+                numSlots = std::max(numSlots, field.slot + 1);
+                hasInt64 |= field.size == 8;
+            }
+            alignTo(2);
+            size_t vtablePos = buf.size();
+            buf.resize(vtablePos + 4 + 2 * numSlots, 0);
+
+            // table: offset to the vtable, then the fields, largest first to minimize padding
+            alignTo(4);
+            if (hasInt64 && (buf.size() + 4) % 8 != 0)
+                append<uint32_t>(0);
+            size_t tablePos = append<int32_t>(0);
+            put<int32_t>(tablePos, tablePos - vtablePos);
+            std::vector<Field> fields = object->fields;
+            std::stable_sort(fields.begin(), fields.end(), [](const Field& a, const Field& b) {return a.size > b.size;});
+            std::vector<std::pair<size_t,Object*>> offsetFields;
+            for (const Field& field : fields) {
+                alignTo(field.size);
+                size_t pos = buf.size();
+                put<uint16_t>(vtablePos + 4 + 2 * field.slot, pos - tablePos);
+                buf.resize(pos + field.size);
+                memcpy(&buf[pos], &field.value, field.size);
+                if (field.child)
+                    offsetFields.push_back(std::make_pair(pos, field.child));
+            }
+            put<uint16_t>(vtablePos, 4 + 2 * numSlots);
+            put<uint16_t>(vtablePos + 2, buf.size() - tablePos);
+
+            for (auto& pair : offsetFields)
+                put<uint32_t>(pair.first, serialize(pair.second) - pair.first);
+            return tablePos;
+        }
+        case Object::STRING: {
+            alignTo(4);
+            size_t pos = append<uint32_t>(object->bytes.size());
+            buf.insert(buf.end(), object->bytes.begin(), object->bytes.end());
+            buf.push_back(0);
+            return pos;
+        }
+        case Object::TABLE_VECTOR: {
+            alignTo(4);
+            size_t pos = append<uint32_t>(object->elements.size());
+            buf.resize(buf.size() + 4 * object->elements.size(), 0);
+            for (size_t i = 0; i < object->elements.size(); i++) {
+                size_t elementPos = pos + 4 + 4 * i;
+                put<uint32_t>(elementPos, serialize(object->elements[i]) - elementPos);
+            }
+            return pos;
+        }
+        case Object::STRUCT_VECTOR: {
+            // the elements (not the length field) must be 8-byte aligned
+            alignTo(4);
+            if ((buf.size() + 4) % 8 != 0)
+                append<uint32_t>(0);
+            size_t pos = append<uint32_t>(object->count);
+            buf.insert(buf.end(), object->bytes.begin(), object->bytes.end());
+            return pos;
+        }
+    }
+    Assert(false);
+    return 0;
+}
+
+std::vector<uint8_t> FlatBufferBuilder::finish(Object *root)
+{
+    buf.clear();
+    append<uint32_t>(0);
+    put<uint32_t>(0, serialize(root));
+    alignTo(8);
+    return buf;
+}
+
+typedef FlatBufferBuilder::Object FbObject;
+
+FbObject *createMessage(FlatBufferBuilder& fb, uint8_t headerType, FbObject *header, int64_t bodyLength)
+{
+    FbObject *message = fb.createTable();
+    fb.addInt16(message, 0, METADATA_V5); // version
+    fb.addUInt8(message, 1, headerType);  // header_type
+    fb.addOffset(message, 2, header);     // header
+    fb.addInt64(message, 3, bodyLength);  // bodyLength
+    return message;
+}
+
+FbObject *createField(FlatBufferBuilder& fb, const std::string& name, uint8_t typeType, FbObject *type, FbObject *dictionary, const std::vector<FbObject *>& children)
+{
+    FbObject *field = fb.createTable();
+    fb.addOffset(field, 0, fb.createString(name)); // name
+    fb.addBool(field, 1, true);                    // nullable
+    fb.addUInt8(field, 2, typeType);               // type_type
+    fb.addOffset(field, 3, type);                  // type
+    if (dictionary)
+        fb.addOffset(field, 4, dictionary);        // dictionary
+    fb.addOffset(field, 5, fb.createTableVector(children)); // children
+    return field;
+}
+
+FbObject *createDoubleType(FlatBufferBuilder& fb)
+{
+    FbObject *type = fb.createTable();
+    fb.addInt16(type, 0, PRECISION_DOUBLE); // precision
+    return type;
+}
+
+FbObject *createRecordBatch(FlatBufferBuilder& fb, int64_t length, const std::vector<FieldNode>& nodes, const std::vector<Buffer>& buffers)
+{
+    FbObject *batch = fb.createTable();
+    fb.addInt64(batch, 0, length);                          // length
+    fb.addOffset(batch, 1, fb.createStructVector(nodes));   // nodes
+    fb.addOffset(batch, 2, fb.createStructVector(buffers)); // buffers
+    return batch;
+}
+
+// computes the position of each buffer within the message body
+std::vector<Buffer> layoutBuffers(const std::vector<std::pair<const void *, size_t>>& bodyBuffers, int64_t& bodyLength)
+{
+    std::vector<Buffer> buffers;
+    bodyLength = 0;
+    for (auto& buffer : bodyBuffers) {
+        buffers.push_back(Buffer {bodyLength, (int64_t)buffer.second});
+        bodyLength += padded(buffer.second);
+    }
+    return buffers;
+}
+
+} // namespace
+
+ArrowFileWriter::~ArrowFileWriter()
+{
+    cleanup();
+}
+
+void ArrowFileWriter::cleanup()  // MUST NOT THROW
+{
+    if (f) {
+        fclose(f);
+        f = nullptr;
+    }
+}
+
+void ArrowFileWriter::writeBytes(const void *data, size_t size)
+{
+    if (size == 0)
+        return;
+    if (fwrite(data, 1, size, f) != size) {
+        cleanup();
+        throw opp_runtime_error("Cannot write Arrow file '%s'", fname.c_str());
+    }
+    filePos += size;
+}
+
+void ArrowFileWriter::writePadding(size_t size)
+{
+    static const char zeroes[8] = {0};
+    writeBytes(zeroes, padded(size) - size);
+}
+
+ArrowFileWriter::Block ArrowFileWriter::writeMessage(const std::vector<uint8_t>& metadata, const std::vector<std::pair<const void *, size_t>>& bodyBuffers)
+{
+    Block block;
+    block.offset = filePos;
+    block.metadataLength = 8 + metadata.size();
+    block.bodyLength = 0;
+
+    int32_t metadataSize = metadata.size();
+    writeBytes(&CONTINUATION, 4);
+    writeBytes(&metadataSize, 4);
+    writeBytes(metadata.data(), metadata.size());
+    for (auto& buffer : bodyBuffers) {
+        writeBytes(buffer.first, buffer.second);
+        writePadding(buffer.second);
+        block.bodyLength += padded(buffer.second);
+    }
+    return block;
+}
+
+static FbObject *createSchema(FlatBufferBuilder& fb, const std::vector<std::string>& names, const std::vector<ArrowFileWriter::ColumnType>& types)
+{
+    std::vector<FbObject *> fields;
+    for (size_t i = 0; i < names.size(); i++) {
+        switch (types[i]) {
+            case ArrowFileWriter::DICTIONARY_STRING: {
+                FbObject *indexType = fb.createTable();
+                fb.addInt32(indexType, 0, 32);  // bitWidth
+                fb.addBool(indexType, 1, true); // is_signed
+                FbObject *dictionary = fb.createTable();
+                fb.addInt64(dictionary, 0, i);           // id
+                fb.addOffset(dictionary, 1, indexType);  // indexType
+                fields.push_back(createField(fb, names[i], TYPE_UTF8, fb.createTable(), dictionary, {}));
+                break;
+            }
+            case ArrowFileWriter::DOUBLE:
+                fields.push_back(createField(fb, names[i], TYPE_FLOATINGPOINT, createDoubleType(fb), nullptr, {}));
+                break;
+            case ArrowFileWriter::DOUBLE_LIST: {
+                FbObject *item = createField(fb, "item", TYPE_FLOATINGPOINT, createDoubleType(fb), nullptr, {});
+                fields.push_back(createField(fb, names[i], TYPE_LIST, fb.createTable(), nullptr, {item}));
+                break;
+            }
+        }
+    }
+    FbObject *schema = fb.createTable();
+    fb.addInt16(schema, 0, 0); // endianness: little
+    fb.addOffset(schema, 1, fb.createTableVector(fields)); // fields
+    return schema;
+}
+
+int ArrowFileWriter::addColumn(const std::string& name, ColumnType type)
+{
+    Assert(!isOpen());
+    Column column;
+    column.name = name;
+    column.type = type;
+    if (type == DOUBLE_LIST)
+        column.offsets.push_back(0);
+    columns.push_back(column);
+    return columns.size() - 1;
+}
+
+void ArrowFileWriter::open(const char *filename)
+{
+    fname = filename;
+    f = fopen(fname.c_str(), "wb");
+    if (f == nullptr)
+        throw opp_runtime_error("Cannot open Arrow file '%s' for write", fname.c_str());
+    filePos = 0;
+    numRows = 0;
+    dictionaryBlocks.clear();
+    recordBatchBlocks.clear();
+
+    writeBytes(MAGIC, sizeof(MAGIC));
+
+    std::vector<std::string> names;
+    std::vector<ColumnType> types;
+    for (const Column& column : columns) {
+        names.push_back(column.name);
+        types.push_back(column.type);
+    }
+    FlatBufferBuilder fb;
+    writeMessage(fb.finish(createMessage(fb, HEADER_SCHEMA, createSchema(fb, names, types), 0)), {});
+}
+
+void ArrowFileWriter::close()
+{
+    if (!f)
+        return;
+
+    writeBatch();
+    for (size_t i = 0; i < columns.size(); i++)
+        if (columns[i].type == DICTIONARY_STRING && columns[i].dictionarySize < 0)
+            setDictionary(i, {});
+
+    // end-of-stream marker
+    uint32_t eos[2] = {CONTINUATION, 0};
+    writeBytes(eos, sizeof(eos));
+
+    // footer: schema again, plus the location of all dictionaries and record batches
+    std::vector<std::string> names;
+    std::vector<ColumnType> types;
+    for (const Column& column : columns) {
+        names.push_back(column.name);
+        types.push_back(column.type);
+    }
+    auto toStructs = [](const std::vector<Block>& blocks) {
+        std::vector<BlockStruct> result;
+        for (const Block& block : blocks)
+            result.push_back(BlockStruct {block.offset, block.metadataLength, 0, block.bodyLength});
+        return result;
+    };
+    FlatBufferBuilder fb;
+    FbObject *footer = fb.createTable();
+    fb.addInt16(footer, 0, METADATA_V5); // version
+    fb.addOffset(footer, 1, createSchema(fb, names, types)); // schema
+    fb.addOffset(footer, 2, fb.createStructVector(toStructs(dictionaryBlocks))); // dictionaries
+    fb.addOffset(footer, 3, fb.createStructVector(toStructs(recordBatchBlocks))); // recordBatches
+    std::vector<uint8_t> footerBytes = fb.finish(footer);
+    int32_t footerSize = footerBytes.size();
+    writeBytes(footerBytes.data(), footerBytes.size());
+    writeBytes(&footerSize, 4);
+    writeBytes(MAGIC, 6);
+
+    if (fclose(f) != 0) {
+        f = nullptr;
+        throw opp_runtime_error("Cannot close Arrow file '%s'", fname.c_str());
+    }
+    f = nullptr;
+}
+
+void ArrowFileWriter::setDictionary(int column, const std::vector<std::string>& values)
+{
+    Assert(isOpen());
+    Column& col = columns.at(column);
+    Assert(col.type == DICTIONARY_STRING && col.dictionarySize < 0 && numRows == 0);
+    col.dictionarySize = values.size();
+
+    std::vector<int32_t> offsets;
+    std::string data;
+    offsets.reserve(values.size() + 1);
+    for (const std::string& value : values) {
+        offsets.push_back(data.size());
+        data += value;
+    }
+    offsets.push_back(data.size());
+
+    int64_t length = values.size();
+    std::vector<std::pair<const void *, size_t>> bodyBuffers = {
+        {nullptr, 0}, // validity: no nulls
+        {offsets.data(), offsets.size() * sizeof(int32_t)},
+        {data.data(), data.size()}
+    };
+    int64_t bodyLength;
+    std::vector<Buffer> buffers = layoutBuffers(bodyBuffers, bodyLength);
+
+    FlatBufferBuilder fb;
+    FbObject *dictionaryBatch = fb.createTable();
+    fb.addInt64(dictionaryBatch, 0, column); // id
+    fb.addOffset(dictionaryBatch, 1, createRecordBatch(fb, length, {FieldNode {length, 0}}, buffers)); // data
+    dictionaryBlocks.push_back(writeMessage(fb.finish(createMessage(fb, HEADER_DICTIONARYBATCH, dictionaryBatch, bodyLength)), bodyBuffers));
+}
+
+void ArrowFileWriter::appendValidity(Column& column, bool valid)
+{
+    if (numRows % 8 == 0)
+        column.validity.push_back(0);
+    if (valid)
+        column.validity.back() |= 1 << (numRows % 8);
+    else
+        column.nullCount++;
+}
+
+void ArrowFileWriter::appendIndex(int column, int32_t index)
+{
+    Column& col = columns[column];
+    Assert(col.type == DICTIONARY_STRING && index >= 0 && index < col.dictionarySize);
+    appendValidity(col, true);
+    col.indices.push_back(index);
+}
+
+void ArrowFileWriter::appendDouble(int column, double value)
+{
+    Column& col = columns[column];
+    Assert(col.type == DOUBLE);
+    appendValidity(col, true);
+    col.values.push_back(value);
+}
+
+void ArrowFileWriter::appendDoubles(int column, const double *values, size_t n)
+{
+    Column& col = columns[column];
+    Assert(col.type == DOUBLE_LIST);
+    if (col.values.size() + n > (size_t)INT32_MAX)
+        throw opp_runtime_error("Arrow file '%s': list too long", fname.c_str());
+    appendValidity(col, true);
+    col.values.insert(col.values.end(), values, values + n);
+    col.offsets.push_back(col.values.size());
+}
+
+void ArrowFileWriter::appendNull(int column)
+{
+    Column& col = columns[column];
+    appendValidity(col, false);
+    switch (col.type) {
+        case DICTIONARY_STRING: col.indices.push_back(0); break;
+        case DOUBLE: col.values.push_back(0); break;
+        case DOUBLE_LIST: col.offsets.push_back(col.values.size()); break;
+    }
+}
+
+void ArrowFileWriter::endRow()
+{
+    numRows++;
+    size_t listItems = 0;
+    for (const Column& col : columns) {
+        Assert((int64_t)col.validity.size() == (numRows + 7) / 8); // exactly one value per column
+        if (col.type == DOUBLE_LIST)
+            listItems += col.values.size();
+    }
+    if (numRows >= batchSize || listItems >= batchListItemsLimit)
+        writeBatch();
+}
+
+void ArrowFileWriter::writeBatch()
+{
+    Assert(isOpen());
+    if (numRows == 0)
+        return;
+    for (size_t i = 0; i < columns.size(); i++)
+        if (columns[i].type == DICTIONARY_STRING && columns[i].dictionarySize < 0)
+            setDictionary(i, {});
+
+    // nodes and buffers in depth-first order of the fields
+    std::vector<FieldNode> nodes;
+    std::vector<std::pair<const void *, size_t>> bodyBuffers;
+    for (const Column& col : columns) {
+        nodes.push_back(FieldNode {numRows, col.nullCount});
+        if (col.nullCount == 0)
+            bodyBuffers.push_back({nullptr, 0});
+        else
+            bodyBuffers.push_back({col.validity.data(), col.validity.size()});
+        switch (col.type) {
+            case DICTIONARY_STRING:
+                bodyBuffers.push_back({col.indices.data(), col.indices.size() * sizeof(int32_t)});
+                break;
+            case DOUBLE:
+                bodyBuffers.push_back({col.values.data(), col.values.size() * sizeof(double)});
+                break;
+            case DOUBLE_LIST:
+                bodyBuffers.push_back({col.offsets.data(), col.offsets.size() * sizeof(int32_t)});
+                nodes.push_back(FieldNode {(int64_t)col.values.size(), 0});
+                bodyBuffers.push_back({nullptr, 0});
+                bodyBuffers.push_back({col.values.data(), col.values.size() * sizeof(double)});
+                break;
+        }
+    }
+    int64_t bodyLength;
+    std::vector<Buffer> buffers = layoutBuffers(bodyBuffers, bodyLength);
+
+    FlatBufferBuilder fb;
+    FbObject *recordBatch = createRecordBatch(fb, numRows, nodes, buffers);
+    recordBatchBlocks.push_back(writeMessage(fb.finish(createMessage(fb, HEADER_RECORDBATCH, recordBatch, bodyLength)), bodyBuffers));
+
+    // start a new batch
+    numRows = 0;
+    for (Column& col : columns) {
+        col.validity.clear();
+        col.nullCount = 0;
+        col.indices.clear();
+        col.values.clear();
+        col.offsets.clear();
+        if (col.type == DOUBLE_LIST)
+            col.offsets.push_back(0);
+    }
+}
+
+} // namespace common
+}  // namespace omnetpp
@@ -0,0 +1,109 @@
+//=========================================================================
+//  ARROWFILEWRITER.H - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#ifndef __OMNETPP_COMMON_ARROWFILEWRITER_H
+#define __OMNETPP_COMMON_ARROWFILEWRITER_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "commondefs.h"
+
+namespace omnetpp {
+namespace common {
+
+/**
+ * Writes tables in the Apache Arrow IPC file format (also known as Feather
+ * version 2), which can be read with pyarrow, pandas.read_feather(), R's
+ * arrow package, etc. The format is produced directly, without depending on
+ * the Arrow libraries, so only the column types needed for exporting results
+ * are supported: dictionary-encoded strings, doubles, and lists of doubles.
+ * All columns are nullable.
+ *
+ * Usage: declare the columns with addColumn(), call open(), set the contents
+ * of all dictionaries with setDictionary(), then add rows by appending one
+ * value to each column followed by endRow(), and finally call close().
+ * Rows are written out in record batches of at most batchSize rows (or fewer
+ * if the list columns grow large), so memory use does not depend on the size
+ * of the table.
+ */
+class COMMON_API ArrowFileWriter
+{
+  public:
+    enum ColumnType { DICTIONARY_STRING, DOUBLE, DOUBLE_LIST };
+
+  protected:
+    struct Column {
+        std::string name;
+        ColumnType type;
+        std::vector<uint8_t> validity; // bitmap, one bit per row
+        int64_t nullCount = 0;
+        std::vector<int32_t> indices;  // DICTIONARY_STRING: indices into the dictionary
+        std::vector<double> values;    // DOUBLE: values; DOUBLE_LIST: concatenated list items
+        std::vector<int32_t> offsets;  // DOUBLE_LIST: start of each list in values[], plus end
+        int64_t dictionarySize = -1;   // DICTIONARY_STRING: -1 until setDictionary() is called
+    };
+
+    struct Block {
+        int64_t offset;         // file offset of the message
+        int32_t metadataLength; // length of the message prefix and metadata
+        int64_t bodyLength;     // length of the message body
+    };
+
+    std::string fname;  // output file name
+    FILE *f = nullptr;  // file ptr of output file
+    int64_t filePos = 0;
+    std::vector<Column> columns;
+    int64_t numRows = 0; // number of rows in the current batch
+    int64_t batchSize = 65536;
+    size_t batchListItemsLimit = 1 << 22;
+    std::vector<Block> dictionaryBlocks;
+    std::vector<Block> recordBatchBlocks;
+
+  protected:
+    void cleanup();  // MUST NOT THROW
+    void writeBytes(const void *data, size_t size);
+    void writePadding(size_t size);
+    Block writeMessage(const std::vector<uint8_t>& metadata, const std::vector<std::pair<const void *, size_t>>& bodyBuffers);
+    void appendValidity(Column& column, bool valid);
+
+  public:
+    ArrowFileWriter() {}
+    virtual ~ArrowFileWriter();
+
+    int addColumn(const std::string& name, ColumnType type); // must be called before open(); returns the column index
+    int getNumColumns() const {return columns.size();}
+    void setBatchSize(int64_t rows) {batchSize = rows;}
+    int64_t getBatchSize() const {return batchSize;}
+
+    void open(const char *filename); // overwrite if file exists
+    void close();
+    bool isOpen() const {return f != nullptr;} // IMPORTANT: file will be closed when an error occurs
+
+    void setDictionary(int column, const std::vector<std::string>& values); // once per dictionary column, before the first row
+
+    void appendIndex(int column, int32_t index); // DICTIONARY_STRING
+    void appendDouble(int column, double value); // DOUBLE
+    void appendDoubles(int column, const double *values, size_t n); // DOUBLE_LIST
+    void appendNull(int column); // any type
+    void endRow();
+
+    void writeBatch(); // writes the rows added so far as a record batch (if there are any)
+};
+
+} // namespace common
+}  // namespace omnetpp
+
+#endif
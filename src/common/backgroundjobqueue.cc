@@ -0,0 +1,111 @@
+//=========================================================================
+//  BACKGROUNDJOBQUEUE.CC - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#include "commonutil.h"
+#include "backgroundjobqueue.h"
+
+namespace omnetpp {
+namespace common {
+
+void BackgroundJobQueue::start()
+{
+    Assert(!isRunning());
+    stopping = false;
+    error = nullptr;
+    thread = std::thread(&BackgroundJobQueue::run, this);
+}
+
+void BackgroundJobQueue::stop()
+{
+    if (!isRunning())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_one();
+    thread.join();
+    thread = std::thread();
+    error = nullptr;
+}
+
+void BackgroundJobQueue::submit(const Job& job, size_t cost)
+{
+    Assert(isRunning() && !isWorkerThread());
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // a job larger than the limit is still accepted when nothing else is pending
+        jobFinished.wait(lock, [&] {return error || costLimit == 0 || pendingCost == 0 || pendingCost + cost <= costLimit;});
+        rethrowError();
+        jobs.push_back(Entry{job, cost});
+        pendingCost += cost;
+    }
+    jobAvailable.notify_one();
+}
+
+void BackgroundJobQueue::drain()
+{
+    if (!isRunning())
+        return;
+    std::unique_lock<std::mutex> lock(mutex);
+    jobFinished.wait(lock, [&] {return jobs.empty() && !busy;});
+    rethrowError();
+}
+
+void BackgroundJobQueue::rethrowError()
+{
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void BackgroundJobQueue::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        jobAvailable.wait(lock, [&] {return !jobs.empty() || stopping;});
+        if (jobs.empty())
+            break;  // stopping, and no more work
+
+        Entry entry = std::move(jobs.front());
+        jobs.pop_front();
+        busy = true;
+        lock.unlock();
+
+        std::exception_ptr e;
+        try {
+            entry.job();
+        }
+        catch (...) {
+            e = std::current_exception();
+        }
+        entry.job = nullptr;  // release captured data outside the lock
+
+        lock.lock();
+        busy = false;
+        pendingCost -= entry.cost;
+        if (e) {
+            error = e;
+            for (Entry& discarded : jobs)
+                pendingCost -= discarded.cost;
+            jobs.clear();
+        }
+        jobFinished.notify_all();
+    }
+}
+
+}  // namespace common
+}  // namespace omnetpp
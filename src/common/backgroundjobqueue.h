@@ -0,0 +1,107 @@
+//=========================================================================
+//  BACKGROUNDJOBQUEUE.H - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#ifndef __OMNETPP_COMMON_BACKGROUNDJOBQUEUE_H
+#define __OMNETPP_COMMON_BACKGROUNDJOBQUEUE_H
+
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include "commondefs.h"
+
+namespace omnetpp {
+namespace common {
+
+/**
+ * Executes jobs one after another, in submission order, on a dedicated
+ * worker thread.
+ *
+ * Each job has a cost (e.g. the number of bytes or samples it holds). When
+ * a cost limit is set, submit() blocks while the total cost of the pending
+ * jobs would exceed it, which provides back-pressure to the submitting thread.
+ *
+ * If a job throws, the remaining jobs are discarded, and the exception is
+ * rethrown by the next submit() or drain() call on the submitting thread.
+ */
+class COMMON_API BackgroundJobQueue
+{
+  public:
+    typedef std::function<void()> Job;
+
+  protected:
+    struct Entry {
+        Job job;
+        size_t cost;
+    };
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable jobAvailable; // signalled to the worker thread
+    std::condition_variable jobFinished;  // signalled to submit() and drain()
+    std::deque<Entry> jobs;
+    size_t pendingCost = 0;  // includes the job being executed
+    size_t costLimit = 0;    // 0=no limit
+    bool busy = false;
+    bool stopping = false;
+    std::exception_ptr error;
+
+  protected:
+    void run();
+    void rethrowError(); // mutex must be held
+
+  public:
+    BackgroundJobQueue() {}
+    BackgroundJobQueue(const BackgroundJobQueue&) = delete;
+    ~BackgroundJobQueue() {stop();}
+
+    void setCostLimit(size_t limit) {costLimit = limit;}
+    size_t getCostLimit() const {return costLimit;}
+
+    /**
+     * Starts the worker thread.
+     */
+    void start();
+
+    /**
+     * Executes the pending jobs, then terminates the worker thread.
+     * Errors are discarded. Does nothing if the thread is not running.
+     */
+    void stop();  // MUST NOT THROW
+
+    bool isRunning() const {return thread.joinable();}
+
+    /**
+     * Returns true if called from a job.
+     */
+    bool isWorkerThread() const {return std::this_thread::get_id() == thread.get_id();}
+
+    /**
+     * Appends a job to the queue. Blocks while the cost limit would be exceeded.
+     */
+    void submit(const Job& job, size_t cost=0);
+
+    /**
+     * Waits until all submitted jobs have been executed.
+     */
+    void drain();
+};
+
+}  // namespace common
+}  // namespace omnetpp
+
+
+#endif
@@ -221,18 +221,18 @@ bool BigDecimal::operator<(const BigDecimal& x) const
     int64_t v = intVal;
     if (m != 0) {
         int64_t mp = powersOfTen[m];
-        v = intVal * mp;
-        if (v / mp != intVal)
-            // overflow
+        if (intVal > INT64_MAX / mp || intVal < INT64_MIN / mp)
+            // overflow (check before multiplying: signed overflow is undefined, and the compiler may optimize out a check done afterwards)
             return negatives;
+        v = intVal * mp;
     }
     int64_t xv = x.intVal;
     if (xm != 0) {
         int64_t xmp = powersOfTen[xm];
-        xv = x.intVal * xmp;
-        if (xv / xmp != x.intVal)
+        if (x.intVal > INT64_MAX / xmp || x.intVal < INT64_MIN / xmp)
             // overflow
             return !negatives;
+        xv = x.intVal * xmp;
     }
     return v < xv;
 }
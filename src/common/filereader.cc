@@ -21,6 +21,13 @@
 #include <cstdarg>
 #include <cstring>
 #include <algorithm>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
 #include "omnetpp/platdep/platmisc.h"
 #include "commonutil.h"
 #include "filereader.h"
@@ -44,6 +51,8 @@ FileReader::FileReader(const char *fileName, size_t bufferSize)
     bufferBegin(new char[bufferSize]),
     bufferEnd(bufferBegin + bufferSize),
     maxLineSize(bufferSize / 2),
+    allocatedBufferSize(bufferSize),
+    allocatedBuffer(bufferBegin),
     lastSavedBufferBegin(new char[bufferSize])
 {
 #ifdef TRACE_FILEREADER
@@ -55,6 +64,9 @@ FileReader::FileReader(const char *fileName, size_t bufferSize)
     bufferFileOffset = -1;
     enableCheckFileForChanges = true;
     enableIgnoreAppendChanges = true;
+    enableMemoryMapping = false;
+    sequentialAccess = true;
+    mappedBegin = nullptr;
     numReadLines = 0;
     numReadBytes = 0;
     dataBegin = nullptr;
@@ -69,7 +81,11 @@ FileReader::~FileReader()
 #ifdef TRACE_FILEREADER
     TRACE_CALL("FileReader::~FileReader(%s)", fileName.c_str());
 #endif
-    delete[] bufferBegin;
+#ifndef _WIN32
+    if (mappedBegin)
+        munmap(mappedBegin, bufferSize);
+#endif
+    delete[] allocatedBuffer;
     delete[] lastSavedBufferBegin;
     ensureFileClosed();
 }
@@ -83,19 +99,62 @@ void FileReader::ensureFileOpenInternal()
         if (!file)
             throw opp_runtime_error("Cannot open file '%s'", fileName.c_str());
 
+        if (bufferFileOffset == -1 && enableMemoryMapping)
+            mapFile();
+
         if (bufferFileOffset == -1)
             seekTo(0);
     }
 }
 
+void FileReader::mapFile()
+{
+#ifndef _WIN32
+    struct opp_stat_t s;
+    if (opp_fstat(fileno(file), &s) != 0 || !S_ISREG(s.st_mode) || s.st_size <= 0 || (uint64_t)s.st_size > (uint64_t)SIZE_MAX)
+        return;
+    // note: private writable mapping, because callers get non-const pointers into it
+    void *p = mmap(nullptr, s.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(file), 0);
+    if (p == MAP_FAILED)
+        return;
+    madvise(p, s.st_size, sequentialAccess ? MADV_SEQUENTIAL : MADV_RANDOM);
+
+    mappedBegin = (char *)p;
+    bufferSize = s.st_size;
+    bufferBegin = mappedBegin;
+    bufferEnd = mappedBegin + bufferSize;
+    bufferFileOffset = 0;
+    dataBegin = mappedBegin;
+    dataEnd = mappedBegin + bufferSize;
+    currentDataPointer = mappedBegin;
+#endif
+}
+
+void FileReader::unmapFile()
+{
+#ifndef _WIN32
+    // switch back to the allocated buffer, keeping the current position
+    file_offset_t fileOffset = pointerToFileOffset(currentDataPointer);
+    munmap(mappedBegin, bufferSize);
+    mappedBegin = nullptr;
+    bufferSize = allocatedBufferSize;
+    bufferBegin = allocatedBuffer;
+    bufferEnd = bufferBegin + bufferSize;
+    bufferFileOffset = -1;
+    dataBegin = dataEnd = nullptr;
+    currentDataPointer = nullptr;
+    seekTo(fileOffset);
+#endif
+}
+
 int FileReader::readFileEnd(void *dataPointer)
 {
     if (!file)
         throw opp_runtime_error("File is not open '%s'", fileName.c_str());
-    opp_fseek(file, std::max((file_offset_t)0, (file_offset_t)(fileSize - bufferSize)), SEEK_SET);
+    opp_fseek(file, std::max((file_offset_t)0, (file_offset_t)(fileSize - allocatedBufferSize)), SEEK_SET);
     if (ferror(file))
         throw opp_runtime_error("Cannot seek in file '%s'", fileName.c_str());
-    int bytesRead = fread(dataPointer, 1, std::min((int64_t)bufferSize, fileSize), file);
+    int bytesRead = fread(dataPointer, 1, std::min((int64_t)allocatedBufferSize, fileSize), file);
     if (ferror(file))
         throw opp_runtime_error("Read error in file '%s'", fileName.c_str());
     return bytesRead;
@@ -105,7 +164,7 @@ void FileReader::ensureFileOpen()
 {
     if (!file) {
         ensureFileOpenInternal();
-        fileSize = getFileSizeInternal();
+        fileSize = mappedBegin ? (int64_t)bufferSize : getFileSizeInternal();
         lastSavedSize = readFileEnd(lastSavedBufferBegin);
     }
 }
@@ -143,6 +202,8 @@ FileReader::FileChangedState FileReader::checkFileForChanges()
     if (newFileSize == fileSize)
         return UNCHANGED;  // NOTE: assuming that the content is not overwritten... :(
     else {
+        if (mappedBegin)
+            unmapFile();  // the mapping does not follow size changes
 #ifdef TRACE_FILEREADER
         int readBytes =
 #endif
@@ -195,6 +256,13 @@ void FileReader::fillBuffer(bool forward)
     TRACE_CALL("FileReader::fillBuffer %s", forward ? "forward" : "backward");
 #endif
 
+    if (mappedBegin) {
+        // all data is in memory; only check for appended data when running out of complete lines
+        if (!forward || !enableCheckFileForChanges || memchr(currentDataPointer, '\n', dataEnd - currentDataPointer) || getFileSizeInternal() == fileSize)
+            return;
+        unmapFile();
+    }
+
     char *dataPointer;
     int dataLength;
 
@@ -306,17 +374,32 @@ bool FileReader::isLineStart(char *s)
     return *(s - 1) == '\n';
 }
 
+// returns the position of the first CR or LF in [s, end), or end if there is none
+static inline char *findLineEnd(char *s, char *end)
+{
+#ifdef USE_SSE2
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    for ( ; end - s >= 16; s += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)s);
+        unsigned mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)));
+        if (mask)
+            return s + __builtin_ctz(mask);
+    }
+#endif
+    while (s < end && *s != '\r' && *s != '\n')
+        s++;
+    return s;
+}
+
 char *FileReader::findNextLineStart(char *start, bool bufferFilled)
 {
 #ifdef TRACE_FILEREADER
     TRACE_CALL("FileReader::findNextLineStart(start: %p)", start);
 #endif
 
-    char *s = start;
-
     // find next CR/LF (fast path)
-    while (s < dataEnd && *s != '\r' && *s != '\n')
-        s++;
+    char *s = findLineEnd(start, dataEnd);
 
     if (s < dataEnd && *s == '\r')
         s++;
@@ -455,6 +538,8 @@ char *FileReader::getNextLineBufferPointer()
 #endif
 
         Assert(currentLineEndOffset >= currentLineStartOffset);
+        if (mappedBegin)
+            numReadBytes += currentLineEndOffset - currentLineStartOffset;
         return fileOffsetToPointer(currentLineStartOffset);
     }
     else {
@@ -504,6 +589,8 @@ char *FileReader::getPreviousLineBufferPointer()
 #endif
 
         Assert(currentLineEndOffset >= currentLineStartOffset);
+        if (mappedBegin)
+            numReadBytes += currentLineEndOffset - currentLineStartOffset;
         return fileOffsetToPointer(currentLineStartOffset);
     }
     else {
@@ -583,6 +670,12 @@ void FileReader::seekTo(file_offset_t fileOffset, unsigned int ensureBufferSizeA
 
     ensureFileOpen();
 
+    // the whole file is in memory if mapped
+    if (mappedBegin) {
+        setCurrentDataPointer(fileOffsetToPointer(fileOffset));
+        return;
+    }
+
     // check if requested offset is already in memory
     if (bufferFileOffset != -1 &&
         bufferFileOffset + ensureBufferSizeAround <= fileOffset &&
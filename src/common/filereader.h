@@ -39,6 +39,11 @@ namespace common {
  * the file in both directions from both ends. Automatically follows file
  * content when appended, but overwriting the file causes an exception to be thrown.
  *
+ * Optionally, regular files can be accessed via a memory mapping of the whole
+ * file instead of the buffer (see setMemoryMapped()). Lines are then returned
+ * without copying, and seeking costs no system calls. When the file is found
+ * to have changed, the reader falls back to buffered reading.
+ *
  * All functions throw class opp_runtime_error on error.
  */
 class COMMON_API FileReader
@@ -51,11 +56,18 @@ class COMMON_API FileReader
     bool enableIgnoreAppendChanges;
 
     // the buffer
-    const size_t bufferSize;
+    size_t bufferSize;
     const char *bufferBegin;
     const char *bufferEnd; // = buffer + bufferSize
     const size_t maxLineSize;
 
+    // the memory mapping; while the file is mapped, the buffer is the whole file
+    bool enableMemoryMapping;
+    bool sequentialAccess;
+    char *mappedBegin; // nullptr if not mapped
+    const size_t allocatedBufferSize;
+    const char *allocatedBuffer;
+
     // file positions and size
     file_offset_t bufferFileOffset;
     int64_t fileSize;
@@ -97,6 +109,8 @@ class COMMON_API FileReader
     void fillBuffer(bool forward);
     int readFileEnd(void *dataPointer);
     void ensureFileOpenInternal();
+    void mapFile();
+    void unmapFile();
     int64_t getFileSizeInternal();
     void checkConsistency(bool checkDataPointer = false) const;
 
@@ -139,6 +153,22 @@ class COMMON_API FileReader
      */
     void setIgnoreAppendChanges(bool value) { enableIgnoreAppendChanges = value; }
 
+    /**
+     * Controls whether the file is read via a memory mapping instead of the
+     * buffer. sequentialAccess is passed to the operating system as a hint
+     * about the expected access pattern. Must be called before the file is
+     * opened. Files that cannot be mapped (pipes, empty files, or on platforms
+     * without mmap) are read via the buffer. Memory mapping is off by default:
+     * truncating a file while it is mapped may crash the process (SIGBUS), so
+     * it should only be enabled for short-lived readers in command-line tools.
+     */
+    void setMemoryMapped(bool value, bool sequentialAccess = true) { enableMemoryMapping = value; this->sequentialAccess = sequentialAccess; }
+
+    /**
+     * Returns true if the file is currently accessed via a memory mapping.
+     */
+    bool isMemoryMapped() const { return mappedBegin != nullptr; }
+
     /**
      * Returns true if the file is open, otherwise returns false.
      */
@@ -20,6 +20,11 @@
 #include "exception.h"
 #include "linetokenizer.h"
 
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+
 namespace omnetpp {
 namespace common {
 
@@ -33,7 +38,7 @@ LineTokenizer::LineTokenizer(int initialBufferSize, int maxTokenNum, char sep1,
     vec = new char *[vecsize];
 
     lineBufferSize = initialBufferSize;
-    lineBuffer = new char[lineBufferSize];
+    lineBuffer = new char[lineBufferSize + SCAN_PADDING];
 }
 
 LineTokenizer::~LineTokenizer()
@@ -98,23 +103,80 @@ static void interpretBackslashes(char *buffer)
     *d = '\0';
 }
 
-int LineTokenizer::tokenize(const char *line, int length)
+// returns a bitmask of the bytes that are separators among the 16 bytes at s
+static inline unsigned findSeparators(const char *s, char sep1, char sep2)
+{
+#ifdef USE_SSE2
+    __m128i chunk = _mm_loadu_si128((const __m128i *)s);
+    __m128i match = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(sep1)), _mm_cmpeq_epi8(chunk, _mm_set1_epi8(sep2)));
+    return (unsigned)_mm_movemask_epi8(match);
+#else
+    unsigned mask = 0;
+    for (int i = 0; i < 16; i++)
+        if (s[i] == sep1 || s[i] == sep2)
+            mask |= 1u << i;
+    return mask;
+#endif
+}
+
+static inline int countTrailingZeros(unsigned x)
+{
+#ifdef __GNUC__
+    return __builtin_ctz(x);
+#else
+    int n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+void LineTokenizer::copyLine(const char *line, int length)
 {
     if (length >= lineBufferSize) {
         delete[] lineBuffer;
         lineBufferSize = length + 1;
-        lineBuffer = new char[lineBufferSize];
+        lineBuffer = new char[lineBufferSize + SCAN_PADDING];
     }
 
-    strncpy(lineBuffer, line, length);
+    memcpy(lineBuffer, line, length);
     lineBuffer[length] = '\0';  // guard
 
     char *s = lineBuffer + length - 1;
     while (s >= lineBuffer && (*s == '\r' || *s == '\n'))
         *s-- = '\0';
+}
+
+int LineTokenizer::tokenize(const char *line, int length)
+{
+    copyLine(line, length);
+
+    // fast path for lines without quoted tokens (e.g. vector data lines): locate
+    // separators 16 bytes at a time, and turn them into token terminators
+    int len = strlen(lineBuffer);
+    if (!memchr(lineBuffer, '"', len)) {
+        numtokens = 0;
+        unsigned prevIsSeparator = 1;  // line start acts as a separator
+        for (int i = 0; i < len; i += 16) {
+            unsigned validMask = len - i >= 16 ? 0xffff : (1u << (len - i)) - 1;
+            unsigned separators = findSeparators(lineBuffer + i, sep1, sep2) & validMask;
+            unsigned tokenStarts = ~separators & ((separators << 1) | prevIsSeparator) & validMask;
+            prevIsSeparator = (separators >> 15) & 1;
+            for ( ; tokenStarts; tokenStarts &= tokenStarts - 1) {
+                if (numtokens == vecsize)
+                    throw opp_runtime_error("Too many tokens on a line, max %d allowed", vecsize-1);
+                vec[numtokens++] = lineBuffer + i + countTrailingZeros(tokenStarts);
+            }
+            for ( ; separators; separators &= separators - 1)
+                lineBuffer[i + countTrailingZeros(separators)] = '\0';
+        }
+        return numtokens;
+    }
 
     numtokens = 0;
-    s = lineBuffer;
+    char *s = lineBuffer;
 
     // loop through the tokens on the line
     for (;;) {
@@ -135,7 +197,8 @@ int LineTokenizer::tokenize(const char *line, int length)
             bool containsBackslash = false;
             while (*s && *s != '"')
                 if (*s++ == '\\') {
-                    s++;
+                    if (*s)  // do not run past the end of the line on a stray backslash
+                        s++;
                     containsBackslash = true;
                 }
             // check we found the close quote
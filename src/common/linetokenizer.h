@@ -46,6 +46,12 @@ class COMMON_API LineTokenizer
     int vecsize;
     int numtokens;
 
+    // allows reading the line in 16-byte chunks without running past the buffer
+    static const int SCAN_PADDING = 16;
+
+  private:
+    void copyLine(const char *line, int length);
+
   public:
     /**
      * Constructor.
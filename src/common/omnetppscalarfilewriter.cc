@@ -30,6 +30,7 @@ OmnetppScalarFileWriter::OmnetppScalarFileWriter()
 
 OmnetppScalarFileWriter::~OmnetppScalarFileWriter()
 {
+    jobQueue.stop();  // discards errors, as close() must not throw here
     close();
 }
 
@@ -46,25 +47,60 @@ void OmnetppScalarFileWriter::open(const char *filename)
 
     if (opp_ftell(f) == 0)
         check(fprintf(f, "version %d\n", SCALAR_FILE_VERSION));
+
+    if (async)
+        jobQueue.start();
 }
 
 void OmnetppScalarFileWriter::close()
 {
+    // let the writer thread finish; its error (if any) is rethrown after closing the file
+    std::exception_ptr error;
+    if (jobQueue.isRunning()) {
+        try {
+            jobQueue.drain();
+        }
+        catch (std::exception&) {
+            error = std::current_exception();
+        }
+        jobQueue.stop();
+    }
+
     if (f) {
         fclose(f);
         f = nullptr;
         fname = "";
     }
+
+    if (error)
+        std::rethrow_exception(error);
 }
 
 void OmnetppScalarFileWriter::check(int fprintfResult)
 {
     if (fprintfResult < 0) {
-        close();
+        if (!jobQueue.isWorkerThread())
+            close();  // otherwise the main thread closes the file when it receives the error
         throw opp_runtime_error("Cannot write output scalar file '%s'", fname.c_str());
     }
 }
 
+template<typename T>
+void OmnetppScalarFileWriter::perform(const T& write)
+{
+    if (!jobQueue.isRunning())
+        write();
+    else {
+        try {
+            jobQueue.submit(write);
+        }
+        catch (std::exception&) {
+            close();  // a previous job failed
+            throw;
+        }
+    }
+}
+
 void OmnetppScalarFileWriter::writeAttributes(const StringMap& attributes)
 {
     for (auto pair : attributes)
@@ -105,43 +141,50 @@ void OmnetppScalarFileWriter::writeStatisticFields(const Statistics& statistic)
 void OmnetppScalarFileWriter::beginRecordingForRun(const std::string& runName, const StringMap& attributes, const StringMap& itervars, const OrderedKeyValueList& configEntries)
 {
     Assert(isOpen());
+    perform([=]() {
+        // save run
+        check(fprintf(f, "run %s\n", QUOTE(runName.c_str())));
 
-    // save run
-    check(fprintf(f, "run %s\n", QUOTE(runName.c_str())));
+        // save run attributes
+        writeAttributes(attributes);
 
-    // save run attributes
-    writeAttributes(attributes);
+        // save itervars
+        for (auto pair : itervars)
+            check(fprintf(f, "itervar %s %s\n", QUOTE(pair.first.c_str()), QUOTE(pair.second.c_str())));
 
-    // save itervars
-    for (auto pair : itervars)
-        check(fprintf(f, "itervar %s %s\n", QUOTE(pair.first.c_str()), QUOTE(pair.second.c_str())));
+        // save config entries
+        for (auto& pair : configEntries)
+            check(fprintf(f, "config %s %s\n", QUOTE(pair.first.c_str()), QUOTE(pair.second.c_str())));
 
-    // save config entries
-    for (auto& pair : configEntries)
-        check(fprintf(f, "config %s %s\n", QUOTE(pair.first.c_str()), QUOTE(pair.second.c_str())));
-
-    check(fprintf(f, "\n"));
+        check(fprintf(f, "\n"));
+    });
 }
 
 void OmnetppScalarFileWriter::endRecordingForRun()
 {
     Assert(isOpen());
-    check(fprintf(f, "\n"));
+    perform([this]() {
+        check(fprintf(f, "\n"));
+    });
 }
 
 void OmnetppScalarFileWriter::recordScalar(const std::string& componentFullPath, const std::string& name, double value, const StringMap& attributes)
 {
     Assert(isOpen());
-    check(fprintf(f, "scalar %s %s %.*g\n", QUOTE(componentFullPath.c_str()), QUOTE(name.c_str()), prec, value));
-    writeAttributes(attributes);
+    perform([=]() {
+        check(fprintf(f, "scalar %s %s %.*g\n", QUOTE(componentFullPath.c_str()), QUOTE(name.c_str()), prec, value));
+        writeAttributes(attributes);
+    });
 }
 
 void OmnetppScalarFileWriter::recordStatistic(const std::string& componentFullPath, const std::string& name, const Statistics& statistic, const StringMap& attributes)
 {
     Assert(isOpen());
-    check(fprintf(f, "statistic %s %s\n", QUOTE(componentFullPath.c_str()), QUOTE(name.c_str())));
-    writeStatisticFields(statistic);
-    writeAttributes(attributes);
+    perform([=]() {
+        check(fprintf(f, "statistic %s %s\n", QUOTE(componentFullPath.c_str()), QUOTE(name.c_str())));
+        writeStatisticFields(statistic);
+        writeAttributes(attributes);
+    });
 }
 
 void OmnetppScalarFileWriter::writeBin(double lowerEdge, double value)
@@ -152,27 +195,40 @@ void OmnetppScalarFileWriter::writeBin(double lowerEdge, double value)
 void OmnetppScalarFileWriter::recordHistogram(const std::string& componentFullPath, const std::string& name, const Statistics& statistic, const Histogram& bins, const StringMap& attributes)
 {
     Assert(isOpen());
-    check(fprintf(f, "statistic %s %s\n", QUOTE(componentFullPath.c_str()), QUOTE(name.c_str())));
-    writeStatisticFields(statistic);
-    writeAttributes(attributes);
+    perform([=]() {
+        check(fprintf(f, "statistic %s %s\n", QUOTE(componentFullPath.c_str()), QUOTE(name.c_str())));
+        writeStatisticFields(statistic);
+        writeAttributes(attributes);
 
-    int n = bins.getNumBins();
-    writeBin(-INFINITY, bins.getUnderflows());
-    for (int i = 0; i < n; i++)
-        writeBin(bins.getBinEdge(i), bins.getBinValue(i));
-    writeBin(bins.getBinEdge(n), bins.getOverflows());
+        int n = bins.getNumBins();
+        writeBin(-INFINITY, bins.getUnderflows());
+        for (int i = 0; i < n; i++)
+            writeBin(bins.getBinEdge(i), bins.getBinValue(i));
+        writeBin(bins.getBinEdge(n), bins.getOverflows());
+    });
 }
 
 void OmnetppScalarFileWriter::recordParameter(const std::string& componentFullPath, const std::string& name, const std::string& value, const StringMap& attributes)
 {
     Assert(isOpen());
-    check(fprintf(f, "par %s %s %s\n", QUOTE(componentFullPath.c_str()), QUOTE(name.c_str()), QUOTE(value.c_str())));
-    writeAttributes(attributes);
+    perform([=]() {
+        check(fprintf(f, "par %s %s %s\n", QUOTE(componentFullPath.c_str()), QUOTE(name.c_str()), QUOTE(value.c_str())));
+        writeAttributes(attributes);
+    });
 }
 
 void OmnetppScalarFileWriter::flush()
 {
     Assert(isOpen());
+    if (jobQueue.isRunning()) {
+        try {
+            jobQueue.drain();
+        }
+        catch (std::exception&) {
+            close();
+            throw;
+        }
+    }
     fflush(f);
 }
 
@@ -22,12 +22,16 @@
 #include <vector>
 #include "statistics.h"
 #include "histogram.h"
+#include "backgroundjobqueue.h"
 
 namespace omnetpp {
 namespace common {
 
 /**
  * Class for writing text-based output scalar files.
+ *
+ * In asynchronous mode, the results are formatted and written by a background
+ * thread. The file produced is identical to that of synchronous mode.
  */
 class COMMON_API OmnetppScalarFileWriter
 {
@@ -39,6 +43,8 @@ class COMMON_API OmnetppScalarFileWriter
     std::string fname;  // output file name
     FILE *f = nullptr;  // file ptr of output file; nullptr if closed (not yet opened, or after error)
     int prec = 14;      // number of significant digits when writing doubles
+    bool async = false; // write from a background thread
+    BackgroundJobQueue jobQueue; // for async mode
 
   protected:
     void check(int fprintfResult);
@@ -47,6 +53,7 @@ class COMMON_API OmnetppScalarFileWriter
     void writeStatisticField(const char *name, int64_t value);
     void writeStatisticField(const char *name, double value);
     void writeBin(double lowerEdge, double value);
+    template<typename T> void perform(const T& write);
 
   public:
     OmnetppScalarFileWriter();
@@ -58,6 +65,8 @@ class COMMON_API OmnetppScalarFileWriter
 
     void setPrecision(int p) {prec = p;}
     int getPrecision() const {return prec;}
+    void setAsync(bool b) {async = b;} // must be called before open()
+    bool isAsync() const {return async;}
 
     void beginRecordingForRun(const std::string& runName, const StringMap& attributes, const StringMap& itervars, const OrderedKeyValueList& configEntries);
     void endRecordingForRun();
@@ -16,6 +16,7 @@
 *--------------------------------------------------------------*/
 
 #include <algorithm>
+#include <memory>
 #include "commonutil.h"
 #include "stringutil.h"
 #include "omnetppvectorfilewriter.h"
@@ -25,6 +26,7 @@ namespace omnetpp {
 namespace common {
 
 #define VECTOR_FILE_VERSION    3
+#define BINARY_VECTOR_FILE_VERSION    4
 #define INDEX_FILE_VERSION     3
 
 using std::ostream;
@@ -37,6 +39,7 @@ OmnetppVectorFileWriter::OmnetppVectorFileWriter()
     f = nullptr;
     fi = nullptr;
     bufferedSamplesLimit = 0;
+    bufferedSamplesThreshold = 0;
     bufferedSamples = 0;
 }
 
@@ -48,7 +51,8 @@ OmnetppVectorFileWriter::~OmnetppVectorFileWriter()
 void OmnetppVectorFileWriter::check(int fprintfResult)
 {
     if (fprintfResult < 0) {
-        close();
+        if (!jobQueue.isWorkerThread())
+            close();  // otherwise the main thread closes the file when it receives the error
         throw opp_runtime_error("Cannot write output vector file '%s'", fname.c_str());
     }
 }
@@ -56,7 +60,8 @@ void OmnetppVectorFileWriter::check(int fprintfResult)
 void OmnetppVectorFileWriter::checki(int fprintfResult)
 {
     if (fprintfResult < 0) {
-        close();
+        if (!jobQueue.isWorkerThread())
+            close();
         throw opp_runtime_error("Cannot write output vector index file '%s'", ifname.c_str());
     }
 }
@@ -68,7 +73,7 @@ void OmnetppVectorFileWriter::open(const char *filename)
     f = fopen(fname.c_str(), "w");  // we only support overwrite but not append
     if (f == nullptr)
         throw opp_runtime_error("Cannot open output vector file '%s'", fname.c_str());
-    check(fprintf(f, "version %d\n", VECTOR_FILE_VERSION));
+    check(fprintf(f, "version %d\n", binary ? BINARY_VECTOR_FILE_VERSION : VECTOR_FILE_VERSION));
 
     // open index file
     ifname = opp_substringbeforelast(fname, ".") + ".vci";
@@ -78,10 +83,33 @@ void OmnetppVectorFileWriter::open(const char *filename)
 
     fprintf(fi, "%64s\n", "");  // leave blank space for "fingerprint" (size and modification date of the vector file)
     check(fprintf(fi, "version %d\n", INDEX_FILE_VERSION));
+
+    // in async mode, samples handed over to the writer thread are no longer
+    // counted in bufferedSamples, so the limit is split in two: half of it for
+    // the samples being collected, and half for those waiting to be written
+    bufferedSamplesThreshold = bufferedSamplesLimit;
+    if (async) {
+        if (bufferedSamplesLimit > 0)
+            bufferedSamplesThreshold = std::max(bufferedSamplesLimit / 2, 1);
+        jobQueue.setCostLimit(bufferedSamplesLimit > 0 ? std::max(bufferedSamplesLimit - bufferedSamplesThreshold, 1) : 0);
+        jobQueue.start();
+    }
 }
 
 void OmnetppVectorFileWriter::close()
 {
+    // let the writer thread finish; its error (if any) is rethrown after closing the files
+    std::exception_ptr error;
+    if (jobQueue.isRunning()) {
+        try {
+            jobQueue.drain();
+        }
+        catch (std::exception&) {
+            error = std::current_exception();
+        }
+        jobQueue.stop();
+    }
+
     if (f) {
         fclose(f);
         f = nullptr;
@@ -99,10 +127,13 @@ void OmnetppVectorFileWriter::close()
         fi = nullptr;
     }
 
+    if (error)
+        std::rethrow_exception(error);
 }
 
 void OmnetppVectorFileWriter::cleanup()  // MUST NOT THROW
 {
+    jobQueue.stop();
     if (f)
         fclose(f);
     if (fi)
@@ -114,6 +145,7 @@ void OmnetppVectorFileWriter::beginRecordingForRun(const std::string& runName, c
     Assert(vectors.size() == 0);
     bufferedSamples = 0;
     Assert(isOpen());
+    drainJobs();
 
     // note: we write everything twice, once in .vec and once in .vci
 
@@ -158,6 +190,7 @@ void OmnetppVectorFileWriter::endRecordingForRun()
         delete vp;
     }
     vectors.clear();
+    drainJobs();
 
     check(fprintf(f, "\n"));
     check(fprintf(fi, "\n"));
@@ -177,15 +210,23 @@ void *OmnetppVectorFileWriter::registerVector(const std::string& componentFullPa
     vectors.push_back(vp);
 
 
+    int id = vp->id;
     const char *columns = vp->recordEventNumbers ? "ETV" : "TV";
-    check(fprintf(f, "vector %d %s %s %s\n", vp->id, QUOTE(componentFullPath.c_str()), QUOTE(name.c_str()), columns));
-    for (auto pair : attributes)
-        check(fprintf(f, "attr %s %s\n", QUOTE(pair.first.c_str()), QUOTE(pair.second.c_str())));
-
-    // write vector declaration and vector attributes to the index file too
-    checki(fprintf(fi, "vector %d %s %s %s\n", vp->id, QUOTE(componentFullPath.c_str()), QUOTE(name.c_str()), columns));
-    for (auto pair : attributes)
-        checki(fprintf(fi, "attr %s %s\n", QUOTE(pair.first.c_str()), QUOTE(pair.second.c_str())));
+    auto writeDeclaration = [this, id, componentFullPath, name, attributes, columns]() {
+        check(fprintf(f, "vector %d %s %s %s\n", id, QUOTE(componentFullPath.c_str()), QUOTE(name.c_str()), columns));
+        for (auto pair : attributes)
+            check(fprintf(f, "attr %s %s\n", QUOTE(pair.first.c_str()), QUOTE(pair.second.c_str())));
+
+        // write vector declaration and vector attributes to the index file too
+        checki(fprintf(fi, "vector %d %s %s %s\n", id, QUOTE(componentFullPath.c_str()), QUOTE(name.c_str()), columns));
+        for (auto pair : attributes)
+            checki(fprintf(fi, "attr %s %s\n", QUOTE(pair.first.c_str()), QUOTE(pair.second.c_str())));
+    };
+
+    if (jobQueue.isRunning())
+        submitJob(writeDeclaration);
+    else
+        writeDeclaration();
 
     return vp;
 }
@@ -224,7 +265,7 @@ void OmnetppVectorFileWriter::recordInVector(void *vectorhandle, eventnumber_t e
     // write out block if necessary
     if (vp->bufferedSamplesLimit > 0 && (int)vp->buffer.size() >= vp->bufferedSamplesLimit)
         writeBlock(vp);
-    else if (bufferedSamplesLimit > 0 && bufferedSamples >= bufferedSamplesLimit)
+    else if (bufferedSamplesThreshold > 0 && bufferedSamples >= bufferedSamplesThreshold)
         writeRecords();
 }
 
@@ -242,12 +283,38 @@ void OmnetppVectorFileWriter::writeBlock(VectorData *vp)
     Assert(vp != nullptr);
     Assert(!vp->buffer.empty());
 
+    size_t numSamples = vp->buffer.size();
+    if (jobQueue.isRunning()) {
+        // hand over the samples and the block statistics to the writer thread
+        std::shared_ptr<VectorData> data = std::make_shared<VectorData>();
+        data->id = vp->id;
+        data->recordEventNumbers = vp->recordEventNumbers;
+        data->bufferedSamplesLimit = vp->bufferedSamplesLimit;
+        data->currentBlock = vp->currentBlock;
+        data->buffer.swap(vp->buffer);
+        if (vp->bufferedSamplesLimit > 0)
+            vp->buffer.reserve(vp->bufferedSamplesLimit);
+        submitJob([this, data]() {writeBlockData(data.get());}, numSamples);
+    }
+    else {
+        writeBlockData(vp);
+        vp->buffer.clear();
+    }
+
+    vp->currentBlock.reset();
+    bufferedSamples -= numSamples;
+}
+
+void OmnetppVectorFileWriter::writeBlockData(VectorData *vp)
+{
     char buf[64], buf2[64];
 
     Block& currentBlock = vp->currentBlock;
     currentBlock.offset = opp_ftell(f);
 
-    if (vp->recordEventNumbers) {
+    if (binary)
+        writeBinaryBlockData(vp);
+    else if (vp->recordEventNumbers) {
         for (auto sample : vp->buffer)
             check(fprintf(f, "%d\t%" PRId64 "\t%s\t%.*g\n", vp->id, sample.eventNumber, sample.time.ttoa(buf), prec, sample.value));
     }
@@ -280,16 +347,67 @@ void OmnetppVectorFileWriter::writeBlock(VectorData *vp)
     }
 
     fflush(fi);
-    block.reset();
+}
 
-    bufferedSamples -= vp->buffer.size();
-    vp->buffer.clear();
+void OmnetppVectorFileWriter::writeBinaryBlockData(VectorData *vp)
+{
+    // samples recorded by a simulation share the same simtime scale exponent,
+    // but e.g. converted files may contain normalized times with varying exponents;
+    // encode all times of the block with the smallest one
+    int scaleExp = vp->buffer[0].time.scaleExp;
+    for (const Sample& sample : vp->buffer)
+        scaleExp = std::min(scaleExp, sample.time.scaleExp);
+
+    encoder.reset(vp->recordEventNumbers, scaleExp);
+    for (const Sample& sample : vp->buffer) {
+        int64_t t = sample.time.t;
+        for (int i = sample.time.scaleExp; i > scaleExp; i--) {
+            if (t > INT64_MAX / 10 || t < INT64_MIN / 10) {
+                if (!jobQueue.isWorkerThread())
+                    close();
+                throw opp_runtime_error("Cannot write output vector file '%s': simulation time out of range", fname.c_str());
+            }
+            t *= 10;
+        }
+        encoder.add(sample.eventNumber, t, sample.value);
+    }
+    encodedBlock.clear();
+    encoder.encode(encodedBlock);
+
+    // header line, encoded block, and a newline so that line-based readers can resync after skipping the block
+    check(fprintf(f, "block %d %" PRId64 "\n", vp->id, (int64_t)encodedBlock.size()));
+    encodedBlock.push_back('\n');
+    if (fwrite(encodedBlock.data(), 1, encodedBlock.size(), f) != encodedBlock.size())
+        check(-1);
 }
 
 void OmnetppVectorFileWriter::flush()
 {
     Assert(isOpen());
     writeRecords();  // flushes both files
+    drainJobs();
+}
+
+void OmnetppVectorFileWriter::submitJob(const BackgroundJobQueue::Job& job, size_t numSamples)
+{
+    try {
+        jobQueue.submit(job, numSamples);
+    }
+    catch (std::exception&) {
+        close();  // a previous job failed
+        throw;
+    }
+}
+
+void OmnetppVectorFileWriter::drainJobs()
+{
+    try {
+        jobQueue.drain();
+    }
+    catch (std::exception&) {
+        close();
+        throw;
+    }
 }
 
 
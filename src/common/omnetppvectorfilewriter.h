@@ -23,6 +23,8 @@
 #include <vector>
 #include "commondefs.h"
 #include "statistics.h"
+#include "vectorblockcodec.h"
+#include "backgroundjobqueue.h"
 #include "omnetpp/platdep/platmisc.h"  // file_offset_t
 
 namespace omnetpp {
@@ -30,7 +32,15 @@ namespace common {
 
 
 /**
- * Class for writing text-based output vector files.
+ * Class for writing output vector files. Vector data are written as text by
+ * default; in binary mode (version 4 files), each block of samples is written
+ * as a "block" line followed by the block encoded with VectorBlockEncoder.
+ * Run and vector declarations, as well as the index file, are text in both modes.
+ *
+ * In asynchronous mode, filled sample buffers are handed over to a background
+ * thread which formats and writes them, so that file I/O overlaps with the
+ * simulation. Samples waiting to be written count against the overall memory
+ * limit as well. The files produced are identical to those of synchronous mode.
  */
 class COMMON_API OmnetppVectorFileWriter
 {
@@ -85,6 +95,7 @@ class COMMON_API OmnetppVectorFileWriter
     std::string fname;   // output file name
     FILE *f;             // file ptr of output file
     int prec = 14;       // number of significant digits when writing doubles
+    bool binary = false; // write vector data as compressed binary blocks
     int nextVectorId;    // holds next free ID for output vectors
 
     std::string ifname;  // index file name
@@ -93,6 +104,13 @@ class COMMON_API OmnetppVectorFileWriter
     Vectors vectors;           // registered output vectors
     int bufferedSamples;       // currently total buffered samples
     int bufferedSamplesLimit;  // limit of total buffered samples (0=no limit)
+    int bufferedSamplesThreshold; // write out all buffers at this many samples: the limit, minus the part reserved for queued samples in async mode
+
+    VectorBlockEncoder encoder; // for binary mode
+    std::string encodedBlock;   // for binary mode
+
+    bool async = false;         // write from a background thread
+    BackgroundJobQueue jobQueue; // for async mode
 
   protected:
     void cleanup();  // MUST NOT THROW
@@ -100,7 +118,11 @@ class COMMON_API OmnetppVectorFileWriter
     void checki(int fprintfResult);
     virtual void writeRecords();
     virtual void writeBlock(VectorData *vp);
+    virtual void writeBlockData(VectorData *vp);
+    virtual void writeBinaryBlockData(VectorData *vp);
     virtual void finalizeVector(VectorData *vp);
+    void submitJob(const BackgroundJobQueue::Job& job, size_t numSamples=0);
+    void drainJobs();
 
   public:
     OmnetppVectorFileWriter();
@@ -112,6 +134,10 @@ class COMMON_API OmnetppVectorFileWriter
 
     void setPrecision(int p) {prec = p;}
     int getPrecision() const {return prec;}
+    void setBinary(bool b) {binary = b;} // must be called before open()
+    bool isBinary() const {return binary;}
+    void setAsync(bool b) {async = b;} // must be called before open()
+    bool isAsync() const {return async;}
     void setOverallMemoryLimit(size_t limit) {bufferedSamplesLimit = limit / sizeof(Sample);}
     size_t getOverallMemoryLimit() const {return bufferedSamplesLimit * sizeof(Sample);}
 
@@ -151,6 +151,17 @@ const char SQL_CREATE_TABLES[] =
             "value         REAL " // cannot be NOT NULL because of NaN values
         "); "
         ""
+        "CREATE TABLE IF NOT EXISTS vectorDataBlock "  // used instead of vectorData in packed mode
+        "( "
+            "vectorId        INTEGER NOT NULL REFERENCES vector(vectorId) ON DELETE CASCADE, "
+            "startEventNum   INTEGER NOT NULL, "
+            "endEventNum     INTEGER NOT NULL, "
+            "startSimtimeRaw INTEGER NOT NULL, "
+            "endSimtimeRaw   INTEGER NOT NULL, "
+            "sampleCount     INTEGER NOT NULL, "
+            "data            BLOB NOT NULL "    // encoded with VectorBlockEncoder
+        "); "
+        ""
         "COMMIT TRANSACTION; "
         ""
         "PRAGMA synchronous = OFF; "
@@ -24,6 +24,7 @@
 #include "sqlite3.h"
 #include "commondefs.h"
 #include "statistics.h"
+#include "vectorblockcodec.h"
 
 namespace omnetpp {
 namespace common {
@@ -31,6 +32,11 @@ namespace common {
 
 /**
  * Class for writing SQLite-based output vector files.
+ *
+ * Samples are stored as rows of the vectorData table by default, inserted
+ * several rows per INSERT statement. In packed mode, each block of samples
+ * is stored as a single row of the vectorDataBlock table, encoded with
+ * VectorBlockEncoder.
  */
 class COMMON_API SqliteVectorFileWriter
 {
@@ -71,8 +77,20 @@ class COMMON_API SqliteVectorFileWriter
     sqlite3_stmt *add_vector_stmt;
     sqlite3_stmt *add_vector_attr_stmt;
     sqlite3_stmt *add_vector_data_stmt;
+    sqlite3_stmt *add_vector_data_multi_stmt;
+    sqlite3_stmt *add_vector_data_block_stmt;
     sqlite3_stmt *update_vector_stmt;
 
+    // settings; must be set before open()
+    bool packed = false;      // store samples in encoded blocks
+    bool walJournal = false;  // use write-ahead logging during recording
+    int pageSize = 0;         // database page size in bytes; 0=unchanged
+    int64_t cacheSize = 0;    // page cache size in bytes; 0=unchanged
+
+    int simtimeScaleExp = 0;     // of the current run
+    VectorBlockEncoder encoder;  // for packed mode
+    std::string encodedBlock;    // for packed mode
+
     int bufferedSamplesLimit;  // limit of total buffered samples; 0=no limit
 
     Vectors vectors;           // registered output vectors
@@ -84,6 +102,7 @@ class COMMON_API SqliteVectorFileWriter
     virtual void writeRecords();
     virtual void writeOneBlock(VectorData *vp);
     virtual void writeBlock(VectorData *vp);
+    virtual void writePackedBlock(VectorData *vp);
     virtual void finalizeVector(VectorData *vp);
     void executeSql(const char *sql);
 
@@ -103,6 +122,14 @@ class COMMON_API SqliteVectorFileWriter
 
     void setOverallMemoryLimit(size_t limit) {bufferedSamplesLimit = limit / sizeof(Sample);}
     size_t getOverallMemoryLimit() const {return bufferedSamplesLimit * sizeof(Sample);}
+    void setPacked(bool b) {packed = b;}
+    bool isPacked() const {return packed;}
+    void setWalJournal(bool b) {walJournal = b;}
+    bool getWalJournal() const {return walJournal;}
+    void setPageSize(int bytes) {pageSize = bytes;} // only has effect when creating a new file
+    int getPageSize() const {return pageSize;}
+    void setCacheSize(int64_t bytes) {cacheSize = bytes;}
+    int64_t getCacheSize() const {return cacheSize;}
 
     void beginRecordingForRun(const std::string& runName, int simtimeScaleExp, const StringMap& attributes, const StringMap& itervars, const OrderedKeyValueList& paramAssignments);
     void endRecordingForRun();
@@ -20,6 +20,7 @@
 #include <climits>
 #include <cerrno>
 #include <cmath>  // HUGE_VAL
+#include <cfloat>  // FLT_EVAL_METHOD
 #include <clocale>
 #include <algorithm>
 #include "omnetpp/platdep/platmisc.h"
@@ -885,6 +886,95 @@ double opp_atof(const char *s)
     return d;
 }
 
+bool opp_parsedouble_fast(const char *s, double& result)
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    // exact powers of ten; larger ones are not representable as double
+    static const double powersOf10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const uint64_t maxExactInteger = (uint64_t)1 << 53;
+
+    const char *p = s;
+    bool negative = (*p == '-');
+    if (*p == '-' || *p == '+')
+        p++;
+
+    // significand; stop collecting digits where it could overflow
+    uint64_t significand = 0;
+    int numDigits = 0, exponent = 0;
+    const char *digitsStart = p;
+    while (*p >= '0' && *p <= '9') {
+        if (numDigits > 15)
+            return false;
+        significand = 10*significand + (*p++ - '0');
+        if (significand != 0)
+            numDigits++;
+    }
+    bool hasDigits = p != digitsStart;
+    if (*p == '.') {
+        p++;
+        const char *fractionStart = p;
+        while (*p >= '0' && *p <= '9') {
+            if (numDigits > 15)
+                return false;
+            significand = 10*significand + (*p++ - '0');
+            if (significand != 0)
+                numDigits++;
+        }
+        exponent = -(int)(p - fractionStart);
+        hasDigits = hasDigits || p != fractionStart;
+    }
+    if (!hasDigits)
+        return false;
+
+    if (*p == 'e' || *p == 'E') {
+        p++;
+        bool negativeExponent = (*p == '-');
+        if (*p == '-' || *p == '+')
+            p++;
+        if (*p < '0' || *p > '9')
+            return false;
+        int e = 0;
+        while (*p >= '0' && *p <= '9') {
+            if (e > 1000)
+                return false;
+            e = 10*e + (*p++ - '0');
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+    if (*p)
+        return false;
+
+    // both the significand and the power of ten are exact, so the result is correctly rounded
+    if (significand > maxExactInteger)
+        return false;
+    double d = (double)significand;
+    if (significand == 0)
+        ;
+    else if (exponent < 0) {
+        if (exponent < -22)
+            return false;
+        d /= powersOf10[-exponent];
+    }
+    else if (exponent > 0) {
+        if (exponent > 22) {
+            // move the excess into the significand if it stays exact (e.g. 1e30)
+            if (exponent > 22+15 || significand > maxExactInteger / (uint64_t)powersOf10[exponent-22])
+                return false;
+            d *= powersOf10[exponent-22];
+            exponent = 22;
+        }
+        d *= powersOf10[exponent];
+    }
+    result = negative ? -d : d;
+    return true;
+#else
+    return false;  // excess precision in intermediate results would break exactness
+#endif
+}
+
 std::string opp_formatdouble(double value, int numSignificantDigits)
 {
     char buf[128];
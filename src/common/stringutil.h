@@ -427,6 +427,19 @@ COMMON_API double opp_strtod(const char *s, char **endptr);
  */
 COMMON_API double opp_atof(const char *s);
 
+/**
+ * Fast, locale-independent conversion of a decimal number to double, for
+ * the common case when the result can be computed exactly with a single
+ * floating-point multiplication or division: an optional sign, digits with
+ * an optional decimal point, and an optional exponent, where the significand
+ * fits into 53 bits (15 significant digits always do) and the exponent is
+ * small. Numbers printed with "%.14g" (the default precision of result files)
+ * are of this form. The whole string must be the number. Returns false (and
+ * leaves result unchanged) for any other input, e.g. longer numbers, "inf"
+ * or "nan"; callers should fall back to strtod() in that case.
+ */
+COMMON_API bool opp_parsedouble_fast(const char *s, double& result);
+
 /**
  * Formats the given double using printf's "%g" formatting. NOTE: This function
  * is needed by the IDE (nativelibs).
@@ -0,0 +1,374 @@
+//=========================================================================
+//  VECTORBLOCKCODEC.CC - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#include <cstring>
+#include <algorithm>
+#include "exception.h"
+#include "vectorblockcodec.h"
+
+namespace omnetpp {
+namespace common {
+
+#define FLAG_EVENTNUMBERS    1
+#define FLAG_COMPRESSED      2
+
+#define LZ4_MINMATCH         4
+#define LZ4_HASHLOG          12
+#define LZ4_LASTLITERALS     5
+#define LZ4_MFLIMIT          12
+#define LZ4_MAXOFFSET        65535
+#define LZ4_SKIPSTRENGTH     6
+
+static void corrupt()
+{
+    throw opp_runtime_error("Corrupt data block in binary vector file");
+}
+
+static inline uint64_t zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static inline void putVarint(std::string& out, uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back((char)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((char)v);
+}
+
+static inline uint64_t getVarint(const unsigned char *& p, const unsigned char *end)
+{
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p >= end)
+            break;
+        unsigned char b = *p++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+            return v;
+    }
+    corrupt();
+    return 0;
+}
+
+//----
+
+void VectorBlockEncoder::reset(bool hasEventNumbers, int scaleExp)
+{
+    this->hasEventNumbers = hasEventNumbers;
+    this->scaleExp = scaleExp;
+    count = 0;
+    prevEventNumber = prevRawTime = 0;
+    prevValueBits = 0;
+    eventColumn.clear();
+    timeColumn.clear();
+    valueColumn.clear();
+}
+
+void VectorBlockEncoder::add(int64_t eventNumber, int64_t rawTime, double value)
+{
+    count++;
+
+    if (hasEventNumbers) {
+        putVarint(eventColumn, zigzag((int64_t)((uint64_t)eventNumber - (uint64_t)prevEventNumber)));
+        prevEventNumber = eventNumber;
+    }
+
+    putVarint(timeColumn, zigzag((int64_t)((uint64_t)rawTime - (uint64_t)prevRawTime)));
+    prevRawTime = rawTime;
+
+    // store the XOR with the previous value: one zero byte if they are equal,
+    // otherwise a header byte (0x40 | trailingZeroBytes<<3 | numBytes-1)
+    // followed by the nonzero middle bytes, least significant first
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint64_t x = bits ^ prevValueBits;
+    prevValueBits = bits;
+    if (x == 0) {
+        valueColumn.push_back(0);
+        return;
+    }
+    int trailingZeroBytes = 0;
+    while ((x & 0xff) == 0) {
+        x >>= 8;
+        trailingZeroBytes++;
+    }
+    int numBytes = 0;
+    for (uint64_t tmp = x; tmp != 0; tmp >>= 8)
+        numBytes++;
+    valueColumn.push_back((char)(0x40 | (trailingZeroBytes << 3) | (numBytes - 1)));
+    for (int i = 0; i < numBytes; i++, x >>= 8)
+        valueColumn.push_back((char)(x & 0xff));
+}
+
+void VectorBlockEncoder::encode(std::string& out, bool compress) const
+{
+    putVarint(out, count);
+    size_t flagsPos = out.size();
+    out.push_back(hasEventNumbers ? FLAG_EVENTNUMBERS : 0);
+    out.push_back((char)(signed char)scaleExp);
+    putVarint(out, eventColumn.size());
+    putVarint(out, timeColumn.size());
+    putVarint(out, valueColumn.size());
+
+    if (compress) {
+        std::string columns;
+        columns.reserve(eventColumn.size() + timeColumn.size() + valueColumn.size());
+        columns.append(eventColumn).append(timeColumn).append(valueColumn);
+
+        size_t pos = out.size();
+        out.resize(pos + lz4CompressBound(columns.size()));
+        size_t compressedSize = lz4Compress(columns.data(), columns.size(), &out[pos]);
+        if (compressedSize < columns.size()) {
+            out.resize(pos + compressedSize);
+            out[flagsPos] |= FLAG_COMPRESSED;
+            return;
+        }
+        out.resize(pos);  // compression did not pay off, store columns as they are
+    }
+    out.append(eventColumn).append(timeColumn).append(valueColumn);
+}
+
+//----
+
+VectorBlockDecoder::VectorBlockDecoder(const char *data, size_t size)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    const unsigned char *end = p + size;
+
+    count = remaining = (int64_t)getVarint(p, end);
+    if (end - p < 2)
+        corrupt();
+    int flags = *p++;
+    scaleExp = (signed char)*p++;
+    hasEventNumbers = (flags & FLAG_EVENTNUMBERS) != 0;
+    uint64_t eventColumnSize = getVarint(p, end);
+    uint64_t timeColumnSize = getVarint(p, end);
+    uint64_t valueColumnSize = getVarint(p, end);
+    uint64_t maxColumnsSize = (uint64_t)size * 256;  // LZ4 cannot compress better than 1:255
+    if (eventColumnSize > maxColumnsSize || timeColumnSize > maxColumnsSize || valueColumnSize > maxColumnsSize)
+        corrupt();
+    uint64_t columnsSize = eventColumnSize + timeColumnSize + valueColumnSize;
+    if (count < 0 || (uint64_t)count > timeColumnSize || (uint64_t)count > valueColumnSize || columnsSize > maxColumnsSize)
+        corrupt();
+
+    const unsigned char *columns;
+    if (flags & FLAG_COMPRESSED) {
+        uncompressed.resize(columnsSize);
+        lz4Decompress((const char *)p, end - p, &uncompressed[0], columnsSize);
+        columns = (const unsigned char *)uncompressed.data();
+    }
+    else {
+        if ((uint64_t)(end - p) != columnsSize)
+            corrupt();
+        columns = p;
+    }
+
+    eventPtr = columns;
+    eventEnd = timePtr = eventPtr + eventColumnSize;
+    timeEnd = valuePtr = timePtr + timeColumnSize;
+    valueEnd = valuePtr + valueColumnSize;
+}
+
+bool VectorBlockDecoder::next(int64_t& eventNumber, int64_t& rawTime, double& value)
+{
+    if (remaining == 0)
+        return false;
+    remaining--;
+
+    if (hasEventNumbers) {
+        this->eventNumber = (int64_t)((uint64_t)this->eventNumber + (uint64_t)unzigzag(getVarint(eventPtr, eventEnd)));
+        eventNumber = this->eventNumber;
+    }
+    else
+        eventNumber = -1;
+
+    this->rawTime = (int64_t)((uint64_t)this->rawTime + (uint64_t)unzigzag(getVarint(timePtr, timeEnd)));
+    rawTime = this->rawTime;
+
+    if (valuePtr >= valueEnd)
+        corrupt();
+    int header = *valuePtr++;
+    if (header != 0) {
+        int trailingZeroBytes = (header >> 3) & 7;
+        int numBytes = (header & 7) + 1;
+        if ((header & 0xc0) != 0x40 || trailingZeroBytes + numBytes > 8 || valueEnd - valuePtr < numBytes)
+            corrupt();
+        uint64_t x = 0;
+        for (int i = 0; i < numBytes; i++)
+            x |= (uint64_t)*valuePtr++ << (8*i);
+        valueBits ^= x << (8*trailingZeroBytes);
+    }
+    memcpy(&value, &valueBits, sizeof(value));
+    return true;
+}
+
+//----
+
+static inline uint32_t read32(const unsigned char *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t lz4Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32 - LZ4_HASHLOG);
+}
+
+static inline unsigned char *writeLength(unsigned char *op, size_t length)
+{
+    for ( ; length >= 255; length -= 255)
+        *op++ = 255;
+    *op++ = (unsigned char)length;
+    return op;
+}
+
+static inline const unsigned char *readLength(const unsigned char *ip, const unsigned char *ipEnd, size_t& length)
+{
+    unsigned char b;
+    do {
+        if (ip >= ipEnd)
+            corrupt();
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return ip;
+}
+
+size_t lz4CompressBound(size_t inputSize)
+{
+    return inputSize + inputSize / 255 + 16;
+}
+
+size_t lz4Compress(const char *src, size_t srcSize, char *dest)
+{
+    const unsigned char *in = (const unsigned char *)src;
+    unsigned char *op = (unsigned char *)dest;
+    size_t anchor = 0;
+
+    // greedy parsing with a single-entry hash table; the format requires
+    // the last 5 bytes to be literals, and the last match to start at
+    // least 12 bytes before the end of the input
+    if (srcSize > LZ4_MFLIMIT) {
+        int64_t table[1 << LZ4_HASHLOG];
+        std::fill(table, table + (1 << LZ4_HASHLOG), -1);
+        size_t matchStartLimit = srcSize - LZ4_MFLIMIT;
+        size_t matchEndLimit = srcSize - LZ4_LASTLITERALS;
+        size_t ip = 0;
+        while (ip < matchStartLimit) {
+            uint32_t sequence = read32(in + ip);
+            uint32_t h = lz4Hash(sequence);
+            int64_t ref = table[h];
+            table[h] = ip;
+            if (ref < 0 || ip - ref > LZ4_MAXOFFSET || read32(in + ref) != sequence) {
+                ip += 1 + ((ip - anchor) >> LZ4_SKIPSTRENGTH);  // skip faster over incompressible data
+                continue;
+            }
+
+            size_t matchLength = LZ4_MINMATCH;
+            while (ip + matchLength < matchEndLimit && in[ref + matchLength] == in[ip + matchLength])
+                matchLength++;
+
+            size_t literalLength = ip - anchor;
+            size_t extraMatchLength = matchLength - LZ4_MINMATCH;
+            unsigned char *token = op++;
+            *token = (unsigned char)((std::min(literalLength, (size_t)15) << 4) | std::min(extraMatchLength, (size_t)15));
+            if (literalLength >= 15)
+                op = writeLength(op, literalLength - 15);
+            memcpy(op, in + anchor, literalLength);
+            op += literalLength;
+            size_t offset = ip - ref;
+            *op++ = (unsigned char)(offset & 0xff);
+            *op++ = (unsigned char)(offset >> 8);
+            if (extraMatchLength >= 15)
+                op = writeLength(op, extraMatchLength - 15);
+
+            ip += matchLength;
+            anchor = ip;
+        }
+    }
+
+    // last literals
+    size_t literalLength = srcSize - anchor;
+    *op++ = (unsigned char)(std::min(literalLength, (size_t)15) << 4);
+    if (literalLength >= 15)
+        op = writeLength(op, literalLength - 15);
+    memcpy(op, in + anchor, literalLength);
+    op += literalLength;
+    return op - (unsigned char *)dest;
+}
+
+void lz4Decompress(const char *src, size_t srcSize, char *dest, size_t destSize)
+{
+    const unsigned char *ip = (const unsigned char *)src;
+    const unsigned char *ipEnd = ip + srcSize;
+    unsigned char *op = (unsigned char *)dest;
+    unsigned char *opBegin = op;
+    unsigned char *opEnd = op + destSize;
+
+    while (true) {
+        if (ip >= ipEnd)
+            corrupt();
+        unsigned int token = *ip++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15)
+            ip = readLength(ip, ipEnd, literalLength);
+        if (literalLength > (size_t)(ipEnd - ip) || literalLength > (size_t)(opEnd - op))
+            corrupt();
+        memcpy(op, ip, literalLength);
+        op += literalLength;
+        ip += literalLength;
+        if (ip == ipEnd)
+            break;  // the last sequence only contains literals
+
+        if (ipEnd - ip < 2)
+            corrupt();
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - opBegin))
+            corrupt();
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15)
+            ip = readLength(ip, ipEnd, matchLength);
+        matchLength += LZ4_MINMATCH;
+        if (matchLength > (size_t)(opEnd - op))
+            corrupt();
+
+        const unsigned char *match = op - offset;
+        if (offset >= matchLength)
+            memcpy(op, match, matchLength);
+        else
+            for (size_t i = 0; i < matchLength; i++)  // overlapping copy repeats the pattern
+                op[i] = match[i];
+        op += matchLength;
+    }
+
+    if (op != opEnd)
+        corrupt();
+}
+
+}  // namespace common
+}  // namespace omnetpp
+
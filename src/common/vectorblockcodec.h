@@ -0,0 +1,134 @@
+//=========================================================================
+//  VECTORBLOCKCODEC.H - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#ifndef __OMNETPP_COMMON_VECTORBLOCKCODEC_H
+#define __OMNETPP_COMMON_VECTORBLOCKCODEC_H
+
+#include <cstdint>
+#include <string>
+#include "commondefs.h"
+
+namespace omnetpp {
+namespace common {
+
+/**
+ * Encoder for the data blocks of binary (version 4) output vector files.
+ *
+ * Samples of a block are stored in columns: event numbers and raw simulation
+ * times as zigzag varint deltas, and values as the XOR of their bit pattern
+ * with that of the previous value, with leading and trailing zero bytes
+ * stripped. The concatenated columns are then compressed using the LZ4
+ * block format, unless that would not make them smaller.
+ *
+ * Layout of an encoded block: varint count, flags byte (1=event numbers
+ * present, 2=compressed), signed byte simtime scale exponent, three varint
+ * column sizes, followed by the (possibly compressed) column data.
+ */
+class COMMON_API VectorBlockEncoder
+{
+  protected:
+    bool hasEventNumbers = true;
+    int scaleExp = 0;
+    int64_t count = 0;
+    int64_t prevEventNumber = 0;
+    int64_t prevRawTime = 0;
+    uint64_t prevValueBits = 0;
+    std::string eventColumn, timeColumn, valueColumn;
+
+  public:
+    VectorBlockEncoder() {}
+
+    /**
+     * Discards the collected samples, and prepares for encoding a new block.
+     */
+    void reset(bool hasEventNumbers, int scaleExp);
+
+    /**
+     * Appends a sample to the block. The event number is ignored if the block
+     * was reset with hasEventNumbers=false.
+     */
+    void add(int64_t eventNumber, int64_t rawTime, double value);
+
+    /**
+     * Returns the number of samples in the block.
+     */
+    int64_t getCount() const {return count;}
+
+    /**
+     * Appends the encoded block to the given buffer.
+     */
+    void encode(std::string& out, bool compress=true) const;
+};
+
+/**
+ * Decoder for data blocks produced by VectorBlockEncoder. Throws an
+ * opp_runtime_error if the block is malformed.
+ */
+class COMMON_API VectorBlockDecoder
+{
+  protected:
+    int64_t count = 0;
+    int64_t remaining = 0;
+    bool hasEventNumbers = false;
+    int scaleExp = 0;
+    std::string uncompressed;
+    const unsigned char *eventPtr, *eventEnd;
+    const unsigned char *timePtr, *timeEnd;
+    const unsigned char *valuePtr, *valueEnd;
+    int64_t eventNumber = 0;
+    int64_t rawTime = 0;
+    uint64_t valueBits = 0;
+
+  public:
+    /**
+     * Parses the header of the block, and decompresses its data if needed.
+     * The block data must remain valid during the lifetime of the decoder
+     * unless it was compressed.
+     */
+    VectorBlockDecoder(const char *data, size_t size);
+    VectorBlockDecoder(const VectorBlockDecoder&) = delete;
+
+    int64_t getCount() const {return count;}
+    bool getHasEventNumbers() const {return hasEventNumbers;}
+    int getScaleExp() const {return scaleExp;}
+
+    /**
+     * Decodes the next sample. Returns false if there are no more samples.
+     * The event number is -1 if the block does not contain event numbers.
+     */
+    bool next(int64_t& eventNumber, int64_t& rawTime, double& value);
+};
+
+/**
+ * Returns the maximum size of the compressed output for an input of the given size.
+ */
+COMMON_API size_t lz4CompressBound(size_t inputSize);
+
+/**
+ * Compresses the input using the LZ4 block format, and returns the size of
+ * the output. The output buffer must be at least lz4CompressBound(srcSize) bytes.
+ */
+COMMON_API size_t lz4Compress(const char *src, size_t srcSize, char *dest);
+
+/**
+ * Decompresses an LZ4 block into a buffer of exactly the given size.
+ * Throws an opp_runtime_error if the input is malformed.
+ */
+COMMON_API void lz4Decompress(const char *src, size_t srcSize, char *dest, size_t destSize);
+
+}  // namespace common
+}  // namespace omnetpp
+
+
+#endif
@@ -0,0 +1,32 @@
+//==========================================================================
+//  BINARYOUTVECTORMGR.CC - part of
+//                     OMNeT++/OMNEST
+//            Discrete System Simulation in C++
+//
+//==========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#include "common/stringutil.h"
+#include "omnetpp/globals.h"
+#include "binaryoutvectormgr.h"
+
+namespace omnetpp {
+namespace envir {
+
+Register_Class(BinaryOutputVectorManager);
+
+void BinaryOutputVectorManager::startRun()
+{
+    OmnetppOutputVectorManager::startRun();
+    writer.setBinary(true);
+}
+
+}  // namespace envir
+}  // namespace omnetpp
+
@@ -0,0 +1,51 @@
+//==========================================================================
+//  BINARYOUTVECTORMGR.H - part of
+//                     OMNeT++/OMNEST
+//            Discrete System Simulation in C++
+//
+//==========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#ifndef __OMNETPP_ENVIR_BINARYOUTVECTORMGR_H
+#define __OMNETPP_ENVIR_BINARYOUTVECTORMGR_H
+
+#include "omnetppoutvectormgr.h"
+
+namespace omnetpp {
+namespace envir {
+
+/**
+ * An output vector manager that writes vector data into the .vec file as
+ * compressed binary blocks (vector file version 4) instead of text lines.
+ * Run and vector declarations and the index file are the same as with
+ * OmnetppOutputVectorManager, so the result analysis tools can load the
+ * file the same way; only the data blocks need to be decoded differently.
+ * Values are stored with full precision, output-vector-precision is ignored.
+ *
+ * @ingroup Envir
+ */
+class BinaryOutputVectorManager : public OmnetppOutputVectorManager
+{
+  public:
+    /**
+     * Constructor.
+     */
+    BinaryOutputVectorManager() {}
+
+    /**
+     * Configures the writer for the binary format, in addition to
+     * what OmnetppOutputVectorManager does.
+     */
+    virtual void startRun() override;
+};
+
+} // namespace envir
+}  // namespace omnetpp
+
+#endif
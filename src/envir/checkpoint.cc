@@ -0,0 +1,324 @@
+//==========================================================================
+//  CHECKPOINT.CC - part of
+//                     OMNeT++/OMNEST
+//             Discrete System Simulation in C++
+//
+//==========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <set>
+#include <vector>
+#include "omnetpp/csimulation.h"
+#include "omnetpp/csimplemodule.h"
+#include "omnetpp/ccomponenttype.h"
+#include "omnetpp/cproperties.h"
+#include "omnetpp/cfutureeventset.h"
+#include "omnetpp/cfingerprint.h"
+#include "omnetpp/ccontextswitcher.h"
+#include "omnetpp/cobjectfactory.h"
+#include "omnetpp/checkandcast.h"
+#include "omnetpp/crng.h"
+#include "omnetpp/opp_string.h"
+#include "checkpoint.h"
+
+#ifdef WITH_PARSIM
+#include "sim/parsim/cmemcommbuffer.h"
+#endif
+
+namespace omnetpp {
+namespace envir {
+
+#define CHECKPOINT_MAGIC    "OMNETPP_CHECKPOINT"
+#define CHECKPOINT_VERSION  1
+
+#ifdef WITH_PARSIM
+
+static void writeFile(const char *fileName, cMemCommBuffer& buffer)
+{
+    FILE *f = fopen(fileName, "wb");
+    if (!f)
+        throw cRuntimeError("Cannot open checkpoint file '%s' for write", fileName);
+    bool ok = fwrite(buffer.getBuffer(), buffer.getMessageSize(), 1, f) == 1;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok)
+        throw cRuntimeError("Cannot write checkpoint file '%s'", fileName);
+}
+
+static void readFile(const char *fileName, cMemCommBuffer& buffer)
+{
+    FILE *f = fopen(fileName, "rb");
+    if (!f)
+        throw cRuntimeError("Cannot open checkpoint file '%s'", fileName);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buffer.allocateAtLeast(size);
+    bool ok = size >= 0 && (size == 0 || fread(buffer.getBuffer(), size, 1, f) == 1);
+    fclose(f);
+    if (!ok)
+        throw cRuntimeError("Cannot read checkpoint file '%s'", fileName);
+    buffer.setMessageSize(size);
+}
+
+static std::string unpackString(cCommBuffer *buffer)
+{
+    opp_string tmp;
+    buffer->unpack(tmp);
+    return tmp.c_str();
+}
+
+void SimulationCheckpoint::write(const char *fileName, cSimulation *simulation, cRNG **rngs, int numRNGs)
+{
+    cMemCommBuffer buffer;
+    buffer.pack(CHECKPOINT_MAGIC);
+    buffer.pack(CHECKPOINT_VERSION);
+    buffer.pack(simulation->getNetworkType()->getFullName());
+    buffer.pack(SimTime::getScaleExp());
+    buffer.pack(simulation->getSimTime());
+    buffer.pack(simulation->getEventNumber());
+
+    buffer.pack(numRNGs);
+    for (int i = 0; i < numRNGs; i++) {
+        buffer.pack(rngs[i]->getClassName());
+        rngs[i]->parsimPack(&buffer);
+    }
+
+    // the fingerprint state goes into a separate block, so that it can be
+    // skipped if the restored run does not compute a fingerprint
+    cFingerprintCalculator *fingerprint = simulation->getFingerprintCalculator();
+    if (buffer.packFlag(fingerprint != nullptr)) {
+        cMemCommBuffer block;
+        fingerprint->parsimPack(&block);
+        buffer.pack(fingerprint->getClassName());
+        buffer.pack(block.getMessageSize());
+        buffer.pack(block.getBuffer(), block.getMessageSize());
+    }
+
+    packComponents(&buffer, simulation);
+    packFutureEvents(&buffer, simulation);
+
+    writeFile(fileName, buffer);
+}
+
+void SimulationCheckpoint::packComponents(cCommBuffer *buffer, cSimulation *simulation)
+{
+    int lastId = simulation->getLastComponentId();
+    buffer->pack(lastId);
+    for (int id = 1; id <= lastId; id++) {
+        cComponent *component = simulation->getComponent(id);
+        if (!buffer->packFlag(component != nullptr))
+            continue;
+        cSimpleModule *simpleModule = dynamic_cast<cSimpleModule *>(component);
+        if (simpleModule && simpleModule->usesActivity())
+            throw cRuntimeError(component, "Cannot write checkpoint: activity()-based modules are not supported");
+        // the default checkpointPack() only saves parameters, so simple modules must declare that they save their full state
+        if (simpleModule && !simpleModule->getProperties()->getAsBool("checkpointable"))
+            throw cRuntimeError(component, "Cannot write checkpoint: module type '%s' is not marked as @checkpointable "
+                    "(simple modules need to save their state by redefining checkpointPack() and checkpointUnpack(), "
+                    "then declare it with the @checkpointable property in NED)", simpleModule->getNedTypeName());
+        buffer->pack(component->getFullPath().c_str());
+        buffer->pack(component->getClassName());
+        component->checkpointPack(buffer);
+    }
+}
+
+void SimulationCheckpoint::packFutureEvents(cCommBuffer *buffer, cSimulation *simulation)
+{
+    // Plain events are not saved: the only ones normally present are internal
+    // to the simulation kernel (such as the one that implements sim-time-limit),
+    // and they are re-created from the configuration. Messages are saved in
+    // their insertion order, so that the order of events with equal time and
+    // priority is preserved.
+    cFutureEventSet *fes = simulation->getFES();
+    std::vector<cMessage *> messages;
+    for (int i = 0; i < fes->getLength(); i++) {
+        cEvent *event = fes->get(i);
+        if (event->isMessage())
+            messages.push_back(static_cast<cMessage *>(event));
+    }
+    std::sort(messages.begin(), messages.end(), [](cMessage *a, cMessage *b) {return a->getInsertOrder() < b->getInsertOrder();});
+
+    buffer->pack((int)messages.size());
+    for (cMessage *msg : messages) {
+        if (msg->getContextPointer() || msg->getControlInfo())
+            throw cRuntimeError(msg, "Cannot write checkpoint: scheduled messages with a context pointer or control info attached are not supported");
+        buffer->pack(msg->getClassName());
+        buffer->pack(msg->getName());
+        buffer->pack(msg->isSelfMessage());
+        buffer->pack(msg->getArrivalModuleId());
+        msg->parsimPack(buffer);
+    }
+}
+
+void SimulationCheckpoint::restore(const char *fileName, cSimulation *simulation, cRNG **rngs, int numRNGs)
+{
+    cMemCommBuffer buffer;
+    readFile(fileName, buffer);
+
+    // check the magic string before unpacking anything from a possibly unrelated file
+    // (a packed string is its length followed by the characters)
+    const size_t magicLength = strlen(CHECKPOINT_MAGIC);
+    if (buffer.getMessageSize() < (int)(sizeof(int) + magicLength) || memcmp(buffer.getBuffer() + sizeof(int), CHECKPOINT_MAGIC, magicLength) != 0)
+        throw cRuntimeError("'%s' is not a simulation checkpoint file", fileName);
+    unpackString(&buffer);
+
+    int version;
+    buffer.unpack(version);
+    if (version != CHECKPOINT_VERSION)
+        throw cRuntimeError("Checkpoint file '%s' has unsupported version %d", fileName, version);
+    std::string networkName = unpackString(&buffer);
+    if (networkName != simulation->getNetworkType()->getFullName())
+        throw cRuntimeError("Checkpoint file '%s' was written for a different network (%s)", fileName, networkName.c_str());
+    int scaleExp;
+    buffer.unpack(scaleExp);
+    if (scaleExp != SimTime::getScaleExp())
+        throw cRuntimeError("Checkpoint file '%s' was written with a different simtime-resolution", fileName);
+    simtime_t t;
+    eventnumber_t eventNumber;
+    buffer.unpack(t);
+    buffer.unpack(eventNumber);
+
+    int n;
+    buffer.unpack(n);
+    if (n != numRNGs)
+        throw cRuntimeError("Cannot restore checkpoint '%s': number of RNGs differ (saved: %d, current: %d)", fileName, n, numRNGs);
+    for (int i = 0; i < numRNGs; i++) {
+        std::string className = unpackString(&buffer);
+        if (className != rngs[i]->getClassName())
+            throw cRuntimeError("Cannot restore checkpoint '%s': RNG class differs (saved: %s, current: %s)", fileName, className.c_str(), rngs[i]->getClassName());
+        rngs[i]->parsimUnpack(&buffer);
+    }
+
+    if (buffer.checkFlag()) {
+        std::string className = unpackString(&buffer);
+        int size;
+        buffer.unpack(size);
+        cMemCommBuffer block;
+        block.allocateAtLeast(size);
+        buffer.unpack(block.getBuffer(), size);
+        block.setMessageSize(size);
+        cFingerprintCalculator *fingerprint = simulation->getFingerprintCalculator();
+        if (fingerprint) {
+            if (className != fingerprint->getClassName())
+                throw cRuntimeError("Cannot restore checkpoint '%s': fingerprint calculator class differs (saved: %s, current: %s)", fileName, className.c_str(), fingerprint->getClassName());
+            fingerprint->parsimUnpack(&block);
+            block.assertBufferEmpty();
+        }
+    }
+
+    simulation->setSimTime(t);
+    simulation->setEventNumber(eventNumber);
+
+    unpackComponents(&buffer, simulation);
+    unpackFutureEvents(&buffer, simulation);
+
+    buffer.assertBufferEmpty();
+}
+
+void SimulationCheckpoint::unpackComponents(cCommBuffer *buffer, cSimulation *simulation)
+{
+    int lastId;
+    buffer->unpack(lastId);
+    if (lastId != simulation->getLastComponentId())
+        throw cRuntimeError("Cannot restore checkpoint: number of modules and channels differ, was the network set up the same way?");
+    for (int id = 1; id <= lastId; id++) {
+        cComponent *component = simulation->getComponent(id);
+        if (buffer->checkFlag() != (component != nullptr))
+            throw cRuntimeError("Cannot restore checkpoint: the set of modules and channels differs, was the network set up the same way?");
+        if (!component)
+            continue;
+        std::string fullPath = unpackString(buffer);
+        std::string className = unpackString(buffer);
+        if (fullPath != component->getFullPath() || className != component->getClassName())
+            throw cRuntimeError("Cannot restore checkpoint: component #%d is (%s)%s, expected (%s)%s",
+                    id, component->getClassName(), component->getFullPath().c_str(), className.c_str(), fullPath.c_str());
+        cContextSwitcher tmp(component);  // objects created during unpacking should belong to the component
+        component->checkpointUnpack(buffer);
+    }
+}
+
+void SimulationCheckpoint::unpackFutureEvents(cCommBuffer *buffer, cSimulation *simulation)
+{
+    // Take out the messages scheduled during initialization. Self-messages go
+    // back to their modules, so that they can be reused below; others (i.e.
+    // messages sent to other modules) are deleted.
+    cFutureEventSet *fes = simulation->getFES();
+    std::vector<cMessage *> scheduled;
+    for (int i = 0; i < fes->getLength(); i++) {
+        cEvent *event = fes->get(i);
+        if (event->isMessage())
+            scheduled.push_back(static_cast<cMessage *>(event));
+    }
+    for (cMessage *msg : scheduled) {
+        cModule *module = simulation->getModule(msg->getArrivalModuleId());
+        if (msg->isSelfMessage() && module) {
+            cContextSwitcher tmp(module);
+            fes->remove(msg);
+        }
+        else {
+            fes->remove(msg);
+            delete msg;
+        }
+    }
+
+    std::set<cMessage *> reused;
+    int n;
+    buffer->unpack(n);
+    for (int i = 0; i < n; i++) {
+        std::string className = unpackString(buffer);
+        std::string name = unpackString(buffer);
+        bool isSelfMessage;
+        int arrivalModuleId;
+        buffer->unpack(isSelfMessage);
+        buffer->unpack(arrivalModuleId);
+
+        // a self-message is restored into the module's idle message object
+        // of the same class and name if there is one, because the module may
+        // hold a pointer to it (typically a timer allocated in initialize())
+        cMessage *msg = nullptr;
+        cModule *module = simulation->getModule(arrivalModuleId);
+        if (isSelfMessage && module) {
+            for (int k = 0; k < module->defaultListSize(); k++) {
+                cMessage *candidate = dynamic_cast<cMessage *>(module->defaultListGet(k));
+                if (candidate && !candidate->isScheduled() && className == candidate->getClassName() &&
+                        name == candidate->getName() && reused.find(candidate) == reused.end()) {
+                    msg = candidate;
+                    break;
+                }
+            }
+        }
+        if (msg)
+            reused.insert(msg);
+        else
+            msg = check_and_cast<cMessage *>(createOne(className.c_str()));
+        msg->parsimUnpack(buffer);
+        fes->insert(msg);
+    }
+}
+
+#else
+
+void SimulationCheckpoint::write(const char *fileName, cSimulation *simulation, cRNG **rngs, int numRNGs)
+{
+    throw cRuntimeError("Cannot write checkpoint: Simulation kernel was compiled without parallel simulation support (WITH_PARSIM=no)");
+}
+
+void SimulationCheckpoint::restore(const char *fileName, cSimulation *simulation, cRNG **rngs, int numRNGs)
+{
+    throw cRuntimeError("Cannot restore checkpoint: Simulation kernel was compiled without parallel simulation support (WITH_PARSIM=no)");
+}
+
+#endif
+
+}  // namespace envir
+}  // namespace omnetpp
+
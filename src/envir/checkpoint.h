@@ -0,0 +1,73 @@
+//==========================================================================
+//  CHECKPOINT.H - part of
+//                     OMNeT++/OMNEST
+//             Discrete System Simulation in C++
+//
+//==========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#ifndef __OMNETPP_ENVIR_CHECKPOINT_H
+#define __OMNETPP_ENVIR_CHECKPOINT_H
+
+#include "omnetpp/simkerneldefs.h"
+#include "envirdefs.h"
+
+namespace omnetpp {
+
+class cSimulation;
+class cRNG;
+class cCommBuffer;
+
+namespace envir {
+
+/**
+ * Saves the state of a running simulation into a checkpoint file, and
+ * restores it in a later run of the same network.
+ *
+ * The checkpoint contains the simulation time and event number, the state
+ * of the RNGs and of the fingerprint calculator, the state of each module
+ * and channel (see cComponent::checkpointPack()), and the messages in the
+ * future event set. It does not contain the module tree itself: it is
+ * restored into a network that has been set up and initialized the same
+ * way as in the run that wrote it; the component IDs, full paths and
+ * classes are checked. Simple modules must be marked with the @checkpointable
+ * NED property, which declares that they save their state. Modules created
+ * dynamically, activity()-based modules, scheduled messages with a context
+ * pointer or control info, and the state of result recorders are not
+ * supported.
+ *
+ * The implementation is based on parsimPack()/parsimUnpack(), so it is
+ * only available if the simulation kernel was compiled with WITH_PARSIM.
+ */
+class ENVIR_API SimulationCheckpoint
+{
+  private:
+    static void packComponents(cCommBuffer *buffer, cSimulation *simulation);
+    static void unpackComponents(cCommBuffer *buffer, cSimulation *simulation);
+    static void packFutureEvents(cCommBuffer *buffer, cSimulation *simulation);
+    static void unpackFutureEvents(cCommBuffer *buffer, cSimulation *simulation);
+
+  public:
+    /**
+     * Writes the current state of the simulation into the given file.
+     * Should be called between events.
+     */
+    static void write(const char *fileName, cSimulation *simulation, cRNG **rngs, int numRNGs);
+
+    /**
+     * Restores the state of the simulation from the given file. The network
+     * should be already set up and initialized.
+     */
+    static void restore(const char *fileName, cSimulation *simulation, cRNG **rngs, int numRNGs);
+};
+
+}  // namespace envir
+}  // namespace omnetpp
+
+#endif
@@ -62,6 +62,7 @@
 #include "appreg.h"
 #include "valueiterator.h"
 #include "xmldoccache.h"
+#include "checkpoint.h"
 
 #ifdef __APPLE__
 // these are needed for debugger detection
@@ -141,6 +142,7 @@ Register_PerRunConfigOption(CFGID_OUTPUTVECTORMANAGER_CLASS, "outputvectormanage
 Register_PerRunConfigOption(CFGID_OUTPUTSCALARMANAGER_CLASS, "outputscalarmanager-class", CFG_STRING, DEFAULT_OUTPUTSCALARMANAGER_CLASS, "Part of the Envir plugin mechanism: selects the output scalar manager class to be used to record data passed to recordScalar(). The class has to implement the `cIOutputScalarManager` interface.");
 Register_PerRunConfigOption(CFGID_SNAPSHOTMANAGER_CLASS, "snapshotmanager-class", CFG_STRING, "omnetpp::envir::FileSnapshotManager", "Part of the Envir plugin mechanism: selects the class to handle streams to which snapshot() writes its output. The class has to implement the `cISnapshotManager` interface.");
 Register_PerRunConfigOption(CFGID_FUTUREEVENTSET_CLASS, "futureeventset-class", CFG_STRING, "omnetpp::cEventHeap", "Part of the Envir plugin mechanism: selects the class for storing the future events in the simulation. The class has to implement the `cFutureEventSet` interface.");
+Register_PerRunConfigOption(CFGID_MESSAGE_POOLING, "message-pooling", CFG_BOOL, "false", "Enables recycling the memory of deleted message and packet objects (including subclasses generated from msg files) for new message objects of the same size, which can speed up simulations that create and delete a large number of messages. Message IDs, ownership tracking and message counters are not affected. The pool hit rate is reported in the Cmdenv performance display (`cmdenv-performance-display=true`).");
 Register_GlobalConfigOption(CFGID_IMAGE_PATH, "image-path", CFG_PATH, "./images", "A semicolon-separated list of directories that contain module icons and other resources. This list will be concatenated with the contents of the `OMNETPP_IMAGE_PATH` environment variable or with a compile-time, hardcoded image path if the environment variable is empty.");
 Register_GlobalConfigOption(CFGID_FNAME_APPEND_HOST, "fname-append-host", CFG_BOOL, nullptr, "Turning it on will cause the host name and process Id to be appended to the names of output files (e.g. omnetpp.vec, omnetpp.sca). This is especially useful with distributed simulation. The default value is true if parallel simulation is enabled, false otherwise.");
 Register_PerRunConfigOption(CFGID_DEBUG_ON_ERRORS, "debug-on-errors", CFG_BOOL, "false", "When set to true, runtime errors will cause the simulation program to break into the C++ debugger (if the simulation is running under one, or just-in-time debugging is activated). Once in the debugger, you can view the stack trace or examine variables.");
@@ -160,6 +162,9 @@ Register_PerRunConfigOptionU(CFGID_SIM_TIME_LIMIT, "sim-time-limit", "s", nullpt
 Register_PerRunConfigOptionU(CFGID_CPU_TIME_LIMIT, "cpu-time-limit", "s", nullptr, "Stops the simulation when CPU usage has reached the given limit. The default is no limit. Note: To reduce per-event overhead, this time limit is only checked every N events (by default, N=1024).");
 Register_PerRunConfigOptionU(CFGID_REAL_TIME_LIMIT, "real-time-limit", "s", nullptr, "Stops the simulation after the specified amount of time has elapsed. The default is no limit. Note: To reduce per-event overhead, this time limit is only checked every N events (by default, N=1024).");
 Register_PerRunConfigOptionU(CFGID_WARMUP_PERIOD, "warmup-period", "s", nullptr, "Length of the initial warm-up period. When set, results belonging to the first x seconds of the simulation will not be recorded into output vectors, and will not be counted into output scalars (see option `**.result-recording-modes`). This option is useful for steady-state simulations. The default is 0s (no warmup period). Note that models that compute and record scalar results manually (via `recordScalar()`) will not automatically obey this setting.");
+Register_PerRunConfigOptionU(CFGID_CHECKPOINT_TIME, "checkpoint-time", "s", nullptr, "When set, the state of the simulation is saved into a checkpoint file (see `checkpoint-file`) when the given simulation time is reached, i.e. before the first event past that time is processed. Later runs can continue from the checkpoint instead of simulating the initial period again; see `restore-checkpoint`. Modules and channels with state need to redefine `checkpointPack()` and `checkpointUnpack()`, and simple modules must be marked with the `@checkpointable` NED property to declare that they do; writing the checkpoint fails if the network contains other simple modules. Scheduled messages that have a context pointer or control info attached cannot be saved. Dynamically created modules and `activity()`-based modules are not supported. Only supported by Cmdenv, and requires parallel simulation support (WITH_PARSIM) in the simulation kernel.");
+Register_PerRunConfigOption(CFGID_CHECKPOINT_FILE, "checkpoint-file", CFG_FILENAME, "${resultdir}/${configname}-${iterationvarsf}#${repetition}.chk", "Name of the checkpoint file written when `checkpoint-time` is set.");
+Register_PerRunConfigOption(CFGID_RESTORE_CHECKPOINT, "restore-checkpoint", CFG_FILENAME, nullptr, "Name of a checkpoint file (see `checkpoint-time`) to continue the simulation from. The network is set up and initialized as usual, then its state is replaced with the one saved in the file. The network and its configuration must be the same as in the run that wrote the checkpoint. Results recorded via `@statistic` are not part of the checkpoint; set `warmup-period` to at least the checkpoint time to obtain the same results as with an uninterrupted run.");
 Register_PerRunConfigOption(CFGID_FINGERPRINT, "fingerprint", CFG_STRING, nullptr, "The expected fingerprints of the simulation. If you need multiple fingerprints, separate them with commas. When provided, the fingerprints will be calculated from the specified properties of simulation events, messages, and statistics during execution, and checked against the provided values. Fingerprints are suitable for crude regression tests. As fingerprints occasionally differ across platforms, more than one value can be specified for a single fingerprint, separated by spaces, and a match with any of them will be accepted. To obtain a fingerprint, enter a dummy value (such as `0000`), and run the simulation.");
 Register_PerRunConfigOption(CFGID_FINGERPRINTER_CLASS, "fingerprintcalculator-class", CFG_STRING, "omnetpp::cSingleFingerprintCalculator", "Part of the Envir plugin mechanism: selects the fingerprint calculator class to be used to calculate the simulation fingerprint. The class has to implement the `cFingerprintCalculator` interface.");
 Register_PerRunConfigOption(CFGID_NUM_RNGS, "num-rngs", CFG_INT, "1", "The number of random number generators.");
@@ -189,6 +194,7 @@ Register_PerObjectConfigOption(CFGID_VECTOR_RECORDING, "vector-recording", KIND_
 Register_PerObjectConfigOption(CFGID_VECTOR_RECORD_EVENTNUMBERS, "vector-record-eventnumbers", KIND_VECTOR, CFG_BOOL, "true", "Whether to record event numbers for an output vector. (Values and timestamps are always recorded.) Event numbers are needed by the Sequence Chart Tool, for example.\nUsage: `<module-full-path>.<vector-name>.vector-record-eventnumbers=true/false`.\nExample: `**.ping.roundTripTime:vector.vector-record-eventnumbers=false`");
 Register_PerObjectConfigOption(CFGID_VECTOR_RECORDING_INTERVALS, "vector-recording-intervals", KIND_VECTOR, CFG_CUSTOM, nullptr, "Allows one to restrict recording of an output vector to one or more simulation time intervals. Usage: `<module-full-path>.<vector-name>.vector-recording-intervals=<intervals>`. The syntax for `<intervals>` is: `[<from>]..[<to>],...` That is, both start and end of an interval are optional, and intervals are separated by comma.\nExample: `**.roundTripTime:vector.vector-recording-intervals=..100, 200..400, 900..`");
 Register_PerRunConfigOptionU(CFGID_OUTPUTVECTOR_MEMORY_LIMIT, "output-vectors-memory-limit", "B", DEFAULT_OUTPUT_VECTOR_MEMORY_LIMIT, "Total memory that can be used for buffering output vectors. Larger values produce less fragmented vector files (i.e. cause vector data to be grouped into larger chunks), and therefore allow more efficient processing later. There is also a per-vector limit, see `**.vector-buffer`.");
+Register_PerRunConfigOption(CFGID_OUTPUT_ASYNC_WRITING, "output-async-writing", CFG_BOOL, "false", "Whether output vector and output scalar files should be written from background threads, so that formatting and writing the results overlaps with the simulation. The files are identical to those written synchronously. In this mode, half of `output-vectors-memory-limit` is used for collecting vector data, and the other half for vector data waiting to be written; when the latter is exhausted, the simulation waits for the writer thread. This option has no effect on SQLite recording.");
 Register_PerObjectConfigOptionU(CFGID_VECTOR_BUFFER, "vector-buffer", KIND_VECTOR, "B", DEFAULT_VECTOR_BUFFER, "For output vectors: the maximum per-vector buffer space used for storing values before writing them out as a block into the output vector file. There is also a total limit, see `output-vectors-memory-limit`.\nUsage: `<module-full-path>.<vector-name>.vector-buffer=<amount>`.");
 
 
@@ -654,6 +660,10 @@ void EnvirBase::printHelp()
     out << "                containing spaces etc need to be enclosed in quotes. Patterns\n";
     out << "                may contain elements matching numeric ranges, in the {a..b}\n";
     out << "                syntax. See also: -q.\n";
+    out << "  -j <numworkers>\n";
+    out << "                Cmdenv: execute the selected runs in the given number of parallel\n";
+    out << "                worker processes. Overrides the cmdenv-num-workers configuration\n";
+    out << "                option.\n";
     out << "  -n <nedpath>  List of folders to load NED files from. Folders are separated\n";
     out << "                with a semicolon (on non-Windows systems, colon may also be used).\n";
     out << "                Multiple -n options may be present. The effective NED path is\n";
@@ -813,6 +823,29 @@ void EnvirBase::prepareForRun()
         getSimulation()->setSimulationTimeLimit(opt->simtimeLimit);
     getSimulation()->callInitialize();
     cLogProxy::flushLastLine();
+    if (!opt->restoreCheckpointFile.empty())
+        SimulationCheckpoint::restore(opt->restoreCheckpointFile.c_str(), getSimulation(), rngs, numRNGs);
+    checkpointPending = opt->checkpointTime >= getSimulation()->getSimTime();
+}
+
+void EnvirBase::writeCheckpointIfDue()
+{
+    // the checkpoint is written before the first event past the checkpoint time
+    simtime_t nextEventTime = getSimulation()->guessNextSimtime();
+    if (nextEventTime > opt->checkpointTime) {
+        checkpointPending = false;
+        mkPath(directoryOf(opt->checkpointFile.c_str()).c_str());
+        SimulationCheckpoint::write(opt->checkpointFile.c_str(), getSimulation(), rngs, numRNGs);
+        if (opt->verbose)
+            out << "Checkpoint written to '" << opt->checkpointFile << "' at t=" << getSimulation()->getSimTime() << endl;
+    }
+}
+
+void EnvirBase::reseedRNGs()
+{
+    opt->seedset = getConfig()->getAsInt(CFGID_SEED_SET);
+    for (int i = 0; i < numRNGs; i++)
+        rngs[i]->initialize(opt->seedset, i, numRNGs, getParsimProcId(), getParsimNumPartitions(), getConfig());
 }
 
 //-------------------------------------------------------------
@@ -1380,6 +1413,9 @@ void EnvirBase::readPerRunOptions()
     opt->realTimeLimit = cfg->getAsDouble(CFGID_REAL_TIME_LIMIT, -1);
     opt->cpuTimeLimit = cfg->getAsDouble(CFGID_CPU_TIME_LIMIT, -1);
     opt->warmupPeriod = cfg->getAsDouble(CFGID_WARMUP_PERIOD);
+    opt->checkpointTime = cfg->getAsDouble(CFGID_CHECKPOINT_TIME, -1);
+    opt->checkpointFile = cfg->getAsFilename(CFGID_CHECKPOINT_FILE);
+    opt->restoreCheckpointFile = cfg->getAsFilename(CFGID_RESTORE_CHECKPOINT);
     opt->numRNGs = cfg->getAsInt(CFGID_NUM_RNGS);
     opt->rngClass = cfg->getAsString(CFGID_RNG_CLASS);
     opt->seedset = cfg->getAsInt(CFGID_SEED_SET);
@@ -1387,6 +1423,7 @@ void EnvirBase::readPerRunOptions()
     opt->checkSignals = cfg->getAsBool(CFGID_CHECK_SIGNALS);
     opt->schedulerClass = cfg->getAsString(CFGID_SCHEDULER_CLASS);
     opt->futureeventsetClass = cfg->getAsString(CFGID_FUTUREEVENTSET_CLASS);
+    opt->messagePooling = cfg->getAsBool(CFGID_MESSAGE_POOLING);
     opt->eventlogManagerClass = cfg->getAsString(CFGID_EVENTLOGMANAGER_CLASS);
     opt->outputVectorManagerClass = cfg->getAsString(CFGID_OUTPUTVECTORMANAGER_CLASS);
     opt->outputScalarManagerClass = cfg->getAsString(CFGID_OUTPUTSCALARMANAGER_CLASS);
@@ -1422,6 +1459,9 @@ void EnvirBase::readPerRunOptions()
     cFutureEventSet *fes = createByClassName<cFutureEventSet>(opt->futureeventsetClass.c_str(), "FES");
     getSimulation()->setFES(fes);
 
+    // configure message pooling
+    cMessage::setPoolingEnabled(opt->messagePooling);
+
     // install scheduler
     if (!opt->parsim) {
         cScheduler *scheduler = createByClassName<cScheduler>(opt->schedulerClass.c_str(), "event scheduler");
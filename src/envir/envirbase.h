@@ -74,7 +74,7 @@ enum class DebuggerPresence {
     CANT_DETECT
 };
 
-#define ARGSPEC "h?f:u:l:c:r:n:x:i:p:q:e:avwsm"
+#define ARGSPEC "h?f:u:l:c:r:j:n:x:i:p:q:e:avwsm"
 
 struct ENVIR_API EnvirOptions
 {
@@ -108,6 +108,7 @@ struct ENVIR_API EnvirOptions
     bool debugStatisticsRecording;
     bool checkSignals;
     bool fnameAppendHost;
+    bool messagePooling;
 
     bool useStderr;
     bool verbose;
@@ -117,6 +118,10 @@ struct ENVIR_API EnvirOptions
     simtime_t simtimeLimit;
     simtime_t warmupPeriod;
 
+    simtime_t checkpointTime; // negative if no checkpoint is to be written
+    std::string checkpointFile;
+    std::string restoreCheckpointFile;
+
     double realTimeLimit;
     double cpuTimeLimit;
 };
@@ -175,6 +180,9 @@ class ENVIR_API EnvirBase : public cRunnableEnvir
 
     simtime_t simulatedTime;  // sim. time after finishing simulation
 
+    // whether a checkpoint is yet to be written in the current run (see writeCheckpointIfDue())
+    bool checkpointPending = false;
+
   public:
 
     bool attachDebuggerOnErrors = false;
@@ -311,6 +319,13 @@ class ENVIR_API EnvirBase : public cRunnableEnvir
     virtual void setupNetwork(cModuleType *network);
     virtual void prepareForRun();
 
+    // to be called by the event loop before each event if checkpointPending is set
+    virtual void writeCheckpointIfDue();
+
+    // re-reads seed-set from the active configuration and reinitializes the RNGs
+    // with it; used when a run is continued in a forked process with other seeds
+    virtual void reseedRNGs();
+
     ArgList *argList()  {return args;}
     void printHelp();
     void setupEventLog();
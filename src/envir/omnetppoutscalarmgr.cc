@@ -45,6 +45,7 @@ typedef std::map<std::string, std::string> StringMap;
 extern omnetpp::cConfigOption *CFGID_OUTPUT_SCALAR_FILE;
 extern omnetpp::cConfigOption *CFGID_OUTPUT_SCALAR_PRECISION;
 extern omnetpp::cConfigOption *CFGID_OUTPUT_SCALAR_FILE_APPEND;
+extern omnetpp::cConfigOption *CFGID_OUTPUT_ASYNC_WRITING;
 
 // per-scalar options
 extern omnetpp::cConfigOption *CFGID_SCALAR_RECORDING;
@@ -55,8 +56,11 @@ Register_Class(OmnetppOutputScalarManager);
 
 void OmnetppOutputScalarManager::startRun()
 {
-    // prevent reuse of object for multiple runs
-    Assert(state == NEW);
+    // prevent reuse of object for multiple runs; restarting is allowed until the
+    // file is opened, i.e. in a run continued in a forked process (cmdenv-fork-time)
+    if (state == OPENED)
+        throw cRuntimeError("Cannot restart result recording, results have already been written to '%s' (hint: set warmup-period)", fname.c_str());
+    Assert(state == NEW || state == STARTED);
     state = STARTED;
 
     // delete file left over from previous runs
@@ -70,6 +74,9 @@ void OmnetppOutputScalarManager::startRun()
     // read configuration
     int prec = getEnvir()->getConfig()->getAsInt(CFGID_OUTPUT_SCALAR_PRECISION);
     writer.setPrecision(prec);
+
+    bool async = getEnvir()->getConfig()->getAsBool(CFGID_OUTPUT_ASYNC_WRITING);
+    writer.setAsync(async);
 }
 
 void OmnetppOutputScalarManager::endRun()
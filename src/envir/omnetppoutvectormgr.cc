@@ -44,6 +44,7 @@ extern omnetpp::cConfigOption *CFGID_OUTPUT_VECTOR_FILE_APPEND;
 extern omnetpp::cConfigOption *CFGID_OUTPUT_VECTOR_FILE;
 extern omnetpp::cConfigOption *CFGID_OUTPUTVECTOR_MEMORY_LIMIT;
 extern omnetpp::cConfigOption *CFGID_OUTPUT_VECTOR_PRECISION;
+extern omnetpp::cConfigOption *CFGID_OUTPUT_ASYNC_WRITING;
 
 // per-vector options
 extern omnetpp::cConfigOption *CFGID_VECTOR_RECORDING;
@@ -53,8 +54,11 @@ extern omnetpp::cConfigOption *CFGID_VECTOR_RECORD_EVENTNUMBERS;
 
 void OmnetppOutputVectorManager::startRun()
 {
-    // prevent reuse of object for multiple runs
-    Assert(state == NEW);
+    // prevent reuse of object for multiple runs; restarting is allowed until the
+    // file is opened, i.e. in a run continued in a forked process (cmdenv-fork-time)
+    if (state == OPENED)
+        throw cRuntimeError("Cannot restart result recording, results have already been written to '%s' (hint: set warmup-period)", fname.c_str());
+    Assert(state == NEW || state == STARTED);
     state = STARTED;
 
     // read configuration
@@ -71,6 +75,9 @@ void OmnetppOutputVectorManager::startRun()
 
     size_t memoryLimit = (size_t) getEnvir()->getConfig()->getAsDouble(CFGID_OUTPUTVECTOR_MEMORY_LIMIT);
     writer.setOverallMemoryLimit(memoryLimit);
+
+    bool async = getEnvir()->getConfig()->getAsBool(CFGID_OUTPUT_ASYNC_WRITING);
+    writer.setAsync(async);
 }
 
 void OmnetppOutputVectorManager::endRun()
@@ -100,6 +100,15 @@ SectionBasedConfiguration::MatchableEntry::~MatchableEntry()
     delete fullPathPattern;
 }
 
+SectionBasedConfiguration::SegmentTrieNode::~SegmentTrieNode()
+{
+    for (auto& child : literalChildren)
+        delete child.second;
+    for (auto& child : indexWildcardChildren)
+        delete child.second;
+    delete anySegmentChild;
+}
+
 //----
 
 SectionBasedConfiguration::SectionBasedConfiguration()
@@ -163,7 +172,7 @@ void SectionBasedConfiguration::clear()
     entries.clear();
     config.clear();
     suffixBins.clear();
-    wildcardSuffixBin.entries.clear();
+    wildcardSuffixBin.clear();
     variables.clear();
 }
 
@@ -313,7 +322,7 @@ void SectionBasedConfiguration::activateGlobalConfig()
             addEntry(Entry(basedirRef, e.getKey(), value.c_str()));
         }
     }
-
+    buildSuffixBinIndices();
 }
 
 void SectionBasedConfiguration::activateConfig(const char *configName, int runNumber)
@@ -365,6 +374,7 @@ void SectionBasedConfiguration::activateConfig(const char *configName, int runNu
             addEntry(Entry(basedirRef, e.getKey(), value.c_str()));
         }
     }
+    buildSuffixBinIndices();
 }
 
 inline std::string unquote(const std::string& txt)
@@ -942,6 +952,156 @@ void SectionBasedConfiguration::addEntry(const Entry& entry)
     }
 }
 
+void SectionBasedConfiguration::buildSuffixBinIndices()
+{
+    for (auto& suffixBin : suffixBins)
+        suffixBin.second.buildIndex();
+    wildcardSuffixBin.buildIndex();
+}
+
+void SectionBasedConfiguration::SuffixBin::buildIndex()
+{
+    // small bins are searched linearly
+    const size_t MIN_ENTRIES_TO_INDEX = 16;
+    delete index;
+    index = nullptr;
+    if (entries.size() < MIN_ENTRIES_TO_INDEX)
+        return;
+
+    index = new SegmentTrieNode();
+    for (int i = 0; i < (int)entries.size(); i++) {
+        const MatchableEntry& entry = entries[i];
+        SegmentTrieNode *node = index;
+        std::string ownerName, suffix;
+        splitKey(entry.key.c_str(), ownerName, suffix);
+        const char *pattern = ownerName.c_str();
+        if (!entry.fullPathPattern && !strchr(pattern, '\\')) {  // escapes would complicate things, and are rare
+            // walk down the trie with the trailing indexable segments of the owner pattern
+            int end = ownerName.size();
+            while (end > 0) {
+                int start;
+                std::string key;
+                SegmentKind kind = getIndexableSegment(pattern, end, start, key);
+                if (kind == UNINDEXABLE_SEGMENT)
+                    break;
+                SegmentTrieNode *&child = kind == LITERAL_SEGMENT ? node->literalChildren[key] : kind == WILDCARD_INDEX_SEGMENT ? node->indexWildcardChildren[key] : node->anySegmentChild;
+                if (!child)
+                    child = new SegmentTrieNode();
+                node = child;
+                end = start - 1;  // skip the dot
+            }
+        }
+        node->entries.push_back(i);
+    }
+}
+
+static bool isLiteralSegmentChar(char c)
+{
+    return c != '.' && !strchr("?*{}[]\\", c);
+}
+
+SectionBasedConfiguration::SegmentKind SectionBasedConfiguration::getIndexableSegment(const char *pattern, int end, int& outStart, std::string& outKey)
+{
+    // Examines the last segment of pattern[0..end): a literal ("app", "host[5]"), a name
+    // with a wildcard or numeric range index ("host[*]", "host[2..]"), "*", or anything
+    // else (e.g. "**", "h*"), which cannot be indexed. The segment must be preceded by
+    // a dot or begin the pattern.
+    if (pattern[end-1] == '*' && (end == 1 || pattern[end-2] == '.')) {
+        outStart = end - 1;
+        return ANY_SEGMENT;
+    }
+
+    int nameEnd = end;
+    std::string indexPart;
+    if (pattern[end-1] == ']') {
+        int q = end - 2;
+        while (q >= 0 && pattern[q] != '[' && pattern[q] != ']')
+            q--;
+        if (q < 0 || pattern[q] != '[')
+            return UNINDEXABLE_SEGMENT;
+        indexPart.assign(pattern + q + 1, end - q - 2);
+        nameEnd = q;
+    }
+    int nameStart = nameEnd;
+    while (nameStart > 0 && isLiteralSegmentChar(pattern[nameStart-1]))
+        nameStart--;
+    if (nameStart > 0 && pattern[nameStart-1] != '.')
+        return UNINDEXABLE_SEGMENT;
+    outStart = nameStart;
+
+    if (nameStart == nameEnd)
+        return UNINDEXABLE_SEGMENT;
+    outKey.assign(pattern + nameStart, nameEnd - nameStart);
+    if (nameEnd == end)
+        return LITERAL_SEGMENT;  // plain name
+
+    // the index: digits make a literal; "*", "?" and numeric ranges "[n..m]" match
+    // any (or some) index but no dot, so only the name can be used as key
+    if (indexPart.empty())
+        return UNINDEXABLE_SEGMENT;
+    bool digitsOnly = indexPart.find_first_not_of("0123456789") == std::string::npos;
+    if (digitsOnly) {
+        outKey.append("[").append(indexPart).append("]");
+        return LITERAL_SEGMENT;
+    }
+    size_t dots = indexPart.find("..");
+    bool isNumRange = dots != std::string::npos && indexPart.find_first_not_of("0123456789") == dots && indexPart.find_first_not_of("0123456789", dots+2) == std::string::npos;
+    bool isWildcard = indexPart.find_first_not_of("0123456789*?") == std::string::npos && indexPart.find("**") == std::string::npos;
+    return isNumRange || isWildcard ? WILDCARD_INDEX_SEGMENT : UNINDEXABLE_SEGMENT;
+}
+
+void SectionBasedConfiguration::collectIndexedEntries(const SegmentTrieNode *node, const char *path, int end, std::vector<int>& outEntries)
+{
+    // path[0..end) is the part of the path not yet consumed; end == -1 means none left
+    outEntries.insert(outEntries.end(), node->entries.begin(), node->entries.end());
+    if (end <= 0)
+        return;
+    int start = end;
+    while (start > 0 && path[start-1] != '.')
+        start--;
+    std::string segment(path + start, end - start);
+    int next = start == 0 ? -1 : start - 1;
+
+    if (!node->literalChildren.empty()) {
+        auto it = node->literalChildren.find(segment);
+        if (it != node->literalChildren.end())
+            collectIndexedEntries(it->second, path, next, outEntries);
+    }
+    if (!node->indexWildcardChildren.empty()) {
+        size_t bracket = segment.find('[');
+        if (bracket != std::string::npos) {
+            auto it = node->indexWildcardChildren.find(segment.substr(0, bracket));
+            if (it != node->indexWildcardChildren.end())
+                collectIndexedEntries(it->second, path, next, outEntries);
+        }
+    }
+    if (node->anySegmentChild)
+        collectIndexedEntries(node->anySegmentChild, path, next, outEntries);
+}
+
+const SectionBasedConfiguration::MatchableEntry *SectionBasedConfiguration::SuffixBin::findMatch(const char *ownerFullPath, const char *suffix, bool acceptDefault) const
+{
+    if (!index) {
+        for (const auto & entry : entries)
+            if (entryMatches(entry, ownerFullPath, suffix))
+                if (acceptDefault || entry.value != "default")
+                    return &entry;
+        return nullptr;
+    }
+
+    // only match the entries the index offers, in their original order
+    std::vector<int> candidates;
+    collectIndexedEntries(index, ownerFullPath, strlen(ownerFullPath), candidates);
+    std::sort(candidates.begin(), candidates.end());
+    for (int i : candidates) {
+        const MatchableEntry& entry = entries[i];
+        if (entryMatches(entry, ownerFullPath, suffix))
+            if (acceptDefault || entry.value != "default")
+                return &entry;
+    }
+    return nullptr;
+}
+
 void SectionBasedConfiguration::splitKey(const char *key, std::string& outOwnerName, std::string& outBinName)
 {
     std::string tmp = key;
@@ -1256,11 +1416,9 @@ const cConfiguration::KeyValue& SectionBasedConfiguration::getParameterEntry(con
     const SuffixBin *bin = it == suffixBins.end() ? &wildcardSuffixBin : &it->second;
 
     // find first match in the bin
-    for (const auto & entry : bin->entries) {
-        if (entryMatches(entry, moduleFullPath, paramName))
-            if (hasDefaultValue || entry.value != "default")
-                return entry;
-    }
+    const MatchableEntry *entry = bin->findMatch(moduleFullPath, paramName, hasDefaultValue);
+    if (entry)
+        return *entry;
     return nullEntry;  // not found
 }
 
@@ -1340,10 +1498,9 @@ const cConfiguration::KeyValue& SectionBasedConfiguration::getPerObjectConfigEnt
     const SuffixBin *suffixBin = &it->second;
 
     // find first match in the bin
-    for (const auto & entry : suffixBin->entries) {
-        if (entryMatches(entry, objectFullPath, keySuffix))
-            return entry;  // found value
-    }
+    const MatchableEntry *entry = suffixBin->findMatch(objectFullPath, keySuffix, true);
+    if (entry)
+        return *entry;  // found value
     return nullEntry;  // not found
 }
 
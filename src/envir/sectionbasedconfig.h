@@ -119,8 +119,39 @@ class ENVIR_API SectionBasedConfiguration : public cConfigurationEx
     //   **.tcp.eedVector.record-interval ==> goes into the "record-interval" bin; ownerPattern="**.tcp.eedVector"
     //   **.tcp.eedVector.record-*"       ==> goes into the wildcard bin; ownerPattern="**.tcp.eedVector", suffixPattern="record-*"
     //
+    //
+    // Large bins (e.g. thousands of "**.host[5].app[*].destAddr"-style keys) are also
+    // indexed, so that a lookup need not match the path against every entry. The index
+    // is a trie over the trailing segments of the owner patterns, last segment first:
+    // for "**.host[5].app[*]", the path in the trie is "app[*]", then "host[5]", and the
+    // entry is stored at that node. (Traversal stops at the first segment that cannot
+    // be indexed, "**" here). A lookup walks the trie with the segments of the module path,
+    // collects the entries from the nodes on the way, and matches them in their original
+    // order against the path as usual, so the precedence of entries is unchanged. Index
+    // edges are: a literal segment ("app", "host[5]"), a name with a wildcard index
+    // ("host[*]", "host[0..3]", keyed by "host"), and "*".
+    //
+    enum SegmentKind {UNINDEXABLE_SEGMENT, LITERAL_SEGMENT, WILDCARD_INDEX_SEGMENT, ANY_SEGMENT};
+    struct SegmentTrieNode {
+        std::vector<int> entries;  // indices into SuffixBin::entries, ascending
+        std::map<std::string,SegmentTrieNode*> literalChildren;
+        std::map<std::string,SegmentTrieNode*> indexWildcardChildren;
+        SegmentTrieNode *anySegmentChild = nullptr;
+        SegmentTrieNode() {}
+        SegmentTrieNode(const SegmentTrieNode&) = delete;
+        ~SegmentTrieNode();
+    };
+
     struct SuffixBin {
         std::vector<MatchableEntry> entries;
+        SegmentTrieNode *index = nullptr; // only for large bins; see buildIndex()
+        SuffixBin() {}
+        SuffixBin(const SuffixBin& other) : entries(other.entries) {}  // index is not copied
+        SuffixBin& operator=(const SuffixBin&) = delete;
+        ~SuffixBin() {delete index;}
+        void clear() {entries.clear(); delete index; index = nullptr;}
+        void buildIndex();
+        const MatchableEntry *findMatch(const char *ownerFullPath, const char *suffix, bool acceptDefault) const;
     };
 
   private:
@@ -169,7 +200,10 @@ class ENVIR_API SectionBasedConfiguration : public cConfigurationEx
     std::vector<int> getBaseConfigIds(int sectionId) const;
     void addEntry(const Entry& entry);
     static void splitKey(const char *key, std::string& outOwnerName, std::string& outBinName);
+    void buildSuffixBinIndices();
     static bool entryMatches(const MatchableEntry& entry, const char *moduleFullPath, const char *paramName);
+    static SegmentKind getIndexableSegment(const char *pattern, int end, int& outStart, std::string& outKey);
+    static void collectIndexedEntries(const SegmentTrieNode *node, const char *path, int end, std::vector<int>& outEntries);
     std::vector<Scenario::IterationVariable> collectIterationVariables(const std::vector<int>& sectionChain, StringMap& outLocationToNameMap) const;
     static void parseVariable(const char *pos, std::string& outVarname, std::string& outValue, std::string& outParVar, const char *&outEndPos);
     std::string substituteVariables(const char *text, int sectionId, int entryId, const StringMap& variables, const StringMap& locationToVarName) const;
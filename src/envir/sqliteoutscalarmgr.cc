@@ -55,8 +55,11 @@ Register_Class(SqliteOutputScalarManager);
 
 void SqliteOutputScalarManager::startRun()
 {
-    // prevent reuse of object for multiple runs
-    Assert(state == NEW);
+    // prevent reuse of object for multiple runs; restarting is allowed until the
+    // file is opened, i.e. in a run continued in a forked process (cmdenv-fork-time)
+    if (state == OPENED)
+        throw cRuntimeError("Cannot restart result recording, results have already been written to '%s' (hint: set warmup-period)", fname.c_str());
+    Assert(state == NEW || state == STARTED);
     state = STARTED;
 
     // clean up file from previous runs
@@ -51,11 +51,18 @@ extern omnetpp::cConfigOption *CFGID_VECTOR_RECORDING_INTERVALS;
 extern omnetpp::cConfigOption *CFGID_VECTOR_BUFFER;
 
 Register_GlobalConfigOption(CFGID_OUTPUT_VECTOR_DB_INDEXING, "output-vector-db-indexing", CFG_CUSTOM, "skip", "Whether and when to add an index to the 'vectordata' table in SQLite output vector files. Possible values: skip, ahead, after");
+Register_GlobalConfigOption(CFGID_OUTPUT_VECTOR_DB_PACKED, "output-vector-db-packed", CFG_BOOL, "false", "Used with SqliteOutputVectorManager: store each block of vector data as a single compressed row of the 'vectorDataBlock' table, instead of one row per sample in the 'vectorData' table. This makes recording several times faster and the file much smaller, but the data can then only be read with OMNeT++ tools (e.g. `opp_scavetool`), not with plain SQL queries.");
+Register_GlobalConfigOption(CFGID_OUTPUT_VECTOR_DB_WAL, "output-vector-db-wal", CFG_BOOL, "false", "Used with SqliteOutputVectorManager: use write-ahead logging (WAL) while recording, which makes committing the data cheaper. The journal mode is switched back to DELETE when the file is closed.");
+Register_GlobalConfigOptionU(CFGID_OUTPUT_VECTOR_DB_PAGE_SIZE, "output-vector-db-page-size", "B", nullptr, "Used with SqliteOutputVectorManager: the page size of newly created SQLite output vector files, a power of two between 512B and 64KiB. By default, the SQLite default (usually 4KiB) is used.");
+Register_GlobalConfigOptionU(CFGID_OUTPUT_VECTOR_DB_CACHE_SIZE, "output-vector-db-cache-size", "B", nullptr, "Used with SqliteOutputVectorManager: the amount of memory SQLite may use for caching database pages while recording. By default, 100000 pages are cached.");
 
 void SqliteOutputVectorManager::startRun()
 {
-    // prevent reuse of object for multiple runs
-    Assert(state == NEW);
+    // prevent reuse of object for multiple runs; restarting is allowed until the
+    // file is opened, i.e. in a run continued in a forked process (cmdenv-fork-time)
+    if (state == OPENED)
+        throw cRuntimeError("Cannot restart result recording, results have already been written to '%s' (hint: set warmup-period)", fname.c_str());
+    Assert(state == NEW || state == STARTED);
     state = STARTED;
 
     // delete file left over from previous runs
@@ -69,6 +76,11 @@ void SqliteOutputVectorManager::startRun()
     size_t memoryLimit = (size_t) getEnvir()->getConfig()->getAsDouble(CFGID_OUTPUTVECTOR_MEMORY_LIMIT);
     writer.setOverallMemoryLimit(memoryLimit);
 
+    writer.setPacked(getEnvir()->getConfig()->getAsBool(CFGID_OUTPUT_VECTOR_DB_PACKED));
+    writer.setWalJournal(getEnvir()->getConfig()->getAsBool(CFGID_OUTPUT_VECTOR_DB_WAL));
+    writer.setPageSize((int) getEnvir()->getConfig()->getAsDouble(CFGID_OUTPUT_VECTOR_DB_PAGE_SIZE, 0));
+    writer.setCacheSize((int64_t) getEnvir()->getConfig()->getAsDouble(CFGID_OUTPUT_VECTOR_DB_CACHE_SIZE, 0));
+
     std::string indexModeStr = getEnvir()->getConfig()->getAsCustom(CFGID_OUTPUT_VECTOR_DB_INDEXING);
     if (indexModeStr == "skip")
         indexingMode = INDEX_NONE;
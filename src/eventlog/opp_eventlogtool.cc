@@ -203,6 +203,7 @@ void offsets(Options options)
         fprintf(stdout, "# Printing event offsets from log file %s\n", options.inputFileName);
 
     FileReader *fileReader = new FileReader(options.inputFileName);
+    fileReader->setMemoryMapped(true, false);
     EventLogIndex eventLogIndex(fileReader);
 
     long begin = clock();
@@ -235,6 +236,7 @@ void events(Options options)
         fprintf(stdout, "# Printing events from log file %s\n", options.inputFileName);
 
     FileReader *fileReader = new FileReader(options.inputFileName);
+    fileReader->setMemoryMapped(true, false);
     EventLog eventLog(fileReader);
 
     long begin = clock();
@@ -262,6 +264,7 @@ void ranges(Options options)
         fprintf(stdout, "# Printing continuous ranges from log file %s\n", options.inputFileName);
 
     FileReader *fileReader = new FileReader(options.inputFileName);
+    fileReader->setMemoryMapped(true);
     EventLog eventLog(fileReader);
 
     long begin = clock();
@@ -292,6 +295,7 @@ void echo(Options options)
         fprintf(stdout, "# Echoing events from log file %s from event number #%" EVENTNUMBER_PRINTF_FORMAT " to event number #%" EVENTNUMBER_PRINTF_FORMAT "\n", options.inputFileName, options.getFirstEventNumber(), options.getLastEventNumber());
 
     FileReader *fileReader = new FileReader(options.inputFileName);
+    fileReader->setMemoryMapped(true);
     IEventLog *eventLog = options.createEventLog(fileReader);
 
     long begin = clock();
@@ -310,6 +314,7 @@ void cat(Options options)
         fprintf(stdout, "# Cating from file %s\n", options.inputFileName);
 
     FileReader *fileReader = new FileReader(options.inputFileName);
+    fileReader->setMemoryMapped(true);
 
     long begin = clock();
     char *line;
@@ -330,6 +335,7 @@ void filter(Options options)
                 options.inputFileName, tracedEventNumber, options.getFirstEventNumber(), options.getLastEventNumber());
 
     FileReader *fileReader = new FileReader(options.inputFileName);
+    fileReader->setMemoryMapped(true);
     IEventLog *eventLog = options.createEventLog(fileReader);
 
     long begin = clock();
@@ -328,6 +328,11 @@ void MsgAnalyzer::analyzeClassOrStruct(ClassInfo& classInfo, const std::string&
 
     classInfo.baseClass = classInfo.extendsQName;
 
+    // copyOnWrite
+    classInfo.copyOnWrite = getPropertyAsBool(classInfo.props, PROP_COPYONWRITE, false);
+    if (classInfo.copyOnWrite && !classInfo.isClass)
+        errors->addError(classInfo.astNode, "'%s': @copyOnWrite is only supported for classes", classInfo.name.c_str());
+
     // omitGetVerb / fieldNameSuffix
     classInfo.omitGetVerb = getPropertyAsBool(classInfo.props, PROP_OMITGETVERB, false);
     classInfo.fieldNameSuffix = getProperty(classInfo.props, PROP_FIELDNAMESUFFIX, "");
@@ -566,6 +571,11 @@ void MsgAnalyzer::analyzeField(ClassInfo& classInfo, FieldInfo *field, const std
         errors->addError(field->astNode, "Field '%s' is editable, but @fromString is unspecified", field->name.c_str());
 
     field->isCustom = getPropertyAsBool(field->props, PROP_CUSTOM, false);
+
+    // with @copyOnWrite, data members are kept in a block shared among copies of the object
+    field->isShared = classInfo.copyOnWrite && !field->isAbstract && !field->isCustom;
+    if (field->isShared && (field->isOwnedPointer || (field->iscOwnedObject && !field->isPointer)))
+        errors->addError(field->astNode, "field '%s': owned objects are not supported in @copyOnWrite class '%s'", field->name.c_str(), classInfo.name.c_str());
 }
 
 MsgAnalyzer::FieldInfo *MsgAnalyzer::findField(ClassInfo& classInfo, const std::string& name)
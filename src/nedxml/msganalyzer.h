@@ -134,6 +134,7 @@ class NEDXML_API MsgAnalyzer
     static constexpr const char* PROP_ALLOWREPLACE = "allowReplace";
     static constexpr const char* PROP_STR = "str";
     static constexpr const char* PROP_CUSTOMIZE = "customize";
+    static constexpr const char* PROP_COPYONWRITE = "copyOnWrite";
     static constexpr const char* PROP_OVERWRITEPREVIOUSDEFINITION = "overwritePreviousDefinition";
     static constexpr const char* PROP_CUSTOM = "custom";
 };
@@ -418,20 +418,39 @@ void MsgCodeGenerator::generateClassDecl(const ClassInfo& classInfo, const std::
 
     H << "\n{\n";
     H << "  protected:\n";
+    std::string indent = "    ";
+    if (classInfo.copyOnWrite) {
+        H << "    // data members, shared among copies of the object until one of them is modified\n";
+        H << "    struct SharedFields {\n";
+        H << "        int refCount = 1;\n";
+        indent = "        ";
+    }
     for (const FieldInfo& field : classInfo.fieldList) {
         if (field.isAbstract || field.isCustom)
             continue;
         if (field.isFixedArray) {
-            H << "    " << field.dataType << " " << field.var << "[" << field.arraySize << "]" << (field.value == "0" ? " = {0}" : "") << ";\n"; // note: C++ has no syntax for filling a full array with a (nonzero) value in an expression
+            H << indent << field.dataType << " " << field.var << "[" << field.arraySize << "]" << (field.value == "0" ? " = {0}" : "") << ";\n"; // note: C++ has no syntax for filling a full array with a (nonzero) value in an expression
         }
         else if (field.isDynamicArray) {
-            H << "    " << field.dataType << " *" << field.var << " = nullptr;\n";
-            H << "    " << field.sizeType << " " << field.sizeVar << " = 0;\n";
+            H << indent << field.dataType << " *" << field.var << " = nullptr;\n";
+            H << indent << field.sizeType << " " << field.sizeVar << " = 0;\n";
         }
         else {
-            H << "    " << field.dataType << " " << field.var << (field.value.empty() ? "" : str(" = ") + field.value) << ";\n";
+            H << indent << field.dataType << " " << field.var << (field.value.empty() ? "" : str(" = ") + field.value) << ";\n";
         }
     }
+    if (classInfo.copyOnWrite) {
+        H << "\n";
+        H << "        SharedFields() {}\n";
+        H << "        SharedFields(const SharedFields& other);\n";
+        H << "        ~SharedFields();\n";
+        H << "        SharedFields& operator=(const SharedFields&) = delete;\n";
+        H << "    };\n";
+        H << "    SharedFields *sharedFields = nullptr;\n";
+        H << "\n";
+        H << "    // makes the data members private to this object; to be called before modifying them\n";
+        H << "    void unshareFields();\n";
+    }
     H << "\n";
     H << "  private:\n";
     H << "    void copy(const " << classInfo.className << "& other);\n\n";
@@ -475,6 +494,8 @@ void MsgCodeGenerator::generateClassDecl(const ClassInfo& classInfo, const std::
     }
     std::string maybe_override = classInfo.iscObject ? " override" : "";
     std::string maybe_handleChange = classInfo.beforeChange.empty() ? "" : (classInfo.beforeChange + ";");
+    if (classInfo.copyOnWrite)
+        maybe_handleChange += "unshareFields();";
     if (!classInfo.str.empty())
         H << "    virtual std::string str() const" << maybe_override << ";\n";
     H << "    virtual void parsimPack(omnetpp::cCommBuffer *b) const" << maybe_override << ";\n";
@@ -531,22 +552,30 @@ void MsgCodeGenerator::generateClassDecl(const ClassInfo& classInfo, const std::
 
 inline std::string var(const MsgTypeTable::FieldInfo& field)
 {
-    return str("this->") + field.var;
+    return str(field.isShared ? "this->sharedFields->" : "this->") + field.var;
 }
 
 inline std::string varElem(const MsgTypeTable::FieldInfo& field)
 {
-    return str("this->") + field.var + (field.isArray ? "[i]" : "");
+    return var(field) + (field.isArray ? "[i]" : "");
+}
+
+inline std::string sizeVar(const MsgTypeTable::FieldInfo& field)
+{
+    // note: for fixed-size arrays, sizeVar is the array size (a constant)
+    return (field.isDynamicArray && field.isShared) ? str("this->sharedFields->") + field.sizeVar : field.sizeVar;
 }
 
 inline std::string forEachIndex(const MsgTypeTable::FieldInfo& field)
 {
-    return str("    for (") + field.sizeType + " i = 0; i < " + field.sizeVar + "; i++)";
+    return str("    for (") + field.sizeType + " i = 0; i < " + sizeVar(field) + "; i++)";
 }
 
 void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
 {
     std::string maybe_handleChange_line = classInfo.beforeChange.empty() ? "" : (str("    ") + classInfo.beforeChange + ";\n");
+    if (classInfo.copyOnWrite)
+        maybe_handleChange_line += "    unshareFields();\n";
 
     if (!classInfo.customize && classInfo.iscObject)
         CC << "Register_Class(" << classInfo.className << ")\n\n";
@@ -560,6 +589,8 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
         CC << " : ::" << classInfo.baseClass << baseArgs;
     CC << "\n";
     CC << "{\n";
+    if (classInfo.copyOnWrite)
+        CC << "    this->sharedFields = new SharedFields();\n";
     for (const auto& baseclassField : classInfo.baseclassFieldlist)
         CC << "    this->" << baseclassField.setter << "(" << baseclassField.value << ");\n";
     if (!classInfo.baseclassFieldlist.empty() && !classInfo.fieldList.empty())
@@ -611,7 +642,13 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
     // destructor:
     CC << "" << classInfo.className << "::~" << classInfo.className << "()\n";
     CC << "{\n";
+    if (classInfo.copyOnWrite) {
+        CC << "    if (--this->sharedFields->refCount == 0)\n";
+        CC << "        delete this->sharedFields;\n";
+    }
     for (const auto& field : classInfo.fieldList) {
+        if (field.isShared)
+            continue;  // freed together with the shared field block
         if (field.isAbstract || field.isCustom)
             continue;
         std::ostringstream releaseElem;
@@ -648,8 +685,15 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
     // copy function:
     CC << "void " << classInfo.className << "::copy(const " << classInfo.className << "& other)\n";
     CC << "{\n";
+    if (classInfo.copyOnWrite) {
+        // share the data members of the other object instead of copying them
+        CC << "    other.sharedFields->refCount++;\n";
+        CC << "    if (this->sharedFields != nullptr && --this->sharedFields->refCount == 0)\n";
+        CC << "        delete this->sharedFields;\n";
+        CC << "    this->sharedFields = other.sharedFields;\n";
+    }
     for (const auto& field : classInfo.fieldList) {
-        if (field.isAbstract || field.isCustom)
+        if (field.isAbstract || field.isCustom || field.isShared)
             continue;
         if (!field.isPointer && field.isConst)
             continue;
@@ -713,6 +757,9 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
     generateMethodCplusplusBlock(classInfo, "copy");
     CC << "}\n\n";
 
+    if (classInfo.copyOnWrite)
+        generateSharedFieldsImpl(classInfo);
+
     // str() function:
     if (!classInfo.str.empty()) {
         CC << "std::string " << classInfo.className << "::str() const\n";
@@ -748,8 +795,8 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
         else {
             if (field.isArray) {
                 if (field.isDynamicArray)
-                    CC << "    b->pack(" << field.sizeVar << ");\n";
-                CC << "    doParsimArrayPacking(b," << var(field) << "," << field.sizeVar << ");\n";
+                    CC << "    b->pack(" << sizeVar(field) << ");\n";
+                CC << "    doParsimArrayPacking(b," << var(field) << "," << sizeVar(field) << ");\n";
             }
             else {
                 CC << "    doParsimPacking(b," << var(field) << ");\n";
@@ -770,6 +817,8 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
             CC << "    doParsimUnpacking(b,(::" << classInfo.baseClass << "&)*this);\n";  // this would do for cOwnedObject too, but the other is nicer
         }
     }
+    if (classInfo.copyOnWrite)
+        CC << "    unshareFields();\n";
     for (const auto& field : classInfo.fieldList) {
         if (field.nopack)
             continue; // @nopack specified
@@ -783,12 +832,12 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
                 }
                 else {
                     CC << "    delete [] " << var(field) << ";\n";
-                    CC << "    b->unpack(" << field.sizeVar << ");\n";
-                    CC << "    if (" << field.sizeVar << " == 0) {\n";
+                    CC << "    b->unpack(" << sizeVar(field) << ");\n";
+                    CC << "    if (" << sizeVar(field) << " == 0) {\n";
                     CC << "        " << var(field) << " = nullptr;\n";
                     CC << "    } else {\n";
-                    CC << "        " << var(field) << " = new " << field.dataType << "[" << field.sizeVar << "];\n";
-                    CC << "        doParsimArrayUnpacking(b," << var(field) << "," << field.sizeVar << ");\n";
+                    CC << "        " << var(field) << " = new " << field.dataType << "[" << sizeVar(field) << "];\n";
+                    CC << "        doParsimArrayUnpacking(b," << var(field) << "," << sizeVar(field) << ");\n";
                     CC << "    }\n";
                 }
             }
@@ -807,21 +856,21 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
         std::string idx = (field.isArray) ? "[k]" : "";
         std::string idxarg = (field.isArray) ? (field.sizeType + " k") : std::string("");
         std::string idxarg2 = (field.isArray) ? (idxarg + ", ") : std::string("");
-        std::string indexedVar = str("this->") + field.var + idx;
+        std::string indexedVar = var(field) + idx;
 
         // getters:
         if (field.isArray) {
             CC << "" << field.sizeType << " " << classInfo.className << "::" << field.sizeGetter << "() const\n";
             CC << "{\n";
             generateMethodCplusplusBlock(classInfo, field.sizeGetter);
-            CC << "    return " << field.sizeVar << ";\n";
+            CC << "    return " << sizeVar(field) << ";\n";
             CC << "}\n\n";
         }
 
         CC << field.returnType << " " << classInfo.className << "::" << field.getter << "(" << idxarg << ")" << " const\n";
         CC << "{\n";
         if (field.isArray)
-            CC << "    if (k >= " << field.sizeVar << ") throw omnetpp::cRuntimeError(\"Array of size " << field.sizeVar << " indexed by %lu\", (unsigned long)k);\n";
+            CC << "    if (k >= " << sizeVar(field) << ") throw omnetpp::cRuntimeError(\"Array of size " << field.sizeVar << " indexed by %lu\", (unsigned long)k);\n";
         generateMethodCplusplusBlock(classInfo, field.getter);
         CC << "    return " << makeFuncall(indexedVar, field.getterConversion) + ";\n";
         CC << "}\n\n";
@@ -832,7 +881,7 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
             CC << "{\n";
             CC << maybe_handleChange_line;
             CC << "    " << field.dataType << " *" << field.var << "2 = (newSize==0) ? nullptr : new " << field.dataType << "[newSize];\n";
-            CC << "    " << field.sizeType << " minSize = " << field.sizeVar << " < newSize ? " << field.sizeVar << " : newSize;\n";
+            CC << "    " << field.sizeType << " minSize = " << sizeVar(field) << " < newSize ? " << sizeVar(field) << " : newSize;\n";
             CC << "    for (" << field.sizeType << " i = 0; i < minSize; i++)\n";
             CC << "        " << field.var << "2[i] = " << var(field) << "[i];\n";
             if (!field.value.empty()) {
@@ -842,7 +891,7 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
             if (!field.isPointer && field.iscOwnedObject)
                 CC << forEachIndex(field) << "\n" << "        drop(&" << varElem(field) << ");\n";
             if (field.isPointer && field.isOwnedPointer) {
-                CC << "    for (" << field.sizeType << " i = newSize; i < " << field.sizeVar << "; i++)\n";
+                CC << "    for (" << field.sizeType << " i = newSize; i < " << sizeVar(field) << "; i++)\n";
                 if (field.iscOwnedObject)
                     CC << "        dropAndDelete(" << field.var << "[i]);\n";
                 else
@@ -850,7 +899,7 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
             }
             CC << "    delete [] " << var(field) << ";\n";
             CC << "    " << var(field) << " = " << field.var << "2;\n";
-            CC << "    " << field.sizeVar << " = newSize;\n";
+            CC << "    " << sizeVar(field) << " = newSize;\n";
             if (!field.isPointer && field.iscOwnedObject)
                 CC << forEachIndex(field) << "\n" << "        take(&" << varElem(field) << ");\n";
             generateMethodCplusplusBlock(classInfo, field.sizeGetter);
@@ -862,7 +911,7 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
             CC << "void " << classInfo.className << "::" << field.setter << "(" << idxarg2 << field.argType << " " << field.argName << ")\n";
             CC << "{\n";
             if (field.isArray) {
-                CC << "    if (k >= " << field.sizeVar << ") throw omnetpp::cRuntimeError(\"Array of size " << field.arraySize << " indexed by %lu\", (unsigned long)k);\n";
+                CC << "    if (k >= " << sizeVar(field) << ") throw omnetpp::cRuntimeError(\"Array of size " << field.arraySize << " indexed by %lu\", (unsigned long)k);\n";
             }
             CC << maybe_handleChange_line;
             generateMethodCplusplusBlock(classInfo, field.setter);
@@ -887,7 +936,7 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
             CC << field.mutableReturnType << " " << classInfo.className << "::" << field.dropper << "(" << idxarg << ")\n";
             CC << "{\n";
             if (field.isArray)
-                CC << "    if (k >= " << field.sizeVar << ") throw omnetpp::cRuntimeError(\"Array of size " << field.arraySize << " indexed by %lu\", (unsigned long)k);\n";
+                CC << "    if (k >= " << sizeVar(field) << ") throw omnetpp::cRuntimeError(\"Array of size " << field.arraySize << " indexed by %lu\", (unsigned long)k);\n";
             CC << maybe_handleChange_line;
             generateMethodCplusplusBlock(classInfo, field.dropper);
             CC << "    " << field.mutableReturnType << " retval = ";
@@ -908,10 +957,10 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
         if (field.isDynamicArray) {
             CC << "void " << classInfo.className << "::" << field.inserter << "(" << idxarg2 << field.argType << " " << field.argName << ")\n";
             CC << "{\n";
-            CC << "    if (k > " << field.sizeVar << ") throw omnetpp::cRuntimeError(\"Array of size " << field.arraySize << " indexed by %lu\", (unsigned long)k);\n";
+            CC << "    if (k > " << sizeVar(field) << ") throw omnetpp::cRuntimeError(\"Array of size " << field.arraySize << " indexed by %lu\", (unsigned long)k);\n";
             CC << maybe_handleChange_line;
             generateMethodCplusplusBlock(classInfo, field.inserter);
-            CC << "    " << field.sizeType << " newSize = " << field.sizeVar << " + 1;\n";
+            CC << "    " << field.sizeType << " newSize = " << sizeVar(field) << " + 1;\n";
             CC << "    " << field.dataType << " *" << field.var << "2 = new " << field.dataType << "[newSize];\n";
             CC << "    " << field.sizeType << " i;\n";
             CC << "    for (i = 0; i < k; i++)\n";
@@ -927,14 +976,14 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
                 CC << forEachIndex(field) << "\n" << "        drop(&" << varElem(field) << ");\n";
             CC << "    delete [] " << var(field) << ";\n";
             CC << "    " << var(field) << " = " << field.var << "2;\n";
-            CC << "    " << field.sizeVar << " = newSize;\n";
+            CC << "    " << sizeVar(field) << " = newSize;\n";
             if (!field.isPointer && field.iscOwnedObject)
                 CC << forEachIndex(field) << "\n" << "        take(&" << varElem(field) << ");\n";
             CC << "}\n\n";
 
             CC << "void " << classInfo.className << "::" << field.inserter << "(" << field.argType << " " << field.argName << ")\n";
             CC << "{\n";
-            CC << "    " << field.inserter << "(" << field.sizeVar << ", " << field.argName << ");\n";
+            CC << "    " << field.inserter << "(" << sizeVar(field) << ", " << field.argName << ");\n";
             CC << "}\n\n";
         }
 
@@ -942,10 +991,10 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
         if (field.isDynamicArray) {
             CC << "void " << classInfo.className << "::" << field.eraser << "(" << idxarg << ")\n";
             CC << "{\n";
-            CC << "    if (k >= " << field.sizeVar << ") throw omnetpp::cRuntimeError(\"Array of size " << field.arraySize << " indexed by %lu\", (unsigned long)k);\n";
+            CC << "    if (k >= " << sizeVar(field) << ") throw omnetpp::cRuntimeError(\"Array of size " << field.arraySize << " indexed by %lu\", (unsigned long)k);\n";
             CC << maybe_handleChange_line;
             generateMethodCplusplusBlock(classInfo, field.eraser);
-            CC << "    " << field.sizeType << " newSize = " << field.sizeVar << " - 1;\n";
+            CC << "    " << field.sizeType << " newSize = " << sizeVar(field) << " - 1;\n";
             CC << "    " << field.dataType << " *" << field.var << "2 = (newSize == 0) ? nullptr : new " << field.dataType << "[newSize];\n";
             CC << "    " << field.sizeType << " i;\n";
             CC << "    for (i = 0; i < k; i++)\n";
@@ -964,7 +1013,7 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
 
             CC << "    delete [] " << var(field) << ";\n";
             CC << "    " << var(field) << " = " << field.var << "2;\n";
-            CC << "    " << field.sizeVar << " = newSize;\n";
+            CC << "    " << sizeVar(field) << " = newSize;\n";
             if (!field.isPointer && field.iscOwnedObject)
                 CC << forEachIndex(field) << "\n" << "        take(&" << varElem(field) << ");\n";
             CC << "}\n\n";
@@ -974,6 +1023,52 @@ void MsgCodeGenerator::generateClassImpl(const ClassInfo& classInfo)
     reportUnusedMethodCplusplusBlocks(classInfo);
 }
 
+void MsgCodeGenerator::generateSharedFieldsImpl(const ClassInfo& classInfo)
+{
+    // copy constructor (note: arrays cannot be copied in the initializer list)
+    std::string sharedFields = classInfo.className + "::SharedFields";
+    CC << sharedFields << "::SharedFields(const SharedFields& other)";
+    const char *initSepar = " :\n    ";
+    for (const auto& field : classInfo.fieldList) {
+        if (field.isShared && !field.isArray) {
+            CC << initSepar << field.var << "(other." << field.var << ")";
+            initSepar = ", ";
+        }
+    }
+    CC << "\n{\n";
+    for (const auto& field : classInfo.fieldList) {
+        if (!field.isShared || !field.isArray)
+            continue;
+        if (field.isDynamicArray) {
+            CC << "    this->" << field.var << " = (other." << field.sizeVar << "==0) ? nullptr : new " << field.dataType << "[other." << field.sizeVar << "];\n";
+            CC << "    this->" << field.sizeVar << " = other." << field.sizeVar << ";\n";
+        }
+        CC << "    for (" << field.sizeType << " i = 0; i < " << (field.isDynamicArray ? "this->" : "") << field.sizeVar << "; i++) {\n";
+        CC << "        this->" << field.var << "[i] = other." << field.var << "[i];\n";
+        if (field.iscNamedObject)
+            CC << "        this->" << field.var << "[i].setName(other." << field.var << "[i].getName());\n";
+        CC << "    }\n";
+    }
+    CC << "}\n\n";
+
+    // destructor
+    CC << sharedFields << "::~SharedFields()\n";
+    CC << "{\n";
+    for (const auto& field : classInfo.fieldList)
+        if (field.isShared && field.isDynamicArray)
+            CC << "    delete [] this->" << field.var << ";\n";
+    CC << "}\n\n";
+
+    CC << "void " << classInfo.className << "::unshareFields()\n";
+    CC << "{\n";
+    CC << "    if (this->sharedFields->refCount > 1) {\n";
+    CC << "        SharedFields *newFields = new SharedFields(*this->sharedFields);\n";
+    CC << "        this->sharedFields->refCount--;\n";
+    CC << "        this->sharedFields = newFields;\n";
+    CC << "    }\n";
+    CC << "}\n\n";
+}
+
 void MsgCodeGenerator::generateStruct(const ClassInfo& classInfo, const std::string& exportDef)
 {
     generateStructDecl(classInfo, exportDef);
@@ -1542,6 +1637,8 @@ void MsgCodeGenerator::generateDescriptorClass(const ClassInfo& classInfo)
             std::string value;
             if (!classInfo.isClass)
                 value = str("pp->") + field.var + (field.isArray ? "[i]" : "");
+            else if (field.isShared && field.hasGetterForUpdate)
+                value = makeFuncall("pp", field.getterForUpdate, field.isArray); // the caller may modify the object via the pointer, so it must not be shared with copies
             else
                 value = makeFuncall("pp", field.getter, field.isArray);
             std::string maybeAddressOf = field.isPointer ? "" : "&";
@@ -61,6 +61,7 @@ class NEDXML_API MsgCodeGenerator
 
     void generateClassDecl(const ClassInfo& classInfo, const std::string& exportDef);
     void generateClassImpl(const ClassInfo& classInfo);
+    void generateSharedFieldsImpl(const ClassInfo& classInfo);
     void generateStructDecl(const ClassInfo& classInfo, const std::string& exportDef);
     void generateStructImpl(const ClassInfo& classInfo);
     void generateCplusplusBlock(std::ofstream& out, const std::string& body);
@@ -36,6 +36,7 @@ const char *MsgCompiler::BUILTIN_DEFINITIONS =
         R"ENDMARK(
         @property[property](type=any; usage=file; desc="Property for declaring properties.");
         @property[customize](type=bool; usage=class; desc="If true: Customize the class via inheritance. Generates base class <name>_Base.");
+        @property[copyOnWrite](type=bool; usage=class; desc="If true: Keep the data members in a reference-counted block that is shared among copies of the object, and only copied when one of the copies is modified. Makes dup() cheap.");
         @property[str](type=string; usage=class; desc="Expression to be returned from the generated str() method.");
         @property[primitive](type=bool; usage=field,class; desc="Shortcut for @opaque @byValue @editable @subclassable(false) @supportsPtr(false).");
         @property[opaque](type=bool; usage=field,class; desc="If true: Treat the field as atomic (non-compound) type, i.e. having no descriptor class. When specified on a class, it determines the default for fields of that type.");
@@ -136,6 +136,7 @@ class NEDXML_API MsgTypeTable
         bool overrideGetter;    // @overrideGetter|@override, used when field getter function overrides a function in base class
         bool overrideSetter;    // @overrideSetter|@override, used when field setter function overrides a function in base class
         bool isCustom;          // @custom; if true, do not generate any data member or code for the field.
+        bool isShared = false;  // if true, the data member is in the shared field block of a @copyOnWrite class
 
         // The following members only affect the generated class descriptor, not the class itself
         bool isEditable;        // @editable(true): field value is editable via the descriptor's setFieldValueFromString() method
@@ -161,6 +162,7 @@ class NEDXML_API MsgTypeTable
         std::string extendsQName;      // fully qualified name of base type
         std::string extendsName;       // base type's name from MSG
         bool customize;                // from @customize
+        bool copyOnWrite = false;      // from @copyOnWrite
         bool omitGetVerb;              // from @omitGetVerb
         bool isClass;                  // true=class, false=struct
         bool iscObject;                // whether type is subclassed from cObject
@@ -0,0 +1,262 @@
+//=========================================================================
+//  ARROWEXPORTER.CC - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#include <memory>
+#include "common/stringutil.h"
+#include "xyarray.h"
+#include "resultfilemanager.h"
+#include "vectorutils.h"
+#include "arrowexporter.h"
+
+using namespace std;
+using namespace omnetpp::common;
+
+namespace omnetpp {
+namespace scave {
+
+class ArrowExporterType : public ExporterType
+{
+    public:
+        virtual std::string getFormatName() const {return "Arrow";}
+        virtual std::string getDisplayName() const {return "Apache Arrow";}
+        virtual std::string getDescription() const {return "Apache Arrow IPC file (Feather) format, a binary columnar format that can be loaded with pyarrow, pandas.read_feather() or R's arrow package";}
+        virtual int getSupportedResultTypes() {return ResultFileManager::SCALAR | ResultFileManager::VECTOR;}
+        virtual std::string getFileExtension() {return "arrow";}
+        virtual StringMap getSupportedOptions() const;
+        virtual std::string getXswtForm() const;
+        virtual Exporter *create() const {return new ArrowExporter();}
+};
+
+string ArrowExporterType::getXswtForm() const
+{
+    return
+            "<?xml version='1.0' encoding='UTF-8'?>\n"
+            "<xswt xmlns:x='http://sweet_swt.sf.net/xswt'>\n"
+            "  <import xmlns='http://sweet_swt.sf.net/xswt'>\n"
+            "    <package name='java.lang'/>\n"
+            "    <package name='org.eclipse.swt.widgets' />\n"
+            "    <package name='org.eclipse.swt.graphics' />\n"
+            "    <package name='org.eclipse.swt.layout' />\n"
+            "    <package name='org.eclipse.swt.custom' />\n"
+            "  </import>\n"
+            "  <layout x:class='GridLayout' numColumns='2'/>\n"
+            "  <x:children>\n"
+            "    <group text='Options'>\n"
+            "      <layoutData x:class='GridData' horizontalSpan='2' horizontalAlignment='FILL' grabExcessHorizontalSpace='true'/>\n"
+            "      <layout x:class='GridLayout' numColumns='2'/>\n"
+            "      <x:children>\n"
+            "         <label text='Rows per record batch:'/>\n"
+            "         <spinner x:id='batchSize' x:style='BORDER' minimum='1' maximum='10000000' textLimit='8' selection='65536'>\n"
+            "           <layoutData x:class='GridData' widthHint='100'/>\n"
+            "         </spinner>\n"
+            "      </x:children>\n"
+            "    </group>\n"
+            "  </x:children>\n"
+            "</xswt>\n";
+}
+
+StringMap ArrowExporterType::getSupportedOptions() const
+{
+    StringMap options {
+        {"batchSize", "The maximum number of rows in a record batch. Batches are also cut when the vector data in them grows large."},
+    };
+    return options;
+}
+
+//---
+
+int32_t ArrowExporter::Dictionary::add(const std::string& s)
+{
+    auto it = indices.find(s);
+    if (it != indices.end())
+        return it->second;
+    int32_t index = values.size();
+    values.push_back(s);
+    indices[s] = index;
+    return index;
+}
+
+ExporterType *ArrowExporter::getDescription()
+{
+    static ArrowExporterType desc;
+    return &desc;
+}
+
+void ArrowExporter::setOption(const std::string& key, const std::string& value)
+{
+    checkOptionKey(getDescription(), key);
+    if (key == "batchSize")
+        setBatchSize(opp_atol(value.c_str()));
+    else
+        throw opp_runtime_error("Exporter: unhandled option '%s'", key.c_str());
+}
+
+void ArrowExporter::addString(int column, Dictionary& dictionary, const std::string *value)
+{
+    int32_t index = value ? dictionary.add(*value) : -1;
+    if (!collecting) {
+        if (index == -1)
+            writer->appendNull(column);
+        else
+            writer->appendIndex(column, index);
+    }
+}
+
+void ArrowExporter::endRow()
+{
+    if (!collecting)
+        writer->endRow();
+}
+
+void ArrowExporter::processRuns(const RunList& runList)
+{
+    static const std::string RUNATTR = "runattr", ITERVAR = "itervar", CONFIG = "config";
+    auto addRow = [this](const std::string& runName, const std::string& type, const std::string& attrName, const std::string& attrValue) {
+        addString(colRun, runs, &runName);
+        addString(colType, types, &type);
+        addString(colModule, modules, nullptr);
+        addString(colName, names, nullptr);
+        addString(colAttrName, attrNames, &attrName);
+        addString(colAttrValue, attrValues, &attrValue);
+        if (!collecting) {
+            for (int column : {colValue, colVecTime, colVecValue})
+                if (column != -1)
+                    writer->appendNull(column);
+        }
+        endRow();
+    };
+
+    for (Run *run : runList) {
+        for (auto& pair : run->getAttributes())
+            addRow(run->getRunName(), RUNATTR, pair.first, pair.second);
+        for (auto& pair : run->getIterationVariables())
+            addRow(run->getRunName(), ITERVAR, pair.first, pair.second);
+        for (auto& pair : run->getConfigEntries())
+            addRow(run->getRunName(), CONFIG, pair.first, pair.second);
+    }
+}
+
+void ArrowExporter::processResultItem(const ResultItem *result, const std::string& type, double value, const XYArray *array)
+{
+    static const std::string ATTR = "attr";
+    const std::string& runName = result->getRun()->getRunName();
+
+    addString(colRun, runs, &runName);
+    addString(colType, types, &type);
+    addString(colModule, modules, &result->getModuleName());
+    addString(colName, names, &result->getName());
+    addString(colAttrName, attrNames, nullptr);
+    addString(colAttrValue, attrValues, nullptr);
+    if (!collecting) {
+        if (colValue != -1) {
+            if (array == nullptr)
+                writer->appendDouble(colValue, value);
+            else
+                writer->appendNull(colValue);
+        }
+        if (colVecTime != -1) {
+            if (array != nullptr) {
+                writer->appendDoubles(colVecTime, array->xs.data(), array->xs.size());
+                writer->appendDoubles(colVecValue, array->ys.data(), array->ys.size());
+            }
+            else {
+                writer->appendNull(colVecTime);
+                writer->appendNull(colVecValue);
+            }
+        }
+    }
+    endRow();
+
+    for (auto& pair : result->getAttributes()) {
+        addString(colRun, runs, &runName);
+        addString(colType, types, &ATTR);
+        addString(colModule, modules, &result->getModuleName());
+        addString(colName, names, &result->getName());
+        addString(colAttrName, attrNames, &pair.first);
+        addString(colAttrValue, attrValues, &pair.second);
+        if (!collecting) {
+            for (int column : {colValue, colVecTime, colVecValue})
+                if (column != -1)
+                    writer->appendNull(column);
+        }
+        endRow();
+    }
+}
+
+void ArrowExporter::saveResults(const std::string& fileName, ResultFileManager *manager, const IDList& idlist, IProgressMonitor *monitor)
+{
+    //TODO progress reporting
+    checkItemTypes(idlist, ResultFileManager::SCALAR | ResultFileManager::VECTOR);
+
+    int itemTypes = idlist.getItemTypes();
+    bool haveScalars = (itemTypes & ResultFileManager::SCALAR) != 0;
+    bool haveVectors = (itemTypes & ResultFileManager::VECTOR) != 0;
+
+    RunList runList = manager->getUniqueRuns(idlist);
+    IDList scalarIDs = idlist.filterByTypes(ResultFileManager::SCALAR);
+    IDList vectorIDs = idlist.filterByTypes(ResultFileManager::VECTOR);
+
+    std::unique_ptr<ArrowFileWriter> arrowWriter(new ArrowFileWriter());
+    writer = arrowWriter.get();
+    colRun = writer->addColumn("run", ArrowFileWriter::DICTIONARY_STRING);
+    colType = writer->addColumn("type", ArrowFileWriter::DICTIONARY_STRING);
+    colModule = writer->addColumn("module", ArrowFileWriter::DICTIONARY_STRING);
+    colName = writer->addColumn("name", ArrowFileWriter::DICTIONARY_STRING);
+    colAttrName = writer->addColumn("attrname", ArrowFileWriter::DICTIONARY_STRING);
+    colAttrValue = writer->addColumn("attrvalue", ArrowFileWriter::DICTIONARY_STRING);
+    colValue = haveScalars ? writer->addColumn("value", ArrowFileWriter::DOUBLE) : -1;
+    colVecTime = haveVectors ? writer->addColumn("vectime", ArrowFileWriter::DOUBLE_LIST) : -1;
+    colVecValue = haveVectors ? writer->addColumn("vecvalue", ArrowFileWriter::DOUBLE_LIST) : -1;
+    writer->setBatchSize(batchSize);
+
+    runs = types = modules = names = attrNames = attrValues = Dictionary();
+
+    // the dictionaries must precede the record batches in the file, so make
+    // two passes: first only collect the strings, then write the rows
+    static const std::string SCALAR = "scalar", VECTOR = "vector";
+    ScalarResult buffer;
+    collecting = true;
+    processRuns(runList);
+    for (ID id : scalarIDs) {
+        const ScalarResult *scalar = manager->getScalar(id, buffer);
+        processResultItem(scalar, SCALAR, scalar->getValue(), nullptr);
+    }
+    for (ID id : vectorIDs)
+        processResultItem(manager->getVector(id), VECTOR, NaN, nullptr);
+
+    collecting = false;
+    writer->open(fileName.c_str());
+    writer->setDictionary(colRun, runs.getValues());
+    writer->setDictionary(colType, types.getValues());
+    writer->setDictionary(colModule, modules.getValues());
+    writer->setDictionary(colName, names.getValues());
+    writer->setDictionary(colAttrName, attrNames.getValues());
+    writer->setDictionary(colAttrValue, attrValues.getValues());
+    processRuns(runList);
+    for (ID id : scalarIDs) {
+        const ScalarResult *scalar = manager->getScalar(id, buffer);
+        processResultItem(scalar, SCALAR, scalar->getValue(), nullptr);
+    }
+    readVectorsInGroups(manager, vectorIDs, false, false, [&](const IDList& group, const std::vector<XYArray *>& xyArrays) {
+        Assert((int)xyArrays.size() == group.size());
+        for (int i = 0; i < group.size(); i++)
+            processResultItem(manager->getVector(group.get(i)), VECTOR, NaN, xyArrays[i]);
+    }, vectorMemoryLimit, numThreads, vectorStartTime, vectorEndTime);
+
+    writer->close();
+    writer = nullptr;
+}
+
+}  // namespace scave
+}  // namespace omnetpp
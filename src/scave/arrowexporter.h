@@ -0,0 +1,77 @@
+//=========================================================================
+//  ARROWEXPORTER.H - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#ifndef __OMNETPP_SCAVE_ARROWEXPORTER_H
+#define __OMNETPP_SCAVE_ARROWEXPORTER_H
+
+#include <unordered_map>
+#include "exporter.h"
+#include "common/arrowfilewriter.h"
+
+namespace omnetpp {
+namespace scave {
+
+class IDList;
+
+using common::ArrowFileWriter;
+
+/**
+ * Export data in Apache Arrow IPC file (Feather) format. The table contains
+ * the same records as the CSV-R export (run, type, module, name, attrname,
+ * attrvalue, value, vectime, vecvalue), with all string columns dictionary
+ * encoded and vector data stored as list-of-double columns. Vectors are read
+ * and written a group at a time, so the whole data set never has to be in
+ * memory.
+ */
+class SCAVE_API ArrowExporter : public Exporter
+{
+    private:
+        class Dictionary {
+            private:
+                std::vector<std::string> values;
+                std::unordered_map<std::string,int32_t> indices;
+            public:
+                int32_t add(const std::string& s);
+                const std::vector<std::string>& getValues() const {return values;}
+        };
+
+        int64_t batchSize = 65536;
+
+        ArrowFileWriter *writer = nullptr;
+        int colRun, colType, colModule, colName, colAttrName, colAttrValue, colValue, colVecTime, colVecValue;
+        Dictionary runs, types, modules, names, attrNames, attrValues;
+        bool collecting = false;
+
+    protected:
+        void processRuns(const RunList& runList);
+        void processResultItem(const ResultItem *result, const std::string& type, double value, const XYArray *array);
+        void addString(int column, Dictionary& dictionary, const std::string *value);
+        void endRow();
+
+    public:
+        ArrowExporter() {}
+
+        void setBatchSize(int64_t n) {batchSize = n;}
+        int64_t getBatchSize() const {return batchSize;}
+
+        virtual void setOption(const std::string& key, const std::string& value);
+        virtual void saveResults(const std::string& fileName, ResultFileManager *manager, const IDList& idlist, IProgressMonitor *monitor=nullptr);
+
+        static ExporterType *getDescription();
+};
+
+} // namespace scave
+}  // namespace omnetpp
+
+#endif
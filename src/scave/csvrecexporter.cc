@@ -279,27 +279,23 @@ void CsvRecordsExporter::saveResultsAsRecords(ResultFileManager *manager, const
 
     // record vectors
     if (haveVectors) {
-        // load vector data
+        // load and write vector data a group at a time
         IDList vectorIDs = idlist.filterByTypes(ResultFileManager::VECTOR);
-        std::vector<XYArray *> xyArrays = readVectorsIntoArrays(manager, vectorIDs, true, false, std::numeric_limits<size_t>::max(), vectorStartTime, vectorEndTime);
-        assert((int)xyArrays.size() == vectorIDs.size());
-
-        // write vectors
-        int numVectors = (int)vectorIDs.size();
-        for (int i = 0; i < numVectors; ++i) {
-            const VectorResult *vector = manager->getVector(vectorIDs.get(i));
-            writeResultItemBase(vector, "vector", numColumns);
-            for (size_t i = 0; i < scalarColumnNames.size() + statisticColumnNames.size() + histogramColumnNames.size(); i++)
-                csv.writeBlank(); // skip intermediate columns
-            XYArray *data = xyArrays[i];
-            writeXAsString(data);
-            writeYAsString(data);
-            finishRecord(numColumns);
-            writeResultAttrRecords(vector, numColumns);
-        }
-
-        for (auto xyArray : xyArrays)
-            delete xyArray;
+        readVectorsInGroups(manager, vectorIDs, true, false, [&](const IDList& vectors, const std::vector<XYArray *>& xyArrays) {
+            assert((int)xyArrays.size() == vectors.size());
+            int numVectors = (int)vectors.size();
+            for (int i = 0; i < numVectors; ++i) {
+                const VectorResult *vector = manager->getVector(vectors.get(i));
+                writeResultItemBase(vector, "vector", numColumns);
+                for (size_t i = 0; i < scalarColumnNames.size() + statisticColumnNames.size() + histogramColumnNames.size(); i++)
+                    csv.writeBlank(); // skip intermediate columns
+                XYArray *data = xyArrays[i];
+                writeXAsString(data);
+                writeYAsString(data);
+                finishRecord(numColumns);
+                writeResultAttrRecords(vector, numColumns);
+            }
+        }, vectorMemoryLimit, numThreads, vectorStartTime, vectorEndTime);
     }
 }
 
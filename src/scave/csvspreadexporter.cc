@@ -286,10 +286,6 @@ void CsvForSpreadsheetExporter::saveVectors(ResultFileManager *manager, const ID
 {
     //TODO use monitor
     collectItervars(manager, idlist);
-    std::vector<XYArray *> xyArrays = readVectorsIntoArrays(manager, idlist, true, false, std::numeric_limits<size_t>::max(), vectorStartTime, vectorEndTime);
-    assert((int)xyArrays.size() == idlist.size());
-
-    int numVectors = (int)idlist.size();
 
     if (vectorLayout == HORIZONTAL) {
         // write header row
@@ -302,35 +298,44 @@ void CsvForSpreadsheetExporter::saveVectors(ResultFileManager *manager, const ID
             csv.writeNewLine();
         }
 
-        // write vectors
-        for (int i = 0; i < numVectors; ++i) {
-            const VectorResult *vector = manager->getVector(idlist.get(i));
-            XYArray *data = xyArrays[i];
-
-            // time row
-            writeRunColumns(vector->getRun());
-            csv.writeString(vector->getModuleName());
-            csv.writeString(vector->getName());
-            csv.writeString("TIME");
-            for (int j = 0; j < data->length(); j++) {
-                if (data->hasPreciseX())
-                    csv.writeBigDecimal(data->getPreciseX(j));
-                else
-                    csv.writeDouble(data->getX(j));
+        // write vectors; they are loaded a group at a time
+        readVectorsInGroups(manager, idlist, true, false, [&](const IDList& vectors, const std::vector<XYArray *>& xyArrays) {
+            assert((int)xyArrays.size() == vectors.size());
+            int numVectors = (int)vectors.size();
+            for (int i = 0; i < numVectors; ++i) {
+                const VectorResult *vector = manager->getVector(vectors.get(i));
+                XYArray *data = xyArrays[i];
+
+                // time row
+                writeRunColumns(vector->getRun());
+                csv.writeString(vector->getModuleName());
+                csv.writeString(vector->getName());
+                csv.writeString("TIME");
+                for (int j = 0; j < data->length(); j++) {
+                    if (data->hasPreciseX())
+                        csv.writeBigDecimal(data->getPreciseX(j));
+                    else
+                        csv.writeDouble(data->getX(j));
+                }
+                csv.writeNewLine();
+
+                // value row
+                writeRunColumns(vector->getRun());
+                csv.writeString(vector->getModuleName());
+                csv.writeString(vector->getName());
+                csv.writeString("VALUE");
+                for (int j = 0; j < data->length(); j++)
+                    csv.writeBigDecimal(data->getY(j));
+                csv.writeNewLine();
             }
-            csv.writeNewLine();
-
-            // value row
-            writeRunColumns(vector->getRun());
-            csv.writeString(vector->getModuleName());
-            csv.writeString(vector->getName());
-            csv.writeString("VALUE");
-            for (int j = 0; j < data->length(); j++)
-                csv.writeBigDecimal(data->getY(j));
-            csv.writeNewLine();
-        }
+        }, vectorMemoryLimit, numThreads, vectorStartTime, vectorEndTime);
     }
     else if (vectorLayout == VERTICAL) {
+        // all vectors are needed at once for writing the rows
+        std::vector<XYArray *> xyArrays = readVectorsIntoArrays(manager, idlist, true, false, std::numeric_limits<size_t>::max(), vectorStartTime, vectorEndTime);
+        assert((int)xyArrays.size() == idlist.size());
+        int numVectors = (int)idlist.size();
+
         // write header row
         if (columnNames) {
             for (int i = 0; i < numVectors; ++i) {
@@ -366,13 +371,12 @@ void CsvForSpreadsheetExporter::saveVectors(ResultFileManager *manager, const ID
             csv.writeNewLine();
         }
 
+        for (auto xyArray : xyArrays)
+            delete xyArray;
     }
     else {
         throw opp_runtime_error("Invalid vector layout");
     }
-
-    for (auto xyArray : xyArrays)
-        delete xyArray;
 }
 
 void CsvForSpreadsheetExporter::saveStatistics(ResultFileManager *manager, const IDList& idlist, IProgressMonitor *monitor)
@@ -26,6 +26,7 @@
 #include "omnetppvectorfileexporter.h"
 #include "sqlitescalarfileexporter.h"
 #include "sqlitevectorfileexporter.h"
+#include "arrowexporter.h"
 
 using namespace omnetpp::common;
 
@@ -76,6 +77,7 @@ void ExporterFactory::ensureInitialized()
         exporters.push_back(OmnetppVectorFileExporter::getDescription());
         exporters.push_back(SqliteScalarFileExporter::getDescription());
         exporters.push_back(SqliteVectorFileExporter::getDescription());
+        exporters.push_back(ArrowExporter::getDescription());
     }
 }
 
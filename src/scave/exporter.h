@@ -56,6 +56,8 @@ class SCAVE_API Exporter
 {
     protected:
         double vectorStartTime = -INFINITY, vectorEndTime = INFINITY;
+        size_t vectorMemoryLimit = 1024*1024*1024; // bytes of vector data held in memory at a time (approx.)
+        int numThreads = 1; // for reading vector data
     protected:
         virtual void checkOptionKey(ExporterType *desc, const std::string& key);
         virtual void checkItemTypes(const IDList& idlist, int supportedTypes);
@@ -66,6 +68,8 @@ class SCAVE_API Exporter
         virtual void setOptions(const StringMap& options);
         virtual void setVectorStartTime(double startTime) {vectorStartTime = startTime;}
         virtual void setVectorEndTime(double endTime) {vectorEndTime = endTime;}
+        virtual void setVectorMemoryLimit(size_t bytes) {vectorMemoryLimit = bytes;}
+        virtual void setNumThreads(int n) {numThreads = n;}
         virtual void saveResults(const std::string& fileName, ResultFileManager *manager, const IDList& idlist, IProgressMonitor *monitor=nullptr) = 0;
 };
 
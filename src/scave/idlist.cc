@@ -272,20 +272,17 @@ void IDList::sortByRunConfigValue(ResultFileManager *mgr, const char *configKey,
 
 void IDList::sortByModule(ResultFileManager *mgr, bool ascending, std::vector<int>& selectionIndices, InterruptedFlag *interrupted)
 {
-    ScalarResult tmp;
-    doSort<const char *>([mgr,&tmp](ID id) {return mgr->uncheckedGetItem(id, tmp)->getModuleName().c_str();}, mgr, ascending, selectionIndices, interrupted);
+    doSort<const char *>([mgr](ID id) {return mgr->uncheckedGetModuleName(id).c_str();}, mgr, ascending, selectionIndices, interrupted);
 }
 
 void IDList::sortByName(ResultFileManager *mgr, bool ascending, std::vector<int>& selectionIndices, InterruptedFlag *interrupted)
 {
-    ScalarResult tmp;
-    doSort<const char *>([mgr,&tmp](ID id) {return mgr->uncheckedGetItem(id, tmp)->getName().c_str();}, mgr, ascending, selectionIndices, interrupted);
+    doSort<const char *>([mgr](ID id) {return mgr->uncheckedGetName(id).c_str();}, mgr, ascending, selectionIndices, interrupted);
 }
 
 void IDList::sortScalarsByValue(ResultFileManager *mgr, bool ascending, std::vector<int>& selectionIndices, InterruptedFlag *interrupted)
 {
-    ScalarResult tmp;
-    doSort<double>([mgr,&tmp](ID id) {return mgr->uncheckedGetScalar(id, tmp)->getValue();}, mgr, ascending, selectionIndices, interrupted);
+    doSort<double>([mgr](ID id) {return mgr->uncheckedGetScalarValue(id);}, mgr, ascending, selectionIndices, interrupted);
 }
 
 void IDList::sortParametersByValue(ResultFileManager *mgr, bool ascending, std::vector<int>& selectionIndices, InterruptedFlag *interrupted)
@@ -14,12 +14,14 @@
   `license' for details on this and other legal matters.
 *--------------------------------------------------------------*/
 
+#include <algorithm>
 #include <clocale>
 #include <cstdlib>
 #include "common/exception.h"
 #include "common/linetokenizer.h"
 #include "common/stringutil.h"
 #include "common/stlutil.h"
+#include "common/vectorblockcodec.h"
 #include "omnetpp/platdep/platmisc.h"
 #include "indexedvectorfilereader.h"
 #include "indexfilereader.h"
@@ -36,16 +38,20 @@ namespace scave {
 //=========================================================================
 
 IndexedVectorFileReader::IndexedVectorFileReader(const char *filename, bool includeEventNumbers, AdapterLambdaType adapterLambda)
-    : adapterLambda(adapterLambda), fname(filename), index(nullptr), includeEventNumbers(includeEventNumbers)
+    : adapterLambda(adapterLambda), fname(filename), index(nullptr), includeEventNumbers(includeEventNumbers), binaryFile(nullptr), reader(nullptr)
 {
     std::string ifname = IndexFileUtils::getIndexFileName(filename);
     IndexFileReader indexReader(ifname.c_str());
     index = indexReader.readAll();
+    isBinary = IndexFileUtils::isBinaryVectorFile(filename);
 }
 
 IndexedVectorFileReader::~IndexedVectorFileReader()
 {
     delete index;
+    delete reader;
+    if (binaryFile)
+        fclose(binaryFile);
 }
 
 // see filemgrs.h
@@ -61,19 +67,27 @@ IndexedVectorFileReader::~IndexedVectorFileReader()
                                         msg, fname.c_str(), (int64_t)block.startOffset, line);\
             }
 
-Entries IndexedVectorFileReader::loadBlock(const Block& block, std::function<bool(const VectorDatum&)> filter)
+Entries IndexedVectorFileReader::loadBlock(const Block& block, std::function<bool(const VectorDatum&)> filter, const IndexRanges *ranges)
 {
+    if (isBinary)
+        return loadBinaryBlock(block, filter, ranges);
+
     std::vector<VectorDatum> result;
 
     VectorInfo *vector = index->getVectorById(block.vectorId);
 
-    size_t bufferSize = vector->blockSize;
-    if (bufferSize < MIN_BUFFER_SIZE)
-        bufferSize = MIN_BUFFER_SIZE;
-    FileReader reader(fname.c_str(), bufferSize);
+    if (!reader) {
+        // a buffer that can hold any block; the file is not memory mapped, as the reader may be long-lived
+        size_t bufferSize = MIN_BUFFER_SIZE;
+        for (int i = 0; i < index->getNumberOfVectors(); i++)
+            bufferSize = std::max(bufferSize, (size_t)index->getVectorAt(i)->blockSize);
+        reader = new FileReader(fname.c_str(), bufferSize);
+    }
 
     long count = block.getCount();
-    reader.seekTo(block.startOffset);
+    if (ranges)
+        count = ranges->empty() ? 0 : std::min(count, ranges->back().second);
+    reader->seekTo(block.startOffset);
 
     result.reserve(count);
 
@@ -85,9 +99,16 @@ Entries IndexedVectorFileReader::loadBlock(const Block& block, std::function<boo
     std::string columns = vector->columns;
     int columnsNo = columns.size();
 
+    size_t range = 0;
     for (int i = 0; i < count; ++i) {
-        CHECK(line = reader.getNextLineBufferPointer(), "Unexpected end of file", block, i);
-        int len = reader.getCurrentLineLength();
+        CHECK(line = reader->getNextLineBufferPointer(), "Unexpected end of file", block, i);
+        if (ranges) {
+            while ((*ranges)[range].second <= i)
+                range++;
+            if (i < (*ranges)[range].first)
+                continue;
+        }
+        int len = reader->getCurrentLineLength();
 
         tokenizer.tokenize(line, len);
         tokens = tokenizer.tokens();
@@ -113,6 +134,54 @@ Entries IndexedVectorFileReader::loadBlock(const Block& block, std::function<boo
     return result;
 }
 
+Entries IndexedVectorFileReader::loadBinaryBlock(const Block& block, std::function<bool(const VectorDatum&)> filter, const IndexRanges *ranges)
+{
+    if (!binaryFile) {
+        binaryFile = fopen(fname.c_str(), "rb");
+        if (!binaryFile)
+            throw opp_runtime_error("Cannot open vector file '%s'", fname.c_str());
+    }
+
+    // the block is a "block <vectorId> <size>" line followed by the encoded data
+    std::vector<char> buffer(block.size);
+    if (opp_fseek(binaryFile, block.startOffset, SEEK_SET) != 0 || fread(buffer.data(), 1, buffer.size(), binaryFile) != buffer.size())
+        throw opp_runtime_error("Cannot read block at offset %" PRId64 " from vector file '%s'", (int64_t)block.startOffset, fname.c_str());
+
+    const char *newline = (const char *)memchr(buffer.data(), '\n', buffer.size());
+    int id;
+    int64_t dataSize;
+    CHECK(newline && sscanf(buffer.data(), "block %d %" SCNd64, &id, &dataSize) == 2, "Malformed block header", block, 0);
+    CHECK(id == block.vectorId, "Unexpected vector id", block, 0);
+    const char *data = newline + 1;
+    CHECK(dataSize >= 0 && dataSize <= buffer.data() + buffer.size() - data, "Truncated block", block, 0);
+
+    VectorBlockDecoder decoder(data, dataSize);
+    CHECK(decoder.getCount() == block.getCount(), "Unexpected number of samples in block", block, 0);
+
+    Entries result;
+    result.reserve(block.getCount());
+    int scaleExp = decoder.getScaleExp();
+    eventnumber_t eventNumber;
+    int64_t rawTime;
+    double value;
+    long count = block.getCount();
+    if (ranges)
+        count = ranges->empty() ? 0 : std::min(count, ranges->back().second);
+    size_t range = 0;
+    for (long i = 0; i < count && decoder.next(eventNumber, rawTime, value); i++) {
+        if (ranges) {
+            while ((*ranges)[range].second <= i)
+                range++;
+            if (i < (*ranges)[range].first)
+                continue;
+        }
+        VectorDatum entry(block.startSerial+i, includeEventNumbers ? eventNumber : -1, BigDecimal(rawTime, scaleExp), value);
+        if (!filter || filter(entry))
+            result.push_back(entry);
+    }
+    return result;
+}
+
 VectorDatum *IndexedVectorFileReader::getEntryBySerial(int vectorId, int64_t serial)
 {
     VectorInfo *vector = index->getVectorById(vectorId);
@@ -213,6 +282,32 @@ void IndexedVectorFileReader::collectEntriesInSimtimeInterval(const std::set<int
     }
 }
 
+void IndexedVectorFileReader::collectEntriesInSerialRanges(int vectorId, const std::vector<std::pair<int64_t,int64_t>>& ranges)
+{
+    const VectorInfo *vector = index->getVectorById(vectorId);
+    if (vector == nullptr || ranges.empty())
+        return;
+
+    size_t first = 0; // the first range that does not end before the current block
+    IndexRanges blockRanges;
+    for (const Block *block : vector->blocks) {
+        int64_t blockStart = block->startSerial, blockEnd = block->endSerial();
+        while (first < ranges.size() && ranges[first].second <= blockStart)
+            first++;
+        if (first == ranges.size())
+            break;
+
+        blockRanges.clear();
+        for (size_t i = first; i < ranges.size() && ranges[i].first < blockEnd; i++)
+            blockRanges.push_back(std::make_pair((long)(std::max(ranges[i].first, blockStart) - blockStart), (long)(std::min(ranges[i].second, blockEnd) - blockStart)));
+        if (blockRanges.empty())
+            continue; // block falls into a gap between ranges
+
+        std::vector<VectorDatum> data = loadBlock(*block, nullptr, &blockRanges);
+        adapterLambda(block->vectorId, data);
+    }
+}
+
 void IndexedVectorFileReader::collectEntriesInEventnumInterval(const std::set<int>& vectorIds, eventnumber_t startEventNum, eventnumber_t endEventNum)
 {
     for (auto block : index->getBlocks()) {
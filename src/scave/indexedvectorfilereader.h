@@ -50,10 +50,20 @@ class SCAVE_API IndexedVectorFileReader : public IVectorDataReader
         std::string fname;  // file name of the vector file
         VectorFileIndex *index; // index of the vector file, loaded fully into the memory
         bool includeEventNumbers;
+        bool isBinary;      // whether the vector file contains binary data blocks (version 4)
+        FILE *binaryFile;   // used for reading binary data blocks
+        common::FileReader *reader; // used for reading text data blocks
 
     protected:
-        /** reads a block from the vector file */
-        Entries loadBlock(const Block& block, std::function<bool(const VectorDatum&)> filter = nullptr);
+        typedef std::vector<std::pair<long,long>> IndexRanges;
+
+        /**
+         * Reads a block from the vector file. If ranges (sorted, disjoint [first,end)
+         * positions within the block) are given, only those data lines are parsed,
+         * and reading stops after the last one.
+         */
+        Entries loadBlock(const Block& block, std::function<bool(const VectorDatum&)> filter = nullptr, const IndexRanges *ranges = nullptr);
+        Entries loadBinaryBlock(const Block& block, std::function<bool(const VectorDatum&)> filter, const IndexRanges *ranges);
 
     public:
         explicit IndexedVectorFileReader(const char* filename, bool includeEventNumbers, Adapter *adapter) :
@@ -72,6 +82,13 @@ class SCAVE_API IndexedVectorFileReader : public IVectorDataReader
         void collectEntries(const std::set<int>& vectorIds) override;
         void collectEntriesInSimtimeInterval(const std::set<int>& vectorIds, simultime_t startTime, simultime_t endTime) override;
         void collectEntriesInEventnumInterval(const std::set<int>& vectorIds, eventnumber_t startEventNum, eventnumber_t endEventNum) override;
+
+        /**
+         * Collects the entries of one vector whose serial number falls into any of
+         * the given [first,end) ranges. The ranges must be sorted and disjoint.
+         * Each block of the vector is read at most once.
+         */
+        void collectEntriesInSerialRanges(int vectorId, const std::vector<std::pair<int64_t,int64_t>>& ranges);
 };
 
 
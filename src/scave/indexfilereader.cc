@@ -58,6 +58,7 @@ VectorFileIndex *IndexFileReader::readAll()
 
     VectorFileIndex *index = new VectorFileIndex();
     reader.setCheckFileForChanges(false);
+    reader.setMemoryMapped(memoryMapped);
     while ((line = reader.getNextLineBufferPointer()) != nullptr) {
         int64_t lineNum = reader.getNumReadLines();
         int len = reader.getCurrentLineLength();
@@ -39,12 +39,20 @@ class SCAVE_API IndexFileReader  //TODO this class should share the reader/parse
    private:
         /** The name of the index file. */
         std::string filename;
+        /** Whether to read the file via memory mapping. */
+        bool memoryMapped = false;
     public:
         /**
          * Creates a reader for the specified index file.
          */
         IndexFileReader(const char *filename);
 
+        /**
+         * Whether to read the file via memory mapping (see FileReader::setMemoryMapped()).
+         * Off by default, because the process may crash if the file is truncated meanwhile.
+         */
+        void setMemoryMapped(bool enabled) {memoryMapped = enabled;}
+
         /**
          * Reads the index fully into the memory.
          */
@@ -37,6 +37,10 @@ class SCAVE_API IndexFileUtils
     public:
         static bool isIndexFile(const char *indexFileName);
         static bool isExistingVectorFile(const char *vectorFileName);
+        /**
+         * Returns true if the file is a vector file with binary data blocks (version 4).
+         */
+        static bool isBinaryVectorFile(const char *vectorFileName);
         static std::string getIndexFileName(const char *vectorFileName);
         static std::string getVectorFileName(const char *indexFileName);
         /**
@@ -375,34 +375,30 @@ void JsonExporter::saveResults(const std::string& fileName, ResultFileManager *m
         // vectors
         IDList vectors = idlist.filterByTypes(ResultFileManager::VECTOR);
         if (!vectors.isEmpty()) {
-            // compute vector data
-            std::vector<XYArray *> xyArrays = readVectorsIntoArrays(manager, vectors, true, true, std::numeric_limits<size_t>::max(), vectorStartTime, vectorEndTime);
-            Assert((int)xyArrays.size() == vectors.size());
-
-            // export
+            // export; vector data are loaded a group at a time
             writer.openArray("vectors");
-            for (int i = 0; i < (int)vectors.size(); i++) {
-                ID id = vectors.get(i);
-                const VectorResult *vector = manager->getVector(id);
-                writer.openObject();
-                writer.writeString("module", vector->getModuleName());
-                writer.writeString("name", vector->getName());
-                if (!skipResultAttributes && !vector->getAttributes().empty())
-                    writeStringMap("attributes", vector->getAttributes());
-
-                XYArray *array = xyArrays[i];
-                writer.startRawValue("time"); writeX(array);
-                writer.startRawValue("value"); writeY(array);
-                if (array->hasEventNumbers()) {
-                    writer.startRawValue("eventnumber"); writeEventNumbers(array);
+            readVectorsInGroups(manager, vectors, true, true, [&](const IDList& group, const std::vector<XYArray *>& xyArrays) {
+                Assert((int)xyArrays.size() == group.size());
+                for (int i = 0; i < (int)group.size(); i++) {
+                    ID id = group.get(i);
+                    const VectorResult *vector = manager->getVector(id);
+                    writer.openObject();
+                    writer.writeString("module", vector->getModuleName());
+                    writer.writeString("name", vector->getName());
+                    if (!skipResultAttributes && !vector->getAttributes().empty())
+                        writeStringMap("attributes", vector->getAttributes());
+
+                    XYArray *array = xyArrays[i];
+                    writer.startRawValue("time"); writeX(array);
+                    writer.startRawValue("value"); writeY(array);
+                    if (array->hasEventNumbers()) {
+                        writer.startRawValue("eventnumber"); writeEventNumbers(array);
+                    }
+
+                    writer.closeObject();
                 }
-
-                writer.closeObject();
-            }
+            }, vectorMemoryLimit, numThreads, vectorStartTime, vectorEndTime);
             writer.closeArray();
-
-            for (auto xyArray : xyArrays)
-                delete xyArray;
         }
 
         writer.closeObject(); // close run
@@ -44,6 +44,7 @@
 #include "scaveexception.h"
 #include "vectorfileindex.h"
 #include "vectorfileindexer.h"
+#include "scalarfilecache.h"
 #include "interruptedflag.h"
 
 #ifdef THREADED
@@ -71,6 +72,8 @@ OmnetppResultFileLoader::OmnetppResultFileLoader(ResultFileManager *resultFileMa
 {
     indexingOption = flags & (ResultFileManager::ALLOW_INDEXING|ResultFileManager::SKIP_IF_NO_INDEX|ResultFileManager::ALLOW_LOADING_WITHOUT_INDEX);
     lockfileOption = flags & (ResultFileManager::SKIP_IF_LOCKED|ResultFileManager::IGNORE_LOCK_FILE);
+    scalarCacheOption = flags & (ResultFileManager::IGNORE_SCALAR_CACHE|ResultFileManager::READ_ONLY_SCALAR_CACHE);
+    memoryMapped = flags & ResultFileManager::MEMORY_MAP_FILES;
     verbose = flags & ResultFileManager::VERBOSE;
 }
 
@@ -90,7 +93,7 @@ void OmnetppResultFileLoader::processLine(char **vec, int numTokens, ParseContex
         int version;
         CHECK(numTokens == 2, "incorrect 'version' line -- version <number> expected");
         CHECK(parseInt(vec[1], version), "version is not a number");
-        CHECK(version == 2 || version == 3, "unsupported file version (version 2 or version 3 expected)");
+        CHECK(version == 2 || version == 3 || version == 4, "unsupported file version (version 2, 3 or 4 expected)");
         return;
     }
 
@@ -263,6 +266,7 @@ void OmnetppResultFileLoader::flush(ParseContext& ctx)
     case ParseContext::NONE:
         break;
     case ParseContext::RUN: {
+        separateItervarsFromAttrs(ctx.attrs, ctx.itervars);
         Run *existingRun = resultFileManager->getRunByName(ctx.runName.c_str());
         if (existingRun) {
             ctx.fileRunRef = resultFileManager->getOrAddFileRun(ctx.fileRef, existingRun);
@@ -271,19 +275,24 @@ void OmnetppResultFileLoader::flush(ParseContext& ctx)
         else {
             Run *runRef = resultFileManager->getOrAddRun(ctx.runName);
             ctx.fileRunRef = resultFileManager->getOrAddFileRun(ctx.fileRef, runRef);
-            separateItervarsFromAttrs(ctx.attrs, ctx.itervars);
             addAll(runRef->attributes, ctx.attrs);
             addAll(runRef->itervars, ctx.itervars);
             addAll(runRef->configEntries, ctx.configEntries);
         }
+        if (ctx.cacheWriter)
+            ctx.cacheWriter->beginRun(ctx.runName, ctx.attrs, ctx.itervars, ctx.configEntries);
         break;
     }
     case ParseContext::SCALAR: {
-        resultFileManager->addScalar(ctx.fileRunRef, ctx.moduleName.c_str(), ctx.resultName.c_str(), ctx.attrs, ctx.scalarValue, false);
+        resultFileManager->addScalar(ctx.fileRunRef, ctx.moduleName.c_str(), ctx.resultName.c_str(), ctx.attrs, ctx.scalarValue);
+        if (ctx.cacheWriter)
+            ctx.cacheWriter->addScalar(ctx.moduleName, ctx.resultName, ctx.attrs, ctx.scalarValue);
         break;
     }
     case ParseContext::PARAMETER: {
         resultFileManager->addParameter(ctx.fileRunRef, ctx.moduleName.c_str(), ctx.resultName.c_str(), ctx.attrs, ctx.paramValue);
+        if (ctx.cacheWriter)
+            ctx.cacheWriter->addParameter(ctx.moduleName, ctx.resultName, ctx.attrs, ctx.paramValue);
         break;
     }
     case ParseContext::VECTOR: {
@@ -293,6 +302,8 @@ void OmnetppResultFileLoader::flush(ParseContext& ctx)
     case ParseContext::STATISTICS: {
         Statistics stats = makeStatsFromFields(ctx);
         resultFileManager->addStatistics(ctx.fileRunRef, ctx.moduleName.c_str(), ctx.resultName.c_str(), stats, ctx.attrs);
+        if (ctx.cacheWriter)
+            ctx.cacheWriter->addStatistics(ctx.moduleName, ctx.resultName, ctx.attrs, stats);
         break;
     }
     case ParseContext::HISTOGRAM: {
@@ -312,6 +323,8 @@ void OmnetppResultFileLoader::flush(ParseContext& ctx)
             CHECK(false, "number of bin edges and bin values do not match");
         }
         resultFileManager->addHistogram(ctx.fileRunRef, ctx.moduleName.c_str(), ctx.resultName.c_str(), stats, bins, ctx.attrs);
+        if (ctx.cacheWriter)
+            ctx.cacheWriter->addHistogram(ctx.moduleName, ctx.resultName, ctx.attrs, stats, bins);
         break;
     }
     default:
@@ -386,7 +399,9 @@ ResultFile *OmnetppResultFileLoader::loadFile(const char *displayName, const cha
             case ResultFileManager::ALLOW_LOADING_WITHOUT_INDEX: LOG << "scanning vec file instead of vci\n"; break;
             case ResultFileManager::ALLOW_INDEXING: {
                 LOG << "reindexing..." << std::flush;
-                VectorFileIndexer().generateIndex(fileSystemFileName, nullptr);
+                VectorFileIndexer indexer;
+                indexer.setMemoryMapped(memoryMapped);
+                indexer.generateIndex(fileSystemFileName, nullptr);
                 hasUpToDateIndex = true;
                 LOG << "done\n";
                 break;
@@ -394,6 +409,8 @@ ResultFile *OmnetppResultFileLoader::loadFile(const char *displayName, const cha
             }
         }
 
+        bool useScalarCache = !isVecFile && scalarCacheOption != ResultFileManager::IGNORE_SCALAR_CACHE && ScalarFileCache::isScalarFile(fileSystemFileName);
+
         fileRef = resultFileManager->addFile(displayName, fileSystemFileName, ResultFile::FILETYPE_OMNETPP);
 
 
@@ -404,10 +421,18 @@ ResultFile *OmnetppResultFileLoader::loadFile(const char *displayName, const cha
             loadVectorsFromIndex(indexFileName.c_str(), fileRef);
             LOG << "done\n";
         }
+        else if (useScalarCache && loadFromScalarCache(fileSystemFileName, fileRef)) {
+            // loaded from the cache file
+        }
         else {
+            std::unique_ptr<ScalarFileCacheWriter> cacheWriter;
+            if (useScalarCache && scalarCacheOption != ResultFileManager::READ_ONLY_SCALAR_CACHE)
+                cacheWriter.reset(new ScalarFileCacheWriter());
             LOG << "reading " << fileSystemFileName << "... " << std::flush;
-            doLoadFile(fileSystemFileName, fileRef);
+            doLoadFile(fileSystemFileName, fileRef, cacheWriter.get());
             LOG << "done\n";
+            if (cacheWriter)
+                writeScalarCache(*cacheWriter, fileSystemFileName, fileRef);
         }
     }
     catch (std::exception&) {
@@ -422,20 +447,30 @@ ResultFile *OmnetppResultFileLoader::loadFile(const char *displayName, const cha
     return fileRef;
 }
 
-void OmnetppResultFileLoader::doLoadFile(const char *fileName, ResultFile *fileRef)
+void OmnetppResultFileLoader::doLoadFile(const char *fileName, ResultFile *fileRef, ScalarFileCacheWriter *cacheWriter)
 {
     // process lines in file
     FileReader freader(fileName);
+    freader.setMemoryMapped(memoryMapped);
     char *line;
     LineTokenizer tokenizer;
     ParseContext ctx;
     ctx.fileRef = fileRef;
     ctx.fileName = fileRef->getFilePath().c_str();
+    ctx.cacheWriter = cacheWriter;
     resetFields(ctx);
     while ((line = freader.getNextLineBufferPointer()) != nullptr) {
         int len = freader.getCurrentLineLength();
         int numTokens = tokenizer.tokenize(line, len);
         char **tokens = tokenizer.tokens();
+        if (numTokens == 3 && tokens[0][0] == 'b' && strcmp(tokens[0], "block") == 0) {
+            // binary data block of a version 4 vector file, skip it (data is followed by a newline)
+            ++ctx.lineNo;
+            int64_t size;
+            CHECK(parseInt64(tokens[2], size) && size >= 0, "invalid block size");
+            freader.seekTo(freader.getCurrentLineEndOffset() + size + 1);
+            continue;
+        }
         processLine(tokens, numTokens, ctx);
     }
     flush(ctx); // last result item
@@ -443,7 +478,9 @@ void OmnetppResultFileLoader::doLoadFile(const char *fileName, ResultFile *fileR
 
 void OmnetppResultFileLoader::loadVectorsFromIndex(const char *filename, ResultFile *fileRef)
 {
-    VectorFileIndex *index = IndexFileReader(filename).readAll();
+    IndexFileReader indexReader(filename);
+    indexReader.setMemoryMapped(memoryMapped);
+    VectorFileIndex *index = indexReader.readAll();
     int numOfVectors = index->getNumberOfVectors();
 
     if (numOfVectors == 0) {
@@ -479,5 +516,110 @@ void OmnetppResultFileLoader::loadVectorsFromIndex(const char *filename, ResultF
     delete index;
 }
 
+bool OmnetppResultFileLoader::loadFromScalarCache(const char *fileName, ResultFile *fileRef)
+{
+    std::string cacheFileName = ScalarFileCache::getCacheFileName(fileName);
+    if (!fileExists(cacheFileName.c_str()))
+        return false;
+
+    ScalarFileCache cache;
+    try {
+        ScalarFileCacheReader reader(cacheFileName.c_str());
+        if (!(reader.readRecordedFingerprint() == fileRef->fingerprint))
+            return false; // out of date
+        reader.readAll(cache);
+    }
+    catch (std::exception& e) {
+        LOG << "cannot use " << cacheFileName << ": " << e.what() << ", ";
+        return false;
+    }
+
+    // same output as when parsing the file, the cache is an implementation detail
+    LOG << "reading " << fileName << "... " << std::flush;
+    addResultsFromScalarCache(cache, fileRef);
+    LOG << "done\n";
+    return true;
+}
+
+void OmnetppResultFileLoader::addResultsFromScalarCache(const ScalarFileCache& cache, ResultFile *fileRef)
+{
+    // pool the strings and attribute sets the first time they are used
+    std::vector<int> moduleNameIndices(cache.strings.size(), -1); // into scalarModuleNameTable
+    std::vector<int> nameIndices(cache.strings.size(), -1); // into scalarNameTable
+    std::vector<const StringMap *> pooledAttrs(cache.attributeSets.size(), nullptr);
+    std::vector<int> attrsIndices(cache.attributeSets.size(), -1); // into scalarAttrsTable
+    auto getPooledAttrs = [&](int k) {
+        if (pooledAttrs[k] == nullptr)
+            pooledAttrs[k] = resultFileManager->getPooledAttributes(cache.attributeSets[k]);
+        return pooledAttrs[k];
+    };
+
+    for (const ScalarFileCache::RunData& run : cache.runs) {
+        // same as flush() does for "run" lines
+        LOG << run.runName << " " << std::flush;
+        Run *runRef = resultFileManager->getRunByName(run.runName.c_str());
+        if (!runRef) {
+            runRef = resultFileManager->addRun(run.runName);
+            runRef->attributes = run.attributes;
+            runRef->itervars = run.itervars;
+            runRef->configEntries = run.configEntries;
+        }
+        FileRun *fileRunRef = resultFileManager->getOrAddFileRun(fileRef, runRef);
+
+        ScalarColumns& scalars = fileRunRef->scalarColumns;
+        int numScalars = run.scalarValues.size();
+        scalars.moduleNameIndices.reserve(scalars.size() + numScalars);
+        scalars.nameIndices.reserve(scalars.size() + numScalars);
+        scalars.attrsIndices.reserve(scalars.size() + numScalars);
+        for (int i = 0; i < numScalars; i++) {
+            int& moduleNameIndex = moduleNameIndices[run.scalarModuleNames[i]];
+            if (moduleNameIndex == -1)
+                moduleNameIndex = resultFileManager->scalarModuleNameTable.insert(resultFileManager->moduleNames.insert(cache.strings[run.scalarModuleNames[i]]));
+            scalars.moduleNameIndices.push_back(moduleNameIndex);
+
+            int& nameIndex = nameIndices[run.scalarNames[i]];
+            if (nameIndex == -1)
+                nameIndex = resultFileManager->scalarNameTable.insert(resultFileManager->names.insert(cache.strings[run.scalarNames[i]]));
+            scalars.nameIndices.push_back(nameIndex);
+
+            int& attrsIndex = attrsIndices[run.scalarAttrs[i]];
+            if (attrsIndex == -1)
+                attrsIndex = resultFileManager->scalarAttrsTable.insert(getPooledAttrs(run.scalarAttrs[i]));
+            scalars.attrsIndices.push_back(attrsIndex);
+        }
+        scalars.values.insert(scalars.values.end(), run.scalarValues.begin(), run.scalarValues.end());
+
+        for (const ScalarFileCache::ParameterItem& item : run.parameters)
+            resultFileManager->addParameter(fileRunRef, cache.strings[item.moduleName].c_str(), cache.strings[item.name].c_str(), *getPooledAttrs(item.attrs), cache.strings[item.value]);
+        for (const ScalarFileCache::StatisticsItem& item : run.statistics)
+            resultFileManager->addStatistics(fileRunRef, cache.strings[item.moduleName].c_str(), cache.strings[item.name].c_str(), item.stat, *getPooledAttrs(item.attrs));
+        for (const ScalarFileCache::HistogramItem& item : run.histograms)
+            resultFileManager->addHistogram(fileRunRef, cache.strings[item.moduleName].c_str(), cache.strings[item.name].c_str(), item.stat, item.bins, *getPooledAttrs(item.attrs));
+    }
+}
+
+void OmnetppResultFileLoader::writeScalarCache(ScalarFileCacheWriter& cacheWriter, const char *fileName, ResultFile *fileRef)
+{
+    // vectors are not supported by the cache format; they normally only occur in .vec files
+    for (FileRun *fileRun : fileRef->fileRuns)
+        if (!fileRun->vectorResults.empty())
+            return;
+
+    // don't cache a file that was modified while being parsed (e.g. still being written)
+    if (!(readFileFingerprint(fileName) == fileRef->fingerprint))
+        return;
+
+    // failure to write the cache is not an error, the file can still be parsed next time
+    std::string cacheFileName = ScalarFileCache::getCacheFileName(fileName);
+    try {
+        LOG << "writing " << cacheFileName << "... " << std::flush;
+        cacheWriter.write(cacheFileName.c_str(), fileRef->fingerprint);
+        LOG << "done\n";
+    }
+    catch (std::exception& e) {
+        LOG << "failed: " << e.what() << "\n";
+    }
+}
+
 }  // namespace scave
 }  // namespace omnetpp
@@ -44,6 +44,9 @@
 namespace omnetpp {
 namespace scave {
 
+class ScalarFileCache;
+class ScalarFileCacheWriter;
+
 class SCAVE_API OmnetppResultFileLoader : public IResultFileLoader
 {
     using VectorInfo = VectorFileIndex::VectorInfo;
@@ -51,6 +54,8 @@ class SCAVE_API OmnetppResultFileLoader : public IResultFileLoader
   protected:
     int indexingOption;
     int lockfileOption;
+    int scalarCacheOption;
+    bool memoryMapped;
     bool verbose;
     InterruptedFlag *interrupted;
 
@@ -59,6 +64,7 @@ class SCAVE_API OmnetppResultFileLoader : public IResultFileLoader
         const char *fileName = nullptr;
         int64_t lineNo = 0;
         FileRun *fileRunRef = nullptr;
+        ScalarFileCacheWriter *cacheWriter = nullptr; // if non-null, parsed items are also added here
 
         enum {NONE, RUN, SCALAR, PARAMETER, VECTOR, STATISTICS, HISTOGRAM} currentItemType = NONE;
         std::string runName;
@@ -86,8 +92,11 @@ class SCAVE_API OmnetppResultFileLoader : public IResultFileLoader
         std::vector<double> binValues;
     };
   protected:
-    void doLoadFile(const char *fileName, ResultFile *fileRef);
+    void doLoadFile(const char *fileName, ResultFile *fileRef, ScalarFileCacheWriter *cacheWriter=nullptr);
     void loadVectorsFromIndex(const char *filename, ResultFile *fileRef);
+    bool loadFromScalarCache(const char *fileName, ResultFile *fileRef);
+    void addResultsFromScalarCache(const ScalarFileCache& cache, ResultFile *fileRef);
+    void writeScalarCache(ScalarFileCacheWriter& cacheWriter, const char *fileName, ResultFile *fileRef);
     void processLine(char **vec, int numTokens, ParseContext& ctx);
     void flush(ParseContext& ctx);
     void resetFields(ParseContext& ctx);
@@ -71,6 +71,9 @@ string OmnetppVectorFileExporterType::getXswtForm() const
             "         <button x:id='skipSpecialValues' text='Skip special values (NaN, +/-Inf)' x:style='CHECK' selection='false'>\n"
             "           <layoutData x:class='GridData' horizontalSpan='2'/>\n"
             "         </button>\n"
+            "         <button x:id='binary' text='Binary format (compressed data blocks, full precision)' x:style='CHECK' selection='false'>\n"
+            "           <layoutData x:class='GridData' horizontalSpan='2'/>\n"
+            "         </button>\n"
             "         <label text='Data precision:'/>\n"
             "         <spinner x:id='precision' x:style='BORDER' minimum='1' maximum='16' textLimit='2' selection='14'>\n"
             "           <layoutData x:class='GridData' widthHint='100'/>\n"
@@ -86,6 +89,7 @@ StringMap OmnetppVectorFileExporterType::getSupportedOptions() const
     StringMap options {
         {"skipSpecialValues", "Allow and skip NaN and +/-Inf values as simulation time in vectors."},
         {"precision", "The number of significant digits for floating-point values (double). The maximum value is ~15."},
+        {"binary", "Write vector data as compressed binary blocks (vector file version 4) instead of text. Values are stored with full precision."},
         {"overallMemoryLimitMB", "Maximum amount of memory allowed to use, in megabytes. Use zero for no limit."},
         {"perVectorMemoryLimitKB", "Maximum amount of memory allowed to use per vector by the writer for output buffering, in kilobytes. Use zero for no limit."},
     };
@@ -107,6 +111,8 @@ void OmnetppVectorFileExporter::setOption(const std::string& key, const std::str
         setPrecision(opp_atol(value.c_str()));
     else if (key == "skipSpecialValues")
         setSkipSpecialValues(translateOptionValue(BOOLS,value));
+    else if (key == "binary")
+        setBinary(translateOptionValue(BOOLS,value));
     else if (key == "overallMemoryLimitMB")
         setOverallMemoryLimit(opp_atol(value.c_str()) * 1024*1024);
     else if (key == "perVectorMemoryLimitKB")
@@ -142,31 +148,30 @@ void OmnetppVectorFileExporter::saveResults(const std::string& fileName, ResultF
             vectorHandles[i] = writer.registerVector(vector->getModuleName(), vector->getName(), vector->getAttributes(), perVectorMemoryLimit, hasEventNumbers);
         }
 
-        // write data for all vectors
-        std::vector<XYArray *> xyArrays = readVectorsIntoArrays(manager, filteredList, true, true, std::numeric_limits<size_t>::max(), vectorStartTime, vectorEndTime);
-        Assert((int)xyArrays.size() == filteredList.size());
-
-        for (int i = 0; i < filteredList.size(); i++) {
-            ID id = filteredList.get(i);
-            const VectorResult *vector = manager->getVector(id);
-            void *vectorHandle = vectorHandles[i];
-            XYArray *array = xyArrays[i];
-            int length = array->length();
-            bool hasPreciseX = array->hasPreciseX();
-            for (int j = 0; j < length; j++) {
-                const BigDecimal time = hasPreciseX ? array->getPreciseX(j) : BigDecimal(array->getX(j));
-                if (!time.isSpecial())
-                    writer.recordInVector(vectorHandle, array->getEventNumber(j), time.getIntValue(), time.getScale(), array->getY(j));
-                else if (!skipSpecialValues) {
-                    std::string vectorName = vector->getModuleName() + "." + vector->getName();
-                    throw opp_runtime_error("Illegal value (NaN of Inf) encountered as time while exporting vector %s; "
-                            "use skipSpecialValues=true to turn off this error message", vectorName.c_str());
+        // write data for all vectors, loading them a group at a time
+        int offset = 0; // index of the group's first vector in filteredList
+        readVectorsInGroups(manager, filteredList, true, true, [&](const IDList& group, const std::vector<XYArray *>& xyArrays) {
+            Assert((int)xyArrays.size() == group.size());
+            for (int i = 0; i < group.size(); i++) {
+                ID id = group.get(i);
+                const VectorResult *vector = manager->getVector(id);
+                void *vectorHandle = vectorHandles[offset + i];
+                XYArray *array = xyArrays[i];
+                int length = array->length();
+                bool hasPreciseX = array->hasPreciseX();
+                for (int j = 0; j < length; j++) {
+                    const BigDecimal time = hasPreciseX ? array->getPreciseX(j) : BigDecimal(array->getX(j));
+                    if (!time.isSpecial())
+                        writer.recordInVector(vectorHandle, array->getEventNumber(j), time.getIntValue(), time.getScale(), array->getY(j));
+                    else if (!skipSpecialValues) {
+                        std::string vectorName = vector->getModuleName() + "." + vector->getName();
+                        throw opp_runtime_error("Illegal value (NaN of Inf) encountered as time while exporting vector %s; "
+                                "use skipSpecialValues=true to turn off this error message", vectorName.c_str());
+                    }
                 }
             }
-        }
-
-        for (auto xyArray : xyArrays)
-            delete xyArray;
+            offset += group.size();
+        }, vectorMemoryLimit, numThreads, vectorStartTime, vectorEndTime);
 
         writer.endRecordingForRun();
     }
@@ -49,6 +49,8 @@ class SCAVE_API OmnetppVectorFileExporter : public Exporter
         size_t getOverallMemoryLimit() const {return writer.getOverallMemoryLimit();}
         void setPerVectorMemoryLimit(size_t n) {perVectorMemoryLimit = n;}
         size_t getPerVectorMemoryLimit() const {return perVectorMemoryLimit;}
+        void setBinary(bool b) {writer.setBinary(b);}
+        bool getBinary() const {return writer.isBinary();}
 
         virtual void setOption(const std::string& key, const std::string& value);
         virtual void saveResults(const std::string& fileName, ResultFileManager *manager, const IDList& idlist, IProgressMonitor *monitor=nullptr);
@@ -35,6 +35,7 @@
 #include "opp_scavetool.h"
 #include "vectorfileindex.h"
 #include "vectorfileindexer.h"
+#include "scalarfilecache.h"
 
 
 using namespace std;
@@ -63,7 +64,7 @@ void ScaveTool::printHelpPage(const std::string& page)
         help.line("Commands:");
         help.option("q, query", "Query the contents of result files");
         help.option("x, export", "Export results in various formats");
-        help.option("i, index", "Generate index files (.vci) for vector files");
+        help.option("i, index", "Generate index files (.vci) for vector files, and cache files (.sci) for scalar files");
         help.option("h, help", "Print help text");
         help.line();
         help.para("The <files> argument accepts directories and glob patterns as well, in addition to file names. "
@@ -103,7 +104,8 @@ void ScaveTool::printHelpPage(const std::string& page)
                     "  'runnumber'   Displays ${configname} ${runnumber}\n"
                     "  'itervars'    Displays ${configname} ${iterationvars} ${repetition}\n"
                     "  'experiment'  Displays ${experiment} ${measurement} ${replication}\n");
-        help.option("-k, --no-indexing", "Disallow automatic indexing of vector files");
+        help.option("-k, --no-indexing", "Disallow automatic indexing of vector files and caching of scalar files");
+        help.option("-J, --jobs <n>", "Load the input files using <n> threads; 0 means the number of CPU cores. The default is 1.");
         help.option("-v, --verbose", "Print info about progress (verbose)");
         help.line();
         help.para("The <files> argument accepts directories and glob/globstar patterns as well, in addition to file names. See main help page for details.");
@@ -122,7 +124,9 @@ void ScaveTool::printHelpPage(const std::string& page)
         help.option("-F <format>", "Selects the exporter. The exporter's operation may further be customized via -x options.");
         help.option("-x <key>=<value>", "Option for the exporter. This option may occur multiple times.");
         help.option("--<key>=<value>", "Same as -x <key>=<value>.");
-        help.option("-k, --no-indexing", "Disallow automatic indexing of vector files");
+        help.option("-k, --no-indexing", "Disallow automatic indexing of vector files and caching of scalar files");
+        help.option("-J, --jobs <n>", "Load the input files and read vector data using <n> threads; 0 means the number of CPU cores. The default is 1.");
+        help.option("--memory-limit <size>", "Approximate amount of vector data to hold in memory at a time, e.g. 500MiB. Vectors are read and exported in groups that fit into this limit; a vector larger than the limit is still read in one piece. The default is 1GiB.");
         help.option("-v, --verbose", "Print info about progress (verbose)");
         help.line();
         help.para("Supported export formats: " + opp_join(ExporterFactory::getSupportedFormats(), ", ", '\''));
@@ -149,12 +153,15 @@ void ScaveTool::printHelpPage(const std::string& page)
         help.line();
     }
     else if (page == "i" || page == "index") {
-        help.para("Usage: opp_scavetool index [<options>] <output-vector-files>");
-        help.para("Generate index files (.vci) for vector files. Note that this command "
-                  "is usually not needed, as other opp_scavetool commands automatically "
-                  "create indices for loaded vector files if they are missing or out of date, "
-                  "unless indexing is explicitly disabled.");
+        help.para("Usage: opp_scavetool index [<options>] <output-vector-and-scalar-files>");
+        help.para("Generate index files (.vci) for vector files, and cache files (.sci) for "
+                  "scalar files. Cache files are a binary form of the scalar file's contents, "
+                  "and are much faster to load. Note that this command is usually not needed, "
+                  "as other opp_scavetool commands automatically create indices and cache files "
+                  "for loaded files if they are missing or out of date, unless indexing is "
+                  "explicitly disabled.");
         help.line("Options:");
+        help.option("-s, --summaries", "Also generate summary files (.vcs) for vector files. They hold multi-resolution min/max/mean summaries of the vectors, which make plotting long vectors fast. Existing summary files are always kept up to date together with the index files.");
         help.option("-v, --verbose", "Print info about progress (verbose)");
         help.para("The <files> argument accepts directories and glob/globstar patterns as well, in addition to file names. See main help page for details.");
         help.line();
@@ -208,7 +215,7 @@ void ScaveTool::printHelpPage(const std::string& page)
     }
 }
 
-void ScaveTool::loadFiles(ResultFileManager& manager, const vector<string>& fileNames, bool indexingAllowed, bool verbose)
+void ScaveTool::loadFiles(ResultFileManager& manager, const vector<string>& fileNames, bool indexingAllowed, int numThreads, bool verbose)
 {
     if (fileNames.empty()) {
         cerr << "opp_scavetool: Warning: No input files\n";
@@ -216,30 +223,31 @@ void ScaveTool::loadFiles(ResultFileManager& manager, const vector<string>& file
     }
 
     typedef ResultFileManager RFM;
-    int loadFlags = RFM::NEVER_RELOAD | (indexingAllowed ? RFM::ALLOW_INDEXING : RFM::ALLOW_LOADING_WITHOUT_INDEX) | RFM::SKIP_IF_LOCKED | (verbose ? RFM::VERBOSE : 0);
+    int loadFlags = RFM::NEVER_RELOAD | (indexingAllowed ? RFM::ALLOW_INDEXING : RFM::ALLOW_LOADING_WITHOUT_INDEX|RFM::READ_ONLY_SCALAR_CACHE) | RFM::SKIP_IF_LOCKED | RFM::MEMORY_MAP_FILES | (verbose ? RFM::VERBOSE : 0);
 
-    // load files
+    // collect files
+    std::vector<std::string> filesToLoad;
     for (auto& i : fileNames) {
         const char *fileArg = i.c_str();
-        std::vector<std::string> filesToLoad;
 
         if (isDirectory(fileArg)) {
-            filesToLoad = collectFilesInDirectory(fileArg, true, ".sca");
+            addAll(filesToLoad, collectFilesInDirectory(fileArg, true, ".sca"));
             addAll(filesToLoad, collectFilesInDirectory(fileArg, true, ".vec"));
         }
         else if (strchr(fileArg, '*') != nullptr || strchr(fileArg, '?') != nullptr) {
-            filesToLoad = collectMatchingFiles(fileArg);
-            if (filesToLoad.empty())
-                filesToLoad.push_back(fileArg); // like "bash" does; allows reporting errors in the pattern ("**/foo*.vec: no such file")
+            std::vector<std::string> matchingFiles = collectMatchingFiles(fileArg);
+            if (matchingFiles.empty())
+                matchingFiles.push_back(fileArg); // like "bash" does; allows reporting errors in the pattern ("**/foo*.vec: no such file")
+            addAll(filesToLoad, matchingFiles);
         }
         else {
             filesToLoad.push_back(fileArg);
         }
-
-        for (auto& fileName : filesToLoad)
-            manager.loadFile(fileName.c_str(), fileName.c_str(), loadFlags, nullptr);
     }
 
+    // load files
+    manager.loadFiles(filesToLoad, std::vector<std::string>(), loadFlags, nullptr, numThreads);
+
     if (verbose)
         cout << manager.getFiles().size() << " file(s) loaded\n";
 }
@@ -368,6 +376,7 @@ void ScaveTool::queryCommand(int argc, char **argv)
     bool opt_useTabs = false;
     bool opt_verbose = false;
     bool opt_indexingAllowed = true;
+    int opt_numThreads = 1;
 
     // parse options
     bool endOpts = false;
@@ -419,6 +428,8 @@ void ScaveTool::queryCommand(int argc, char **argv)
             opt_useTabs = true;
         else if (opt == "-k" || opt == "--no-indexing")
             opt_indexingAllowed = false;
+        else if ((opt == "-J" || opt == "--jobs") && i != argc-1)
+            opt_numThreads = opp_atol(argv[++i]);
         else if (opt == "-v" || opt == "--verbose")
             opt_verbose = true;
         else if (opt[0] != '-')
@@ -447,7 +458,7 @@ void ScaveTool::queryCommand(int argc, char **argv)
 
     // load files
     ResultFileManager resultFileManager;
-    loadFiles(resultFileManager, opt_fileNames, opt_indexingAllowed, opt_verbose);
+    loadFiles(resultFileManager, opt_fileNames, opt_indexingAllowed, opt_numThreads, opt_verbose);
 
     // filter statistics
     IDList results = resultFileManager.getAllItems(opt_includeFields);
@@ -664,6 +675,17 @@ inline double parseTime(const char *str)
         return UnitConversion::convertUnit(d, actualUnit.c_str(), "s");
 }
 
+inline size_t parseMemorySize(const char *str)
+{
+    std::string actualUnit;
+    double d = UnitConversion::parseQuantity(str, actualUnit);
+    if (!actualUnit.empty())
+        d = UnitConversion::convertUnit(d, actualUnit.c_str(), "B");
+    if (d <= 0)
+        throw opp_runtime_error("Invalid memory limit '%s'", str);
+    return (size_t)d;
+}
+
 void ScaveTool::exportCommand(int argc, char **argv)
 {
     vector<string> opt_fileNames;
@@ -672,9 +694,11 @@ void ScaveTool::exportCommand(int argc, char **argv)
     int opt_resultTypeFilter = ResultFileManager::SCALAR | ResultFileManager::VECTOR | ResultFileManager::STATISTICS | ResultFileManager::HISTOGRAM | ResultFileManager::PARAMETER;
     bool opt_verbose = false;
     bool opt_indexingAllowed = true;
+    int opt_numThreads = 1;
     bool opt_includeFields = false;
     double opt_vectorStartTime = -INFINITY;
     double opt_vectorEndTime = INFINITY;
+    size_t opt_memoryLimit = 0;
     string opt_fileName;
     string opt_exporter;
     vector<string> opt_exporterOptions;
@@ -709,6 +733,10 @@ void ScaveTool::exportCommand(int argc, char **argv)
             opt_exporterOptions.push_back(opt.substr(2));
         else if (opt == "-k" || opt == "--no-indexing")
             opt_indexingAllowed = false;
+        else if ((opt == "-J" || opt == "--jobs") && i != argc-1)
+            opt_numThreads = opp_atol(argv[++i]);
+        else if (opt == "--memory-limit" && i != argc-1)
+            opt_memoryLimit = parseMemorySize(argv[++i]);
         else if (opt == "-v" || opt == "--verbose")
             opt_verbose = true;
         else if (opt[0] == '-' && opt[1]== '-' && opt[2])
@@ -743,6 +771,9 @@ void ScaveTool::exportCommand(int argc, char **argv)
 
     exporter->setVectorStartTime(opt_vectorStartTime);
     exporter->setVectorEndTime(opt_vectorEndTime);
+    if (opt_memoryLimit != 0)
+        exporter->setVectorMemoryLimit(opt_memoryLimit);
+    exporter->setNumThreads(opt_numThreads);
 
     // resolve -T, filter by result type
     if (opt_resultTypeFilterStr != "")
@@ -750,7 +781,7 @@ void ScaveTool::exportCommand(int argc, char **argv)
 
     // load files
     ResultFileManager resultFileManager;
-    loadFiles(resultFileManager, opt_fileNames, opt_indexingAllowed, opt_verbose);
+    loadFiles(resultFileManager, opt_fileNames, opt_indexingAllowed, opt_numThreads, opt_verbose);
 
     // filter results
     IDList results = resultFileManager.getAllItems(opt_includeFields);
@@ -793,11 +824,14 @@ void ScaveTool::indexCommand(int argc, char **argv)
 {
     // process args
     bool opt_verbose = false;
+    bool opt_summaries = false;
     vector<string> opt_fileNames;
     for (int i = 0; i < argc; i++) {
         string opt = argv[i];
         if (opt == "-v" || opt == "--verbose")
             opt_verbose = true;
+        else if (opt == "-s" || opt == "--summaries")
+            opt_summaries = true;
         else if (opt[0] != '-')
             opt_fileNames.push_back(argv[i]);
         else
@@ -805,12 +839,17 @@ void ScaveTool::indexCommand(int argc, char **argv)
     }
 
     VectorFileIndexer indexer;
+    indexer.setGenerateSummaries(opt_summaries);
+    indexer.setMemoryMapped(true);
     int count = 0;
     for (int i = 0; i < (int)opt_fileNames.size(); i++) {
         const char *fileName = opt_fileNames[i].c_str();
         if (opt_verbose)
             cout << "indexing " << fileName << "... " << std::flush;
-        indexer.generateIndex(fileName);
+        if (ScalarFileCache::isScalarFile(fileName))
+            ScalarFileCache::generateCacheFile(fileName);
+        else
+            indexer.generateIndex(fileName);
         count++;
     }
 
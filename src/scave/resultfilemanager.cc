@@ -23,6 +23,10 @@
 #include <algorithm>
 #include <utility>
 #include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include "common/opp_ctype.h"
 #include "common/matchexpression.h"
 #include "common/patternmatcher.h"
@@ -43,6 +47,7 @@
 #include "omnetppresultfileloader.h"
 #include "sqliteresultfileloader.h"
 #include "vectorfileindex.h"
+#include "indexfileutils.h"
 #include "interruptedflag.h"
 
 
@@ -105,9 +110,22 @@ void ResultFileManager::clear()
     fileList.clear();
     filesByDisplayName.clear();
 
+    for (const StringMap *attrs : attrsPool)
+        delete attrs;
+    attrsPool.clear();
+    namesWithSuffixCache.clear();
+
     moduleNames.clear();
     names.clear();
     classNames.clear();
+
+    scalarModuleNameTable.clear();
+    scalarNameTable.clear();
+    scalarAttrsTable.clear();
+
+    std::lock_guard<std::mutex> guard(filterCacheMutex);
+    filterCache.clear();
+    filterCacheNumIDs = 0;
 }
 
 ResultFileList ResultFileManager::getFiles() const
@@ -155,12 +173,10 @@ ResultFileList ResultFileManager::getFilesForInput(const char *inputName) const
 
 const ResultItem *ResultFileManager::getItem(ID id, ScalarResult& buffer) const
 {
-    if (_fieldid(id) == 0)
+    if (_type(id) == SCALAR)
+        return getScalar(id, buffer);
+    else
         return getNonfieldItem(id);
-    else {
-        buffer = getFieldScalar(id);
-        return &buffer;
-    }
 }
 
 const ResultItem *ResultFileManager::getNonfieldItem(ID id) const
@@ -172,7 +188,7 @@ const ResultItem *ResultFileManager::getNonfieldItem(ID id) const
 
     try {
         switch (_type(id)) {
-            case SCALAR: return &getFileRunForID(id)->scalarResults.at(_pos(id));
+            case SCALAR: throw opp_runtime_error("ResultFileManager::getNonfieldItem(id): scalars are not stored as objects, use getItem(id, buffer) or getScalar(id, buffer)");
             case PARAMETER: return &getFileRunForID(id)->parameterResults.at(_pos(id));
             case VECTOR: return &getFileRunForID(id)->vectorResults.at(_pos(id));
             case STATISTICS: return &getFileRunForID(id)->statisticsResults.at(_pos(id));
@@ -437,14 +453,18 @@ IDListsByFile ResultFileManager::getPartitionByFile(const IDList& ids) const
     return IDListsByFile(map);
 }
 
-const ScalarResult *ResultFileManager::getNonfieldScalar(ID id) const
+ScalarResult ResultFileManager::getNonfieldScalar(ID id) const
 {
+    ScalarResult result;
     READER_MUTEX
     if (_type(id) != SCALAR)
         throw opp_runtime_error("ResultFileManager::getScalar(id): This item is not a scalar");
     if (_fieldid(id) != 0 || _hosttype(id) != 0)
         throw opp_runtime_error("ResultFileManager::getScalar(id): use getFieldScalar() for scalars which are a field of a statistic/histogram/vector");
-    return &getFileRunForID(id)->scalarResults.at(_pos(id));
+    if (_pos(id) >= getFileRunForID(id)->scalarColumns.size())
+        throw opp_runtime_error("ResultFileManager::getScalar(id): Invalid ID");
+    fillNonfieldScalar(result, id);
+    return result;
 }
 
 const char *ResultFileManager::getNameSuffixForFieldScalar(FieldNum fieldId)
@@ -475,6 +495,20 @@ ScalarResult ResultFileManager::getFieldScalar(ID id) const
     return result;
 }
 
+void ResultFileManager::fillNonfieldScalar(ScalarResult& scalar, ID id) const
+{
+    // internal method, READER_MUTEX and ID checks are left to the caller
+    FileRun *fileRun = fileRunList[_filerunid(id)];
+    const ScalarColumns& columns = fileRun->scalarColumns;
+    int pos = _pos(id);
+    scalar.fileRunRef = fileRun;
+    scalar.moduleNameRef = scalarModuleNameTable.get(columns.moduleNameIndices[pos]);
+    scalar.nameRef = scalarNameTable.get(columns.nameIndices[pos]);
+    scalar.attributes = scalarAttrsTable.get(columns.attrsIndices[pos]);
+    scalar.value = columns.values[pos];
+    scalar.ownID = id;
+}
+
 void ResultFileManager::fillFieldScalar(ScalarResult& scalar, ID id) const
 {
     READER_MUTEX
@@ -504,11 +538,33 @@ const std::string *ResultFileManager::getPooledNameWithSuffix(const std::string
 const ScalarResult *ResultFileManager::getScalar(ID id, ScalarResult& buffer) const
 {
     if (_fieldid(id) == 0)
-        return getNonfieldScalar(id);
-    else {
+        buffer = getNonfieldScalar(id);
+    else
         fillFieldScalar(buffer, id);
-        return &buffer;
+    return &buffer;
+}
+
+const std::string& ResultFileManager::uncheckedGetModuleName(ID id) const
+{
+    if (_type(id) == SCALAR) {
+        if (_fieldid(id) == 0)
+            return *scalarModuleNameTable.get(fileRunList[_filerunid(id)]->scalarColumns.moduleNameIndices[_pos(id)]);
+        id = _containingItemID(id); // field scalar has the same module as its containing result item
+    }
+    ScalarResult unused;
+    return uncheckedGetItem(id, unused)->getModuleName();
+}
+
+const std::string& ResultFileManager::uncheckedGetName(ID id) const
+{
+    if (_type(id) == SCALAR) {
+        if (_fieldid(id) == 0)
+            return *scalarNameTable.get(fileRunList[_filerunid(id)]->scalarColumns.nameIndices[_pos(id)]);
+        ScalarResult unused;
+        return *getPooledNameWithSuffix(&uncheckedGetItem(_containingItemID(id), unused)->getName(), (FieldNum)_fieldid(id));
     }
+    ScalarResult unused;
+    return uncheckedGetItem(id, unused)->getName();
 }
 
 const ParameterResult *ResultFileManager::getParameter(ID id) const
@@ -575,6 +631,11 @@ const char *ResultFileManager::getItemProperty(ID id, const char *propertyName)
             if (strcmp(propertyName, Scave::MODULE) == 0) {
                 if (isField(id))
                     return getContainingItem(id)->getModuleName().c_str(); // field scalar has the same module as its containing result item
+                else if (_type(id) == SCALAR) {
+                    READER_MUTEX
+                    const ScalarColumns& columns = getFileRunForID(id)->scalarColumns;
+                    return scalarModuleNameTable.get(columns.moduleNameIndices.at(_pos(id)))->c_str();
+                }
                 else
                     return getNonfieldItem(id)->getModuleName().c_str();
             }
@@ -584,6 +645,11 @@ const char *ResultFileManager::getItemProperty(ID id, const char *propertyName)
             if (strcmp(propertyName, Scave::NAME) == 0) {
                 if (isField(id))
                     return getPooledNameWithSuffix(&getContainingItem(id)->getName(), (FieldNum)_fieldid(id))->c_str();
+                else if (_type(id) == SCALAR) {
+                    READER_MUTEX
+                    const ScalarColumns& columns = getFileRunForID(id)->scalarColumns;
+                    return scalarNameTable.get(columns.nameIndices.at(_pos(id)))->c_str();
+                }
                 else
                     return getNonfieldItem(id)->getName().c_str();
             }
@@ -636,7 +702,7 @@ IDList ResultFileManager::getItems(const FileRunList& fileRuns, int types, bool
             if (types & PARAMETER)
                 makeIDs(out, fileRun, fileRun->parameterResults.size(), PARAMETER);
             if (types & SCALAR) {
-                makeIDs(out, fileRun, fileRun->scalarResults.size(), SCALAR);
+                makeIDs(out, fileRun, fileRun->scalarColumns.size(), SCALAR);
                 if (includeFields) {
                     makeFieldScalarIDs(out, fileRun, fileRun->statisticsResults.size(), HOSTTYPE_STATISTICS, StatisticsResult::getAvailableFields());
                     makeFieldScalarIDs(out, fileRun, fileRun->histogramResults.size(), HOSTTYPE_HISTOGRAM, HistogramResult::getAvailableFields());
@@ -710,14 +776,17 @@ ID ResultFileManager::getItemByName(FileRun *fileRunRef, const char *module, con
     if (!nameRef)
         return 0;
 
-    //TODO could use pointer comparisons (const char* pointing into a stringpool) instead of string comparisons
-    ScalarResults& scalarResults = fileRunRef->scalarResults;
-    for (int i = 0; i < (int)scalarResults.size(); i++) {
-        const ResultItem& d = scalarResults[i];
-        if (d.getModuleName() == *moduleNameRef && d.getName() == *nameRef)
-            return _mkID(SCALAR, fileRunRef->id, i);
+    int moduleNameIndex = scalarModuleNameTable.find(moduleNameRef);
+    int nameIndex = scalarNameTable.find(nameRef);
+    if (moduleNameIndex != -1 && nameIndex != -1) {
+        const ScalarColumns& scalarColumns = fileRunRef->scalarColumns;
+        for (int i = 0; i < scalarColumns.size(); i++)
+            if (scalarColumns.moduleNameIndices[i] == moduleNameIndex && scalarColumns.nameIndices[i] == nameIndex)
+                return _mkID(SCALAR, fileRunRef->id, i);
     }
 
+    //TODO could use pointer comparisons (const char* pointing into a stringpool) instead of string comparisons
+
     ParameterResults& parameterResults = fileRunRef->parameterResults;
     for (int i = 0; i < (int)parameterResults.size(); i++) {
         const ResultItem& d = parameterResults[i];
@@ -832,21 +901,30 @@ IDList ResultFileManager::filterIDList(const IDList& idlist,
     bool patMatchModule = PatternMatcher::containsWildcards(moduleFilter);
     bool patMatchName = PatternMatcher::containsWildcards(nameFilter);
 
-    PatternMatcher *modulePattern = nullptr;
-    if (patMatchModule) {
-        modulePattern = new PatternMatcher(moduleFilter, false, true, true);  // case-sensitive full-string match
-    }
-    PatternMatcher *namePattern = nullptr;
-    if (patMatchName) {
-        namePattern = new PatternMatcher(nameFilter, false, true, true);  // case-sensitive full-string match
-    }
-
-    // TODO: if there's no wildcard, find string pointers in the stringsets
-    // in advance, then we don't have to do strcmp().
+    std::unique_ptr<PatternMatcher> modulePattern;
+    if (patMatchModule)
+        modulePattern.reset(new PatternMatcher(moduleFilter, false, true, true));  // case-sensitive full-string match
+    std::unique_ptr<PatternMatcher> namePattern;
+    if (patMatchName)
+        namePattern.reset(new PatternMatcher(nameFilter, false, true, true));  // case-sensitive full-string match
 
     // iterate over all values and add matching ones to "out".
     // we can exploit the fact that ResultFileManager contains the data in the order
     // they were read from file, i.e. grouped by runs
+    auto moduleMatches = [&](const std::string& moduleName) {
+        return !moduleFilter || !moduleFilter[0] ||
+            (patMatchModule ? modulePattern->matches(moduleName.c_str()) : moduleName == moduleFilter);
+    };
+    auto nameMatches = [&](const std::string& name) {
+        return !nameFilter || !nameFilter[0] ||
+            (patMatchName ? namePattern->matches(name.c_str()) : name == nameFilter);
+    };
+
+    // for (non-field) scalars, match results are cached per module name and
+    // name index, so each distinct string is matched only once (-1 = unknown)
+    std::vector<signed char> scalarModuleNameMatches(scalarModuleNameTable.size(), -1);
+    std::vector<signed char> scalarNameMatches(scalarNameTable.size(), -1);
+
     std::vector<ID> out;
     FileRun *lastFileRunRef = nullptr;
     bool lastFileRunMatched = false;
@@ -862,18 +940,26 @@ IDList ResultFileManager::filterIDList(const IDList& idlist,
                 continue;
         }
 
-        const ResultItem *item = getItem(id, buffer);
-
-        if (moduleFilter && moduleFilter[0] &&
-            (patMatchModule ? !modulePattern->matches(item->getModuleName().c_str())
-             : strcmp(item->getModuleName().c_str(), moduleFilter))
-            )
-            continue;  // no match
+        if (_type(id) == SCALAR && _fieldid(id) == 0) {
+            const ScalarColumns& columns = getFileRunForID(id)->scalarColumns;
+            int pos = _pos(id);
+            if (pos >= columns.size())
+                throw opp_runtime_error("ResultFileManager::filterIDList(): Invalid ID");
+            signed char& moduleMatch = scalarModuleNameMatches[columns.moduleNameIndices[pos]];
+            if (moduleMatch == -1)
+                moduleMatch = moduleMatches(*scalarModuleNameTable.get(columns.moduleNameIndices[pos]));
+            if (!moduleMatch)
+                continue;
+            signed char& nameMatch = scalarNameMatches[columns.nameIndices[pos]];
+            if (nameMatch == -1)
+                nameMatch = nameMatches(*scalarNameTable.get(columns.nameIndices[pos]));
+            if (nameMatch)
+                out.push_back(id);
+            continue;
+        }
 
-        if (nameFilter && nameFilter[0] &&
-            (patMatchName ? !namePattern->matches(item->getName().c_str())
-             : strcmp(item->getName().c_str(), nameFilter))
-            )
+        const ResultItem *item = getItem(id, buffer);
+        if (!moduleMatches(item->getModuleName()) || !nameMatches(item->getName()))
             continue;  // no match
 
         // everything matched, insert it.
@@ -915,17 +1001,205 @@ IDList ResultFileManager::filterIDList(const IDList& idlist, const Run *run, con
     return IDList(std::move(result));
 }
 
-class MatchableResultItem : public MatchExpression::Matchable
+/**
+ * A filter expression compiled for matching result items. Each pattern is
+ * matched only once against each distinct value it is applied to (pooled module
+ * name, name, attribute set, or the run/file properties of a FileRun), and the
+ * outcome is remembered. Values are identified by their index in
+ * ResultFileManager's tables or by their pooled pointer, which are stable
+ * while the read lock is held. An instance is meant to be used for one query.
+ */
+class CompiledResultFilter
 {
-    private:
-        const ResultFileManager *manager;
-        ID id;
-    public:
-        MatchableResultItem(const ResultFileManager *manager, ID id) : manager(manager), id(id) {}
-        virtual const char *getAsString() const override { return manager->getItemProperty(id, "name"); }
-        virtual const char *getAsString(const char *attribute) const override { return manager->getItemProperty(id, attribute); }
+  private:
+    enum FieldKind { FIELD_NAME, FIELD_MODULE, FIELD_ATTR, FIELD_FILERUN, FIELD_OTHER };
+
+    struct Leaf {
+        FieldKind kind;
+        std::string fieldName; // as accepted by getItemProperty(); attribute name for FIELD_ATTR
+        PatternMatcher matcher;
+        std::vector<signed char> matchesByIndex; // by scalar table index or filerun id; -1: not yet known
+        std::unordered_map<std::pair<const void *,int>, bool, pair_hash> matchesByPtr; // by pooled string or attribute map, plus field id
+    };
+
+    enum OpCode { LEAF, AND, OR, NOT };
+    struct Node {
+        OpCode code;
+        int leaf; // for LEAF
+        int arg1, arg2; // for AND, OR, NOT
+    };
+
+    class Parser : public MatchExpression {
+      public:
+        std::vector<Elem> parse(const char *pattern) {return parsePattern(pattern);}
+    };
+
+    typedef ResultFileManager RFM;
+    const ResultFileManager *manager;
+    std::vector<Leaf> leaves;
+    std::vector<Node> nodes; // root is the last one
+    ScalarResult buffer;
+
+  private:
+    void checkID(ID id) const;
+    bool evaluate(int nodeIndex, ID id);
+    bool matches(Leaf& leaf, ID id);
+    bool matchesAttr(Leaf& leaf, const StringMap *attrs);
+
+  public:
+    CompiledResultFilter(const ResultFileManager *manager, const char *pattern);
+    bool matches(ID id) {checkID(id); return evaluate(nodes.size()-1, id);}
 };
 
+CompiledResultFilter::CompiledResultFilter(const ResultFileManager *manager, const char *pattern) : manager(manager)
+{
+    std::vector<MatchExpression::Elem> elems = Parser().parse(pattern);
+    std::vector<int> stack;
+    for (auto& e : elems) {
+        switch (e.type) {
+            case MatchExpression::Elem::PATTERN: {
+                Leaf leaf;
+                const char *field = e.fieldname.empty() ? Scave::NAME : e.fieldname.c_str();
+                leaf.fieldName = field;
+                leaf.matcher.setPattern(e.pattern.c_str(), false, true, true); // full-string, case-sensitive match
+                if (strcmp(field, Scave::NAME) == 0) {
+                    leaf.kind = FIELD_NAME;
+                    leaf.matchesByIndex.resize(manager->scalarNameTable.size(), -1);
+                }
+                else if (strcmp(field, Scave::MODULE) == 0) {
+                    leaf.kind = FIELD_MODULE;
+                    leaf.matchesByIndex.resize(manager->scalarModuleNameTable.size(), -1);
+                }
+                else if (strncmp(field, Scave::ATTR_PREFIX, strlen(Scave::ATTR_PREFIX)) == 0) {
+                    leaf.kind = FIELD_ATTR;
+                    leaf.fieldName = field + strlen(Scave::ATTR_PREFIX);
+                }
+                else if (strcmp(field, Scave::FILE) == 0 || strcmp(field, Scave::RUN) == 0 ||
+                        strncmp(field, Scave::RUNATTR_PREFIX, strlen(Scave::RUNATTR_PREFIX)) == 0 ||
+                        strncmp(field, Scave::ITERVAR_PREFIX, strlen(Scave::ITERVAR_PREFIX)) == 0 ||
+                        strncmp(field, Scave::CONFIG_PREFIX, strlen(Scave::CONFIG_PREFIX)) == 0) {
+                    leaf.kind = FIELD_FILERUN;
+                    leaf.matchesByIndex.resize(manager->fileRunList.size(), -1);
+                }
+                else
+                    leaf.kind = FIELD_OTHER; // "type", "isfield", or invalid (reported by getItemProperty())
+                leaves.push_back(std::move(leaf));
+                nodes.push_back(Node{LEAF, (int)leaves.size()-1, -1, -1});
+                break;
+            }
+            case MatchExpression::Elem::AND:
+            case MatchExpression::Elem::OR: {
+                Assert(stack.size() >= 2);
+                int arg2 = stack.back(); stack.pop_back();
+                int arg1 = stack.back(); stack.pop_back();
+                nodes.push_back(Node{e.type == MatchExpression::Elem::AND ? AND : OR, -1, arg1, arg2});
+                break;
+            }
+            case MatchExpression::Elem::NOT: {
+                Assert(!stack.empty());
+                int arg = stack.back(); stack.pop_back();
+                nodes.push_back(Node{NOT, -1, arg, -1});
+                break;
+            }
+            default:
+                throw opp_runtime_error("Malformed filter expression: Unknown element type");
+        }
+        stack.push_back(nodes.size()-1);
+    }
+    if (stack.size() != 1 || stack.back() != (int)nodes.size()-1)
+        throw opp_runtime_error("Malformed filter expression");
+}
+
+void CompiledResultFilter::checkID(ID id) const
+{
+    FileRun *fileRun = manager->getFileRunForID(id); // checks for stale ID
+    int type = RFM::_type(id);
+    int numItems;
+    if (type == RFM::SCALAR && RFM::_fieldid(id) != 0)
+        type = RFM::getTypeOf(RFM::_containingItemID(id));
+    switch (type) {
+        case RFM::SCALAR: numItems = manager->getNumScalarsInFileRun(fileRun); break;
+        case RFM::PARAMETER: numItems = manager->getNumParametersInFileRun(fileRun); break;
+        case RFM::VECTOR: numItems = manager->getNumVectorsInFileRun(fileRun); break;
+        case RFM::STATISTICS: numItems = manager->getNumStatisticsInFileRun(fileRun); break;
+        case RFM::HISTOGRAM: numItems = manager->getNumHistogramsInFileRun(fileRun); break;
+        default: throw opp_runtime_error("ResultFileManager: Invalid ID: Wrong type");
+    }
+    if (RFM::_pos(id) >= numItems)
+        throw opp_runtime_error("ResultFileManager: Invalid ID");
+}
+
+bool CompiledResultFilter::evaluate(int nodeIndex, ID id)
+{
+    const Node& node = nodes[nodeIndex];
+    switch (node.code) {
+        case LEAF: return matches(leaves[node.leaf], id);
+        case AND: return evaluate(node.arg1, id) && evaluate(node.arg2, id);
+        case OR: return evaluate(node.arg1, id) || evaluate(node.arg2, id);
+        case NOT: return !evaluate(node.arg1, id);
+        default: throw opp_runtime_error("Invalid node in compiled filter expression");
+    }
+}
+
+bool CompiledResultFilter::matches(Leaf& leaf, ID id)
+{
+    if (RFM::_type(id) == RFM::SCALAR && RFM::_fieldid(id) == 0 && leaf.kind != FIELD_FILERUN && leaf.kind != FIELD_OTHER) {
+        // read the scalar columns directly
+        const ScalarColumns& columns = manager->fileRunList[RFM::_filerunid(id)]->scalarColumns;
+        int pos = RFM::_pos(id);
+        if (leaf.kind == FIELD_ATTR)
+            return matchesAttr(leaf, manager->scalarAttrsTable.get(columns.attrsIndices[pos]));
+        bool isName = leaf.kind == FIELD_NAME;
+        int index = isName ? columns.nameIndices[pos] : columns.moduleNameIndices[pos];
+        signed char& slot = leaf.matchesByIndex[index];
+        if (slot == -1)
+            slot = leaf.matcher.matches((isName ? manager->scalarNameTable.get(index) : manager->scalarModuleNameTable.get(index))->c_str());
+        return slot;
+    }
+
+    switch (leaf.kind) {
+        case FIELD_NAME:
+        case FIELD_MODULE:
+        case FIELD_ATTR: {
+            // field scalars share the module name and attributes of their containing item,
+            // and their names are derived from its name
+            int fieldId = RFM::_fieldid(id);
+            const ResultItem *item = manager->uncheckedGetItem(fieldId == 0 ? id : RFM::_containingItemID(id), buffer);
+            if (leaf.kind == FIELD_ATTR)
+                return matchesAttr(leaf, &item->getAttributes());
+            if (leaf.kind == FIELD_MODULE)
+                fieldId = 0;
+            const std::string *str = leaf.kind == FIELD_NAME ? &item->getName() : &item->getModuleName();
+            auto key = std::make_pair((const void *)str, fieldId);
+            auto it = leaf.matchesByPtr.find(key);
+            if (it != leaf.matchesByPtr.end())
+                return it->second;
+            if (fieldId != 0)
+                str = manager->getPooledNameWithSuffix(str, (RFM::FieldNum)fieldId);
+            return leaf.matchesByPtr[key] = leaf.matcher.matches(str->c_str());
+        }
+        case FIELD_FILERUN: {
+            signed char& slot = leaf.matchesByIndex[RFM::_filerunid(id)];
+            if (slot == -1)
+                slot = leaf.matcher.matches(manager->getItemProperty(id, leaf.fieldName.c_str()));
+            return slot;
+        }
+        default:
+            return leaf.matcher.matches(manager->getItemProperty(id, leaf.fieldName.c_str()));
+    }
+}
+
+bool CompiledResultFilter::matchesAttr(Leaf& leaf, const StringMap *attrs)
+{
+    auto key = std::make_pair((const void *)attrs, 0);
+    auto it = leaf.matchesByPtr.find(key);
+    if (it != leaf.matchesByPtr.end())
+        return it->second;
+    auto attrIt = attrs->find(leaf.fieldName);
+    const std::string& value = attrIt == attrs->end() ? NULLSTRING : attrIt->second;
+    return leaf.matchesByPtr[key] = leaf.matcher.matches(value.c_str());
+}
+
 class MatchableRun : public MatchExpression::Matchable
 {
     private:
@@ -1093,27 +1367,92 @@ IDList ResultFileManager::filterIDList(const IDList& idlist, const char *pattern
     if (opp_isblank(pattern))  // no filter
         throw opp_runtime_error("Empty filter expression is not allowed");
 
-    MatchExpression matchExpr(pattern, false  /*dottedpath*/, true  /*fullstring*/, true  /*casesensitive*/);
-
     InterruptedFlag dummy;
     if (interrupted == nullptr)
         interrupted = &dummy;
 
     READER_MUTEX
+
+    IDList result;
+    bool useCache = filterCacheSize > 0 && (size_t)idlist.size() <= filterCacheCapacity;
+    int64_t hash = useCache ? idlist.hashCode64() : 0;
+    if (useCache && lookupFilterCache(idlist, hash, pattern, limit, result))
+        return result;
+
+    CompiledResultFilter filter(this, pattern);
+
     std::vector<ID> out;
     int count = 0;
     for (ID id : idlist) {
         if (interrupted->flag)
             throw InterruptedException("Result filtering interrupted");
-        MatchableResultItem matchable(this, id);
-        if (matchExpr.matches(&matchable)) {
+        if (filter.matches(id)) {
             out.push_back(id);
             count++;
             if (limit > 0 && count == limit)
                 break;
         }
     }
-    return IDList(std::move(out));
+    result = IDList(std::move(out));
+
+    if (useCache)
+        addToFilterCache(idlist, hash, pattern, limit, result);
+    return result;
+}
+
+bool ResultFileManager::lookupFilterCache(const IDList& idlist, int64_t hash, const char *pattern, int limit, IDList& result) const
+{
+    std::lock_guard<std::mutex> guard(filterCacheMutex);
+    if (filterCacheSerial != serial) {
+        filterCache.clear();
+        filterCacheNumIDs = 0;
+        filterCacheSerial = serial;
+    }
+    for (auto it = filterCache.begin(); it != filterCache.end(); ++it) {
+        if (it->inputHash == hash && it->limit == limit && it->pattern == pattern && it->input.asVector() == idlist.asVector()) {
+            filterCache.splice(filterCache.begin(), filterCache, it); // move to front
+            result = it->result;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ResultFileManager::addToFilterCache(const IDList& idlist, int64_t hash, const char *pattern, int limit, const IDList& result) const
+{
+    std::lock_guard<std::mutex> guard(filterCacheMutex);
+    if (filterCacheSerial != serial)
+        return;  // results changed meanwhile
+    size_t numIDs = idlist.size() + result.size();
+    if (numIDs > filterCacheCapacity)
+        return;
+    filterCache.push_front(FilterCacheEntry{pattern, limit, hash, idlist, result});
+    filterCacheNumIDs += numIDs;
+    trimFilterCache();
+}
+
+void ResultFileManager::trimFilterCache() const
+{
+    // evict least recently used entries
+    while (!filterCache.empty() && ((int)filterCache.size() > filterCacheSize || filterCacheNumIDs > filterCacheCapacity)) {
+        const FilterCacheEntry& entry = filterCache.back();
+        filterCacheNumIDs -= entry.input.size() + entry.result.size();
+        filterCache.pop_back();
+    }
+}
+
+void ResultFileManager::setFilterCacheSize(int size)
+{
+    std::lock_guard<std::mutex> guard(filterCacheMutex);
+    filterCacheSize = size;
+    trimFilterCache();
+}
+
+void ResultFileManager::setFilterCacheCapacity(size_t numIDs)
+{
+    std::lock_guard<std::mutex> guard(filterCacheMutex);
+    filterCacheCapacity = numIDs;
+    trimFilterCache();
 }
 
 RunList ResultFileManager::filterRunList(const RunList& runlist, const char *pattern) const
@@ -1194,15 +1533,145 @@ FileRun *ResultFileManager::getOrAddFileRun(ResultFile *file, Run *run)
     return fileRun;
 }
 
+ResultFile *ResultFileManager::mergeFile(ResultFile *stagingFile)
+{
+    // Metadata of runs that are already known are treated the same way as the
+    // loaders do it: vector index files overwrite them, SQLite files add to
+    // them (conflicting values are an error), other files leave them alone.
+    const char *fileSystemFileName = stagingFile->getFileSystemFilePath().c_str();
+    bool isSqlite = stagingFile->getFileType() == ResultFile::FILETYPE_SQLITE;
+    bool isLoadedFromIndex = !isSqlite && IndexFileUtils::isExistingVectorFile(fileSystemFileName) && IndexFileUtils::isIndexFileUpToDate(fileSystemFileName);
+    if (isSqlite) {
+        for (FileRun *stagingFileRun : stagingFile->fileRuns) {
+            Run *stagingRun = stagingFileRun->runRef;
+            Run *run = getRunByName(stagingRun->getRunName().c_str());
+            if (!run)
+                continue;
+            for (auto& pair : stagingRun->attributes)
+                if (run->attributes.find(pair.first) != run->attributes.end() && run->attributes[pair.first] != pair.second)
+                    throw opp_runtime_error("Cannot read SQLite result file '%s': Value of run attribute conflicts with previously loaded value", stagingFile->getFileName().c_str());
+            for (auto& pair : stagingRun->itervars)
+                if (run->itervars.find(pair.first) != run->itervars.end() && run->itervars[pair.first] != pair.second)
+                    throw opp_runtime_error("Cannot read SQLite result file '%s': Value of iteration variable conflicts with previously loaded value", stagingFile->getFileName().c_str());
+        }
+    }
+
+    ResultFile *file = addFile(stagingFile->getFilePath().c_str(), stagingFile->getFileSystemFilePath().c_str(), stagingFile->getFileType());
+    file->fingerprint = stagingFile->fingerprint; // as of parsing
+    file->inputName = stagingFile->inputName;
+
+    // the result items are moved over, and their pooled strings and attributes
+    // are re-interned; the maps ensure that each distinct one is looked up only once
+    typedef std::unordered_map<const std::string *, const std::string *> StringPtrMap;
+    StringPtrMap moduleNameMap, nameMap;
+    std::unordered_map<const StringMap *, const StringMap *> attrsMap;
+    auto reinternString = [](const std::string *str, StringPtrMap& map, ScaveStringPool& pool) {
+        const std::string *& result = map[str];
+        if (!result)
+            result = pool.insert(*str);
+        return result;
+    };
+    auto reinternAttrs = [&](const StringMap *attrs) {
+        const StringMap *& result = attrsMap[attrs];
+        if (!result)
+            result = getPooledAttributes(*attrs);
+        return result;
+    };
+    auto rebind = [&](ResultItem& item, FileRun *fileRun) {
+        item.fileRunRef = fileRun;
+        item.moduleNameRef = reinternString(item.moduleNameRef, moduleNameMap, moduleNames);
+        item.nameRef = reinternString(item.nameRef, nameMap, names);
+        item.attributes = reinternAttrs(item.attributes);
+    };
+
+    // scalar columns contain indices into the staging manager's tables, they need
+    // to be mapped to indices into ours (-1: not mapped yet)
+    const ResultFileManager *stagingManager = stagingFile->getResultFileManager();
+    std::vector<int> moduleNameIndexMap(stagingManager->scalarModuleNameTable.size(), -1);
+    std::vector<int> nameIndexMap(stagingManager->scalarNameTable.size(), -1);
+    std::vector<int> attrsIndexMap(stagingManager->scalarAttrsTable.size(), -1);
+    auto remapIndices = [](std::vector<int>& indices, std::vector<int>& indexMap, const std::function<int(int)>& mapIndex) {
+        for (int& index : indices) {
+            int& newIndex = indexMap[index];
+            if (newIndex == -1)
+                newIndex = mapIndex(index);
+            index = newIndex;
+        }
+    };
+
+    for (FileRun *stagingFileRun : stagingFile->fileRuns) {
+        Run *stagingRun = stagingFileRun->runRef;
+        Run *run = getRunByName(stagingRun->getRunName().c_str());
+        if (!run || isLoadedFromIndex) {
+            if (!run)
+                run = addRun(stagingRun->getRunName());
+            run->attributes = stagingRun->attributes;
+            run->itervars = stagingRun->itervars;
+            run->configEntries = stagingRun->configEntries;
+        }
+        else if (isSqlite) {
+            addAll(run->attributes, stagingRun->attributes);
+            addAll(run->itervars, stagingRun->itervars);
+            addAll(run->configEntries, stagingRun->configEntries);
+        }
+        FileRun *fileRun = addFileRun(file, run);
+
+        fileRun->scalarColumns = std::move(stagingFileRun->scalarColumns);
+        ScalarColumns& scalarColumns = fileRun->scalarColumns;
+        remapIndices(scalarColumns.moduleNameIndices, moduleNameIndexMap, [&](int index) {
+            return scalarModuleNameTable.insert(reinternString(stagingManager->scalarModuleNameTable.get(index), moduleNameMap, moduleNames));
+        });
+        remapIndices(scalarColumns.nameIndices, nameIndexMap, [&](int index) {
+            return scalarNameTable.insert(reinternString(stagingManager->scalarNameTable.get(index), nameMap, names));
+        });
+        remapIndices(scalarColumns.attrsIndices, attrsIndexMap, [&](int index) {
+            return scalarAttrsTable.insert(reinternAttrs(stagingManager->scalarAttrsTable.get(index)));
+        });
+        fileRun->parameterResults = std::move(stagingFileRun->parameterResults);
+        for (ResultItem& item : fileRun->parameterResults)
+            rebind(item, fileRun);
+        fileRun->vectorResults = std::move(stagingFileRun->vectorResults);
+        for (ResultItem& item : fileRun->vectorResults)
+            rebind(item, fileRun);
+        fileRun->statisticsResults = std::move(stagingFileRun->statisticsResults);
+        for (ResultItem& item : fileRun->statisticsResults)
+            rebind(item, fileRun);
+        fileRun->histogramResults = std::move(stagingFileRun->histogramResults);
+        for (ResultItem& item : fileRun->histogramResults)
+            rebind(item, fileRun);
+    }
+    return file;
+}
+
 int ResultFileManager::addScalar(FileRun *fileRunRef, const char *moduleName, const char *scalarName,
-        const StringMap& attrs, double value, bool isField)
+        const StringMap& attrs, double value)
 {
-    ScalarResult scalar(fileRunRef, moduleName, scalarName, attrs, value, isField);
-    ScalarResults& scalars = fileRunRef->scalarResults;
-    scalars.push_back(scalar);
+    ScalarColumns& scalars = fileRunRef->scalarColumns;
+    scalars.moduleNameIndices.push_back(scalarModuleNameTable.insert(moduleNames.insert(moduleName)));
+    scalars.nameIndices.push_back(scalarNameTable.insert(names.insert(scalarName)));
+    scalars.attrsIndices.push_back(scalarAttrsTable.insert(getPooledAttributes(attrs)));
+    scalars.values.push_back(value);
     return scalars.size() - 1;
 }
 
+void ResultFileManager::setScalarAttribute(FileRun *fileRunRef, int pos, const std::string& attrName, const std::string& value)
+{
+    int& attrsIndex = fileRunRef->scalarColumns.attrsIndices.at(pos);
+    StringMap tmp = *scalarAttrsTable.get(attrsIndex); // make a copy
+    tmp[attrName] = value;
+    attrsIndex = scalarAttrsTable.insert(getPooledAttributes(tmp));
+}
+
+const StringMap *ResultFileManager::getPooledAttributes(const StringMap& attrs)
+{
+    auto it = attrsPool.find(&attrs);
+    if (it != attrsPool.end())
+        return *it;
+    const StringMap *pooledAttrs = new StringMap(attrs);
+    attrsPool.insert(pooledAttrs);
+    return pooledAttrs;
+}
+
 int ResultFileManager::addParameter(FileRun *fileRunRef, const char *moduleName, const char *paramName, const StringMap& attrs, const std::string& value)
 {
     ParameterResult param(fileRunRef, moduleName, paramName, attrs, value);
@@ -1320,6 +1789,139 @@ ResultFile *ResultFileManager::loadFile(const char *displayName, const char *fil
     }
 }
 
+bool ResultFileManager::needsReload(ResultFile *file, const char *fileSystemFileName, int reloadOption) const
+{
+    switch (reloadOption) {
+        case RELOAD: return true;
+        case RELOAD_IF_CHANGED: return !(readFileFingerprint(fileSystemFileName) == file->fingerprint);
+        default: return false;
+    }
+}
+
+ResultFileList ResultFileManager::loadFiles(const StringVector& displayNames, const StringVector& fileSystemFileNames, int flags, InterruptedFlag *interrupted, int numThreads)
+{
+    if (!fileSystemFileNames.empty() && fileSystemFileNames.size() != displayNames.size())
+        throw opp_runtime_error("loadFiles(): displayNames and fileSystemFileNames must be of the same size");
+    auto fileSystemFileName = [&](int i) {return fileSystemFileNames.empty() ? displayNames[i].c_str() : fileSystemFileNames[i].c_str();};
+    int numFiles = displayNames.size();
+
+    if (numThreads <= 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    ResultFileList result(numFiles, nullptr);
+    if (numThreads == 1) {
+        for (int i = 0; i < numFiles; i++)
+            result[i] = loadFile(displayNames[i].c_str(), fileSystemFileName(i), flags, interrupted);
+        return result;
+    }
+
+    int reloadOption = flags & (RELOAD|RELOAD_IF_CHANGED|NEVER_RELOAD);
+    bool verbose = (flags & VERBOSE) != 0;
+
+    // select the files that need to be parsed (this is checked again before merging);
+    // repeated occurrences of a file are not parsed in advance, see below
+    struct Job {
+        int index;
+        std::unique_ptr<ResultFileManager> staging;
+        ResultFile *file = nullptr;
+        std::exception_ptr error;
+        bool done = false;
+    };
+    std::vector<Job> jobs;
+    std::vector<bool> isRepeated(numFiles, false);
+    {
+        READER_MUTEX
+        std::set<std::string> seen;
+        for (int i = 0; i < numFiles; i++) {
+            if (!seen.insert(fileNameToSlash(displayNames[i].c_str())).second) {
+                isRepeated[i] = true;
+                continue;
+            }
+            ResultFile *file = getFile(displayNames[i].c_str());
+            if (!file || needsReload(file, fileSystemFileName(i), reloadOption)) {
+                jobs.push_back(Job());
+                jobs.back().index = i;
+            }
+        }
+    }
+
+    // parse files in worker threads, each into its own ResultFileManager
+    std::mutex mutex;
+    std::condition_variable jobDone;
+    std::atomic<int> nextJob(0);
+    std::atomic<bool> cancelled(false);
+    auto worker = [&]() {
+        int k;
+        while (!cancelled && (k = nextJob++) < (int)jobs.size()) {
+            Job& job = jobs[k];
+            try {
+                job.staging.reset(new ResultFileManager());
+                job.file = job.staging->loadFile(displayNames[job.index].c_str(), fileSystemFileName(job.index), flags, interrupted);
+            }
+            catch (...) {
+                job.error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            job.done = true;
+            jobDone.notify_all();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < std::min(numThreads, (int)jobs.size()); t++)
+        threads.push_back(std::thread(worker));
+
+    // merge them in the original order
+    try {
+        size_t k = 0;
+        for (int i = 0; i < numFiles; i++) {
+            if (isRepeated[i]) {
+                // handled like with sequential loading, e.g. RELOAD loads the file again
+                result[i] = loadFile(displayNames[i].c_str(), fileSystemFileName(i), flags, interrupted);
+                continue;
+            }
+            if (k == jobs.size() || jobs[k].index != i) {
+                READER_MUTEX
+                result[i] = getFile(displayNames[i].c_str()); // already loaded
+                continue;
+            }
+
+            Job& job = jobs[k++];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobDone.wait(lock, [&] {return job.done;});
+            }
+            if (job.error)
+                std::rethrow_exception(job.error);
+            if (job.file) {
+                WRITER_MUTEX
+                ResultFile *fileRef = getFile(displayNames[i].c_str());
+                if (fileRef && !needsReload(fileRef, fileSystemFileName(i), reloadOption))
+                    result[i] = fileRef;
+                else {
+                    if (fileRef) {
+                        if (verbose)
+                            std::cout << "already loaded, unloading previous content: " << displayNames[i] << std::endl;
+                        unloadFile(fileRef);
+                    }
+                    serial++;
+                    result[i] = mergeFile(job.file);
+                }
+            }
+            job.staging.reset();
+        }
+    }
+    catch (std::exception&) {
+        cancelled = true;
+        for (std::thread& thread : threads)
+            thread.join();
+        throw;
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+    return result;
+}
+
 #undef LOG
 
 void ResultFileManager::setFileInput(ResultFile *file, const char *inputName)
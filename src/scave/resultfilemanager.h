@@ -25,6 +25,7 @@
 #include <set>
 #include <map>
 #include <list>
+#include <mutex>
 #include <unordered_set>
 
 #include "common/exception.h"
@@ -51,6 +52,7 @@ extern const std::string NULLSTRING;
 class ResultFileManager;
 class InterruptedFlag;
 class CmpBase;
+class CompiledResultFilter;
 class OmnetppResultFileLoader;
 class SqliteResultFileLoader;
 
@@ -124,6 +126,14 @@ class SCAVE_API ResultFileManager
 
         VERBOSE = (1<<8), // print on stdout what it's doing
 
+        // How to use the cache files (.sci) of scalar files (default: read if up to date, otherwise create/update it):
+        IGNORE_SCALAR_CACHE = (1<<9), // always parse the scalar file, neither read nor write its cache file
+        READ_ONLY_SCALAR_CACHE = (1<<10), // read the cache file if up to date, but do not create or update it
+
+        // Read result and index files via memory mapping. Faster, but the process may crash if a file is
+        // truncated while being read, so it is only meant for short-lived command-line tools.
+        MEMORY_MAP_FILES = (1<<11),
+
         LOADFLAGS_DEFAULTS = RELOAD_IF_CHANGED | ALLOW_INDEXING | SKIP_IF_LOCKED
     };
 
@@ -133,6 +143,7 @@ class SCAVE_API ResultFileManager
     friend class IDList;  // _type()
     friend class Run;  // _pos()
     friend class CmpBase; // uncheckedGet...()
+    friend class CompiledResultFilter; // _type(), uncheckedGet...() etc.
     friend class OmnetppResultFileLoader;
     friend class SqliteResultFileLoader;
   private:
@@ -153,8 +164,30 @@ class SCAVE_API ResultFileManager
     ScaveStringPool names;
     ScaveStringPool classNames; // currently not used
 
+    // scalars refer to their pooled module names, names and attributes via these tables (see ScalarColumns)
+    ScaveIndexTable<std::string> scalarModuleNameTable;
+    ScaveIndexTable<std::string> scalarNameTable;
+    ScaveIndexTable<StringMap> scalarAttrsTable;
+
     mutable std::unordered_map<std::pair<const std::string *, ResultItem::FieldNum>,const std::string *, common::pair_hash> namesWithSuffixCache;
 
+    // results of recent filterIDList(idlist, pattern) calls, most recently used first;
+    // invalidated when serial changes. Bounded both by the number of entries and
+    // by the total number of IDs held (inputs and results); larger inputs are not cached.
+    struct FilterCacheEntry {
+        std::string pattern;
+        int limit;
+        int64_t inputHash;
+        IDList input;
+        IDList result;
+    };
+    mutable std::list<FilterCacheEntry> filterCache;
+    mutable size_t filterCacheNumIDs = 0;
+    mutable int filterCacheSerial = -1;
+    mutable std::mutex filterCacheMutex; // filterIDList() may be called concurrently under the read lock
+    int filterCacheSize = 8;
+    size_t filterCacheCapacity = 1 << 20;
+
 #ifdef THREADED
     omnetpp::common::ReentrantReadWriteLock lock;
 #endif
@@ -192,8 +225,12 @@ class SCAVE_API ResultFileManager
     FileRun *addFileRun(ResultFile *file, Run *run);
     Run *getOrAddRun(const std::string& runName);
     FileRun *getOrAddFileRun(ResultFile *file, Run *run);
+    ResultFile *mergeFile(ResultFile *stagingFile); // copies a file loaded into another (staging) ResultFileManager
+    bool needsReload(ResultFile *file, const char *fileSystemFileName, int reloadOption) const;
 
-    int addScalar(FileRun *fileRunRef, const char *moduleName, const char *scalarName, const StringMap& attrs, double value, bool isField);
+    int addScalar(FileRun *fileRunRef, const char *moduleName, const char *scalarName, const StringMap& attrs, double value);
+    void setScalarAttribute(FileRun *fileRunRef, int pos, const std::string& attrName, const std::string& value);
+    const StringMap *getPooledAttributes(const StringMap& attrs);
     int addParameter(FileRun *fileRunRef, const char *moduleName, const char *paramName, const StringMap& attrs, const std::string& value);
     int addVector(FileRun *fileRunRef, int vectorId, const char *moduleName, const char *vectorName, const StringMap& attrs, const char *columns);
     int addStatistics(FileRun *fileRunRef, const char *moduleName, const char *statisticsName, const Statistics& stat, const StringMap& attrs);
@@ -201,6 +238,10 @@ class SCAVE_API ResultFileManager
 
     FileRun *getFileRunForID(ID id) const; // checks for nullptr
 
+    bool lookupFilterCache(const IDList& idlist, int64_t hash, const char *pattern, int limit, IDList& result) const;
+    void addToFilterCache(const IDList& idlist, int64_t hash, const char *pattern, int limit, const IDList& result) const;
+    void trimFilterCache() const;
+
     void makeIDs(std::vector<ID>& out, FileRun *fileRun, int numItems, int type) const;
     void makeFieldScalarIDs(std::vector<ID>& out, FileRun *fileRun, int numItems, HostType hosttype, FieldNum *fieldIds) const;
 
@@ -211,7 +252,11 @@ class SCAVE_API ResultFileManager
     const VectorResult *uncheckedGetVector(ID id) const;
     const StatisticsResult *uncheckedGetStatistics(ID id) const;
     const HistogramResult *uncheckedGetHistogram(ID id) const;
+    const std::string& uncheckedGetModuleName(ID id) const;
+    const std::string& uncheckedGetName(ID id) const;
+    double uncheckedGetScalarValue(ID id) const;
 
+    void fillNonfieldScalar(ScalarResult& scalar, ID id) const;
     void fillFieldScalar(ScalarResult& scalar, ID id) const;
     const std::string *getPooledNameWithSuffix(const std::string *name, FieldNum fieldId) const;
     static const char *getNameSuffixForFieldScalar(FieldNum fieldId);
@@ -242,11 +287,11 @@ class SCAVE_API ResultFileManager
     ResultFileList getFilesForRun(Run *run) const;
     ResultFileList getFilesForInput(const char *inputName) const;
 
-    const ResultItem *getNonfieldItem(ID id) const;
-    const ResultItem *getItem(ID id, ScalarResult& buffer) const; // common interface for getNonfieldItem() and getFieldScalar()
+    const ResultItem *getNonfieldItem(ID id) const; // not for scalars, as they are not stored as objects
+    const ResultItem *getItem(ID id, ScalarResult& buffer) const; // common interface for getNonfieldItem() and getScalar()
     ScalarResult getFieldScalar(ID id) const; // returns a temporary
-    const ScalarResult *getNonfieldScalar(ID id) const;
-    const ScalarResult *getScalar(ID id, ScalarResult& buffer) const; // common interface for getNonfieldScalar() and getFieldScalar()
+    ScalarResult getNonfieldScalar(ID id) const; // returns a temporary
+    const ScalarResult *getScalar(ID id, ScalarResult& buffer) const; // fills in and returns buffer
     const ParameterResult *getParameter(ID id) const;
     const VectorResult *getVector(ID id) const;
     const StatisticsResult *getStatistics(ID id) const;
@@ -302,7 +347,7 @@ class SCAVE_API ResultFileManager
     IDList getHistogramsInFileRun(FileRun *fileRun) const {return getItems(FileRunList(1,fileRun), HISTOGRAM);}
 
     // these ones are called from InputsTree
-    int getNumScalarsInFileRun(FileRun *fileRun) const {return fileRun->scalarResults.size();}
+    int getNumScalarsInFileRun(FileRun *fileRun) const {return fileRun->scalarColumns.size();}
     int getNumParametersInFileRun(FileRun *fileRun) const {return fileRun->parameterResults.size();}
     int getNumVectorsInFileRun(FileRun *fileRun) const {return fileRun->vectorResults.size();}
     int getNumStatisticsInFileRun(FileRun *fileRun) const {return fileRun->statisticsResults.size();}
@@ -328,8 +373,28 @@ class SCAVE_API ResultFileManager
                         const char *moduleFilter,
                         const char *nameFilter) const;
 
+    /**
+     * Get the subset of the input set that matches the given filter expression.
+     * The expression is compiled once, and each of its patterns is evaluated
+     * only once for each distinct module name, name, attribute set, etc.
+     * Results of recent calls are cached (see setFilterCacheSize()).
+     */
     IDList filterIDList(const IDList& idlist, const char *pattern, int limit=-1, InterruptedFlag *interrupted = nullptr) const;
 
+    /**
+     * Sets the number of recent filterIDList(idlist, pattern) results to remember;
+     * 0 disables caching. The default is 8.
+     */
+    void setFilterCacheSize(int size);
+
+    /**
+     * Sets the total number of IDs the filterIDList() cache may hold, counting
+     * both the input and the result IDList of each entry. Calls whose input and
+     * result do not fit are not cached, and their input is not even hashed.
+     * The default is 2^20 IDs, i.e. 8MiB.
+     */
+    void setFilterCacheCapacity(size_t numIDs);
+
     /**
      * Get a filtered subset of the input set.
      * All three filter parameters may be null, if given they are
@@ -358,6 +423,19 @@ class SCAVE_API ResultFileManager
      * the file is actually read from fileSystemFileName.
      */
     ResultFile *loadFile(const char *displayName, const char *fileSystemFileName, int flags, InterruptedFlag *interrupted);
+
+    /**
+     * Loads several files, using up to numThreads threads (numThreads <= 0 means
+     * the number of CPU cores). Each file is parsed into a private, temporary
+     * ResultFileManager, and then merged into this one in the order the files
+     * were given, so the outcome (including IDs) is the same as if they were
+     * loaded one by one with loadFile(). The write lock is only held while
+     * merging. fileSystemFileNames may be empty, meaning that the display names
+     * are also the file system names. Returns the files in the input order,
+     * with nullptr for skipped files. If loading a file fails, the files before
+     * it remain loaded, and the exception is rethrown.
+     */
+    ResultFileList loadFiles(const StringVector& displayNames, const StringVector& fileSystemFileNames, int flags, InterruptedFlag *interrupted, int numThreads);
     void setFileInput(ResultFile *file, const char *inputName); // for the "Inputs" page in the IDE
     void unloadFile(ResultFile *file);
     void unloadFile(const char *displayName);
@@ -435,11 +513,18 @@ inline const ResultItem *ResultFileManager::uncheckedGetItem(ID id, ScalarResult
 inline const ScalarResult *ResultFileManager::uncheckedGetScalar(ID id, ScalarResult& buffer) const
 {
     if (_fieldid(id) == 0)
-        return &fileRunList[_filerunid(id)]->scalarResults[_pos(id)];
-    else {
+        fillNonfieldScalar(buffer, id);
+    else
         fillFieldScalar(buffer, id);
-        return &buffer;
-    }
+    return &buffer;
+}
+
+inline double ResultFileManager::uncheckedGetScalarValue(ID id) const
+{
+    if (_fieldid(id) == 0)
+        return fileRunList[_filerunid(id)]->scalarColumns.values[_pos(id)];
+    else
+        return getContainingItem(id)->getScalarField((FieldNum)_fieldid(id));
 }
 
 inline const ParameterResult *ResultFileManager::uncheckedGetParameter(ID id) const
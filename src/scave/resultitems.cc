@@ -38,12 +38,7 @@ ResultItem::ResultItem(FileRun *fileRun, const std::string& moduleName, const st
 
 void ResultItem::setAttributes(const StringMap& attrs)
 {
-    ResultFileManager *resultFileManager = fileRunRef->fileRef->getResultFileManager();
-    auto it = resultFileManager->attrsPool.find(&attrs);
-    if (it != resultFileManager->attrsPool.end())
-        attributes = *it;
-    else
-        resultFileManager->attrsPool.insert(attributes = new StringMap(attrs));
+    attributes = fileRunRef->fileRef->getResultFileManager()->getPooledAttributes(attrs);
 }
 
 void ResultItem::setAttribute(const std::string& attrName, const std::string& value)
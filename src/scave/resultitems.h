@@ -242,7 +242,6 @@ class SCAVE_API HistogramResult : public StatisticsResult
     static FieldNum *getAvailableFields(); // zero-terminated array
 };
 
-typedef std::vector<ScalarResult> ScalarResults;
 typedef std::vector<ParameterResult> ParameterResults;
 typedef std::vector<VectorResult> VectorResults;
 typedef std::vector<StatisticsResult> StatisticsResults;
@@ -252,6 +251,23 @@ typedef std::vector<Run*> RunList;
 typedef std::vector<ResultFile*> ResultFileList;
 typedef std::vector<FileRun *> FileRunList;
 
+/**
+ * Stores the scalars of a FileRun in columnar form, which needs less than half
+ * the memory of ScalarResult objects, and allows tight loops for filtering and
+ * sorting. Module names, names and attribute sets are indices into tables in
+ * ResultFileManager; the run is implied by the containing FileRun. ScalarResult
+ * objects are materialized on demand, see ResultFileManager::getScalar().
+ */
+struct SCAVE_API ScalarColumns
+{
+    std::vector<int> moduleNameIndices;
+    std::vector<int> nameIndices;
+    std::vector<int> attrsIndices;
+    std::vector<double> values;
+
+    int size() const {return values.size();}
+};
+
 /**
  * Represents a loaded scalar or vector file.
  */
@@ -346,6 +362,7 @@ class SCAVE_API FileRun
     friend class IDList;
     friend class ResultItem;
     friend class ResultFileManager;
+    friend class CompiledResultFilter;
     friend class OmnetppResultFileLoader;
     friend class SqliteResultFileLoader;
 
@@ -354,7 +371,7 @@ class SCAVE_API FileRun
     ResultFile *fileRef;
     Run *runRef;
 
-    ScalarResults scalarResults;
+    ScalarColumns scalarColumns;
     ParameterResults parameterResults;
     VectorResults vectorResults;
     StatisticsResults statisticsResults;
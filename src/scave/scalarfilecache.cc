@@ -0,0 +1,525 @@
+//=========================================================================
+//  SCALARFILECACHE.CC - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#include "common/stringutil.h"
+#include "common/fileutil.h"
+#include "omnetpp/platdep/platmisc.h"
+#include "scaveexception.h"
+#include "resultfilemanager.h"
+#include "scalarfilecache.h"
+
+using namespace omnetpp::common;
+
+namespace omnetpp {
+namespace scave {
+
+//
+// File layout (all numbers in native byte order, which is verified via the
+// byte order mark; strings and attribute sets are referred to by index):
+//
+//   header:     magic[8], u32 version, u32 byteOrderMark, i64 fileSize,
+//               i64 lastModified, u64 payloadSize
+//   strings:    u32 count, then each: u32 length, bytes
+//   attr sets:  u32 count, then each: u32 numPairs, pairs of (u32 key, u32 value)
+//   runs:       u32 count, then each:
+//                 u32 runName, attributes, itervars, configEntries (as pair lists)
+//                 u32 numScalars, u32 moduleNames[n], u32 names[n], u32 attrs[n], f64 values[n]
+//                 u32 numParameters, then each: u32 moduleName, name, attrs, value
+//                 u32 numStatistics, then each: u32 moduleName, name, attrs, <stat>
+//                 u32 numHistograms, then each: u32 moduleName, name, attrs, <stat>,
+//                     f64 underflows, f64 overflows, u32 numEdges, f64 edges[], u32 numValues, f64 values[]
+//   <stat>:     u8 weighted, i64 count, f64 min, max, sumWeights, sumWeightedValues,
+//               sumSquaredWeights, sumWeightedSquaredValues
+//
+
+static const char MAGIC[8] = {'O', 'P', 'P', '-', 'S', 'C', 'I', '\n'};
+static const uint32_t VERSION = 1;
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const size_t HEADER_SIZE = sizeof(MAGIC) + 4 + 4 + 8 + 8 + 8;
+
+bool ScalarFileCache::isScalarFile(const char *fileName)
+{
+    return opp_stringendswith(fileName, ".sca");
+}
+
+std::string ScalarFileCache::getCacheFileName(const char *scalarFileName)
+{
+    std::string cacheFileName(scalarFileName);
+    std::string::size_type pos = cacheFileName.rfind('.');
+    if (pos != std::string::npos)
+        cacheFileName.replace(cacheFileName.begin()+pos, cacheFileName.end(), ".sci");
+    else
+        cacheFileName.append(".sci");
+    return cacheFileName;
+}
+
+bool ScalarFileCache::isCacheFileUpToDate(const char *scalarFileName)
+{
+    std::string cacheFileName = getCacheFileName(scalarFileName);
+    if (!fileExists(cacheFileName.c_str()))
+        return false;
+    try {
+        ScalarFileCacheReader reader(cacheFileName.c_str());
+        return reader.readRecordedFingerprint() == readFileFingerprint(scalarFileName);
+    }
+    catch (std::exception&) {
+        return false;
+    }
+}
+
+void ScalarFileCache::generateCacheFile(const char *scalarFileName)
+{
+    // load the file into a scratch ResultFileManager, which writes the cache as a side effect
+    std::string cacheFileName = getCacheFileName(scalarFileName);
+    if (unlink(cacheFileName.c_str()) != 0 && errno != ENOENT)
+        throw opp_runtime_error("Cannot remove original cache file '%s': %s", cacheFileName.c_str(), strerror(errno));
+    ResultFileManager manager;
+    manager.loadFile(scalarFileName, scalarFileName, ResultFileManager::RELOAD | ResultFileManager::ALLOW_INDEXING | ResultFileManager::IGNORE_LOCK_FILE, nullptr);
+    if (!isCacheFileUpToDate(scalarFileName))
+        throw opp_runtime_error("Could not create cache file '%s'", cacheFileName.c_str());
+}
+
+//---
+
+int ScalarFileCacheWriter::addString(const std::string& str)
+{
+    auto it = stringIndices.find(str);
+    if (it != stringIndices.end())
+        return it->second;
+    int index = cache.strings.size();
+    cache.strings.push_back(str);
+    stringIndices[str] = index;
+    return index;
+}
+
+int ScalarFileCacheWriter::addAttributes(const StringMap& attrs)
+{
+    auto it = attrsIndices.find(&attrs);
+    if (it != attrsIndices.end())
+        return it->second;
+    int index = cache.attributeSets.size();
+    cache.attributeSets.push_back(attrs);
+    attrsKeys.push_back(attrs);
+    attrsIndices[&attrsKeys.back()] = index;
+    for (auto& pair : attrs) {
+        addString(pair.first);
+        addString(pair.second);
+    }
+    return index;
+}
+
+void ScalarFileCacheWriter::fillItem(ScalarFileCache::Item& item, const std::string& moduleName, const std::string& name, const StringMap& attrs)
+{
+    // consecutive items very often belong to the same module
+    if (lastModuleNameIndex == -1 || lastModuleName != moduleName) {
+        lastModuleNameIndex = addString(moduleName);
+        lastModuleName = moduleName;
+    }
+    item.moduleName = lastModuleNameIndex;
+    item.name = addString(name);
+    item.attrs = addAttributes(attrs);
+}
+
+ScalarFileCache::RunData& ScalarFileCacheWriter::getCurrentRun()
+{
+    if (currentRun == -1)
+        throw opp_runtime_error("ScalarFileCacheWriter: beginRun() must be called first");
+    return cache.runs[currentRun];
+}
+
+void ScalarFileCacheWriter::beginRun(const std::string& runName, const StringMap& attributes, const StringMap& itervars, const OrderedKeyValueList& configEntries)
+{
+    auto it = runIndices.find(runName);
+    if (it != runIndices.end()) {
+        currentRun = it->second;
+        return;
+    }
+    currentRun = runIndices[runName] = cache.runs.size();
+    cache.runs.push_back(ScalarFileCache::RunData());
+    ScalarFileCache::RunData& run = cache.runs.back();
+    run.runName = runName;
+    run.attributes = attributes;
+    run.itervars = itervars;
+    run.configEntries = configEntries;
+}
+
+void ScalarFileCacheWriter::addScalar(const std::string& moduleName, const std::string& name, const StringMap& attrs, double value)
+{
+    ScalarFileCache::RunData& run = getCurrentRun();
+    ScalarFileCache::Item item;
+    fillItem(item, moduleName, name, attrs);
+    run.scalarModuleNames.push_back(item.moduleName);
+    run.scalarNames.push_back(item.name);
+    run.scalarAttrs.push_back(item.attrs);
+    run.scalarValues.push_back(value);
+}
+
+void ScalarFileCacheWriter::addParameter(const std::string& moduleName, const std::string& name, const StringMap& attrs, const std::string& value)
+{
+    ScalarFileCache::ParameterItem item;
+    fillItem(item, moduleName, name, attrs);
+    item.value = addString(value);
+    getCurrentRun().parameters.push_back(item);
+}
+
+void ScalarFileCacheWriter::addStatistics(const std::string& moduleName, const std::string& name, const StringMap& attrs, const Statistics& stat)
+{
+    ScalarFileCache::StatisticsItem item;
+    fillItem(item, moduleName, name, attrs);
+    item.stat = stat;
+    getCurrentRun().statistics.push_back(item);
+}
+
+void ScalarFileCacheWriter::addHistogram(const std::string& moduleName, const std::string& name, const StringMap& attrs, const Statistics& stat, const Histogram& bins)
+{
+    ScalarFileCache::HistogramItem item;
+    fillItem(item, moduleName, name, attrs);
+    item.stat = stat;
+    item.bins = bins;
+    getCurrentRun().histograms.push_back(item);
+}
+
+namespace {
+
+class Buffer
+{
+  public:
+    std::vector<char> bytes;
+
+    void appendBytes(const void *data, size_t size) {bytes.insert(bytes.end(), (const char *)data, (const char *)data + size);}
+    template<typename T> void append(T value) {appendBytes(&value, sizeof(T));}
+    void appendU32(size_t value) {append<uint32_t>(value);}
+    void appendString(const std::string& str) {appendU32(str.size()); appendBytes(str.data(), str.size());}
+    void appendU32s(const std::vector<int>& values) {for (int value : values) appendU32(value);}
+    void appendDoubles(const std::vector<double>& values) {appendU32(values.size()); appendBytes(values.data(), values.size() * sizeof(double));}
+};
+
+}  // namespace
+
+template<typename Map>
+static void appendPairs(Buffer& buffer, const Map& pairs, std::unordered_map<std::string,int>& stringIndices)
+{
+    buffer.appendU32(pairs.size());
+    for (auto& pair : pairs) {
+        buffer.appendU32(stringIndices.at(pair.first));
+        buffer.appendU32(stringIndices.at(pair.second));
+    }
+}
+
+static void appendItem(Buffer& buffer, const ScalarFileCache::Item& item)
+{
+    buffer.appendU32(item.moduleName);
+    buffer.appendU32(item.name);
+    buffer.appendU32(item.attrs);
+}
+
+static void appendStatistics(Buffer& buffer, const Statistics& stat)
+{
+    buffer.append<uint8_t>(stat.isWeighted() ? 1 : 0);
+    buffer.append<int64_t>(stat.getCount());
+    buffer.append<double>(stat.getMin());
+    buffer.append<double>(stat.getMax());
+    buffer.append<double>(stat.getSumWeights());
+    buffer.append<double>(stat.getWeightedSum());
+    buffer.append<double>(stat.getSumSquaredWeights());
+    buffer.append<double>(stat.getSumWeightedSquaredValues());
+}
+
+static std::string createTempFileName(const std::string& baseFileName)
+{
+    std::string prefix = baseFileName + ".temp";
+    std::string tmpFileName = prefix;
+    int serial = 0;
+    while (fileExists(tmpFileName.c_str()))
+        tmpFileName = opp_stringf("%s%d", prefix.c_str(), serial++);
+    return tmpFileName;
+}
+
+void ScalarFileCacheWriter::write(const char *cacheFileName, const FileFingerprint& scalarFileFingerprint)
+{
+    // run metadata strings were not interned as they came
+    for (auto& run : cache.runs) {
+        addString(run.runName);
+        for (auto& pair : run.attributes) {addString(pair.first); addString(pair.second);}
+        for (auto& pair : run.itervars) {addString(pair.first); addString(pair.second);}
+        for (auto& pair : run.configEntries) {addString(pair.first); addString(pair.second);}
+    }
+
+    Buffer payload;
+    payload.appendU32(cache.strings.size());
+    for (auto& str : cache.strings)
+        payload.appendString(str);
+    payload.appendU32(cache.attributeSets.size());
+    for (auto& attrs : cache.attributeSets)
+        appendPairs(payload, attrs, stringIndices);
+    payload.appendU32(cache.runs.size());
+    for (auto& run : cache.runs) {
+        payload.appendU32(stringIndices.at(run.runName));
+        appendPairs(payload, run.attributes, stringIndices);
+        appendPairs(payload, run.itervars, stringIndices);
+        appendPairs(payload, run.configEntries, stringIndices);
+
+        payload.appendU32(run.scalarValues.size());
+        payload.appendU32s(run.scalarModuleNames);
+        payload.appendU32s(run.scalarNames);
+        payload.appendU32s(run.scalarAttrs);
+        payload.appendBytes(run.scalarValues.data(), run.scalarValues.size() * sizeof(double));
+
+        payload.appendU32(run.parameters.size());
+        for (auto& item : run.parameters) {
+            appendItem(payload, item);
+            payload.appendU32(item.value);
+        }
+        payload.appendU32(run.statistics.size());
+        for (auto& item : run.statistics) {
+            appendItem(payload, item);
+            appendStatistics(payload, item.stat);
+        }
+        payload.appendU32(run.histograms.size());
+        for (auto& item : run.histograms) {
+            appendItem(payload, item);
+            appendStatistics(payload, item.stat);
+            payload.append<double>(item.bins.getUnderflows());
+            payload.append<double>(item.bins.getOverflows());
+            payload.appendDoubles(item.bins.getBinEdges());
+            payload.appendDoubles(item.bins.getBinValues());
+        }
+    }
+
+    Buffer header;
+    header.appendBytes(MAGIC, sizeof(MAGIC));
+    header.append<uint32_t>(VERSION);
+    header.append<uint32_t>(BYTE_ORDER_MARK);
+    header.append<int64_t>(scalarFileFingerprint.fileSize);
+    header.append<int64_t>(scalarFileFingerprint.lastModified);
+    header.append<uint64_t>(payload.bytes.size());
+    Assert(header.bytes.size() == HEADER_SIZE);
+
+    // write to a temp file then rename it, so that other processes/threads never see an incomplete file
+    std::string tempFileName = createTempFileName(cacheFileName);
+    FILE *f = fopen(tempFileName.c_str(), "wb");
+    if (!f)
+        throw opp_runtime_error("Cannot open cache file '%s' for write: %s", tempFileName.c_str(), strerror(errno));
+    bool ok = fwrite(header.bytes.data(), 1, header.bytes.size(), f) == header.bytes.size() &&
+              fwrite(payload.bytes.data(), 1, payload.bytes.size(), f) == payload.bytes.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        unlink(tempFileName.c_str());
+        throw opp_runtime_error("Cannot write cache file '%s'", tempFileName.c_str());
+    }
+    if (unlink(cacheFileName) != 0 && errno != ENOENT) {
+        unlink(tempFileName.c_str());
+        throw opp_runtime_error("Cannot remove original cache file '%s': %s", cacheFileName, strerror(errno));
+    }
+    if (rename(tempFileName.c_str(), cacheFileName) != 0) {
+        unlink(tempFileName.c_str());
+        throw opp_runtime_error("Cannot rename cache file from '%s' to '%s': %s", tempFileName.c_str(), cacheFileName, strerror(errno));
+    }
+}
+
+//---
+
+ScalarFileCacheReader::ScalarFileCacheReader(const char *fileName) : fileName(fileName)
+{
+    FILE *f = fopen(fileName, "rb");
+    if (!f)
+        throw opp_runtime_error("Cannot open cache file '%s'", fileName);
+    struct opp_stat_t s;
+    if (opp_fstat(fileno(f), &s) != 0 || (uint64_t)s.st_size > (uint64_t)SIZE_MAX) {
+        fclose(f);
+        throw opp_runtime_error("Cannot determine size of cache file '%s'", fileName);
+    }
+    size = s.st_size;
+#ifndef _WIN32
+    if (size > 0) {
+        void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+        if (p != MAP_FAILED) {
+            madvise(p, size, MADV_SEQUENTIAL);
+            data = (const char *)p;
+            mapped = true;
+        }
+    }
+#endif
+    if (!mapped) {
+        char *buffer = new char[size > 0 ? size : 1];
+        if (fread(buffer, 1, size, f) != size) {
+            delete[] buffer;
+            fclose(f);
+            throw opp_runtime_error("Cannot read cache file '%s'", fileName);
+        }
+        data = buffer;
+    }
+    fclose(f);
+}
+
+ScalarFileCacheReader::~ScalarFileCacheReader()
+{
+#ifndef _WIN32
+    if (mapped) {
+        munmap((void *)data, size);
+        return;
+    }
+#endif
+    delete[] data;
+}
+
+namespace {
+
+class Cursor
+{
+  private:
+    const char *fileName;
+    const char *p;
+    const char *end;
+  public:
+    Cursor(const char *fileName, const char *begin, const char *end) : fileName(fileName), p(begin), end(end) {}
+    bool atEnd() const {return p == end;}
+    void check(bool cond) {if (!cond) throw opp_runtime_error("Corrupt or truncated cache file '%s'", fileName);}
+    void readBytes(void *dest, size_t size) {check((size_t)(end - p) >= size); memcpy(dest, p, size); p += size;}
+    template<typename T> T read() {T value; readBytes(&value, sizeof(T)); return value;}
+    uint32_t readU32() {return read<uint32_t>();}
+    uint32_t readIndex(size_t limit) {uint32_t index = readU32(); check(index < limit); return index;}
+    size_t readCount(size_t minItemSize) {uint32_t count = readU32(); check(count <= (size_t)(end - p) / minItemSize); return count;} // guards against huge allocations
+    void readIndices(std::vector<int>& out, size_t n, size_t limit) {
+        out.resize(n);
+        readBytes(out.data(), n * sizeof(int));
+        for (int index : out)
+            check(index >= 0 && (size_t)index < limit);
+    }
+};
+
+}  // namespace
+
+static_assert(sizeof(int) == sizeof(uint32_t), "scalar file cache stores indices as 32-bit ints");
+
+template<typename Map>
+static void readPairs(Cursor& in, Map& pairs, const std::vector<std::string>& strings)
+{
+    size_t n = in.readCount(8);
+    for (size_t i = 0; i < n; i++) {
+        const std::string& key = strings[in.readIndex(strings.size())];
+        const std::string& value = strings[in.readIndex(strings.size())];
+        pairs.insert(pairs.end(), std::make_pair(key, value));
+    }
+}
+
+static void readItem(Cursor& in, ScalarFileCache::Item& item, const ScalarFileCache& cache)
+{
+    item.moduleName = in.readIndex(cache.strings.size());
+    item.name = in.readIndex(cache.strings.size());
+    item.attrs = in.readIndex(cache.attributeSets.size());
+}
+
+static Statistics readStatistics(Cursor& in)
+{
+    bool weighted = in.read<uint8_t>() != 0;
+    int64_t count = in.read<int64_t>();
+    double fields[6];
+    in.readBytes(fields, sizeof(fields));
+    if (!weighted)
+        return Statistics::makeUnweighted(count, fields[0], fields[1], fields[3], fields[5]);
+    else
+        return Statistics::makeWeighted(count, fields[0], fields[1], fields[2], fields[3], fields[4], fields[5]);
+}
+
+static std::vector<double> readDoubles(Cursor& in)
+{
+    std::vector<double> values(in.readCount(sizeof(double)));
+    in.readBytes(values.data(), values.size() * sizeof(double));
+    return values;
+}
+
+FileFingerprint ScalarFileCacheReader::readRecordedFingerprint()
+{
+    Cursor in(fileName.c_str(), data, data + size);
+    char magic[sizeof(MAGIC)];
+    in.readBytes(magic, sizeof(magic));
+    in.check(memcmp(magic, MAGIC, sizeof(MAGIC)) == 0);
+    if (in.readU32() != VERSION || in.readU32() != BYTE_ORDER_MARK)
+        throw opp_runtime_error("Cache file '%s' was written by a different version or on a different platform", fileName.c_str());
+    FileFingerprint fingerprint;
+    fingerprint.fileSize = in.read<int64_t>();
+    fingerprint.lastModified = in.read<int64_t>();
+    in.check(in.read<uint64_t>() == size - HEADER_SIZE);
+    return fingerprint;
+}
+
+void ScalarFileCacheReader::readAll(ScalarFileCache& cache)
+{
+    cache.fingerprint = readRecordedFingerprint();
+
+    Cursor in(fileName.c_str(), data + HEADER_SIZE, data + size);
+    cache.strings.resize(in.readCount(4));
+    for (std::string& str : cache.strings) {
+        size_t length = in.readCount(1);
+        str.resize(length);
+        in.readBytes(&str[0], length);
+    }
+    cache.attributeSets.resize(in.readCount(4));
+    for (StringMap& attrs : cache.attributeSets)
+        readPairs(in, attrs, cache.strings);
+
+    cache.runs.resize(in.readCount(4));
+    for (ScalarFileCache::RunData& run : cache.runs) {
+        run.runName = cache.strings[in.readIndex(cache.strings.size())];
+        readPairs(in, run.attributes, cache.strings);
+        readPairs(in, run.itervars, cache.strings);
+        readPairs(in, run.configEntries, cache.strings);
+
+        size_t numScalars = in.readCount(20);
+        in.readIndices(run.scalarModuleNames, numScalars, cache.strings.size());
+        in.readIndices(run.scalarNames, numScalars, cache.strings.size());
+        in.readIndices(run.scalarAttrs, numScalars, cache.attributeSets.size());
+        run.scalarValues.resize(numScalars);
+        in.readBytes(run.scalarValues.data(), numScalars * sizeof(double));
+
+        run.parameters.resize(in.readCount(16));
+        for (auto& item : run.parameters) {
+            readItem(in, item, cache);
+            item.value = in.readIndex(cache.strings.size());
+        }
+        run.statistics.resize(in.readCount(12));
+        for (auto& item : run.statistics) {
+            readItem(in, item, cache);
+            item.stat = readStatistics(in);
+        }
+        run.histograms.resize(in.readCount(12));
+        for (auto& item : run.histograms) {
+            readItem(in, item, cache);
+            item.stat = readStatistics(in);
+            double underflows = in.read<double>();
+            double overflows = in.read<double>();
+            std::vector<double> edges = readDoubles(in);
+            std::vector<double> values = readDoubles(in);
+            if (!edges.empty()) {
+                in.check(edges.size() == values.size() + 1);
+                item.bins.setBins(edges, values);
+            }
+            item.bins.setUnderflows(underflows);
+            item.bins.setOverflows(overflows);
+        }
+    }
+    in.check(in.atEnd());
+}
+
+}  // namespace scave
+}  // namespace omnetpp
@@ -0,0 +1,158 @@
+//=========================================================================
+//  SCALARFILECACHE.H - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#ifndef __OMNETPP_SCAVE_SCALARFILECACHE_H
+#define __OMNETPP_SCAVE_SCALARFILECACHE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include "common/statistics.h"
+#include "common/histogram.h"
+#include "scavedefs.h"
+#include "scaveutils.h"
+#include "resultfilemanager.h"
+
+namespace omnetpp {
+namespace scave {
+
+/**
+ * Contents of a scalar file cache (.sci file). A cache file is a binary
+ * sidecar of an output scalar (.sca) file, and contains everything that
+ * loading the .sca file would add to a ResultFileManager: runs with their
+ * metadata, scalars, parameters, statistics and histograms. Strings and
+ * attribute sets are stored once, in tables; items refer to them by index.
+ * The cache file records the size and modification time of the .sca file
+ * it was made from, and it is only used while they match.
+ */
+class SCAVE_API ScalarFileCache
+{
+  public:
+    struct Item {
+        int moduleName; // index into strings
+        int name;       // index into strings
+        int attrs;      // index into attributeSets
+    };
+    struct ParameterItem : Item {
+        int value;      // index into strings
+    };
+    struct StatisticsItem : Item {
+        Statistics stat;
+    };
+    struct HistogramItem : StatisticsItem {
+        Histogram bins;
+    };
+
+    struct RunData {
+        std::string runName;
+        StringMap attributes;
+        StringMap itervars;
+        OrderedKeyValueList configEntries;
+        std::vector<int> scalarModuleNames; // scalars in columnar form, indices like in Item
+        std::vector<int> scalarNames;
+        std::vector<int> scalarAttrs;
+        std::vector<double> scalarValues;
+        std::vector<ParameterItem> parameters;
+        std::vector<StatisticsItem> statistics;
+        std::vector<HistogramItem> histograms;
+    };
+
+    FileFingerprint fingerprint; // of the .sca file
+    std::vector<std::string> strings;
+    std::vector<StringMap> attributeSets;
+    std::vector<RunData> runs; // in the order of their first occurrence in the .sca file
+
+  public:
+    static bool isScalarFile(const char *fileName);
+    static std::string getCacheFileName(const char *scalarFileName);
+
+    /**
+     * Returns true if the cache file of the given scalar file exists, is
+     * readable, and was made from the current version of the scalar file.
+     */
+    static bool isCacheFileUpToDate(const char *scalarFileName);
+
+    /**
+     * Creates or updates the cache file of the given scalar file.
+     */
+    static void generateCacheFile(const char *scalarFileName);
+};
+
+/**
+ * Builds up the contents of a scalar file cache while a scalar file is being
+ * parsed, and writes it out. Items are added to the run set by the last
+ * beginRun() call; beginRun() with the name of a run seen earlier switches
+ * back to that run (its metadata are not changed), which mirrors the way
+ * the result file loader adds items.
+ */
+class SCAVE_API ScalarFileCacheWriter
+{
+  private:
+    ScalarFileCache cache;
+    std::unordered_map<std::string,int> stringIndices;
+    std::deque<StringMap> attrsKeys; // copy of cache.attributeSets, with stable addresses
+    std::unordered_map<const StringMap*,int,StringMapPtrHash,StringMapPtrEq> attrsIndices; // keys point into attrsKeys
+    std::unordered_map<std::string,int> runIndices;
+    int currentRun = -1;
+    std::string lastModuleName;
+    int lastModuleNameIndex = -1;
+
+  protected:
+    int addString(const std::string& str);
+    int addAttributes(const StringMap& attrs);
+    void fillItem(ScalarFileCache::Item& item, const std::string& moduleName, const std::string& name, const StringMap& attrs);
+    ScalarFileCache::RunData& getCurrentRun();
+
+  public:
+    ScalarFileCacheWriter() {}
+    void beginRun(const std::string& runName, const StringMap& attributes, const StringMap& itervars, const OrderedKeyValueList& configEntries);
+    void addScalar(const std::string& moduleName, const std::string& name, const StringMap& attrs, double value);
+    void addParameter(const std::string& moduleName, const std::string& name, const StringMap& attrs, const std::string& value);
+    void addStatistics(const std::string& moduleName, const std::string& name, const StringMap& attrs, const Statistics& stat);
+    void addHistogram(const std::string& moduleName, const std::string& name, const StringMap& attrs, const Statistics& stat, const Histogram& bins);
+
+    /**
+     * Writes the cache file. The file is written under a temporary name first,
+     * and renamed when complete, so that concurrent readers never see a partial
+     * file.
+     */
+    void write(const char *cacheFileName, const FileFingerprint& scalarFileFingerprint);
+};
+
+/**
+ * Reads a scalar file cache. The file is memory-mapped where possible.
+ * Throws an exception if the file is malformed, or was written on a platform
+ * with a different byte order or by a different version of the code.
+ */
+class SCAVE_API ScalarFileCacheReader
+{
+  private:
+    std::string fileName;
+    const char *data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+
+  public:
+    ScalarFileCacheReader(const char *fileName);
+    ~ScalarFileCacheReader();
+    FileFingerprint readRecordedFingerprint();
+    void readAll(ScalarFileCache& cache);
+};
+
+} // namespace scave
+}  // namespace omnetpp
+
+#endif
@@ -0,0 +1,212 @@
+//=========================================================================
+//  SCAVECAPI.CC - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include "common/stringutil.h"
+#include "xyarray.h"
+#include "resultfilemanager.h"
+#include "vectorutils.h"
+#include "scavecapi.h"
+
+using namespace omnetpp::common;
+using namespace omnetpp::scave;
+
+struct scave_manager
+{
+    ResultFileManager manager;
+};
+
+struct scave_table
+{
+    std::vector<std::string> strings;
+    std::unordered_map<std::string,int32_t> stringIndices;
+    std::vector<int32_t> columns[SCAVE_NUM_STRING_COLUMNS];
+    std::vector<double> values;
+    std::vector<int64_t> vectorLengths;
+    std::vector<const double *> vectorTimes;
+    std::vector<const double *> vectorValues;
+    std::vector<XYArray *> xyArrays; // owned
+
+    ~scave_table() {
+        for (XYArray *array : xyArrays)
+            delete array;
+    }
+
+    int32_t intern(const std::string& s) {
+        auto it = stringIndices.find(s);
+        if (it != stringIndices.end())
+            return it->second;
+        int32_t index = strings.size();
+        strings.push_back(s);
+        stringIndices[s] = index;
+        return index;
+    }
+
+    void addRow(const std::string& run, const char *type, const std::string *module, const std::string *name,
+                const std::string *attrName, const std::string *attrValue, double value = NaN, const XYArray *array = nullptr) {
+        columns[SCAVE_COL_RUN].push_back(intern(run));
+        columns[SCAVE_COL_TYPE].push_back(intern(type));
+        columns[SCAVE_COL_MODULE].push_back(module ? intern(*module) : -1);
+        columns[SCAVE_COL_NAME].push_back(name ? intern(*name) : -1);
+        columns[SCAVE_COL_ATTRNAME].push_back(attrName ? intern(*attrName) : -1);
+        columns[SCAVE_COL_ATTRVALUE].push_back(attrValue ? intern(*attrValue) : -1);
+        values.push_back(value);
+        vectorLengths.push_back(array ? array->length() : -1);
+        vectorTimes.push_back(array ? array->xs.data() : nullptr);
+        vectorValues.push_back(array ? array->ys.data() : nullptr);
+    }
+
+    void addAttrRows(const ResultItem *result) {
+        for (auto& pair : result->getAttributes())
+            addRow(result->getRun()->getRunName(), "attr", &result->getModuleName(), &result->getName(), &pair.first, &pair.second);
+    }
+};
+
+static thread_local std::string lastError;
+
+const char *scave_get_last_error()
+{
+    return lastError.c_str();
+}
+
+scave_manager *scave_create_manager()
+{
+    return new scave_manager();
+}
+
+void scave_delete_manager(scave_manager *manager)
+{
+    delete manager;
+}
+
+int scave_load_files(scave_manager *manager, const char **fileNames, int numFiles, int numThreads)
+{
+    try {
+        typedef ResultFileManager RFM;
+        StringVector names(fileNames, fileNames + numFiles);
+        int loadFlags = RFM::NEVER_RELOAD | RFM::ALLOW_INDEXING | RFM::SKIP_IF_LOCKED;
+        ResultFileList files = manager->manager.loadFiles(names, StringVector(), loadFlags, nullptr, numThreads);
+        return files.size();
+    }
+    catch (std::exception& e) {
+        lastError = e.what();
+        return -1;
+    }
+}
+
+scave_table *scave_query(scave_manager *manager, const char *filterExpression, int resultTypes, double startTime, double endTime)
+{
+    return scave_query_downsampled(manager, filterExpression, resultTypes, startTime, endTime, 0);
+}
+
+scave_table *scave_query_downsampled(scave_manager *manager, const char *filterExpression, int resultTypes, double startTime, double endTime, int numBins)
+{
+    try {
+        if ((resultTypes & ~(SCAVE_SCALAR | SCAVE_VECTOR)) != 0)
+            throw opp_runtime_error("Only scalars and vectors are supported");
+
+        ResultFileManager& rfm = manager->manager;
+
+        IDList results = rfm.getAllItems();
+        results = results.filterByTypes(resultTypes);
+        if (!opp_isblank(filterExpression))
+            results = rfm.filterIDList(results, filterExpression);
+
+        std::unique_ptr<scave_table> table(new scave_table());
+
+        // run records, in the same order as the CSV-R exporter
+        for (Run *run : rfm.getUniqueRuns(results)) {
+            for (auto& pair : run->getAttributes())
+                table->addRow(run->getRunName(), "runattr", nullptr, nullptr, &pair.first, &pair.second);
+            for (auto& pair : run->getIterationVariables())
+                table->addRow(run->getRunName(), "itervar", nullptr, nullptr, &pair.first, &pair.second);
+            for (auto& pair : run->getConfigEntries())
+                table->addRow(run->getRunName(), "config", nullptr, nullptr, &pair.first, &pair.second);
+        }
+
+        IDList scalarIDs = results.filterByTypes(ResultFileManager::SCALAR);
+        ScalarResult buffer;
+        for (ID id : scalarIDs) {
+            const ScalarResult *scalar = rfm.getScalar(id, buffer);
+            table->addRow(scalar->getRun()->getRunName(), "scalar", &scalar->getModuleName(), &scalar->getName(), nullptr, nullptr, scalar->getValue());
+            table->addAttrRows(scalar);
+        }
+
+        IDList vectorIDs = results.filterByTypes(ResultFileManager::VECTOR);
+        if (!vectorIDs.isEmpty()) {
+            if (numBins > 0)
+                table->xyArrays = readDownsampledVectorsIntoArrays(&rfm, vectorIDs, numBins, startTime, endTime);
+            else
+                table->xyArrays = readVectorsIntoArrays(&rfm, vectorIDs, false, false, std::numeric_limits<size_t>::max(), startTime, endTime);
+            for (int i = 0; i < vectorIDs.size(); i++) {
+                const VectorResult *vector = rfm.getVector(vectorIDs.get(i));
+                table->addRow(vector->getRun()->getRunName(), "vector", &vector->getModuleName(), &vector->getName(), nullptr, nullptr, NaN, table->xyArrays[i]);
+                table->addAttrRows(vector);
+            }
+        }
+        return table.release();
+    }
+    catch (std::exception& e) {
+        lastError = e.what();
+        return nullptr;
+    }
+}
+
+void scave_delete_table(scave_table *table)
+{
+    delete table;
+}
+
+int64_t scave_table_get_num_rows(const scave_table *table)
+{
+    return table->values.size();
+}
+
+int64_t scave_table_get_num_strings(const scave_table *table)
+{
+    return table->strings.size();
+}
+
+const char *scave_table_get_string(const scave_table *table, int64_t index)
+{
+    return table->strings.at(index).c_str();
+}
+
+const int32_t *scave_table_get_string_column(const scave_table *table, int column)
+{
+    return table->columns[column].data();
+}
+
+const double *scave_table_get_values(const scave_table *table)
+{
+    return table->values.data();
+}
+
+const int64_t *scave_table_get_vector_lengths(const scave_table *table)
+{
+    return table->vectorLengths.data();
+}
+
+const double * const *scave_table_get_vector_times(const scave_table *table)
+{
+    return table->vectorTimes.data();
+}
+
+const double * const *scave_table_get_vector_values(const scave_table *table)
+{
+    return table->vectorValues.data();
+}
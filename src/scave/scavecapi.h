@@ -0,0 +1,107 @@
+//=========================================================================
+//  SCAVECAPI.H - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#ifndef __OMNETPP_SCAVE_SCAVECAPI_H
+#define __OMNETPP_SCAVE_SCAVECAPI_H
+
+#include <cstdint>
+#include "scavedefs.h"
+
+/**
+ * Plain C interface to the result file manager, for use from language
+ * bindings (Python ctypes) that cannot deal with C++ classes directly.
+ *
+ * Query results are returned as a column-oriented table in the same
+ * record layout as the "CSV-R" exporter produces (run, type, module, name,
+ * attrname, attrvalue, value, vectime, vecvalue), so that the Python side
+ * can wrap the columns into NumPy arrays without copying or parsing text.
+ * String columns are dictionary-encoded: they hold indices into the string
+ * pool of the table, with -1 standing for a blank cell.
+ *
+ * Functions that can fail return nullptr or a negative number, and the
+ * error message can be obtained with scave_get_last_error().
+ */
+extern "C" {
+
+typedef struct scave_manager scave_manager;
+typedef struct scave_table scave_table;
+
+/** Result type flags for scave_query(); same values as in ResultFileManager. */
+enum {
+    SCAVE_PARAMETER = 1<<0,
+    SCAVE_SCALAR = 1<<1,
+    SCAVE_STATISTICS = 1<<2,
+    SCAVE_HISTOGRAM = 1<<3,
+    SCAVE_VECTOR = 1<<4
+};
+
+/** Column identifiers for scave_table_get_string_column(). */
+enum {
+    SCAVE_COL_RUN,
+    SCAVE_COL_TYPE,
+    SCAVE_COL_MODULE,
+    SCAVE_COL_NAME,
+    SCAVE_COL_ATTRNAME,
+    SCAVE_COL_ATTRVALUE,
+    SCAVE_NUM_STRING_COLUMNS
+};
+
+/** Returns the message of the last failed call on this thread, or "". */
+SCAVE_API const char *scave_get_last_error();
+
+SCAVE_API scave_manager *scave_create_manager();
+SCAVE_API void scave_delete_manager(scave_manager *manager);
+
+/**
+ * Loads the given files, using several threads if numThreads is not 1
+ * (0 means one per CPU core). Returns the number of files loaded, or -1.
+ */
+SCAVE_API int scave_load_files(scave_manager *manager, const char **fileNames, int numFiles, int numThreads);
+
+/**
+ * Selects the results of the given types (SCAVE_SCALAR etc.) that match the
+ * filter expression (all of them if it is blank), and returns them as records. Only scalars and vectors
+ * are supported. Vector data are limited to the [startTime, endTime] interval.
+ */
+SCAVE_API scave_table *scave_query(scave_manager *manager, const char *filterExpression, int resultTypes, double startTime, double endTime);
+
+/**
+ * Like scave_query(), but vector data are reduced for plotting to the first,
+ * last, minimum and maximum points of each of numBins equal parts of the
+ * time interval (see readDownsampledVectorsIntoArrays()). numBins=0 means
+ * no reduction.
+ */
+SCAVE_API scave_table *scave_query_downsampled(scave_manager *manager, const char *filterExpression, int resultTypes, double startTime, double endTime, int numBins);
+SCAVE_API void scave_delete_table(scave_table *table);
+
+SCAVE_API int64_t scave_table_get_num_rows(const scave_table *table);
+SCAVE_API int64_t scave_table_get_num_strings(const scave_table *table);
+SCAVE_API const char *scave_table_get_string(const scave_table *table, int64_t index);
+SCAVE_API const int32_t *scave_table_get_string_column(const scave_table *table, int column);
+
+/** The "value" column; NaN in rows that are not scalars. */
+SCAVE_API const double *scave_table_get_values(const scave_table *table);
+
+/**
+ * Vector data, one entry per row: the number of data points (-1 in rows
+ * that are not vectors), and pointers to the time and value arrays. The
+ * arrays remain valid until the table is deleted.
+ */
+SCAVE_API const int64_t *scave_table_get_vector_lengths(const scave_table *table);
+SCAVE_API const double * const *scave_table_get_vector_times(const scave_table *table);
+SCAVE_API const double * const *scave_table_get_vector_values(const scave_table *table);
+
+} // extern "C"
+
+#endif
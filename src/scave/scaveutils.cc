@@ -19,14 +19,39 @@
 #include <utility>
 #include <clocale>
 #include "omnetpp/platdep/platmisc.h"
+#include "common/stringutil.h"
 #include "scaveutils.h"
 
+using namespace omnetpp::common;
+
 namespace omnetpp {
 namespace scave {
 
 
+// fast path for plain decimal numbers of at most maxDigits digits; returns false for anything else
+static inline bool parseSmallInt(const char *s, int maxDigits, int64_t& dest)
+{
+    const char *p = s;
+    bool negative = (*p == '-');
+    if (negative)
+        p++;
+    int64_t value = 0;
+    const char *digitsStart = p;
+    while (*p >= '0' && *p <= '9' && p - digitsStart < maxDigits)
+        value = 10*value + (*p++ - '0');
+    if (*p || p == digitsStart)
+        return false;
+    dest = negative ? -value : value;
+    return true;
+}
+
 bool parseInt(const char *s, int& dest)
 {
+    int64_t value;
+    if (parseSmallInt(s, 9, value)) {
+        dest = (int)value;
+        return true;
+    }
     char *e;
     dest = (int)strtol(s, &e, 10);
     return !*e;
@@ -34,6 +59,11 @@ bool parseInt(const char *s, int& dest)
 
 bool parseLong(const char *s, long& dest)
 {
+    int64_t value;
+    if (parseSmallInt(s, 9, value)) {
+        dest = (long)value;
+        return true;
+    }
     char *e;
     dest = strtol(s, &e, 10);
     return !*e;
@@ -41,6 +71,8 @@ bool parseLong(const char *s, long& dest)
 
 bool parseInt64(const char *s, int64_t& dest)
 {
+    if (parseSmallInt(s, 18, dest))
+        return true;
     char *e;
     dest = strtoll(s, &e, 10);
     return !*e;
@@ -48,6 +80,9 @@ bool parseInt64(const char *s, int64_t& dest)
 
 bool parseDouble(const char *s, double& dest)
 {
+    if (opp_parsedouble_fast(s, dest))
+        return true;
+
     char *e;
     setlocale(LC_NUMERIC, "C");
     dest = strtod(s, &e);
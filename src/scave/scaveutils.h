@@ -19,6 +19,8 @@
 
 #include <string>
 #include <set>
+#include <vector>
+#include <unordered_map>
 #include <functional>
 #include <cstdint>
 #include "common/commonutil.h"
@@ -83,6 +85,39 @@ class ScaveStringPool
         void clear() { lastInsertedPtr = nullptr; pool.clear(); }
 };
 
+/**
+ * Assigns small consecutive integer indices to pointers (typically pooled
+ * strings or attribute maps), so that they can be stored compactly, e.g. in
+ * columns of int. Indices are never reused until clear().
+ */
+template<class T>
+class ScaveIndexTable
+{
+    private:
+        std::vector<const T*> items;
+        std::unordered_map<const T*,int> indices;
+        const T *lastInsertedPtr = nullptr;
+        int lastInsertedIndex = -1;
+    public:
+        int insert(const T *item) {
+            if (item != lastInsertedPtr) {
+                auto p = indices.insert(std::make_pair(item, (int)items.size()));
+                if (p.second)
+                    items.push_back(item);
+                lastInsertedPtr = item;
+                lastInsertedIndex = p.first->second;
+            }
+            return lastInsertedIndex;
+        }
+        int find(const T *item) const {
+            auto it = indices.find(item);
+            return it != indices.end() ? it->second : -1;
+        }
+        const T *get(int index) const {return items[index];}
+        int size() const {return items.size();}
+        void clear() {items.clear(); indices.clear(); lastInsertedPtr = nullptr; lastInsertedIndex = -1;}
+};
+
 } // namespace scave
 }  // namespace omnetpp
 
@@ -184,7 +184,7 @@ void SqliteResultFileLoader::loadScalars()
         std::string moduleName = (const char *)sqlite3_column_text(stmt, 2);
         std::string scalarName = (const char *)sqlite3_column_text(stmt, 3);
         double scalarValue = sqlite3ColumnDouble(stmt,4);        // converts NULL to NaN
-        int i = resultFileManager->addScalar(fileRunMap.at(runId), moduleName.c_str(), scalarName.c_str(), emptyAttrs, scalarValue, false);
+        int i = resultFileManager->addScalar(fileRunMap.at(runId), moduleName.c_str(), scalarName.c_str(), emptyAttrs, scalarValue);
         sqliteScalarIdToScalarIdx[scalarId] = i;
     }
     finalizeStatement();
@@ -202,8 +202,7 @@ void SqliteResultFileLoader::loadScalars()
         SqliteScalarIdToScalarIdx::iterator it = sqliteScalarIdToScalarIdx.find(scalarId);
         if (it == sqliteScalarIdToScalarIdx.end())
             error("Invalid scalarId in scalarAttr table");
-        ScalarResult& sca = fileRunMap.at(runId)->scalarResults.at(sqliteScalarIdToScalarIdx.at(scalarId));
-        sca.setAttribute(attrName, attrValue);
+        resultFileManager->setScalarAttribute(fileRunMap.at(runId), it->second, attrName, attrValue);
     }
     finalizeStatement();
 }
@@ -15,6 +15,7 @@
 *--------------------------------------------------------------*/
 
 #include "common/opp_ctype.h"
+#include "common/vectorblockcodec.h"
 #include "omnetpp/platdep/platmisc.h"
 #include "scaveutils.h"
 #include "resultfilemanager.h"
@@ -194,7 +195,175 @@ void SqliteVectorDataReader::ensureDbOpen()
         }
 
         finalizeStatement();
+
+        // find vectors stored in packed blocks (older files do not have the table)
+        prepareStatement("SELECT COUNT(*) FROM sqlite_master WHERE type='table' AND name='vectorDataBlock';");
+        checkRow(sqlite3_step(stmt));
+        bool hasBlockTable = sqlite3_column_int(stmt, 0) != 0;
+        finalizeStatement();
+
+        if (hasBlockTable) {
+            prepareStatement("SELECT DISTINCT vectorId FROM vectorDataBlock;");
+            while (true) {
+                int resultCode = sqlite3_step(stmt);
+                if (resultCode == SQLITE_DONE)
+                    break;
+                checkRow(resultCode);
+                packedVectorIds.insert(sqlite3_column_int(stmt, 0));
+            }
+            finalizeStatement();
+        }
+    }
+}
+
+void SqliteVectorDataReader::splitVectorIds(const std::set<int>& vectorIds, std::set<int>& rowVectorIds, std::set<int>& blockVectorIds)
+{
+    for (int id : vectorIds)
+        (isPacked(id) ? blockVectorIds : rowVectorIds).insert(id);
+}
+
+std::vector<SqliteVectorDataReader::BlockInfo> SqliteVectorDataReader::getBlocks(int vectorId)
+{
+    prepareStatement(
+        "SELECT rowid, startEventNum, endEventNum, startSimtimeRaw, endSimtimeRaw, sampleCount "
+        "FROM vectorDataBlock WHERE vectorId = ? ORDER BY rowid;");
+    checkOK(sqlite3_bind_int64(stmt, 1, vectorId));
+
+    std::vector<BlockInfo> blocks;
+    while (true) {
+        int resultCode = sqlite3_step(stmt);
+        if (resultCode == SQLITE_DONE)
+            break;
+        checkRow(resultCode);
+
+        BlockInfo block;
+        block.rowId = sqlite3_column_int64(stmt, 0);
+        block.vectorId = vectorId;
+        block.startEventNum = sqlite3_column_int64(stmt, 1);
+        block.endEventNum = sqlite3_column_int64(stmt, 2);
+        block.startSimtimeRaw = sqlite3_column_int64(stmt, 3);
+        block.endSimtimeRaw = sqlite3_column_int64(stmt, 4);
+        block.count = sqlite3_column_int64(stmt, 5);
+        blocks.push_back(block);
     }
+    finalizeStatement();
+    return blocks;
+}
+
+void SqliteVectorDataReader::loadBlock(int64_t rowId, long serial, Entries& entries)
+{
+    prepareStatement("SELECT data FROM vectorDataBlock WHERE rowid = ?;");
+    checkOK(sqlite3_bind_int64(stmt, 1, rowId));
+    checkRow(sqlite3_step(stmt));
+
+    const char *data = (const char *)sqlite3_column_blob(stmt, 0);
+    int size = sqlite3_column_bytes(stmt, 0);
+    VectorBlockDecoder decoder(data, size);
+    eventnumber_t eventNumber;
+    int64_t simtimeRaw;
+    double value;
+    while (decoder.next(eventNumber, simtimeRaw, value))
+        entries.push_back(VectorDatum(serial++, eventNumber, BigDecimal(simtimeRaw, decoder.getScaleExp()), value));
+
+    finalizeStatement();
+}
+
+VectorDatum *SqliteVectorDataReader::findEntryInBlocks(int vectorId, bool after, const std::function<bool(const BlockInfo&)>& blockFilter, const std::function<bool(const VectorDatum&)>& entryFilter)
+{
+    // returns the first (after=true) or last (after=false) entry accepted by entryFilter;
+    // blockFilter must accept all blocks that may contain such an entry
+    std::vector<BlockInfo> blocks = getBlocks(vectorId);
+    std::vector<long> serials(blocks.size());
+    long serial = 0;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        serials[i] = serial;
+        serial += blocks[i].count;
+    }
+
+    Entries entries;
+    int n = blocks.size();
+    for (int k = 0; k < n; k++) {
+        int i = after ? k : n-1-k;
+        if (!blockFilter(blocks[i]))
+            continue;
+        entries.clear();
+        loadBlock(blocks[i].rowId, serials[i], entries);
+        if (after) {
+            for (auto it = entries.begin(); it != entries.end(); ++it)
+                if (entryFilter(*it))
+                    return new VectorDatum(*it);
+        }
+        else {
+            for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+                if (entryFilter(*it))
+                    return new VectorDatum(*it);
+        }
+    }
+    return nullptr;
+}
+
+void SqliteVectorDataReader::collectBlockEntries(const std::set<int>& vectorIds, const std::function<bool(const BlockInfo&)>& blockFilter, const std::function<bool(int vectorId, eventnumber_t eventNumber, int64_t simtimeRaw)>& sampleFilter)
+{
+    // note: blob columns are only read from the database when accessed, so skipping blocks is cheap
+    prepareStatement((
+        "SELECT rowid, vectorId, startEventNum, endEventNum, startSimtimeRaw, endSimtimeRaw, sampleCount, data "
+        "FROM vectorDataBlock WHERE vectorId IN (" + makePlaceholders(vectorIds.size()) + ") ORDER BY rowid;").c_str());
+
+    int i = 1;
+    for (int v : vectorIds)
+        checkOK(sqlite3_bind_int64(stmt, i++, v));
+
+    std::map<int, long> serials; // serial of the next sample, per vector
+    int currentVectorId = -1;
+    std::vector<VectorDatum> entryBuffer;
+    entryBuffer.reserve(bufferSize);
+
+    while (true) {
+        int resultCode = sqlite3_step(stmt);
+        if (resultCode == SQLITE_DONE)
+            break;
+        checkRow(resultCode);
+
+        BlockInfo block;
+        block.rowId = sqlite3_column_int64(stmt, 0);
+        block.vectorId = sqlite3_column_int(stmt, 1);
+        block.startEventNum = sqlite3_column_int64(stmt, 2);
+        block.endEventNum = sqlite3_column_int64(stmt, 3);
+        block.startSimtimeRaw = sqlite3_column_int64(stmt, 4);
+        block.endSimtimeRaw = sqlite3_column_int64(stmt, 5);
+        block.count = sqlite3_column_int64(stmt, 6);
+
+        long& nextSerial = serials[block.vectorId];
+        long serial = nextSerial;
+        nextSerial += block.count;
+        if (blockFilter && !blockFilter(block))
+            continue;
+
+        const char *data = (const char *)sqlite3_column_blob(stmt, 7);
+        int size = sqlite3_column_bytes(stmt, 7);
+        VectorBlockDecoder decoder(data, size);
+        eventnumber_t eventNumber;
+        int64_t simtimeRaw;
+        double value;
+        for ( ; decoder.next(eventNumber, simtimeRaw, value); serial++) {
+            if (sampleFilter && !sampleFilter(block.vectorId, eventNumber, simtimeRaw))
+                continue;
+
+            if (block.vectorId != currentVectorId || entryBuffer.size() >= bufferSize) {
+                if (!entryBuffer.empty())
+                    adapterLambda(currentVectorId, entryBuffer);
+                currentVectorId = block.vectorId;
+                entryBuffer.clear();
+            }
+
+            entryBuffer.push_back(VectorDatum(serial, eventNumber, BigDecimal(simtimeRaw, decoder.getScaleExp()), value));
+        }
+    }
+
+    if (!entryBuffer.empty())
+        adapterLambda(currentVectorId, entryBuffer);
+
+    finalizeStatement();
 }
 
 int SqliteVectorDataReader::getSimtimeExp(int vectorId)
@@ -262,6 +431,21 @@ VectorDatum *SqliteVectorDataReader::getEntryBySerial(int vectorId, int64_t seri
 {
     ensureDbOpen();
 
+    if (isPacked(vectorId)) {
+        if (serial < 0)
+            return nullptr;
+        long serialBase = 0;
+        for (const BlockInfo& block : getBlocks(vectorId)) {
+            if (serial < serialBase + block.count) {
+                Entries entries;
+                loadBlock(block.rowId, serialBase, entries);
+                return serial - serialBase < (int64_t)entries.size() ? new VectorDatum(entries[serial - serialBase]) : nullptr;
+            }
+            serialBase += block.count;
+        }
+        return nullptr;
+    }
+
     prepareStatement(
             "SELECT rowid, eventNumber, simtimeRaw, value "
             "FROM vectorData WHERE vectorId = ? ORDER BY rowid LIMIT 1 OFFSET ?;");
@@ -276,6 +460,20 @@ VectorDatum *SqliteVectorDataReader::getEntryBySimtime(int vectorId, simultime_t
 {
     ensureDbOpen();
 
+    if (isPacked(vectorId)) {
+        // compare raw values, like the SQL queries below
+        int simtimeExp = getSimtimeExp(vectorId);
+        int64_t simtimeRaw = simtime.getMantissaForScale(simtimeExp);
+        if (after)
+            return findEntryInBlocks(vectorId, true,
+                    [=](const BlockInfo& block) {return block.endSimtimeRaw >= simtimeRaw;},
+                    [=](const VectorDatum& datum) {return datum.simtime.getMantissaForScale(simtimeExp) >= simtimeRaw;});
+        else
+            return findEntryInBlocks(vectorId, false,
+                    [=](const BlockInfo& block) {return block.startSimtimeRaw <= simtimeRaw;},
+                    [=](const VectorDatum& datum) {return datum.simtime.getMantissaForScale(simtimeExp) <= simtimeRaw;});
+    }
+
     if (after) {
         prepareStatement(
             "SELECT rowid, eventNumber, simtimeRaw, value "
@@ -299,6 +497,17 @@ VectorDatum *SqliteVectorDataReader::getEntryByEventnum(int vectorId, eventnumbe
 {
     ensureDbOpen();
 
+    if (isPacked(vectorId)) {
+        if (after)
+            return findEntryInBlocks(vectorId, true,
+                    [=](const BlockInfo& block) {return block.endEventNum >= eventNum;},
+                    [=](const VectorDatum& datum) {return datum.eventNumber >= eventNum;});
+        else
+            return findEntryInBlocks(vectorId, false,
+                    [=](const BlockInfo& block) {return block.startEventNum <= eventNum;},
+                    [=](const VectorDatum& datum) {return datum.eventNumber <= eventNum;});
+    }
+
     if (after) {
         prepareStatement(
             "SELECT rowid, eventNumber, simtimeRaw, value "
@@ -320,22 +529,51 @@ void SqliteVectorDataReader::collectEntries(const std::set<int>& vectorIds)
 {
     ensureDbOpen();
 
-    prepareStatement((
-        "SELECT vectorId, eventNumber, simtimeRaw, value "
-        "FROM vectorData WHERE vectorId IN (" + makePlaceholders(vectorIds.size()) + ") ORDER BY rowid;").c_str());
+    std::set<int> rowVectorIds, blockVectorIds;
+    splitVectorIds(vectorIds, rowVectorIds, blockVectorIds);
 
-    int i = 1;
-    for (int v : vectorIds)
-        checkOK(sqlite3_bind_int64(stmt, i++, v));
+    if (!rowVectorIds.empty()) {
+        prepareStatement((
+            "SELECT vectorId, eventNumber, simtimeRaw, value "
+            "FROM vectorData WHERE vectorId IN (" + makePlaceholders(rowVectorIds.size()) + ") ORDER BY rowid;").c_str());
 
-    processStatementRows();
+        int i = 1;
+        for (int v : rowVectorIds)
+            checkOK(sqlite3_bind_int64(stmt, i++, v));
+
+        processStatementRows();
+    }
+
+    if (!blockVectorIds.empty())
+        collectBlockEntries(blockVectorIds, nullptr, nullptr);
 }
 
 void SqliteVectorDataReader::collectEntriesInSimtimeInterval(const std::set<int>& vectorIds, simultime_t startTime, simultime_t endTime)
 {
     ensureDbOpen();
 
-    std::map<int, std::set<int>> vectorIdGroups = groupVectorIdsBySimtimeExp(vectorIds);
+    std::set<int> rowVectorIds, blockVectorIds;
+    splitVectorIds(vectorIds, rowVectorIds, blockVectorIds);
+
+    if (!blockVectorIds.empty()) {
+        // same semantics as the SQL query below: compare with the bounds converted to raw simtime
+        std::map<int, std::pair<int64_t,int64_t>> rawBounds;
+        for (int id : blockVectorIds) {
+            int simtimeExp = getSimtimeExp(id);
+            rawBounds[id] = std::make_pair(startTime.getMantissaForScale(simtimeExp), endTime.getMantissaForScale(simtimeExp));
+        }
+        collectBlockEntries(blockVectorIds,
+                [&](const BlockInfo& block) {
+                    auto& bounds = rawBounds[block.vectorId];
+                    return block.endSimtimeRaw >= bounds.first && block.startSimtimeRaw < bounds.second;
+                },
+                [&](int vectorId, eventnumber_t eventNumber, int64_t simtimeRaw) {
+                    auto& bounds = rawBounds[vectorId];
+                    return simtimeRaw >= bounds.first && simtimeRaw < bounds.second;
+                });
+    }
+
+    std::map<int, std::set<int>> vectorIdGroups = groupVectorIdsBySimtimeExp(rowVectorIds);
 
     for (auto vectorIdGroup : vectorIdGroups) {
         int simtimeExp = vectorIdGroup.first;
@@ -367,19 +605,30 @@ void SqliteVectorDataReader::collectEntriesInEventnumInterval(const std::set<int
 {
     ensureDbOpen();
 
-    prepareStatement((
-        "SELECT vectorId, eventNumber, simtimeRaw, value "
-        "FROM vectorData WHERE vectorId IN (" + makePlaceholders(vectorIds.size()) + ") "
-        " AND eventNumber >= ? AND eventNumber < ? ORDER BY rowid;").c_str());
+    std::set<int> rowVectorIds, blockVectorIds;
+    splitVectorIds(vectorIds, rowVectorIds, blockVectorIds);
 
-    int i = 1;
-    for (int v : vectorIds)
-        checkOK(sqlite3_bind_int64(stmt, i++, v));
+    if (!rowVectorIds.empty()) {
+        prepareStatement((
+            "SELECT vectorId, eventNumber, simtimeRaw, value "
+            "FROM vectorData WHERE vectorId IN (" + makePlaceholders(rowVectorIds.size()) + ") "
+            " AND eventNumber >= ? AND eventNumber < ? ORDER BY rowid;").c_str());
+
+        int i = 1;
+        for (int v : rowVectorIds)
+            checkOK(sqlite3_bind_int64(stmt, i++, v));
+
+        checkOK(sqlite3_bind_int64(stmt, i++, startEventNum));
+        checkOK(sqlite3_bind_int64(stmt, i++, endEventNum));
 
-    checkOK(sqlite3_bind_int64(stmt, i++, startEventNum));
-    checkOK(sqlite3_bind_int64(stmt, i++, endEventNum));
+        processStatementRows();
+    }
 
-    processStatementRows();
+    if (!blockVectorIds.empty()) {
+        collectBlockEntries(blockVectorIds,
+                [=](const BlockInfo& block) {return block.endEventNum >= startEventNum && block.startEventNum < endEventNum;},
+                [=](int vectorId, eventnumber_t eventNumber, int64_t simtimeRaw) {return eventNumber >= startEventNum && eventNumber < endEventNum;});
+    }
 }
 
 
@@ -30,9 +30,22 @@ class VectorResult;
 
 #define SQLITEVECTORDATAREADER_BUFSIZE  (64*1024)
 
+/**
+ * Reads vector data from SQLite result files. Both the vectorData table
+ * (one row per sample) and the vectorDataBlock table (packed blocks of
+ * samples, see SqliteVectorFileWriter) are supported.
+ */
 class SCAVE_API SqliteVectorDataReader : public IVectorDataReader
 {
     protected:
+        struct BlockInfo {
+            int64_t rowId;
+            int vectorId;
+            eventnumber_t startEventNum, endEventNum;
+            int64_t startSimtimeRaw, endSimtimeRaw;
+            int64_t count;
+        };
+
         sqlite3 *db;
         sqlite3_stmt *stmt; // we only have one prepared statement active at a time
         std::string filename;
@@ -40,6 +53,7 @@ class SCAVE_API SqliteVectorDataReader : public IVectorDataReader
         size_t bufferSize;
         AdapterLambdaType adapterLambda;
         std::map<int, int> simtimeExpForVectorId;
+        std::set<int> packedVectorIds; // vectors stored in the vectorDataBlock table
 
     protected:
         void ensureDbOpen();
@@ -56,6 +70,13 @@ class SCAVE_API SqliteVectorDataReader : public IVectorDataReader
         VectorDatum *getSingleEntry(int simtimeExp);
         void processStatementRows();
 
+        bool isPacked(int vectorId) const {return packedVectorIds.find(vectorId) != packedVectorIds.end();}
+        void splitVectorIds(const std::set<int>& vectorIds, std::set<int>& rowVectorIds, std::set<int>& blockVectorIds);
+        std::vector<BlockInfo> getBlocks(int vectorId);
+        void loadBlock(int64_t rowId, long serial, Entries& entries);
+        VectorDatum *findEntryInBlocks(int vectorId, bool after, const std::function<bool(const BlockInfo&)>& blockFilter, const std::function<bool(const VectorDatum&)>& entryFilter);
+        void collectBlockEntries(const std::set<int>& vectorIds, const std::function<bool(const BlockInfo&)>& blockFilter, const std::function<bool(int vectorId, eventnumber_t eventNumber, int64_t simtimeRaw)>& sampleFilter);
+
     public:
         explicit SqliteVectorDataReader(const char* filename, bool includeEventNumbers, Adapter *adapter, size_t bufferSize = SQLITEVECTORDATAREADER_BUFSIZE) :
             SqliteVectorDataReader(filename, includeEventNumbers, [adapter](int vectorId, const std::vector<VectorDatum>& data) { adapter->process(vectorId, data); }, bufferSize)
@@ -70,6 +70,9 @@ string SqliteVectorFileExporterType::getXswtForm() const
             "         <button x:id='skipSpecialValues' text='Skip special values (NaN, +/-Inf)' x:style='CHECK' selection='false'>\n"
             "           <layoutData x:class='GridData' horizontalSpan='2'/>\n"
             "         </button>\n"
+            "         <button x:id='packed' text='Packed format (compressed blocks of samples)' x:style='CHECK' selection='false'>\n"
+            "           <layoutData x:class='GridData' horizontalSpan='2'/>\n"
+            "         </button>\n"
             "         <label text='Simtime scale exponent:'/>\n"
             "         <spinner x:id='simtimeScaleExp' x:style='BORDER' minimum='-14' maximum='0' textLimit='3' selection='-12'>\n"
             "           <layoutData x:class='GridData' widthHint='100'/>\n"
@@ -85,6 +88,7 @@ StringMap SqliteVectorFileExporterType::getSupportedOptions() const
     StringMap options {
         {"simtimeScaleExp", "Simulation time scale exponent. "}, //TODO explain: simtime-resolution, raw int64's in the db, etc
         {"skipSpecialValues", "Allow and skip NaN and +/-Inf values as simulation time in vectors."},
+        {"packed", "Store vector data as compressed blocks of samples in the vectorDataBlock table, instead of one row per sample in the vectorData table."},
         {"overallMemoryLimitMB", "Maximum amount of memory allowed to use, in megabytes. Use zero for no limit."},
         {"perVectorMemoryLimitKB", "Maximum amount of memory allowed to use per vector by the writer for output buffering, in kilobytes. Use zero for no limit."},
     };
@@ -106,6 +110,8 @@ void SqliteVectorFileExporter::setOption(const std::string& key, const std::stri
         setSimtimeScaleExp(opp_atol(value.c_str()));
     else if (key == "skipSpecialValues")
         setSkipSpecialValues(translateOptionValue(BOOLS,value));
+    else if (key == "packed")
+        setPacked(translateOptionValue(BOOLS,value));
     else if (key == "overallMemoryLimitMB")
         setOverallMemoryLimit(opp_atol(value.c_str()) * 1024*1024);
     else if (key == "perVectorMemoryLimitKB")
@@ -136,33 +142,33 @@ void SqliteVectorFileExporter::saveResults(const std::string& fileName, ResultFi
             vectorHandles[i] = writer.registerVector(vector->getModuleName(), vector->getName(), vector->getAttributes(), perVectorMemoryLimit);
         }
 
-        // write data for all vectors
-        std::vector<XYArray *> xyArrays = readVectorsIntoArrays(manager, filteredList, true, true, std::numeric_limits<size_t>::max(), vectorStartTime, vectorEndTime);
-        Assert((int)xyArrays.size() == filteredList.size());
+        // write data for all vectors, loading them a group at a time
 
         //NOTE if there's no event number, order of values belonging to the same t will be undefined...
 
-        for (int i = 0; i < filteredList.size(); i++) {
-            ID id = filteredList.get(i);
-            const VectorResult *vector = manager->getVector(id);
-            void *vectorHandle = vectorHandles[i];
-            XYArray *array = xyArrays[i];
-            int length = array->length();
-            bool hasPreciseX = array->hasPreciseX();
-            for (int j = 0; j < length; j++) {
-                const BigDecimal time = hasPreciseX ? array->getPreciseX(j) : BigDecimal(array->getX(j));
-                if (!time.isSpecial())
-                    writer.recordInVector(vectorHandle, array->getEventNumber(j), time.getMantissaForScale(simtimeScaleExp), array->getY(j));
-                else if (!skipSpecialValues) {
-                    std::string vectorName = vector->getModuleName() + "." + vector->getName();
-                    throw opp_runtime_error("Illegal value (NaN of Inf) encountered as time while exporting vector %s; "
-                            "use skipSpecialValues=true to turn off this error message", vectorName.c_str());
+        int offset = 0; // index of the group's first vector in filteredList
+        readVectorsInGroups(manager, filteredList, true, true, [&](const IDList& group, const std::vector<XYArray *>& xyArrays) {
+            Assert((int)xyArrays.size() == group.size());
+            for (int i = 0; i < group.size(); i++) {
+                ID id = group.get(i);
+                const VectorResult *vector = manager->getVector(id);
+                void *vectorHandle = vectorHandles[offset + i];
+                XYArray *array = xyArrays[i];
+                int length = array->length();
+                bool hasPreciseX = array->hasPreciseX();
+                for (int j = 0; j < length; j++) {
+                    const BigDecimal time = hasPreciseX ? array->getPreciseX(j) : BigDecimal(array->getX(j));
+                    if (!time.isSpecial())
+                        writer.recordInVector(vectorHandle, array->getEventNumber(j), time.getMantissaForScale(simtimeScaleExp), array->getY(j));
+                    else if (!skipSpecialValues) {
+                        std::string vectorName = vector->getModuleName() + "." + vector->getName();
+                        throw opp_runtime_error("Illegal value (NaN of Inf) encountered as time while exporting vector %s; "
+                                "use skipSpecialValues=true to turn off this error message", vectorName.c_str());
+                    }
                 }
             }
-        }
-
-        for (auto xyArray : xyArrays)
-            delete xyArray;
+            offset += group.size();
+        }, vectorMemoryLimit, numThreads, vectorStartTime, vectorEndTime);
 
         writer.endRecordingForRun();
     }
@@ -50,6 +50,8 @@ class SCAVE_API SqliteVectorFileExporter : public Exporter
         size_t getOverallMemoryLimit() const {return writer.getOverallMemoryLimit();}
         void setPerVectorMemoryLimit(size_t n) {perVectorMemoryLimit = n;}
         size_t getPerVectorMemoryLimit() const {return perVectorMemoryLimit;}
+        void setPacked(bool b) {writer.setPacked(b);}
+        bool getPacked() const {return writer.isPacked();}
 
         virtual void setOption(const std::string& key, const std::string& value);
         virtual void saveResults(const std::string& fileName, ResultFileManager *manager, const IDList& idlist, IProgressMonitor *monitor=nullptr);
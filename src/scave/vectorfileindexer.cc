@@ -19,10 +19,12 @@
 #include <sstream>
 #include <ostream>
 #include <cstdlib>
+#include <memory>
 #include "common/opp_ctype.h"
 #include "common/stringutil.h"
 #include "common/filereader.h"
 #include "common/linetokenizer.h"
+#include "common/vectorblockcodec.h"
 #include "omnetpp/platdep/platmisc.h"
 #include "scaveutils.h"
 #include "scaveexception.h"
@@ -31,6 +33,7 @@
 #include "vectorfileindexer.h"
 #include "indexedvectorfilereader.h"
 #include "vectorfileindex.h"
+#include "vectorsummary.h"
 
 using namespace std;
 using namespace omnetpp::common;
@@ -56,10 +59,30 @@ static string createTempFileName(const string& baseFileName)
     return tmpFileName;
 }
 
+void VectorFileIndexer::collectBinaryBlock(FILE *f, const char *vectorFileName, file_offset_t offset, int64_t size, int vectorId, Block *block, VectorSummaryBuilder *summaryBuilder)
+{
+    std::vector<char> data(size);
+    if (opp_fseek(f, offset, SEEK_SET) != 0 || fread(data.data(), 1, size, f) != (size_t)size)
+        throw opp_runtime_error("Vector file indexer: Cannot read block at offset %" PRId64 " from '%s'", (int64_t)offset, vectorFileName);
+
+    VectorBlockDecoder decoder(data.data(), size);
+    eventnumber_t eventNum;
+    int64_t rawTime;
+    double value;
+    while (decoder.next(eventNum, rawTime, value)) {
+        BigDecimal simtime(rawTime, decoder.getScaleExp());
+        block->collect(eventNum, simtime, value);
+        if (summaryBuilder)
+            summaryBuilder->collect(vectorId, simtime.dbl(), value);
+    }
+}
+
 // TODO: adjacent blocks are merged
 void VectorFileIndexer::generateIndex(const char *vectorFileName, IProgressMonitor *monitor)
 {
     FileReader reader(vectorFileName);
+    reader.setMemoryMapped(memoryMapped);
+    FILE *binaryFile = nullptr;  // for reading binary data blocks (version 4 files)
     LineTokenizer tokenizer(1024);
     VectorFileIndex index;
     index.vectorFileName = vectorFileName;
@@ -72,6 +95,13 @@ void VectorFileIndexer::generateIndex(const char *vectorFileName, IProgressMonit
     VectorInfo *lastVectorDecl = nullptr;
     Block *currentBlock = new Block();
 
+    // summaries need both the time and the value of data points
+    std::string summaryFileName = VectorSummaryFile::getSummaryFileName(vectorFileName);
+    std::unique_ptr<VectorSummaryBuilder> summaryBuilder;
+    if (generateSummaries || existsFile(summaryFileName))
+        summaryBuilder.reset(new VectorSummaryBuilder());
+    bool summarizeCurrentVector = false;
+
     int64_t onePercentFileSize = reader.getFileSize() / 100;
     int readPercentage = 0;
 
@@ -82,6 +112,8 @@ void VectorFileIndexer::generateIndex(const char *vectorFileName, IProgressMonit
         while ((line = reader.getNextLineBufferPointer()) != nullptr) {
             if (monitor) {
                 if (monitor->isCanceled()) {
+                    if (binaryFile)
+                        fclose(binaryFile);
                     monitor->done();
                     return;
                 }
@@ -145,8 +177,37 @@ void VectorFileIndexer::generateIndex(const char *vectorFileName, IProgressMonit
                     throw ResultFileFormatException("Vector file indexer: Missing version number", vectorFileName, lineNo);
                 if (!parseInt(tokens[1], version))
                     throw ResultFileFormatException("Vector file indexer: Version is not a number", vectorFileName, lineNo);
-                if (version != 2 && version != 3)
-                    throw ResultFileFormatException("Vector file indexer: Expects version 2 or version 3", vectorFileName, lineNo);
+                if (version != 2 && version != 3 && version != 4)
+                    throw ResultFileFormatException("Vector file indexer: Expects version 2, 3 or 4", vectorFileName, lineNo);
+            }
+            else if (tokens[0][0] == 'b' && strcmp(tokens[0], "block") == 0) {
+                // binary data block: "block <vectorId> <size>" line, followed by <size> bytes of data and a newline
+                int vectorId;
+                int64_t size;
+                if (numTokens < 3 || !parseInt(tokens[1], vectorId) || !parseInt64(tokens[2], size) || size < 0)
+                    throw ResultFileFormatException("Vector file indexer: Malformed block header", vectorFileName, lineNo);
+                VectorInfo *vectorRef = index.getVectorById(vectorId);
+                if (vectorRef == nullptr)
+                    throw ResultFileFormatException("Vector file indexer: Missing vector declaration", vectorFileName, lineNo);
+
+                if (!binaryFile && (binaryFile = fopen(vectorFileName, "rb")) == nullptr)
+                    throw opp_runtime_error("Vector file indexer: Cannot open '%s'", vectorFileName);
+
+                file_offset_t dataOffset = reader.getCurrentLineEndOffset();
+                Block *block = new Block();
+                block->startOffset = reader.getCurrentLineStartOffset();
+                block->size = (int64_t)(dataOffset + size + 1 - block->startOffset);
+                try {
+                    collectBinaryBlock(binaryFile, vectorFileName, dataOffset, size, vectorId, block, summaryBuilder.get());
+                }
+                catch (exception&) {
+                    delete block;
+                    throw;
+                }
+                vectorRef->addBlock(block);
+                index.addBlock(block);
+
+                reader.seekTo(dataOffset + size + 1);
             }
             else {  // data line
                 int vectorId;
@@ -176,6 +237,7 @@ void VectorFileIndexer::generateIndex(const char *vectorFileName, IProgressMonit
                     currentVectorRef = index.getVectorById(vectorId);
                     if (currentVectorRef == nullptr)
                         throw ResultFileFormatException("Vector file indexer: Missing vector declaration", vectorFileName, lineNo);
+                    summarizeCurrentVector = summaryBuilder && currentVectorRef->hasColumn('T') && currentVectorRef->hasColumn('V');
                 }
 
                 for (int i = 0; i < (int)currentVectorRef->columns.size(); ++i) {
@@ -203,6 +265,8 @@ void VectorFileIndexer::generateIndex(const char *vectorFileName, IProgressMonit
                 }
 
                 currentBlock->collect(eventNum, simTime, value);
+                if (summarizeCurrentVector)
+                    summaryBuilder->collect(vectorId, simTime.dbl(), value);
             }
         }
 
@@ -221,10 +285,14 @@ void VectorFileIndexer::generateIndex(const char *vectorFileName, IProgressMonit
         }
     }
     catch (exception&) {
+        if (binaryFile)
+            fclose(binaryFile);
         if (monitor)
             monitor->done();
         throw;
     }
+    if (binaryFile)
+        fclose(binaryFile);
     if (monitor) {
         if (monitor->isCanceled()) {
             monitor->done();
@@ -262,6 +330,20 @@ void VectorFileIndexer::generateIndex(const char *vectorFileName, IProgressMonit
         unlink(tempIndexFileName.c_str());
         throw;
     }
+
+    if (summaryBuilder) {
+        try {
+            summaryBuilder->write(summaryFileName.c_str(), readFileFingerprint(vectorFileName));
+        }
+        catch (exception&) {
+            // a stale summary file would be ignored anyway, but don't leave it around
+            unlink(summaryFileName.c_str());
+            if (monitor)
+                monitor->done();
+            throw;
+        }
+    }
+
     if (monitor)
         monitor->done();
 }
@@ -25,17 +25,41 @@
 namespace omnetpp {
 namespace scave {
 
+class VectorSummaryBuilder;
+
 /**
- * Generate an index file (.vci) for an output vector file (.vec)
+ * Generate an index file (.vci) for an output vector file (.vec), and
+ * optionally a summary file (.vcs, see VectorSummaryFile) as well.
  */
 class SCAVE_API VectorFileIndexer
 {
     using VectorInfo = VectorFileIndex::VectorInfo;
     using Block = VectorFileIndex::Block;
 
+    private:
+        bool generateSummaries = false;
+        bool memoryMapped = false;
+
+    protected:
+        void collectBinaryBlock(FILE *f, const char *vectorFileName, file_offset_t offset, int64_t size, int vectorId, Block *block, VectorSummaryBuilder *summaryBuilder);
+
     public:
         typedef omnetpp::common::IProgressMonitor IProgressMonitor;
 
+        /**
+         * Whether to generate a summary file as well. If the vector file already
+         * has a summary file, it is always regenerated together with the index.
+         */
+        void setGenerateSummaries(bool enabled) {generateSummaries = enabled;}
+        bool getGenerateSummaries() const {return generateSummaries;}
+
+        /**
+         * Whether to read the vector file via memory mapping (see FileReader::setMemoryMapped()).
+         * Off by default, because the process may crash if the file is truncated meanwhile.
+         */
+        void setMemoryMapped(bool enabled) {memoryMapped = enabled;}
+        bool getMemoryMapped() const {return memoryMapped;}
+
         void generateIndex(const char *filename, IProgressMonitor *monitor = nullptr);
 };
 
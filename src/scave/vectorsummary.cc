@@ -0,0 +1,475 @@
+//=========================================================================
+//  VECTORSUMMARY.CC - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#include "common/stringutil.h"
+#include "common/fileutil.h"
+#include "omnetpp/platdep/platmisc.h"
+#include "xyarray.h"
+#include "vectorsummary.h"
+
+using namespace omnetpp::common;
+
+namespace omnetpp {
+namespace scave {
+
+//
+// File layout (all numbers in native byte order, which is verified via the
+// byte order mark; all offsets are from the start of the file, and multiples of 8):
+//
+//   header:     magic[8], u32 version, u32 byteOrderMark, i64 fileSize,
+//               i64 lastModified, u32 numVectors, u32 entrySize
+//   directory:  for each vector: i32 vectorId, u32 numLevels, i64 bucketSize,
+//               u32 fanout, u32 reserved, then for each level: u64 offset, u64 numEntries
+//   entries:    arrays of VectorSummaryEntry
+//
+
+static const char MAGIC[8] = {'O', 'P', 'P', '-', 'V', 'C', 'S', '\n'};
+static const uint32_t VERSION = 1;
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const size_t HEADER_SIZE = sizeof(MAGIC) + 4 + 4 + 8 + 8 + 4 + 4;
+static const size_t VECTOR_HEADER_SIZE = 4 + 4 + 8 + 4 + 4;
+static const size_t LEVEL_HEADER_SIZE = 8 + 8;
+
+static_assert(sizeof(VectorSummaryEntry) == 9 * sizeof(double) + sizeof(int64_t), "VectorSummaryEntry must not contain padding");
+
+void VectorSummaryEntry::collect(double time, double value)
+{
+    if (count == 0) {
+        startTime = time;
+        first = value;
+    }
+    endTime = time;
+    last = value;
+    if (value < min) {
+        min = value;
+        minTime = time;
+    }
+    if (value > max) {
+        max = value;
+        maxTime = time;
+    }
+    sum += value;
+    count++;
+}
+
+void VectorSummaryEntry::merge(const VectorSummaryEntry& other)
+{
+    if (other.count == 0)
+        return;
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+    endTime = other.endTime;
+    last = other.last;
+    if (other.min < min) {
+        min = other.min;
+        minTime = other.minTime;
+    }
+    if (other.max > max) {
+        max = other.max;
+        maxTime = other.maxTime;
+    }
+    sum += other.sum;
+    count += other.count;
+}
+
+//---
+
+std::string VectorSummaryFile::getSummaryFileName(const char *vectorFileName)
+{
+    std::string summaryFileName(vectorFileName);
+    std::string::size_type pos = summaryFileName.rfind('.');
+    if (pos != std::string::npos)
+        summaryFileName.replace(summaryFileName.begin()+pos, summaryFileName.end(), ".vcs");
+    else
+        summaryFileName.append(".vcs");
+    return summaryFileName;
+}
+
+bool VectorSummaryFile::isSummaryFileUpToDate(const char *vectorFileName)
+{
+    std::string summaryFileName = getSummaryFileName(vectorFileName);
+    if (!fileExists(summaryFileName.c_str()))
+        return false;
+    try {
+        VectorSummaryFile summaryFile(summaryFileName.c_str());
+        FileFingerprint recorded = summaryFile.getRecordedFingerprint();
+        return recorded == readFileFingerprint(vectorFileName);
+    }
+    catch (std::exception&) {
+        return false;
+    }
+}
+
+VectorSummaryFile::VectorSummaryFile(const char *fileName) : fileName(fileName)
+{
+    FILE *f = fopen(fileName, "rb");
+    if (!f)
+        throw opp_runtime_error("Cannot open summary file '%s'", fileName);
+    struct opp_stat_t s;
+    if (opp_fstat(fileno(f), &s) != 0 || (uint64_t)s.st_size > (uint64_t)SIZE_MAX) {
+        fclose(f);
+        throw opp_runtime_error("Cannot determine size of summary file '%s'", fileName);
+    }
+    size = s.st_size;
+#ifndef _WIN32
+    if (size > 0) {
+        void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+        if (p != MAP_FAILED) {
+            madvise(p, size, MADV_RANDOM);
+            data = (const char *)p;
+            mapped = true;
+        }
+    }
+#endif
+    if (!mapped) {
+        // operator new[] returns memory suitably aligned for the entries
+        char *buffer = new char[size > 0 ? size : 1];
+        if (fread(buffer, 1, size, f) != size) {
+            delete[] buffer;
+            fclose(f);
+            throw opp_runtime_error("Cannot read summary file '%s'", fileName);
+        }
+        data = buffer;
+    }
+    fclose(f);
+
+    try {
+        parse();
+    }
+    catch (std::exception&) {
+        release();
+        throw;
+    }
+}
+
+VectorSummaryFile::~VectorSummaryFile()
+{
+    release();
+}
+
+void VectorSummaryFile::release()
+{
+#ifndef _WIN32
+    if (mapped)
+        munmap((void *)data, size);
+    else
+#endif
+        delete[] data;
+    data = nullptr;
+    mapped = false;
+}
+
+template<typename T>
+static T readAt(const char *data, size_t offset)
+{
+    T value;
+    memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+void VectorSummaryFile::parse()
+{
+    auto check = [this](bool cond) {
+        if (!cond)
+            throw opp_runtime_error("Corrupt or truncated summary file '%s'", fileName.c_str());
+    };
+
+    check(size >= HEADER_SIZE && memcmp(data, MAGIC, sizeof(MAGIC)) == 0);
+    size_t pos = sizeof(MAGIC);
+    uint32_t version = readAt<uint32_t>(data, pos); pos += 4;
+    uint32_t byteOrderMark = readAt<uint32_t>(data, pos); pos += 4;
+    if (version != VERSION || byteOrderMark != BYTE_ORDER_MARK)
+        throw opp_runtime_error("Summary file '%s' was written by a different version or on a different platform", fileName.c_str());
+    fingerprint.fileSize = readAt<int64_t>(data, pos); pos += 8;
+    fingerprint.lastModified = readAt<int64_t>(data, pos); pos += 8;
+    uint32_t numVectors = readAt<uint32_t>(data, pos); pos += 4;
+    uint32_t entrySize = readAt<uint32_t>(data, pos); pos += 4;
+    check(entrySize == sizeof(VectorSummaryEntry));
+
+    for (uint32_t i = 0; i < numVectors; i++) {
+        check(size - pos >= VECTOR_HEADER_SIZE);
+        VectorSummary summary;
+        summary.vectorId = readAt<int32_t>(data, pos);
+        uint32_t numLevels = readAt<uint32_t>(data, pos + 4);
+        summary.bucketSize = readAt<int64_t>(data, pos + 8);
+        summary.fanout = readAt<uint32_t>(data, pos + 16);
+        pos += VECTOR_HEADER_SIZE;
+        check(summary.bucketSize > 0 && summary.fanout >= 2 && (size - pos) / LEVEL_HEADER_SIZE >= numLevels);
+
+        for (uint32_t k = 0; k < numLevels; k++) {
+            uint64_t offset = readAt<uint64_t>(data, pos);
+            uint64_t numEntries = readAt<uint64_t>(data, pos + 8);
+            pos += LEVEL_HEADER_SIZE;
+            check(offset % 8 == 0 && offset <= size && (size - offset) / sizeof(VectorSummaryEntry) >= numEntries);
+            if (k > 0) {
+                // each entry must have its children on the level below
+                size_t below = summary.levels.back().size;
+                check(numEntries == (below + summary.fanout - 1) / summary.fanout);
+            }
+            summary.levels.push_back(VectorSummary::Level { (const VectorSummaryEntry *)(data + offset), (size_t)numEntries });
+        }
+        summaries[summary.vectorId] = summary;
+    }
+}
+
+const VectorSummary *VectorSummaryFile::getVectorSummary(int vectorId) const
+{
+    auto it = summaries.find(vectorId);
+    return it != summaries.end() && !it->second.levels.empty() ? &it->second : nullptr;
+}
+
+//---
+
+VectorSummaryBuilder::VectorSummaryBuilder(int64_t bucketSize, int fanout) : bucketSize(bucketSize), fanout(fanout)
+{
+    if (bucketSize < 1 || fanout < 2)
+        throw opp_runtime_error("VectorSummaryBuilder: Invalid bucket size or fanout");
+}
+
+namespace {
+
+class Buffer
+{
+  public:
+    std::vector<char> bytes;
+
+    void appendBytes(const void *data, size_t size) {bytes.insert(bytes.end(), (const char *)data, (const char *)data + size);}
+    template<typename T> void append(T value) {appendBytes(&value, sizeof(T));}
+};
+
+}  // namespace
+
+static std::string createTempFileName(const std::string& baseFileName)
+{
+    std::string prefix = baseFileName + ".temp";
+    std::string tmpFileName = prefix;
+    int serial = 0;
+    while (fileExists(tmpFileName.c_str()))
+        tmpFileName = opp_stringf("%s%d", prefix.c_str(), serial++);
+    return tmpFileName;
+}
+
+void VectorSummaryBuilder::write(const char *summaryFileName, const FileFingerprint& vectorFileFingerprint)
+{
+    // finish level 0, and build the upper levels
+    std::map<int,std::vector<std::vector<VectorSummaryEntry>>> pyramids;
+    for (auto& pair : vectors) {
+        VectorData& vector = pair.second;
+        if (vector.current.count > 0) {
+            vector.entries.push_back(vector.current);
+            vector.current = VectorSummaryEntry();
+        }
+        if (vector.entries.empty())
+            continue;
+        std::vector<std::vector<VectorSummaryEntry>>& levels = pyramids[pair.first];
+        levels.push_back(std::move(vector.entries));
+        while (levels.back().size() > (size_t)fanout) {
+            const std::vector<VectorSummaryEntry>& below = levels.back();
+            std::vector<VectorSummaryEntry> level((below.size() + fanout - 1) / fanout);
+            for (size_t i = 0; i < below.size(); i++)
+                level[i / fanout].merge(below[i]);
+            levels.push_back(std::move(level));
+        }
+    }
+    vectors.clear();
+    lastVector = nullptr;
+
+    Buffer header;
+    header.appendBytes(MAGIC, sizeof(MAGIC));
+    header.append<uint32_t>(VERSION);
+    header.append<uint32_t>(BYTE_ORDER_MARK);
+    header.append<int64_t>(vectorFileFingerprint.fileSize);
+    header.append<int64_t>(vectorFileFingerprint.lastModified);
+    header.append<uint32_t>(pyramids.size());
+    header.append<uint32_t>(sizeof(VectorSummaryEntry));
+    Assert(header.bytes.size() == HEADER_SIZE);
+
+    size_t directorySize = 0;
+    for (auto& pair : pyramids)
+        directorySize += VECTOR_HEADER_SIZE + pair.second.size() * LEVEL_HEADER_SIZE;
+    uint64_t offset = HEADER_SIZE + directorySize;
+    for (auto& pair : pyramids) {
+        header.append<int32_t>(pair.first);
+        header.append<uint32_t>(pair.second.size());
+        header.append<int64_t>(bucketSize);
+        header.append<uint32_t>(fanout);
+        header.append<uint32_t>(0);
+        for (auto& level : pair.second) {
+            header.append<uint64_t>(offset);
+            header.append<uint64_t>(level.size());
+            offset += level.size() * sizeof(VectorSummaryEntry);
+        }
+    }
+
+    // write to a temp file then rename it, so that other processes/threads never see an incomplete file
+    std::string tempFileName = createTempFileName(summaryFileName);
+    FILE *f = fopen(tempFileName.c_str(), "wb");
+    if (!f)
+        throw opp_runtime_error("Cannot open summary file '%s' for write: %s", tempFileName.c_str(), strerror(errno));
+    bool ok = fwrite(header.bytes.data(), 1, header.bytes.size(), f) == header.bytes.size();
+    for (auto& pair : pyramids)
+        for (auto& level : pair.second)
+            ok = ok && fwrite(level.data(), sizeof(VectorSummaryEntry), level.size(), f) == level.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        unlink(tempFileName.c_str());
+        throw opp_runtime_error("Cannot write summary file '%s'", tempFileName.c_str());
+    }
+    if (unlink(summaryFileName) != 0 && errno != ENOENT) {
+        unlink(tempFileName.c_str());
+        throw opp_runtime_error("Cannot remove original summary file '%s': %s", summaryFileName, strerror(errno));
+    }
+    if (rename(tempFileName.c_str(), summaryFileName) != 0) {
+        unlink(tempFileName.c_str());
+        throw opp_runtime_error("Cannot rename summary file from '%s' to '%s': %s", tempFileName.c_str(), summaryFileName, strerror(errno));
+    }
+}
+
+//---
+
+VectorDownsampler::VectorDownsampler(double startTime, double endTime, int numBins) : startTime(startTime), endTime(endTime)
+{
+    if (numBins < 1)
+        throw opp_runtime_error("VectorDownsampler: Number of bins must be positive");
+    if (!std::isfinite(startTime) || !std::isfinite(endTime) || startTime > endTime)
+        throw opp_runtime_error("VectorDownsampler: Invalid time interval");
+    binWidth = (endTime - startTime) / numBins;
+    bins.resize(numBins);
+}
+
+void VectorDownsampler::updateFirstLast(Bin& bin, double time, double value, int64_t serial)
+{
+    if (bin.count == 0 || time < bin.firstTime || (time == bin.firstTime && serial < bin.firstSerial)) {
+        bin.firstTime = time;
+        bin.first = value;
+        bin.firstSerial = serial;
+    }
+    if (bin.count == 0 || time > bin.lastTime || (time == bin.lastTime && serial > bin.lastSerial)) {
+        bin.lastTime = time;
+        bin.last = value;
+        bin.lastSerial = serial;
+    }
+}
+
+void VectorDownsampler::updateMinMax(Bin& bin, double time, double value)
+{
+    // points may arrive out of order, so break ties by time to get the same result as in-order
+    if (value < bin.min || (value == bin.min && time < bin.minTime)) {
+        bin.min = value;
+        bin.minTime = time;
+    }
+    if (value > bin.max || (value == bin.max && time < bin.maxTime)) {
+        bin.max = value;
+        bin.maxTime = time;
+    }
+}
+
+void VectorDownsampler::collect(double time, double value, int64_t serial)
+{
+    if (time < startTime || time > endTime)
+        return;
+    Bin& bin = bins[getBinIndex(time)];
+    updateFirstLast(bin, time, value, serial);
+    updateMinMax(bin, time, value);
+    bin.count++;
+}
+
+void VectorDownsampler::collect(const VectorSummaryEntry& entry, int64_t firstSerial)
+{
+    if (entry.count == 0)
+        return;
+    Bin& bin = bins[getBinIndex(entry.startTime)];
+    updateFirstLast(bin, entry.startTime, entry.first, firstSerial);
+    bin.count++;
+    updateFirstLast(bin, entry.endTime, entry.last, firstSerial + entry.count - 1);
+    bin.count += entry.count - 1;
+    if (!std::isnan(entry.minTime))
+        updateMinMax(bin, entry.minTime, entry.min);
+    if (!std::isnan(entry.maxTime))
+        updateMinMax(bin, entry.maxTime, entry.max);
+}
+
+void VectorDownsampler::collectSummaryEntry(const VectorSummary& summary, int level, size_t index, int64_t entrySize, std::vector<std::pair<int64_t,int64_t>>& rawRanges)
+{
+    const VectorSummaryEntry& entry = summary.levels[level].entries[index];
+    if (entry.count == 0 || entry.endTime < startTime || entry.startTime > endTime)
+        return;
+    bool inside = entry.startTime >= startTime && entry.endTime <= endTime;
+    if (inside && getBinIndex(entry.startTime) == getBinIndex(entry.endTime))
+        collect(entry, index * entrySize);  // all entries but the last one of a level are full
+    else if (level > 0) {
+        const VectorSummary::Level& below = summary.levels[level-1];
+        size_t end = std::min(below.size, (index + 1) * summary.fanout);
+        for (size_t i = index * summary.fanout; i < end; i++)
+            collectSummaryEntry(summary, level-1, i, entrySize / summary.fanout, rawRanges);
+    }
+    else {
+        // the points of the entry that determine the last point of a bin and the
+        // first point of the next one are not in the summary
+        int64_t firstSerial = index * entrySize;
+        if (!rawRanges.empty() && rawRanges.back().second == firstSerial)
+            rawRanges.back().second += entry.count;
+        else
+            rawRanges.push_back(std::make_pair(firstSerial, firstSerial + entry.count));
+    }
+}
+
+void VectorDownsampler::collect(const VectorSummary& summary, std::vector<std::pair<int64_t,int64_t>>& rawRanges)
+{
+    if (summary.levels.empty())
+        return;
+    int top = summary.levels.size() - 1;
+    int64_t entrySize = summary.bucketSize;
+    for (int level = 0; level < top; level++)
+        entrySize *= summary.fanout;
+    for (size_t i = 0; i < summary.levels[top].size; i++)
+        collectSummaryEntry(summary, top, i, entrySize, rawRanges);  // note: visits entries in serial order
+}
+
+void VectorDownsampler::fillArray(XYArray *array) const
+{
+    for (const Bin& bin : bins) {
+        if (bin.count == 0)
+            continue;
+        std::pair<double,double> points[4];
+        int n = 0;
+        points[n++] = std::make_pair(bin.firstTime, bin.first);
+        if (!std::isnan(bin.minTime))
+            points[n++] = std::make_pair(bin.minTime, bin.min);
+        if (!std::isnan(bin.maxTime))
+            points[n++] = std::make_pair(bin.maxTime, bin.max);
+        points[n++] = std::make_pair(bin.lastTime, bin.last);
+        std::stable_sort(points + 1, points + n - 1, [](const std::pair<double,double>& a, const std::pair<double,double>& b) {return a.first < b.first;});
+        for (int i = 0; i < n; i++) {
+            if (i > 0 && points[i] == points[i-1])
+                continue;
+            array->xs.push_back(points[i].first);
+            array->ys.push_back(points[i].second);
+        }
+    }
+}
+
+}  // namespace scave
+}  // namespace omnetpp
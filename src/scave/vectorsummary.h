@@ -0,0 +1,222 @@
+//=========================================================================
+//  VECTORSUMMARY.H - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#ifndef __OMNETPP_SCAVE_VECTORSUMMARY_H
+#define __OMNETPP_SCAVE_VECTORSUMMARY_H
+
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+#include <utility>
+#include "scavedefs.h"
+#include "scaveutils.h"
+
+namespace omnetpp {
+namespace scave {
+
+class XYArray;
+
+/**
+ * Summary of a run of consecutive data points of a vector.
+ * The layout is also the on-disk format, see VectorSummaryFile.
+ */
+struct SCAVE_API VectorSummaryEntry
+{
+    double startTime = NAN, endTime = NAN; // time of the first and last data point
+    double minTime = NAN, maxTime = NAN;   // time of the minimum and maximum value; NaN if all values are NaN
+    double first = NAN, last = NAN;        // first and last value
+    double min = INFINITY, max = -INFINITY;
+    double sum = 0;
+    int64_t count = 0;
+
+    double getMean() const {return sum / count;}
+    void collect(double time, double value);
+    void merge(const VectorSummaryEntry& other);
+};
+
+/**
+ * Multi-resolution summary (level-of-detail pyramid) of one vector. Level 0
+ * summarizes each consecutive group of bucketSize data points in one entry,
+ * and each entry of level k+1 summarizes fanout consecutive entries of level k.
+ * The top level has at most fanout entries.
+ */
+struct SCAVE_API VectorSummary
+{
+    struct Level {
+        const VectorSummaryEntry *entries;
+        size_t size;
+    };
+
+    int vectorId = -1;
+    int64_t bucketSize = 0;
+    int fanout = 0;
+    std::vector<Level> levels; // levels[0] is the finest
+};
+
+/**
+ * A summary file (.vcs), which holds the summary pyramids of the vectors of
+ * an output vector file. It is an optional companion of the index file (.vci);
+ * it is generated by VectorFileIndexer on request, and updated with the index
+ * file afterwards. Like the index file, it records the size and modification
+ * time of the vector file, and is only valid while they match.
+ *
+ * The file is memory-mapped where possible, and the entries are accessed in
+ * place. Throws an exception if the file is malformed, or was written on a
+ * platform with a different byte order or by a different version of the code.
+ */
+class SCAVE_API VectorSummaryFile
+{
+  private:
+    std::string fileName;
+    const char *data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+    FileFingerprint fingerprint;
+    std::map<int,VectorSummary> summaries;
+
+  private:
+    void parse();
+    void release();
+
+  public:
+    static std::string getSummaryFileName(const char *vectorFileName);
+
+    /**
+     * Returns true if the summary file of the given vector file exists, is
+     * readable, and was made from the current version of the vector file.
+     */
+    static bool isSummaryFileUpToDate(const char *vectorFileName);
+
+    VectorSummaryFile(const char *fileName);
+    ~VectorSummaryFile();
+    VectorSummaryFile(const VectorSummaryFile&) = delete;
+
+    const FileFingerprint& getRecordedFingerprint() const {return fingerprint;}
+
+    /**
+     * Returns the summary of the given vector, or nullptr if the file has none.
+     * The returned object is valid while this object exists.
+     */
+    const VectorSummary *getVectorSummary(int vectorId) const;
+};
+
+/**
+ * Builds the summary pyramids of vectors from their data points, and writes
+ * them into a summary file. The data points of each vector must be added in
+ * the order they appear in the vector file.
+ */
+class SCAVE_API VectorSummaryBuilder
+{
+  private:
+    struct VectorData {
+        VectorSummaryEntry current;
+        std::vector<VectorSummaryEntry> entries; // level 0
+    };
+    int64_t bucketSize;
+    int fanout;
+    std::map<int,VectorData> vectors;
+    int lastVectorId = -1;
+    VectorData *lastVector = nullptr;
+
+  public:
+    VectorSummaryBuilder(int64_t bucketSize=256, int fanout=8);
+    VectorSummaryBuilder(const VectorSummaryBuilder&) = delete;
+
+    void collect(int vectorId, double time, double value) {
+        if (vectorId != lastVectorId || lastVector == nullptr) {
+            lastVectorId = vectorId;
+            lastVector = &vectors[vectorId];
+        }
+        VectorData& vector = *lastVector;
+        vector.current.collect(time, value);
+        if (vector.current.count == bucketSize) {
+            vector.entries.push_back(vector.current);
+            vector.current = VectorSummaryEntry();
+        }
+    }
+
+    /**
+     * Writes the summary file. The file is written under a temporary name
+     * first, and renamed when complete.
+     */
+    void write(const char *summaryFileName, const FileFingerprint& vectorFileFingerprint);
+};
+
+/**
+ * Reduces a series to at most four points (the first, last, minimum and
+ * maximum) per bin, where the bins divide the [startTime,endTime] interval
+ * into numBins equal parts; with one bin per pixel, a line plot of the result
+ * is indistinguishable from that of the full series. Data points can be added
+ * in any order, individually or as summary entries; points with equal times
+ * are ordered by their serial (position in the vector), so the result is the
+ * same as with the data points added in order.
+ */
+class SCAVE_API VectorDownsampler
+{
+  private:
+    struct Bin {
+        double firstTime, first, lastTime, last;
+        int64_t firstSerial, lastSerial;
+        double minTime = NAN, min = INFINITY, maxTime = NAN, max = -INFINITY;
+        int64_t count = 0;
+    };
+    double startTime, endTime, binWidth;
+    std::vector<Bin> bins;
+
+  private:
+    void collectSummaryEntry(const VectorSummary& summary, int level, size_t index, int64_t entrySize, std::vector<std::pair<int64_t,int64_t>>& rawRanges);
+    static void updateFirstLast(Bin& bin, double time, double value, int64_t serial);
+    static void updateMinMax(Bin& bin, double time, double value);
+
+  public:
+    VectorDownsampler(double startTime, double endTime, int numBins);
+
+    int getBinIndex(double time) const {
+        int i = binWidth > 0 ? (int)std::floor((time - startTime) / binWidth) : 0;
+        return i < 0 ? 0 : i >= (int)bins.size() ? (int)bins.size() - 1 : i;
+    }
+
+    /**
+     * Adds a data point; serial is its position in the vector. Points outside
+     * the [startTime,endTime] interval are ignored.
+     */
+    void collect(double time, double value, int64_t serial);
+
+    /**
+     * Adds a summary entry that lies within a single bin; firstSerial is the
+     * position of its first data point in the vector.
+     */
+    void collect(const VectorSummaryEntry& entry, int64_t firstSerial);
+
+    /**
+     * Adds the part of a vector that lies within the [startTime,endTime] interval,
+     * using the coarsest summary entries that each fit into a single bin. Where
+     * the summary is not enough, i.e. for the finest entries that straddle a bin
+     * boundary or an end of the interval, the serial number ranges [first,end)
+     * whose data points should be added via collect(time, value, serial) are
+     * appended to rawRanges, sorted and disjoint.
+     */
+    void collect(const VectorSummary& summary, std::vector<std::pair<int64_t,int64_t>>& rawRanges);
+
+    /**
+     * Appends the reduced series to the array, in time order.
+     */
+    void fillArray(XYArray *array) const;
+};
+
+} // namespace scave
+}  // namespace omnetpp
+
+#endif
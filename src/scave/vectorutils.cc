@@ -18,10 +18,14 @@
 #include "vectorutils.h"
 
 #include <set>
+#include <deque>
+#include <future>
+#include <thread>
 #include "common/opp_ctype.h"
 #include "common/commonutil.h"
 #include "common/stringutil.h"
 #include "common/stlutil.h"
+#include "common/fileutil.h"
 #include "scaveutils.h"
 #include "memoryutils.h"
 #include "xyarray.h"
@@ -29,6 +33,7 @@
 #include "indexedvectorfilereader.h"
 #include "sqliteresultfileutils.h"
 #include "sqlitevectordatareader.h"
+#include "vectorsummary.h"
 #include "interruptedflag.h"
 
 using namespace std;
@@ -37,6 +42,11 @@ namespace omnetpp {
 using namespace common;
 namespace scave {
 
+static int getVectorElementSize(bool includePreciseX, bool includeEventNumbers)
+{
+    return sizeof(double) + sizeof(double) + (includePreciseX ? sizeof(BigDecimal) : 0) + (includeEventNumbers ? sizeof(eventnumber_t) : 0);
+}
+
 vector<XYArray *> readVectorsIntoArrays(ResultFileManager *manager, const IDList& idlist, bool includePreciseX, bool includeEventNumbers, size_t memoryLimitBytes, double simTimeStart, double simTimeEnd, InterruptedFlag *interrupted)
 {
     std::vector<XYArray *> result;
@@ -72,7 +82,7 @@ vector<XYArray *> readVectorsIntoArrays(ResultFileManager *manager, const IDList
             vectorIdToIndex[vectorID] = idlist.indexOf(id);
         }
 
-        const int elementSize = sizeof(double) + sizeof(double) + (includePreciseX ? sizeof(BigDecimal) : 0) + (includeEventNumbers ? sizeof(eventnumber_t) : 0);
+        const int elementSize = getVectorElementSize(includePreciseX, includeEventNumbers);
 
         auto adapter = [&](int vectorId, const std::vector<VectorDatum>& data) {
             memoryUsedBytes += data.size() * elementSize;
@@ -122,9 +132,206 @@ vector<XYArray *> readVectorsIntoArrays(ResultFileManager *manager, const IDList
     return result;
 }
 
+static void deleteArrays(const std::vector<XYArray *>& arrays)
+{
+    for (XYArray *array : arrays)
+        delete array;
+}
+
+void readVectorsInGroups(ResultFileManager *manager, const IDList& idlist, bool includePreciseX, bool includeEventNumbers, const VectorGroupConsumer& consumer, size_t memoryLimitBytes, int numThreads, double simTimeStart, double simTimeEnd, InterruptedFlag *interrupted)
+{
+    if (numThreads <= 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    // with multiple threads, numThreads groups are being read while the consumer holds one
+    size_t groupLimitBytes = numThreads == 1 ? memoryLimitBytes : memoryLimitBytes / (numThreads + 1);
+    size_t elementSize = getVectorElementSize(includePreciseX, includeEventNumbers);
+
+    std::vector<IDList> groups;
+    std::vector<ID> group;
+    size_t groupBytes = 0;
+    for (ID id : idlist) {
+        int64_t count = manager->getVector(id)->getStatistics().getCount();
+        size_t vectorBytes = std::max(count, (int64_t)0) * elementSize;
+        if (!group.empty() && groupBytes + vectorBytes > groupLimitBytes) {
+            groups.push_back(IDList(std::move(group)));
+            group.clear();
+            groupBytes = 0;
+        }
+        group.push_back(id);
+        groupBytes += vectorBytes;
+    }
+    if (!group.empty())
+        groups.push_back(IDList(std::move(group)));
+
+    auto readGroup = [=](const IDList& group) {
+        return readVectorsIntoArrays(manager, group, includePreciseX, includeEventNumbers, std::numeric_limits<size_t>::max(), simTimeStart, simTimeEnd, interrupted);
+    };
+
+    if (numThreads == 1 || groups.size() <= 1) {
+        for (const IDList& group : groups) {
+            std::vector<XYArray *> arrays = readGroup(group);
+            try {
+                consumer(group, arrays);
+            }
+            catch (std::exception&) {
+                deleteArrays(arrays);
+                throw;
+            }
+            deleteArrays(arrays);
+        }
+        return;
+    }
+
+    std::deque<std::future<std::vector<XYArray *>>> pending;
+    size_t next = 0;
+    try {
+        for (const IDList& group : groups) {
+            while (next < groups.size() && pending.size() < (size_t)numThreads)
+                pending.push_back(std::async(std::launch::async, readGroup, std::cref(groups[next++])));
+            std::vector<XYArray *> arrays = pending.front().get();
+            pending.pop_front();
+            try {
+                consumer(group, arrays);
+            }
+            catch (std::exception&) {
+                deleteArrays(arrays);
+                throw;
+            }
+            deleteArrays(arrays);
+        }
+    }
+    catch (std::exception&) {
+        // wait for the reads still in progress, and discard their results
+        for (auto& future : pending) {
+            try {
+                deleteArrays(future.get());
+            }
+            catch (std::exception&) {
+            }
+        }
+        throw;
+    }
+}
+
+vector<XYArray *> readDownsampledVectorsIntoArrays(ResultFileManager *manager, const IDList& idlist, int numBins, double simTimeStart, double simTimeEnd, InterruptedFlag *interrupted)
+{
+    std::vector<XYArray *> result;
+    result.resize(idlist.size());
+    for (size_t i = 0; i < result.size(); ++i)
+        result[i] = new XYArray();
+
+    try {
+        ResultFileList filteredVectorFileList = manager->getUniqueFiles(idlist);
+        for (ResultFile *resultFile : filteredVectorFileList) {
+            const char *fileName = resultFile->getFileSystemFilePath().c_str();
+            RunList runs = manager->getRunsInFile(resultFile);
+            if (runs.size() > 1)
+                throw opp_runtime_error("More than one run in vector file.");
+            IDList idsInFile = manager->filterIDList(idlist, runs[0], nullptr, nullptr);
+
+            // the time interval of the bins is the part of [simTimeStart,simTimeEnd] where the vector has data
+            std::map<int, std::unique_ptr<VectorDownsampler>> downsamplers; // by vectorId
+            std::map<int, int> vectorIdToIndex;
+            for (ID id : idsInFile) {
+                const VectorResult *vector = manager->getVector(id);
+                double startTime = std::max(simTimeStart, vector->getStartTime().dbl());
+                double endTime = std::min(simTimeEnd, vector->getEndTime().dbl());
+                if (vector->getStatistics().getCount() <= 0 || startTime > endTime)
+                    continue;
+                downsamplers[vector->getVectorId()].reset(new VectorDownsampler(startTime, endTime, numBins));
+                vectorIdToIndex[vector->getVectorId()] = idlist.indexOf(id);
+            }
+            if (downsamplers.empty())
+                continue;
+
+            // use the summary file where possible
+            bool isSqliteFile = SqliteResultFileUtils::isSqliteFile(fileName);
+            std::unique_ptr<VectorSummaryFile> summaryFile;
+            std::string summaryFileName = VectorSummaryFile::getSummaryFileName(fileName);
+            if (!isSqliteFile && fileExists(summaryFileName.c_str())) {
+                try {
+                    summaryFile.reset(new VectorSummaryFile(summaryFileName.c_str()));
+                    FileFingerprint recorded = summaryFile->getRecordedFingerprint();
+                    if (!(recorded == readFileFingerprint(fileName)))
+                        summaryFile.reset();
+                }
+                catch (std::exception&) {
+                    summaryFile.reset(); // unusable, read the vector file instead
+                }
+            }
+
+            std::set<int> unsummarizedVectorIds;
+            std::map<int, std::vector<std::pair<int64_t,int64_t>>> rawRanges; // serial number ranges by vectorId
+            for (auto& pair : downsamplers) {
+                const VectorSummary *summary = summaryFile ? summaryFile->getVectorSummary(pair.first) : nullptr;
+                if (summary)
+                    pair.second->collect(*summary, rawRanges[pair.first]);
+                else
+                    unsummarizedVectorIds.insert(pair.first);
+            }
+
+            // read the data points that the summaries could not stand in for
+            bool needRawData = !unsummarizedVectorIds.empty();
+            for (auto& pair : rawRanges)
+                needRawData = needRawData || !pair.second.empty();
+            if (needRawData) {
+                // readers that don't know the serials (unpacked SQLite files) deliver -1;
+                // the data of each vector arrives in order, so number the points here
+                std::map<int, int64_t> nextSerials; // by vectorId
+                auto adapter = [&](int vectorId, const std::vector<VectorDatum>& data) {
+                    VectorDownsampler *downsampler = downsamplers.at(vectorId).get();
+                    int64_t& nextSerial = nextSerials[vectorId];
+                    for (const VectorDatum& vd : data) {
+                        int64_t serial = vd.serial >= 0 ? vd.serial : nextSerial;
+                        nextSerial = serial + 1;
+                        downsampler->collect(vd.simtime.dbl(), vd.value, serial);
+                    }
+                    if (interrupted != nullptr && interrupted->flag)
+                        throw InterruptedException("Vector loading interrupted");
+                };
+
+                std::unique_ptr<IVectorDataReader> reader;
+                if (isSqliteFile)
+                    reader.reset(new SqliteVectorDataReader(fileName, false, adapter));
+                else
+                    reader.reset(new IndexedVectorFileReader(fileName, false, adapter));
+
+                if (!unsummarizedVectorIds.empty()) {
+                    if (simTimeStart == -INFINITY && simTimeEnd == INFINITY)
+                        reader->collectEntries(unsummarizedVectorIds);
+                    else {
+                        // the reader compares BigDecimal times, and the conversion from double
+                        // rounds, so read a bit more; the downsamplers drop the points outside
+                        double margin = 1e-9 * std::max(1.0, std::max(std::fabs(simTimeStart), std::fabs(simTimeEnd)));
+                        reader->collectEntriesInSimtimeInterval(unsummarizedVectorIds, simTimeStart - margin, simTimeEnd + margin);
+                    }
+                }
+                // raw ranges only come from summary files, which only exist for .vec files
+                for (auto& pair : rawRanges)
+                    if (!pair.second.empty())
+                        static_cast<IndexedVectorFileReader *>(reader.get())->collectEntriesInSerialRanges(pair.first, pair.second);
+            }
+
+            for (auto& pair : downsamplers)
+                pair.second->fillArray(result[vectorIdToIndex.at(pair.first)]);
+        }
+    }
+    catch (std::exception&) {
+        deleteArrays(result);
+        throw;
+    }
+
+    return result;
+}
+
 XYArrayVector *readVectorsIntoArrays2(ResultFileManager *manager, const IDList& idlist, bool includePreciseX, bool includeEventNumbers, size_t memoryLimitBytes, double simTimeStart, double simTimeEnd, InterruptedFlag *interrupted) {
     return new XYArrayVector(readVectorsIntoArrays(manager, idlist, includePreciseX, includeEventNumbers, memoryLimitBytes, simTimeStart, simTimeEnd, interrupted));
 }
 
+XYArrayVector *readDownsampledVectorsIntoArrays2(ResultFileManager *manager, const IDList& idlist, int numBins, double simTimeStart, double simTimeEnd, InterruptedFlag *interrupted) {
+    return new XYArrayVector(readDownsampledVectorsIntoArrays(manager, idlist, numBins, simTimeStart, simTimeEnd, interrupted));
+}
+
 } // namespace scave
 }  // namespace omnetpp
@@ -19,6 +19,7 @@
 #define __OMNETPP_SCAVE_VECTORUTILS_H
 
 #include <limits>
+#include <functional>
 #include "scavedefs.h"
 #include "resultfilemanager.h"
 #include "xyarray.h"
@@ -33,6 +34,33 @@ namespace scave {
  */
 SCAVE_API std::vector<XYArray *> readVectorsIntoArrays(ResultFileManager *manager, const IDList& idlist, bool includePreciseX, bool includeEventNumbers, size_t memoryLimitBytes = std::numeric_limits<size_t>::max(), double simTimeStart = -INFINITY, double simTimeEnd = INFINITY, InterruptedFlag *interrupted=nullptr);
 
+typedef std::function<void(const IDList& vectors, const std::vector<XYArray *>& arrays)> VectorGroupConsumer;
+
+/**
+ * Reads the VectorResult items in the IDList in groups, and passes each group
+ * with its data to the consumer, in IDList order. The arrays are deleted when
+ * the consumer returns. Groups are formed so that their estimated size (based
+ * on the number of values in each vector) stays within memoryLimitBytes; a
+ * vector that is larger than that forms a group by itself. With numThreads > 1
+ * (0 means the number of CPU cores), the following groups are read in parallel
+ * while the consumer processes the current one, and the memory limit is shared
+ * among them.
+ */
+SCAVE_API void readVectorsInGroups(ResultFileManager *manager, const IDList& idlist, bool includePreciseX, bool includeEventNumbers, const VectorGroupConsumer& consumer, size_t memoryLimitBytes = std::numeric_limits<size_t>::max(), int numThreads = 1, double simTimeStart = -INFINITY, double simTimeEnd = INFINITY, InterruptedFlag *interrupted=nullptr);
+
+/**
+ * Reads the VectorResult items in the IDList into the XYArrays in reduced
+ * form, for plotting: the [simTimeStart,simTimeEnd] interval (clipped to the
+ * extent of each vector) is divided into numBins equal bins, e.g. one per
+ * pixel, and only the first, last, minimum and maximum points of each bin are
+ * kept. Uses the summary file (.vcs) of the vector file if it is up to date,
+ * so that only the data points around bin boundaries need to be read, and the
+ * cost depends on the number of bins rather than on the length of the vectors;
+ * otherwise the data points are read and reduced on the fly. The result is the
+ * same either way.
+ */
+SCAVE_API std::vector<XYArray *> readDownsampledVectorsIntoArrays(ResultFileManager *manager, const IDList& idlist, int numBins, double simTimeStart = -INFINITY, double simTimeEnd = INFINITY, InterruptedFlag *interrupted=nullptr);
+
 /**
   * This class simply wraps the std::vector<XYArray *> to make it usable from Java.
  */
@@ -60,6 +88,11 @@ class SCAVE_API XYArrayVector {
  */
 SCAVE_API XYArrayVector *readVectorsIntoArrays2(ResultFileManager *manager, const IDList& idlist, bool includePreciseX, bool includeEventNumbers, size_t memoryLimitBytes = std::numeric_limits<size_t>::max(), double simTimeStart = -INFINITY, double simTimeEnd = INFINITY, InterruptedFlag *interrupted=nullptr);
 
+/*
+ * The same as readDownsampledVectorsIntoArrays, except the result is wrapped into an XYArrayVector.
+ */
+SCAVE_API XYArrayVector *readDownsampledVectorsIntoArrays2(ResultFileManager *manager, const IDList& idlist, int numBins, double simTimeStart = -INFINITY, double simTimeEnd = INFINITY, InterruptedFlag *interrupted=nullptr);
+
 } // namespace scave
 }  // namespace omnetpp
 
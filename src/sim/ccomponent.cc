@@ -35,6 +35,8 @@
 #include "omnetpp/cenvir.h"
 #include "omnetpp/cresultrecorder.h"
 #include "omnetpp/cresultfilter.h"
+#include "omnetpp/ccommbuffer.h"
+#include "omnetpp/opp_string.h"
 
 using namespace omnetpp::common;
 
@@ -50,6 +52,8 @@ static const int NOTIFICATION_STACK_SIZE = 64;
 cIListener **cComponent::notificationStack[NOTIFICATION_STACK_SIZE];
 int cComponent::notificationSP = 0;
 
+uint64_t cComponent::listenerGeneration = 1;
+
 bool cComponent::checkSignals;
 
 simsignal_t PRE_MODEL_CHANGE = cComponent::registerSignal("PRE_MODEL_CHANGE");
@@ -96,6 +100,13 @@ cComponent::~cComponent()
     delete[] parArray;
     delete displayString;
 
+    if (listenerChains) {
+        for (ListenerChain *chain : *listenerChains)
+            delete chain;
+        delete listenerChains;
+        listenerGeneration++;  // we may be deleted from a listener, while fire() is iterating our chain
+    }
+
     if (selfPointers) {
         for (void **pptr : *selfPointers)
             *pptr = nullptr;
@@ -160,6 +171,48 @@ void cComponent::preDelete(cComponent *root)
 {
 }
 
+void cComponent::checkpointPack(cCommBuffer *buffer) const
+{
+#ifndef WITH_PARSIM
+    throw cRuntimeError(this, E_NOPARSIM);
+#else
+    // parameters may have been changed during the simulation; volatile ones
+    // are re-evaluated on each read anyway
+    buffer->pack(numPars);
+    for (int i = 0; i < numPars; i++) {
+        const cPar& p = par(i);
+        buffer->pack(p.getName());
+        if (buffer->packFlag(!p.isVolatile()))
+            buffer->pack(p.str().c_str());
+    }
+#endif
+}
+
+void cComponent::checkpointUnpack(cCommBuffer *buffer)
+{
+#ifndef WITH_PARSIM
+    throw cRuntimeError(this, E_NOPARSIM);
+#else
+    short n;
+    buffer->unpack(n);
+    if (n != numPars)
+        throw cRuntimeError(this, "Cannot restore checkpoint: number of parameters differ (saved: %d, current: %d)", n, numPars);
+    for (int i = 0; i < numPars; i++) {
+        cPar& p = par(i);
+        opp_string name;
+        buffer->unpack(name);
+        if (strcmp(name.c_str(), p.getName()) != 0)
+            throw cRuntimeError(this, "Cannot restore checkpoint: parameter '%s' expected, found '%s'", name.c_str(), p.getName());
+        if (buffer->checkFlag()) {
+            opp_string value;
+            buffer->unpack(value);
+            if (p.str() != value.c_str())
+                p.parse(value.c_str());
+        }
+    }
+#endif
+}
+
 cComponentType *cComponent::getComponentType() const
 {
     if (!componentType)
@@ -486,6 +539,8 @@ void cComponent::clearSignalState()
 
     // clear notification stack
     notificationSP = 0;
+
+    listenerGeneration++;
 }
 
 void cComponent::clearSignalRegistrations()
@@ -641,33 +696,87 @@ void cComponent::emit(simsignal_t signalID, cObject *obj, cObject *details)
         fire(this, signalID, obj, details);
 }
 
+cComponent::ListenerChain *cComponent::getListenerChain(simsignal_t signalID)
+{
+    // note: linear search, for the same reason as in findListenerList()
+    ListenerChain *chain = nullptr;
+    if (!listenerChains)
+        listenerChains = new std::vector<ListenerChain*>;
+    for (ListenerChain *c : *listenerChains) {
+        if (c->signalID == signalID) {
+            chain = c;
+            break;
+        }
+    }
+    if (!chain) {
+        chain = new ListenerChain;
+        chain->signalID = signalID;
+        listenerChains->push_back(chain);
+    }
+
+    // recompute if listeners or the module hierarchy may have changed since
+    if (chain->generation != listenerGeneration) {
+        chain->levels.clear();
+        for (cComponent *component = this; component; component = component->getParentModule())
+            if (SignalListenerList *listenerList = component->findListenerList(signalID))
+                chain->levels.push_back(std::make_pair(component, listenerList->listeners));
+        chain->generation = listenerGeneration;
+    }
+    return chain;
+}
+
+template<typename T>
+void cComponent::notifyListeners(cComponent *component, cIListener **listeners, cComponent *source, simsignal_t signalID, T x, cObject *details)
+{
+    if (notificationSP >= NOTIFICATION_STACK_SIZE)
+        throw cRuntimeError(component, "emit(): Recursive notification stack overflow, signalID=%d", signalID);
+
+    int oldNotificationSP = notificationSP;
+    try {
+        notificationStack[notificationSP++] = listeners;  // lock against modification
+        for (int i = 0; listeners[i]; i++)
+            listeners[i]->receiveSignal(source, signalID, x, details);  // will crash if listener is already deleted
+        notificationSP--;
+    }
+    catch (std::exception& e) {
+        notificationSP = oldNotificationSP;
+        throw;
+    }
+}
+
 template<typename T>
 void cComponent::fire(cComponent *source, simsignal_t signalID, T x, cObject *details)
 {
-    // notify local listeners if there are any
-    SignalListenerList *listenerList = findListenerList(signalID);
-    if (listenerList) {
-        cIListener **listeners = listenerList->listeners;
-        if (notificationSP >= NOTIFICATION_STACK_SIZE)
-            throw cRuntimeError(this, "emit(): Recursive notification stack overflow, signalID=%d", signalID);
-
-        int oldNotificationSP = notificationSP;
-        try {
-            notificationStack[notificationSP++] = listeners;  // lock against modification
-            for (int i = 0; listeners[i]; i++)
-                listeners[i]->receiveSignal(source, signalID, x, details);  // will crash if listener is already deleted
-            notificationSP--;
-        }
-        catch (std::exception& e) {
-            notificationSP = oldNotificationSP;
-            throw;
+    // notify listeners here and in ancestors, as listed in the chain
+    ListenerChain *chain = getListenerChain(signalID);
+    uint64_t generation = listenerGeneration;
+    for (size_t k = 0; k < chain->levels.size(); k++) {
+        cComponent *component = chain->levels[k].first;
+        notifyListeners(component, chain->levels[k].second, source, signalID, x, details);
+
+        // if a listener subscribed, unsubscribed or moved modules, the rest of the
+        // chain may be out of date (and may even have been recomputed in a nested emit)
+        if (listenerGeneration != generation) {
+            cModule *parent = component->getParentModule();
+            if (parent)
+                parent->fireRecursively(source, signalID, x, details);
+            return;
         }
     }
+}
+
+template<typename T>
+void cComponent::fireRecursively(cComponent *source, simsignal_t signalID, T x, cObject *details)
+{
+    // notify local listeners if there are any
+    SignalListenerList *listenerList = findListenerList(signalID);
+    if (listenerList)
+        notifyListeners(this, listenerList->listeners, source, signalID, x, details);
 
     // notify ancestors recursively
     cModule *parent = getParentModule();
     if (parent)
-        parent->fire(source, signalID, x, details);
+        parent->fireRecursively(source, signalID, x, details);
 }
 
 void cComponent::fireFinish()
@@ -692,6 +801,7 @@ void cComponent::subscribe(simsignal_t signalID, cIListener *listener)
     if (!listenerList->addListener(listener))
         throw cRuntimeError(this, "subscribe(): Listener already subscribed at this component to signal '%s' (id=%d)", getSignalName(signalID), signalID);
     signalListenerCounts[signalID]++;
+    listenerGeneration++;
     listener->subscriptions.push_back(std::pair<cComponent*,simsignal_t>(this,signalID));
     listener->subscribedTo(this, signalID);
 }
@@ -714,6 +824,7 @@ void cComponent::unsubscribe(simsignal_t signalID, cIListener *listener)
         removeListenerList(signalID);
 
     signalListenerCounts[signalID]--;
+    listenerGeneration++;
     ASSERT(signalListenerCounts[signalID] >= 0);
     auto subscription = std::pair<cComponent*,simsignal_t>(this,signalID);
     ASSERT(contains(listener->subscriptions, subscription));
@@ -75,6 +75,8 @@ std::string cConfiguration::parseFilename(const char *s, const char *baseDir, co
     if (!s || !s[0])
         return "";
     std::string str = s[0]=='"' ? Expression().parse(s).stringValue() : s;
+    if (str.empty())
+        return "";  // "" also means no file, not the base directory
     return tidyFilename(concatDirAndFile(baseDir, str.c_str()).c_str());
 }
 
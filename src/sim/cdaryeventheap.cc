@@ -0,0 +1,387 @@
+//=========================================================================
+//  CDARYEVENTHEAP.CC - part of
+//
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//   Member functions of
+//    cDaryEventHeap : future event set, implemented as 4-ary heap
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 1992-2017 Andras Varga
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <sstream>
+#include "omnetpp/globals.h"
+#include "omnetpp/cmessage.h"
+#include "omnetpp/cdaryeventheap.h"
+
+namespace omnetpp {
+
+Register_Class(cDaryEventHeap);
+
+#define ARITY             4
+#define CACHELINESIZE     64
+
+#define PARENT(i)         (((i)-1)/ARITY)
+#define FIRSTCHILD(i)     (ARITY*(i)+1)
+
+#define CBHEAPINDEX(i)    (-2-(i))
+#define CBINC(i)          ((i) = ((i)+1)&(cbsize-1))
+#define CBDEC(i)          ((i) = ((i)-1)&(cbsize-1))
+
+inline bool cDaryEventHeap::Entry::operator<(const Entry& other) const
+{
+    return arrivalTime < other.arrivalTime ? true :
+           arrivalTime > other.arrivalTime ? false :
+           priority < other.priority ? true :
+           priority > other.priority ? false :
+           insertOrder < other.insertOrder;
+}
+
+//----
+
+cDaryEventHeap::cDaryEventHeap(const char *name, int initialCapacity) : cFutureEventSet(name)
+{
+    insertCount = 0;
+
+    heapLength = 0;
+    heap = nullptr;
+    heapAlloc = nullptr;
+    allocateHeap(std::max(initialCapacity, ARITY));
+
+    cbsize = 4;  // must be power of 2!
+    cb = new cEvent *[cbsize];
+    cbhead = cbtail = 0;
+    useCb = true;
+}
+
+cDaryEventHeap::cDaryEventHeap(const cDaryEventHeap& other) : cFutureEventSet(other)
+{
+    cb = nullptr;
+    heap = nullptr;
+    heapAlloc = nullptr;
+    heapLength = 0;
+    copy(other);
+}
+
+cDaryEventHeap::~cDaryEventHeap()
+{
+    clear();
+    free(heapAlloc);
+    delete[] cb;
+}
+
+void cDaryEventHeap::allocateHeap(int capacity)
+{
+    // align heap[1] (and thus every group of siblings) to cache line boundary;
+    // Entry is 32 bytes, so a group of 4 siblings spans exactly 2 cache lines
+    void *block = malloc((capacity+1) * sizeof(Entry) + CACHELINESIZE);
+    if (!block)
+        throw std::bad_alloc();
+    uintptr_t p = (uintptr_t)block + sizeof(Entry) + CACHELINESIZE - 1;
+    p -= p % CACHELINESIZE;
+    Entry *newHeap = (Entry *)(p - sizeof(Entry));
+
+    if (heap)
+        std::copy(heap, heap + heapLength, newHeap);
+    free(heapAlloc);
+    heapAlloc = block;
+    heap = newHeap;
+    heapCapacity = capacity;
+}
+
+cDaryEventHeap::Entry cDaryEventHeap::makeEntry(cEvent *event)
+{
+    Entry entry;
+    entry.arrivalTime = event->getArrivalTime().raw();
+    entry.insertOrder = event->getInsertOrder();
+    entry.event = event;
+    entry.priority = event->getSchedulingPriority();
+    return entry;
+}
+
+std::string cDaryEventHeap::str() const
+{
+    if (isEmpty())
+        return std::string("empty");
+    std::stringstream out;
+    out << "length=" << getLength();
+    return out.str();
+}
+
+void cDaryEventHeap::forEachChild(cVisitor *v)
+{
+    sort();
+
+    for (int i = cbhead; i != cbtail; CBINC(i))
+        v->visit(cb[i]);
+
+    for (int i = 0; i < heapLength; i++)
+        v->visit(heap[i].event);
+}
+
+void cDaryEventHeap::clear()
+{
+    for (int i = cbhead; i != cbtail; CBINC(i))
+        dropAndDelete(cb[i]);
+    cbhead = cbtail = 0;
+
+    for (int i = 0; i < heapLength; i++)
+        dropAndDelete(heap[i].event);
+    heapLength = 0;
+}
+
+void cDaryEventHeap::copy(const cDaryEventHeap& other)
+{
+    // copy heap
+    heapLength = 0;
+    allocateHeap(other.heapCapacity);
+    for (int i = 0; i < other.heapLength; i++) {
+        heap[i] = other.heap[i];
+        take(heap[i].event = other.heap[i].event->dup());
+        heap[i].event->insertOrder = heap[i].insertOrder;
+        heap[i].event->heapIndex = i;
+    }
+    heapLength = other.heapLength;
+    insertCount = other.insertCount;
+
+    // copy circular buffer
+    cbhead = other.cbhead;
+    cbtail = other.cbtail;
+    cbsize = other.cbsize;
+    useCb = other.useCb;
+    delete[] cb;
+    cb = new cEvent *[cbsize];
+    for (int i = cbhead; i != cbtail; CBINC(i)) {
+        take(cb[i] = other.cb[i]->dup());
+        cb[i]->insertOrder = other.cb[i]->insertOrder;
+        cb[i]->heapIndex = CBHEAPINDEX(i);
+    }
+}
+
+cDaryEventHeap& cDaryEventHeap::operator=(const cDaryEventHeap& other)
+{
+    if (this == &other)
+        return *this;
+    cFutureEventSet::operator=(other);
+    clear();
+    copy(other);
+    return *this;
+}
+
+cEvent *cDaryEventHeap::get(int k)
+{
+    if (k < 0)
+        return nullptr;
+
+    // first few elements map into the circular buffer
+    int cblen = cblength();
+    if (k < cblen)
+        return cbget(k);
+    k -= cblen;
+
+    // map the rest to the heap
+    if (k >= heapLength)
+        return nullptr;
+    return heap[k].event;
+}
+
+void cDaryEventHeap::sort()
+{
+    // note: a sorted array also satisfies the heap property
+    std::sort(heap, heap + heapLength);
+    for (int i = 0; i < heapLength; i++)
+        heap[i].event->heapIndex = i;
+}
+
+void cDaryEventHeap::insert(cEvent *event)
+{
+    take(event);
+
+    event->insertOrder = insertCount++;
+
+    if (!useCb) {
+        heapInsert(event);
+        return;
+    }
+
+    // is event eligible for putting it into the cb?
+    bool eligible = false;
+    simtime_t now = simTime();
+    if (event->getArrivalTime() == now) {
+        ASSERT(cbhead == cbtail || cb[cbhead]->getArrivalTime() == now); // causality violation
+        if (event->getSchedulingPriority() == 0) {
+            if (heapLength == 0 || heap[0].arrivalTime > now.raw())
+                eligible = true;
+        }
+        else if (event->getSchedulingPriority() < 0)
+            flushCb();  // move all events into the heap
+    }
+
+    if (eligible)
+        cbInsert(event);
+    else
+        heapInsert(event);
+}
+
+void cDaryEventHeap::cbInsert(cEvent *event)
+{
+    cb[cbtail] = event;
+    event->heapIndex = CBHEAPINDEX(cbtail);
+    CBINC(cbtail);
+    if (cbtail == cbhead)
+        cbgrow();
+}
+
+void cDaryEventHeap::heapInsert(cEvent *event)
+{
+    if (heapLength == heapCapacity)
+        allocateHeap(2 * heapCapacity);
+    siftUp(heapLength++, makeEntry(event));
+}
+
+void cDaryEventHeap::cbgrow()
+{
+    int newsize = 2*cbsize;  // cbsize MUST be power of 2
+    cEvent **newcb = new cEvent *[newsize];
+    for (int i = 0; i < cbsize; i++)
+        (newcb[i] = cb[(cbhead+i)&(cbsize-1)])->heapIndex = CBHEAPINDEX(i);
+    delete[] cb;
+
+    cb = newcb;
+    cbhead = 0;
+    cbtail = cbsize;
+    cbsize = newsize;
+}
+
+void cDaryEventHeap::flushCb()
+{
+    for (int i = cbhead; i != cbtail; CBINC(i))
+        heapInsert(cb[i]);
+    cbtail = cbhead;
+}
+
+void cDaryEventHeap::siftUp(int pos, const Entry& entry)
+{
+    // moves the hole at pos towards the root until entry can be placed into it
+    while (pos > 0) {
+        int parent = PARENT(pos);
+        if (!(entry < heap[parent]))
+            break;
+        heap[pos] = heap[parent];
+        heap[pos].event->heapIndex = pos;
+        pos = parent;
+    }
+    heap[pos] = entry;
+    entry.event->heapIndex = pos;
+}
+
+void cDaryEventHeap::siftDown(int pos, const Entry& entry)
+{
+    // moves the hole at pos towards the leaves until entry can be placed into it
+    while (true) {
+        int first = FIRSTCHILD(pos);
+        if (first >= heapLength)
+            break;
+        int last = std::min(first + ARITY, heapLength);
+        int smallest = first;
+        for (int child = first + 1; child < last; child++)
+            if (heap[child] < heap[smallest])
+                smallest = child;
+        if (!(heap[smallest] < entry))
+            break;
+        heap[pos] = heap[smallest];
+        heap[pos].event->heapIndex = pos;
+        pos = smallest;
+    }
+    heap[pos] = entry;
+    entry.event->heapIndex = pos;
+}
+
+cEvent *cDaryEventHeap::peekFirst() const
+{
+    return cbhead != cbtail ? cb[cbhead] : heapLength != 0 ? heap[0].event : nullptr;
+}
+
+cEvent *cDaryEventHeap::removeFirst()
+{
+    if (cbhead != cbtail) {
+        // remove head element from circular buffer
+        cEvent *event = cb[cbhead];
+        CBINC(cbhead);
+        drop(event);
+        event->heapIndex = -1;
+        return event;
+    }
+    else if (heapLength > 0) {
+        // heap: first is taken out and replaced by the last one
+        cEvent *event = heap[0].event;
+        if (--heapLength > 0)
+            siftDown(0, heap[heapLength]);
+        drop(event);
+        event->heapIndex = -1;
+        return event;
+    }
+    return nullptr;
+}
+
+cEvent *cDaryEventHeap::remove(cEvent *event)
+{
+    // make sure it is really on the heap
+    if (event->heapIndex == -1)
+        return nullptr;
+
+    if (event->heapIndex < 0) {
+        // event is in the circular buffer
+        int i = -event->heapIndex-2;
+        ASSERT(cb[i] == event);  // sanity check
+
+        // remove
+        int iminus1 = i;
+        CBINC(i);
+        for (  /**/; i != cbtail; iminus1 = i, CBINC(i))
+            (cb[iminus1] = cb[i])->heapIndex = CBHEAPINDEX(iminus1);
+        CBDEC(cbtail);
+    }
+    else {
+        // event is on the heap; last element will be used to fill the hole
+        int pos = event->heapIndex;
+        ASSERT(heap[pos].event == event);  // sanity check
+        if (pos != --heapLength) {
+            Entry fill = heap[heapLength];
+            if (pos > 0 && fill < heap[PARENT(pos)])
+                siftUp(pos, fill);
+            else
+                siftDown(pos, fill);
+        }
+    }
+
+    drop(event);
+    event->heapIndex = -1;
+    return event;
+}
+
+void cDaryEventHeap::putBackFirst(cEvent *event)
+{
+    take(event);
+
+    CBDEC(cbhead);
+    cb[cbhead] = event;
+    event->heapIndex = CBHEAPINDEX(cbhead);
+
+    if (cbtail == cbhead)
+        cbgrow();
+}
+
+}  // namespace omnetpp
+
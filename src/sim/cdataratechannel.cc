@@ -358,6 +358,50 @@ void cDatarateChannel::finish()
     }
 }
 
+void cDatarateChannel::checkpointPack(cCommBuffer *buffer) const
+{
+#ifndef WITH_PARSIM
+    throw cRuntimeError(this, E_NOPARSIM);
+#else
+    cChannel::checkpointPack(buffer);
+    buffer->pack((int)mode);
+    buffer->pack(singleTx.startTime);
+    buffer->pack(singleTx.finishTime);
+    buffer->pack(singleTx.transmissionId);
+    buffer->pack((int)txList.size());
+    for (const Tx& tx : txList) {
+        buffer->pack(tx.startTime);
+        buffer->pack(tx.finishTime);
+        buffer->pack(tx.transmissionId);
+    }
+    buffer->pack(channelFinishTime);
+#endif
+}
+
+void cDatarateChannel::checkpointUnpack(cCommBuffer *buffer)
+{
+#ifndef WITH_PARSIM
+    throw cRuntimeError(this, E_NOPARSIM);
+#else
+    cChannel::checkpointUnpack(buffer);
+    int m;
+    buffer->unpack(m);
+    mode = (Mode)m;
+    buffer->unpack(singleTx.startTime);
+    buffer->unpack(singleTx.finishTime);
+    buffer->unpack(singleTx.transmissionId);
+    int n;
+    buffer->unpack(n);
+    txList.resize(n);
+    for (Tx& tx : txList) {
+        buffer->unpack(tx.startTime);
+        buffer->unpack(tx.finishTime);
+        buffer->unpack(tx.transmissionId);
+    }
+    buffer->unpack(channelFinishTime);
+#endif
+}
+
 void cDatarateChannel::forceTransmissionFinishTime(simtime_t t)
 {
     if (mode != SINGLE)
@@ -29,6 +29,8 @@
 #include "omnetpp/cstringtokenizer.h"
 #include "omnetpp/cconfiguration.h"
 #include "omnetpp/cconfigoption.h"
+#include "omnetpp/ccommbuffer.h"
+#include "omnetpp/opp_string.h"
 #include "omnetpp/regmacros.h"
 #include "common/stringutil.h"
 
@@ -370,6 +372,31 @@ bool cSingleFingerprintCalculator::checkFingerprint() const
     return false;
 }
 
+void cSingleFingerprintCalculator::parsimPack(cCommBuffer *buffer) const
+{
+#ifndef WITH_PARSIM
+    throw cRuntimeError(this, E_NOPARSIM);
+#else
+    buffer->pack(ingredients.c_str());
+    buffer->pack(hasher->getHash());
+#endif
+}
+
+void cSingleFingerprintCalculator::parsimUnpack(cCommBuffer *buffer)
+{
+#ifndef WITH_PARSIM
+    throw cRuntimeError(this, E_NOPARSIM);
+#else
+    opp_string savedIngredients;
+    buffer->unpack(savedIngredients);
+    if (ingredients != savedIngredients.c_str())
+        throw cRuntimeError(this, "Cannot continue fingerprint computation: ingredients differ (saved: '%s', current: '%s')", savedIngredients.c_str(), ingredients.c_str());
+    uint32_t hash;
+    buffer->unpack(hash);
+    hasher->setHash(hash);
+#endif
+}
+
 //----
 
 cMultiFingerprintCalculator::cMultiFingerprintCalculator(cFingerprintCalculator *prototype) :
@@ -435,6 +462,31 @@ bool cMultiFingerprintCalculator::checkFingerprint() const
     return true;
 }
 
+void cMultiFingerprintCalculator::parsimPack(cCommBuffer *buffer) const
+{
+#ifndef WITH_PARSIM
+    throw cRuntimeError(this, E_NOPARSIM);
+#else
+    buffer->pack((int)elements.size());
+    for (auto element: elements)
+        element->parsimPack(buffer);
+#endif
+}
+
+void cMultiFingerprintCalculator::parsimUnpack(cCommBuffer *buffer)
+{
+#ifndef WITH_PARSIM
+    throw cRuntimeError(this, E_NOPARSIM);
+#else
+    int n;
+    buffer->unpack(n);
+    if (n != (int)elements.size())
+        throw cRuntimeError(this, "Cannot continue fingerprint computation: number of fingerprints differ (saved: %d, current: %d)", n, (int)elements.size());
+    for (auto element: elements)
+        element->parsimUnpack(buffer);
+#endif
+}
+
 std::string cMultiFingerprintCalculator::str() const
 {
     std::stringstream stream;
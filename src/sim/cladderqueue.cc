@@ -0,0 +1,385 @@
+//=========================================================================
+//  CLADDERQUEUE.CC - part of
+//
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//   Member functions of
+//    cLadderQueue : future event set, implemented as ladder queue
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 1992-2017 Andras Varga
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#include <algorithm>
+#include <sstream>
+#include "omnetpp/globals.h"
+#include "omnetpp/cevent.h"
+#include "omnetpp/cladderqueue.h"
+
+namespace omnetpp {
+
+Register_Class(cLadderQueue);
+
+// a bucket is only split into a new rung if it contains more events than this
+#define SPLIT_THRESHOLD    50
+
+// maximum number of rungs; buckets in the last rung are always sorted into bottom
+#define MAX_RUNGS          8
+
+// value of heapIndex for events in the bottom list; for events in the top list
+// or in a bucket, heapIndex is the position in the containing vector
+#define BOTTOMINDEX        0
+
+static bool precedes(const cEvent *a, const cEvent *b)
+{
+    return a->shouldPrecede(b);
+}
+
+cLadderQueue::cLadderQueue(const char *name) : cFutureEventSet(name)
+{
+    insertCount = 0;
+    length = 0;
+    topLimit = INT64_MIN;
+    topMin = INT64_MAX;
+    topMax = INT64_MIN;
+    numRungs = 0;
+    snapshotValid = false;
+}
+
+cLadderQueue::cLadderQueue(const cLadderQueue& other) : cFutureEventSet(other)
+{
+    insertCount = 0;
+    length = 0;
+    topLimit = INT64_MIN;
+    topMin = INT64_MAX;
+    topMax = INT64_MIN;
+    numRungs = 0;
+    snapshotValid = false;
+    copy(other);
+}
+
+cLadderQueue::~cLadderQueue()
+{
+    clear();
+}
+
+std::string cLadderQueue::str() const
+{
+    if (isEmpty())
+        return std::string("empty");
+    std::stringstream out;
+    out << "length=" << getLength();
+    return out.str();
+}
+
+void cLadderQueue::forEachChild(cVisitor *v)
+{
+    // note: not the snapshot, which may contain already removed events
+    std::vector<cEvent *> events;
+    collectEvents(events);
+    for (cEvent *event : events)
+        v->visit(event);
+}
+
+void cLadderQueue::clear()
+{
+    std::vector<cEvent *> events;
+    collectEvents(events);
+    for (cEvent *event : events)
+        dropAndDelete(event);
+
+    top.clear();
+    for (int i = 0; i < numRungs; i++)
+        for (Bucket& bucket : rungs[i].buckets)
+            bucket.clear();
+    numRungs = 0;
+    bottom.clear();
+    length = 0;
+
+    topLimit = INT64_MIN;
+    topMin = INT64_MAX;
+    topMax = INT64_MIN;
+    snapshot.clear();
+    snapshotValid = false;
+}
+
+void cLadderQueue::copy(const cLadderQueue& other)
+{
+    std::vector<cEvent *> events;
+    other.collectEvents(events);
+    for (cEvent *otherEvent : events) {
+        cEvent *event = otherEvent->dup();
+        take(event);
+        event->insertOrder = otherEvent->insertOrder;
+        doInsert(event);
+        length++;
+    }
+    insertCount = other.insertCount;
+}
+
+cLadderQueue& cLadderQueue::operator=(const cLadderQueue& other)
+{
+    if (this == &other)
+        return *this;
+    cFutureEventSet::operator=(other);
+    clear();
+    copy(other);
+    return *this;
+}
+
+void cLadderQueue::collectEvents(std::vector<cEvent *>& result) const
+{
+    result.clear();
+    result.reserve(length);
+    result.insert(result.end(), bottom.begin(), bottom.end());
+    for (int i = 0; i < numRungs; i++) {
+        const Rung& rung = rungs[i];
+        for (int k = rung.currentBucket; k < rung.numBuckets; k++)
+            result.insert(result.end(), rung.buckets[k].begin(), rung.buckets[k].end());
+    }
+    result.insert(result.end(), top.begin(), top.end());
+}
+
+cEvent *cLadderQueue::get(int k)
+{
+    if (k < 0 || k >= length)
+        return nullptr;
+    if (!snapshotValid) {
+        collectEvents(snapshot);
+        std::sort(snapshot.begin(), snapshot.end(), precedes);
+        snapshotValid = true;
+    }
+    return snapshot[k];
+}
+
+void cLadderQueue::insert(cEvent *event)
+{
+    take(event);
+    event->insertOrder = insertCount++;
+    doInsert(event);
+    length++;
+    snapshotValid = false;
+}
+
+void cLadderQueue::doInsert(cEvent *event)
+{
+    int64_t t = event->getArrivalTime().raw();
+    if (t > topLimit) {
+        insertIntoBucket(top, event);
+        if (t < topMin)
+            topMin = t;
+        if (t > topMax)
+            topMax = t;
+        return;
+    }
+
+    int rungIndex, bucketIndex;
+    if (findRung(t, rungIndex, bucketIndex))
+        insertIntoBucket(rungs[rungIndex].buckets[bucketIndex], event);
+    else
+        insertIntoBottom(event);
+}
+
+bool cLadderQueue::findRung(int64_t t, int& rungIndex, int& bucketIndex) const
+{
+    // the event belongs to the first rung (from the top) whose unconsumed part
+    // starts at or before t; offsets are computed in unsigned arithmetic to
+    // avoid overflow near the maximum simulation time
+    for (int i = 0; i < numRungs; i++) {
+        const Rung& rung = rungs[i];
+        if (t < rung.start)
+            continue;
+        uint64_t k = ((uint64_t)t - (uint64_t)rung.start) / rung.bucketWidth;
+        if (k >= (uint64_t)rung.currentBucket) {
+            ASSERT(k < (uint64_t)rung.numBuckets);
+            rungIndex = i;
+            bucketIndex = (int)k;
+            return true;
+        }
+    }
+    return false;
+}
+
+void cLadderQueue::insertIntoBucket(Bucket& bucket, cEvent *event)
+{
+    event->heapIndex = bucket.size();
+    bucket.push_back(event);
+}
+
+void cLadderQueue::removeFromBucket(Bucket& bucket, cEvent *event)
+{
+    int i = event->heapIndex;
+    ASSERT(i >= 0 && i < (int)bucket.size() && bucket[i] == event);  // sanity check
+    cEvent *last = bucket.back();
+    bucket[i] = last;
+    last->heapIndex = i;
+    bucket.pop_back();
+}
+
+void cLadderQueue::insertIntoBottom(cEvent *event)
+{
+    // events with equal timestamps are typically inserted in order, so the
+    // insertion point is usually close to the end of the deque
+    auto it = std::upper_bound(bottom.begin(), bottom.end(), event, precedes);
+    bottom.insert(it, event);
+    event->heapIndex = BOTTOMINDEX;
+}
+
+cLadderQueue::Rung& cLadderQueue::addRung(int64_t start, uint64_t bucketWidth, int numBuckets)
+{
+    if ((int)rungs.size() == numRungs)
+        rungs.push_back(Rung());
+    Rung& rung = rungs[numRungs++];
+    rung.start = start;
+    rung.bucketWidth = bucketWidth;
+    rung.numBuckets = numBuckets;
+    rung.currentBucket = 0;
+    if ((int)rung.buckets.size() < numBuckets)
+        rung.buckets.resize(numBuckets);  // note: buckets are all empty, including unused ones
+    return rung;
+}
+
+void cLadderQueue::transferTopToRung()
+{
+    ASSERT(numRungs == 0 && !top.empty());
+
+    // aim for about one event per bucket
+    uint64_t n = top.size();
+    uint64_t range = (uint64_t)topMax - (uint64_t)topMin;
+    uint64_t width = std::max(range / n, (uint64_t)1);
+    int numBuckets = (int)(range / width + 1);
+
+    Rung& rung = addRung(topMin, width, numBuckets);
+    for (cEvent *event : top) {
+        uint64_t k = ((uint64_t)event->getArrivalTime().raw() - (uint64_t)rung.start) / width;
+        insertIntoBucket(rung.buckets[k], event);
+    }
+    top.clear();
+
+    topLimit = topMax;
+    topMin = INT64_MAX;
+    topMax = INT64_MIN;
+}
+
+void cLadderQueue::spawnRung(Bucket& events, int64_t start, uint64_t width)
+{
+    // new rung covers the time interval [start, start+width) of the parent bucket
+    uint64_t n = events.size();
+    uint64_t childWidth = (width - 1) / n + 1;
+    int numBuckets = (int)((width - 1) / childWidth + 1);
+
+    Rung& rung = addRung(start, childWidth, numBuckets);
+    for (cEvent *event : events) {
+        uint64_t k = ((uint64_t)event->getArrivalTime().raw() - (uint64_t)start) / childWidth;
+        insertIntoBucket(rung.buckets[k], event);
+    }
+}
+
+bool cLadderQueue::refillBottom()
+{
+    ASSERT(bottom.empty());
+
+    Bucket events;
+    while (true) {
+        if (numRungs == 0) {
+            if (top.empty())
+                return false;
+            transferTopToRung();
+        }
+
+        // find the first non-empty bucket in the lowest rung
+        Rung& rung = rungs[numRungs-1];
+        while (rung.currentBucket < rung.numBuckets && rung.buckets[rung.currentBucket].empty())
+            rung.currentBucket++;
+        if (rung.currentBucket == rung.numBuckets) {
+            numRungs--;  // rung is exhausted
+            continue;
+        }
+
+        Bucket& bucket = rung.buckets[rung.currentBucket];
+        int64_t bucketStart = rung.start + (int64_t)(rung.currentBucket * rung.bucketWidth);
+        uint64_t bucketWidth = rung.bucketWidth;
+        rung.currentBucket++;
+
+        if (bucket.size() <= SPLIT_THRESHOLD || bucketWidth == 1 || numRungs == MAX_RUNGS) {
+            // sort bucket into bottom
+            std::sort(bucket.begin(), bucket.end(), precedes);
+            bottom.assign(bucket.begin(), bucket.end());
+            for (cEvent *event : bottom)
+                event->heapIndex = BOTTOMINDEX;
+            bucket.clear();
+            return true;
+        }
+
+        // split bucket into a new rung (note: addRung() may invalidate rung and bucket)
+        events.swap(bucket);
+        spawnRung(events, bucketStart, bucketWidth);
+        events.clear();
+    }
+}
+
+cEvent *cLadderQueue::peekFirst() const
+{
+    // refilling the bottom list does not change the observable state of the FES
+    if (bottom.empty() && !const_cast<cLadderQueue *>(this)->refillBottom())
+        return nullptr;
+    return bottom.front();
+}
+
+cEvent *cLadderQueue::removeFirst()
+{
+    if (bottom.empty() && !refillBottom())
+        return nullptr;
+
+    cEvent *event = bottom.front();
+    bottom.pop_front();
+    length--;
+    snapshotValid = false;
+    drop(event);
+    event->heapIndex = -1;
+    return event;
+}
+
+cEvent *cLadderQueue::remove(cEvent *event)
+{
+    // make sure it is really in the FES
+    if (event->heapIndex == -1)
+        return nullptr;
+
+    // locate the event the same way as doInsert() would
+    int64_t t = event->getArrivalTime().raw();
+    int rungIndex, bucketIndex;
+    if (t > topLimit)
+        removeFromBucket(top, event);
+    else if (findRung(t, rungIndex, bucketIndex))
+        removeFromBucket(rungs[rungIndex].buckets[bucketIndex], event);
+    else {
+        auto it = std::lower_bound(bottom.begin(), bottom.end(), event, precedes);
+        ASSERT(it != bottom.end() && *it == event);  // sanity check
+        bottom.erase(it);
+    }
+
+    length--;
+    snapshotValid = false;
+    drop(event);
+    event->heapIndex = -1;
+    return event;
+}
+
+void cLadderQueue::putBackFirst(cEvent *event)
+{
+    take(event);
+    doInsert(event);  // it will end up at the front of the bottom list
+    length++;
+    snapshotValid = false;
+}
+
+}  // namespace omnetpp
+
@@ -23,6 +23,7 @@
 #include "omnetpp/csimulation.h"
 #include "omnetpp/cexception.h"
 #include "omnetpp/cconfigoption.h"
+#include "omnetpp/ccommbuffer.h"
 
 namespace omnetpp {
 
@@ -67,6 +68,26 @@ void cLCG32::selfTest()
         throw cRuntimeError("cLCG32: selfTest() failed, please report this problem!");
 }
 
+void cLCG32::parsimPack(cCommBuffer *buffer) const
+{
+#ifndef WITH_PARSIM
+    throw cRuntimeError(this, E_NOPARSIM);
+#else
+    buffer->pack(seed);
+    buffer->pack(numDrawn);
+#endif
+}
+
+void cLCG32::parsimUnpack(cCommBuffer *buffer)
+{
+#ifndef WITH_PARSIM
+    throw cRuntimeError(this, E_NOPARSIM);
+#else
+    buffer->unpack(seed);
+    buffer->unpack(numDrawn);
+#endif
+}
+
 unsigned long cLCG32::intRand()
 {
     numDrawn++;
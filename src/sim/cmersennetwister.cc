@@ -23,6 +23,7 @@
 #include "omnetpp/cmersennetwister.h"
 #include "omnetpp/cmessage.h"
 #include "omnetpp/cconfigoption.h"
+#include "omnetpp/ccommbuffer.h"
 
 namespace omnetpp {
 
@@ -77,6 +78,30 @@ void cMersenneTwister::selfTest()
         throw cRuntimeError("cMersenneTwister: selfTest() failed, please report this problem!");
 }
 
+void cMersenneTwister::parsimPack(cCommBuffer *buffer) const
+{
+#ifndef WITH_PARSIM
+    throw cRuntimeError(this, E_NOPARSIM);
+#else
+    MTRand::uint32 state[MTRand::SAVE];
+    rng.save(state);
+    buffer->pack(state, MTRand::SAVE);
+    buffer->pack(numDrawn);
+#endif
+}
+
+void cMersenneTwister::parsimUnpack(cCommBuffer *buffer)
+{
+#ifndef WITH_PARSIM
+    throw cRuntimeError(this, E_NOPARSIM);
+#else
+    MTRand::uint32 state[MTRand::SAVE];
+    buffer->unpack(state, MTRand::SAVE);
+    rng.load(state);
+    buffer->unpack(numDrawn);
+#endif
+}
+
 unsigned long cMersenneTwister::intRand()
 {
     numDrawn++;
@@ -38,6 +38,89 @@ long cMessage::nextMessageId = 0;
 long cMessage::totalMsgCount = 0;
 long cMessage::liveMsgCount = 0;
 
+// message pooling: blocks are kept on free lists by size, rounded up to a
+// multiple of POOL_GRANULARITY; larger objects bypass the pool
+#define POOL_GRANULARITY    8
+#define POOL_MAXSIZE        1024
+#define POOL_NUMLISTS       (POOL_MAXSIZE/POOL_GRANULARITY+1)
+#define POOL_INDEX(size)    (((size)+POOL_GRANULARITY-1)/POOL_GRANULARITY)
+
+bool cMessage::poolingEnabled = false;
+void *cMessage::freeBlocks[POOL_NUMLISTS];
+long cMessage::poolHitCount = 0;
+long cMessage::poolMissCount = 0;
+long cMessage::pooledBlockCount = 0;
+
+void *cMessage::operator new(size_t size)
+{
+    if (size > POOL_MAXSIZE)
+        return ::operator new(size);
+
+    // note: memory is always allocated with the rounded-up size, so that
+    // blocks can be recycled regardless of when pooling was turned on or off
+    size_t index = POOL_INDEX(size);
+    if (poolingEnabled) {
+        if (void *block = freeBlocks[index]) {
+            freeBlocks[index] = *(void **)block;
+            pooledBlockCount--;
+            poolHitCount++;
+            return block;
+        }
+        poolMissCount++;
+    }
+    return ::operator new(index * POOL_GRANULARITY);
+}
+
+void cMessage::operator delete(void *p, size_t size)
+{
+    // note: thanks to the virtual destructor, size is that of the most derived class
+    if (!p)
+        return;
+    if (!poolingEnabled || size > POOL_MAXSIZE) {
+        ::operator delete(p);
+        return;
+    }
+    size_t index = POOL_INDEX(size);
+    *(void **)p = freeBlocks[index];
+    freeBlocks[index] = p;
+    pooledBlockCount++;
+}
+
+void *cMessage::operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    try {
+        return cMessage::operator new(size);
+    }
+    catch (std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void cMessage::operator delete(void *p, const std::nothrow_t&) noexcept
+{
+    // only called if a constructor throws; the block is not recycled, but
+    // that is fine because all blocks come from the global operator new
+    ::operator delete(p);
+}
+
+void cMessage::setPoolingEnabled(bool enabled)
+{
+    poolingEnabled = enabled;
+    if (!enabled)
+        purgePool();
+}
+
+void cMessage::purgePool()
+{
+    for (int i = 0; i < POOL_NUMLISTS; i++) {
+        while (void *block = freeBlocks[i]) {
+            freeBlocks[i] = *(void **)block;
+            ::operator delete(block);
+        }
+    }
+    pooledBlockCount = 0;
+}
+
 cMessage::cMessage(const cMessage& msg) : cEvent(msg)
 {
     parList = nullptr;
@@ -19,6 +19,9 @@
 #include <cstdio>  // sprintf
 #include <cstring>  // strcpy
 #include <algorithm>
+#include <string>
+#include <vector>
+#include <unordered_map>
 #include "common/stringutil.h"
 #include "omnetpp/cmodule.h"
 #include "omnetpp/csimplemodule.h"
@@ -50,6 +53,93 @@ Register_Class(cModule);
 std::string cModule::lastModuleFullPath;
 const cModule *cModule::lastModuleFullPathModule = nullptr;
 
+/*
+ * Submodules by name and index. When several submodules have the same name
+ * and index, the table holds the first one in the submodule list, and the
+ * others are only counted (numShadowed). add() and remove() return false if
+ * the table cannot be updated incrementally, and needs to be rebuilt.
+ */
+struct cModule::SubmoduleIndex
+{
+    struct Entry {
+        cModule *scalar = nullptr;        // the non-vector submodule with this name
+        std::vector<cModule *> elements;  // submodule vector elements with this name, by index
+    };
+    std::unordered_map<std::string, Entry> entries;
+    int numShadowed = 0;
+
+    cModule *& getSlot(Entry& entry, cModule *mod);
+    bool add(cModule *mod, bool isLast);
+    bool remove(cModule *mod);
+    bool lookup(const char *name, int index, cModule *& result) const;
+};
+
+cModule *& cModule::SubmoduleIndex::getSlot(Entry& entry, cModule *mod)
+{
+    if (!mod->isVector())
+        return entry.scalar;
+    size_t index = mod->getIndex();
+    if (index >= entry.elements.size())
+        entry.elements.resize(index + 1, nullptr);
+    return entry.elements[index];
+}
+
+bool cModule::SubmoduleIndex::add(cModule *mod, bool isLast)
+{
+    cModule *& slot = getSlot(entries[mod->getName()], mod);
+    if (slot == nullptr)
+        slot = mod;
+    else if (isLast)
+        numShadowed++;  // the module in the table precedes it in the submodule list
+    else
+        return false;
+    return true;
+}
+
+bool cModule::SubmoduleIndex::remove(cModule *mod)
+{
+    auto it = entries.find(mod->getName());
+    if (it == entries.end())
+        return false;
+    Entry& entry = it->second;
+    cModule *& slot = getSlot(entry, mod);
+    if (slot != mod) {
+        numShadowed--;
+        return true;
+    }
+    if (numShadowed > 0)
+        return false;  // a shadowed module might need to take its place
+    slot = nullptr;
+    while (!entry.elements.empty() && entry.elements.back() == nullptr)
+        entry.elements.pop_back();
+    if (entry.scalar == nullptr && entry.elements.empty())
+        entries.erase(it);
+    return true;
+}
+
+bool cModule::SubmoduleIndex::lookup(const char *name, int index, cModule *& result) const
+{
+    result = nullptr;
+    auto it = entries.find(name);
+    if (it == entries.end() || index < -1)
+        return true;
+    const Entry& entry = it->second;
+    if (index == -1)
+        result = entry.scalar;
+    else {
+        if ((size_t)index < entry.elements.size())
+            result = entry.elements[index];
+        if (index == 0 && entry.scalar != nullptr) {
+            // a non-vector submodule has index 0 too; if there is also
+            // element 0 of a vector with the same name, list order decides
+            if (result != nullptr)
+                return false;
+            result = entry.scalar;
+        }
+    }
+    return true;
+}
+
 #ifdef NDEBUG
 bool cModule::cacheFullPath = false; // in release mode keep memory usage low
 #else
@@ -65,6 +155,7 @@ cModule::cModule()
 
     prevSibling = nextSibling = firstSubmodule = lastSubmodule = nullptr;
     firstChannel = lastChannel = nullptr;
+    submoduleIndex = nullptr;
 
     gateDescArraySize = 0;
     gateDescArray = nullptr;
@@ -108,6 +199,7 @@ cModule::~cModule()
 
     delete canvas;
     delete osgCanvas;
+    delete submoduleIndex;
 
     delete[] fullName;
     delete[] fullPath;
@@ -227,10 +319,15 @@ void cModule::forEachChild(cVisitor *v)
 void cModule::setNameAndIndex(const char *s, int i, int n)
 {
     // a two-in-one function, so that we don't end up calling updateFullPath() twice
+    cModule *parent = getParentModule();
+    if (parent)
+        parent->submoduleRenaming(this);
     cOwnedObject::setName(s);
     vectorIndex = i;
     vectorSize = n;
     updateFullName();
+    if (parent)
+        parent->submoduleRenamed(this);
 }
 
 std::string cModule::str() const
@@ -254,6 +351,9 @@ void cModule::insertSubmodule(cModule *mod)
         firstSubmodule = mod;
     lastSubmodule = mod;
 
+    if (submoduleIndex && !submoduleIndex->add(mod, true))
+        discardSubmoduleIndex();
+
     // cached module getFullPath() possibly became invalid
     lastModuleFullPathModule = nullptr;
 }
@@ -277,10 +377,38 @@ void cModule::removeSubmodule(cModule *mod)
     // this is not strictly needed but makes it cleaner
     mod->prevSibling = mod->nextSibling = nullptr;
 
+    if (submoduleIndex && !submoduleIndex->remove(mod))
+        discardSubmoduleIndex();
+
     // cached module getFullPath() possibly became invalid
     lastModuleFullPathModule = nullptr;
 }
 
+void cModule::submoduleRenaming(cModule *mod)
+{
+    if (submoduleIndex && !submoduleIndex->remove(mod))
+        discardSubmoduleIndex();
+}
+
+void cModule::submoduleRenamed(cModule *mod)
+{
+    if (submoduleIndex && !submoduleIndex->add(mod, mod == lastSubmodule))
+        discardSubmoduleIndex();
+}
+
+void cModule::buildSubmoduleIndex() const
+{
+    submoduleIndex = new SubmoduleIndex();
+    for (cModule *child = firstSubmodule; child; child = child->nextSibling)
+        submoduleIndex->add(child, true);  // in list order, so each is last so far
+}
+
+void cModule::discardSubmoduleIndex()
+{
+    delete submoduleIndex;
+    submoduleIndex = nullptr;
+}
+
 void cModule::insertChannel(cChannel *channel)
 {
     // note: no take(channel), as channels are owned by their src gates.
@@ -318,8 +446,13 @@ cModule *cModule::getParentModule() const
 
 void cModule::setName(const char *s)
 {
+    cModule *parent = getParentModule();
+    if (parent)
+        parent->submoduleRenaming(this);
     cOwnedObject::setName(s);
     updateFullName();
+    if (parent)
+        parent->submoduleRenamed(this);
 }
 
 void cModule::updateFullName()
@@ -347,12 +480,13 @@ void cModule::updateFullName()
 
 void cModule::reassignModuleIdRec()
 {
+    cSimulation *simulation = getSimulation();  // note: deregisterComponent() clears it
     int oldId = getId();
-    getSimulation()->deregisterComponent(this);
-    getSimulation()->registerComponent(this);
+    simulation->deregisterComponent(this);
+    simulation->registerComponent(this);
     int newId = getId();
 
-    cFutureEventSet *fes = getSimulation()->getFES();
+    cFutureEventSet *fes = simulation->getFES();
     int fesLen = fes->getLength();
     for (int i = 0; i < fesLen; i++) {
         cEvent *event = fes->get(i);
@@ -1149,17 +1283,18 @@ bool cModule::checkInternalConnections() const
 
 int cModule::findSubmodule(const char *name, int index) const
 {
-    for (SubmoduleIterator it(this); !it.end(); ++it) {
-        cModule *submodule = *it;
-        if (submodule->isName(name) && ((index == -1 && !submodule->isVector()) || submodule->getIndex() == index))
-            return submodule->getId();
-    }
-
-    return -1;
+    cModule *submodule = getSubmodule(name, index);
+    return submodule ? submodule->getId() : -1;
 }
 
 cModule *cModule::getSubmodule(const char *name, int index) const
 {
+    if (!submoduleIndex)
+        buildSubmoduleIndex();
+    cModule *result;
+    if (submoduleIndex->lookup(name, index, result))
+        return result;
+
     for (SubmoduleIterator it(this); !it.end(); ++it) {
         cModule *submodule = *it;
         if (submodule->isName(name) && ((index == -1 && !submodule->isVector()) || submodule->getIndex() == index))
@@ -1341,6 +1476,7 @@ void cModule::changeParentTo(cModule *module)
     cModule *oldparent = getParentModule();
     oldparent->removeSubmodule(this);
     module->insertSubmodule(this);
+    listenerGeneration++;  // signal listener chains of the subtree are now different
     int oldId = getId();
     reassignModuleIdRec();
     if (cacheFullPath)
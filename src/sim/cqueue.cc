@@ -109,11 +109,13 @@ void cQueue::parsimUnpack(cCommBuffer *buffer)
 #else
     cOwnedObject::parsimUnpack(buffer);
 
-    buffer->unpack(len);
+    int n;
+    buffer->unpack(n);
 
+    clear();
     Comparator *oldCmp = comparator;
     comparator = nullptr;  // temporarily, so that insert() keeps the original order
-    for (int i = 0; i < len; i++) {
+    for (int i = 0; i < n; i++) {
         cObject *obj = buffer->unpackObject();
         insert(obj);
     }
@@ -0,0 +1,497 @@
+//=========================================================================
+//  CSHAREDMEMORYCOMM.CC - part of
+//
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2003-2017 Andras Varga
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+#include "csharedmemorycomm.h"
+
+#ifndef _WIN32
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <atomic>
+#include <algorithm>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sched.h>
+#include <ctime>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+#include "omnetpp/cexception.h"
+#include "omnetpp/clog.h"
+#include "omnetpp/globals.h"
+#include "omnetpp/regmacros.h"
+#include "omnetpp/cconfigoption.h"
+#include "omnetpp/cenvir.h"
+#include "omnetpp/csimulation.h"
+#include "omnetpp/cconfiguration.h"
+#include "cmemcommbuffer.h"
+#include "parsimutil.h"
+
+#ifdef __linux__
+#define DEFAULT_PREFIX  "/dev/shm/omnetpp-parsim-"
+#else
+#define DEFAULT_PREFIX  "comm/shm-"
+#endif
+
+namespace omnetpp {
+
+Register_Class(cSharedMemoryCommunications);
+
+Register_GlobalConfigOption(CFGID_PARSIM_SHMCOMM_PREFIX, "parsim-sharedmemorycommunications-prefix", CFG_STRING, DEFAULT_PREFIX, "When `cSharedMemoryCommunications` is selected as parsim communications class: selects the prefix (directory+potential filename prefix) of the memory-mapped files that serve as shared memory segments. On Linux, the default is in `/dev/shm` which is backed by memory; simulations running concurrently on the same host need to use different prefixes.");
+Register_GlobalConfigOptionU(CFGID_PARSIM_SHMCOMM_BUFFER_SIZE, "parsim-sharedmemorycommunications-buffer-size", "B", "1MiB", "When `cSharedMemoryCommunications` is selected as parsim communications class: the size of the ring buffer for each pair of partitions (rounded up to a power of two). Messages larger than the buffer are transferred in chunks.");
+
+#define SEGMENT_MAGIC     0x4f505348  // "OPSH"
+#define HEADER_SIZE       64
+#define CACHELINE_SIZE    64
+#define SPIN_COUNT        2000        // receive attempts before going to sleep
+#define SLEEP_TIMEOUT_MS  100         // receiveBlocking() calls idle() with this frequency
+#define OPEN_TIMEOUT_SECS 30
+
+// at the beginning of each segment
+struct cSharedMemoryCommunications::SegmentHeader
+{
+    std::atomic<uint32_t> magic;      // set when the segment has been initialized
+    uint32_t numPartitions;
+    int32_t creatorPid;               // process that created the segment; used to detect stale segments
+    uint64_t ringSize;
+    std::atomic<uint32_t> wakeupSeq;  // futex word; incremented by senders to wake up the receiver
+    std::atomic<uint32_t> sleeping;   // set by the receiver before it goes to sleep
+};
+
+// single-producer single-consumer ring buffer; the data area follows the struct.
+// Read and write positions increase monotonically, and are masked with (ringSize-1)
+// when indexing into the data area.
+struct cSharedMemoryCommunications::Ring
+{
+    alignas(CACHELINE_SIZE) std::atomic<uint64_t> writePos;  // only modified by the sender
+    alignas(CACHELINE_SIZE) std::atomic<uint64_t> readPos;   // only modified by the receiver
+
+    char *getData() {return (char *)this + sizeof(Ring);}
+};
+
+// atomics in shared memory must be lock-free, otherwise they are not usable across processes
+#if ATOMIC_INT_LOCK_FREE != 2 || ATOMIC_LLONG_LOCK_FREE != 2
+#error "cSharedMemoryCommunications requires lock-free atomic integers"
+#endif
+
+static inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static bool isProcessAlive(pid_t pid)
+{
+    return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+static void waitABit(int& counter)
+{
+    // spin first, then yield the CPU, finally sleep
+    if (++counter < 1000)
+        cpuRelax();
+    else if (counter < 2000)
+        sched_yield();
+    else
+        usleep(100);
+}
+
+cSharedMemoryCommunications::cSharedMemoryCommunications()
+{
+    static_assert(sizeof(SegmentHeader) <= HEADER_SIZE, "segment header too large");
+
+    prefix = getEnvir()->getConfig()->getAsString(CFGID_PARSIM_SHMCOMM_PREFIX);
+    size_t size = (size_t)getEnvir()->getConfig()->getAsDouble(CFGID_PARSIM_SHMCOMM_BUFFER_SIZE);
+    ringSize = 4096;
+    while (ringSize < size)
+        ringSize *= 2;
+    numPartitions = 0;
+    myProcId = -1;
+    segmentSize = 0;
+    rrBase = 0;
+}
+
+cSharedMemoryCommunications::~cSharedMemoryCommunications()
+{
+    for (int i = 0; i < (int)segments.size(); i++)
+        if (segments[i])
+            munmap(segments[i], segmentSize);
+
+    for (auto item : receivedBuffers)
+        delete item.buffer;
+    for (auto& pm : partialMessages)
+        delete pm.buffer;
+    for (auto buffer : freeBuffers)
+        delete buffer;
+}
+
+std::string cSharedMemoryCommunications::getSegmentName(int procId) const
+{
+    return prefix + std::to_string(procId);
+}
+
+cSharedMemoryCommunications::SegmentHeader *cSharedMemoryCommunications::getHeader(int procId) const
+{
+    return (SegmentHeader *)segments[procId];
+}
+
+cSharedMemoryCommunications::Ring *cSharedMemoryCommunications::getRing(int procId, int senderProcId) const
+{
+    return (Ring *)(segments[procId] + HEADER_SIZE + senderProcId * (sizeof(Ring) + ringSize));
+}
+
+void cSharedMemoryCommunications::init(int np)
+{
+    // store parameter
+    numPartitions = np;
+
+    // get myProcId from "-p" command-line option
+    myProcId = getProcIdFromCommandLineArgs(numPartitions, "cSharedMemoryCommunications");
+
+    EV << "cSharedMemoryCommunications: started as process " << myProcId << " out of " << numPartitions << ".\n";
+
+    segmentSize = HEADER_SIZE + numPartitions * (sizeof(Ring) + ringSize);
+    segments.assign(numPartitions, nullptr);
+    partialMessages.assign(numPartitions, PartialMessage());
+
+    // create our own segment where the other partitions will write to
+    std::string fname = getSegmentName(myProcId);
+    EV << "cSharedMemoryCommunications: creating shared memory segment '" << fname << "'...\n";
+    segments[myProcId] = createSegment(fname.c_str());
+
+    // map the segments of the other partitions
+    for (int i = 0; i < numPartitions; i++) {
+        if (i == myProcId)
+            continue;
+        fname = getSegmentName(i);
+        EV << "cSharedMemoryCommunications: opening shared memory segment '" << fname << "'...\n";
+        segments[i] = openSegment(fname.c_str());
+    }
+}
+
+char *cSharedMemoryCommunications::createSegment(const char *fname)
+{
+    unlink(fname);
+    int fd = open(fname, O_RDWR|O_CREAT|O_EXCL, 0600);
+    if (fd == -1)
+        throw cRuntimeError("cSharedMemoryCommunications: Cannot create shared memory segment '%s': %s", fname, strerror(errno));
+    if (ftruncate(fd, segmentSize) == -1) {
+        close(fd);
+        throw cRuntimeError("cSharedMemoryCommunications: Cannot set size of shared memory segment '%s': %s", fname, strerror(errno));
+    }
+    void *p = mmap(nullptr, segmentSize, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        throw cRuntimeError("cSharedMemoryCommunications: Cannot map shared memory segment '%s': %s", fname, strerror(errno));
+
+    // the file is zero-filled, which is a valid initial state for the rings
+    SegmentHeader *header = (SegmentHeader *)p;
+    header->numPartitions = numPartitions;
+    header->ringSize = ringSize;
+    header->creatorPid = getpid();
+    header->magic.store(SEGMENT_MAGIC, std::memory_order_release);
+    return (char *)p;
+}
+
+char *cSharedMemoryCommunications::openSegment(const char *fname)
+{
+    // wait until the other partition creates and initializes its segment
+    for (int k = 0; k < 10*OPEN_TIMEOUT_SECS; k++) {
+        int fd = open(fname, O_RDWR);
+        if (fd != -1) {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && (size_t)st.st_size == segmentSize) {
+                void *p = mmap(nullptr, segmentSize, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+                close(fd);
+                if (p == MAP_FAILED)
+                    throw cRuntimeError("cSharedMemoryCommunications: Cannot map shared memory segment '%s': %s", fname, strerror(errno));
+                SegmentHeader *header = (SegmentHeader *)p;
+                // a segment whose creator no longer exists was left behind by
+                // a crashed run; its owner will unlink it and create a new one
+                if (header->magic.load(std::memory_order_acquire) == SEGMENT_MAGIC && isProcessAlive(header->creatorPid)) {
+                    if (header->numPartitions != (uint32_t)numPartitions || header->ringSize != ringSize)
+                        throw cRuntimeError("cSharedMemoryCommunications: Shared memory segment '%s' has different parameters (number of partitions or buffer size)", fname);
+                    return (char *)p;
+                }
+                munmap(p, segmentSize);
+            }
+            else
+                close(fd);
+        }
+        usleep(100000);
+    }
+    throw cRuntimeError("cSharedMemoryCommunications: Cannot open shared memory segment '%s': Timed out waiting for the partition to create it", fname);
+}
+
+void cSharedMemoryCommunications::shutdown()
+{
+    for (int i = 0; i < numPartitions; i++) {
+        if (segments[i])
+            munmap(segments[i], segmentSize);
+        segments[i] = nullptr;
+    }
+    unlink(getSegmentName(myProcId).c_str());
+}
+
+int cSharedMemoryCommunications::getNumPartitions() const
+{
+    return numPartitions;
+}
+
+int cSharedMemoryCommunications::getProcId() const
+{
+    return myProcId;
+}
+
+cCommBuffer *cSharedMemoryCommunications::createCommBuffer()
+{
+    if (freeBuffers.empty())
+        return new cMemCommBuffer();
+    cMemCommBuffer *buffer = freeBuffers.back();
+    freeBuffers.pop_back();
+    buffer->reset();
+    return buffer;
+}
+
+void cSharedMemoryCommunications::recycleCommBuffer(cCommBuffer *buffer)
+{
+    freeBuffers.push_back((cMemCommBuffer *)buffer);
+}
+
+void cSharedMemoryCommunications::wakeUp(SegmentHeader *header)
+{
+    // pairs with the fence in receive(): either we see that the receiver is
+    // sleeping, or the receiver sees the data we have just published
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header->sleeping.load(std::memory_order_relaxed)) {
+        header->wakeupSeq.fetch_add(1, std::memory_order_seq_cst);
+#ifdef __linux__
+        syscall(SYS_futex, (uint32_t *)&header->wakeupSeq, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+    }
+}
+
+void cSharedMemoryCommunications::sleep(SegmentHeader *header, unsigned int seq)
+{
+#ifdef __linux__
+    // returns immediately if a sender has already incremented wakeupSeq
+    struct timespec timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_nsec = SLEEP_TIMEOUT_MS * 1000000L;
+    syscall(SYS_futex, (uint32_t *)&header->wakeupSeq, FUTEX_WAIT, seq, &timeout, nullptr, 0);
+#else
+    // no portable cross-process wait primitive; poll with a short sleep
+    for (int k = 0; k < SLEEP_TIMEOUT_MS*10 && header->wakeupSeq.load() == seq; k++)
+        usleep(100);
+#endif
+}
+
+void cSharedMemoryCommunications::writeBytes(int destination, Ring *ring, const void *data, size_t length)
+{
+    const char *src = (const char *)data;
+    char *ringData = ring->getData();
+    uint64_t writePos = ring->writePos.load(std::memory_order_relaxed);
+    int waitCounter = 0;
+    while (length > 0) {
+        size_t space = ringSize - (size_t)(writePos - ring->readPos.load(std::memory_order_acquire));
+        if (space == 0) {
+            // ring is full: publish what we have written so far, and wait for the
+            // receiver; meanwhile, accept incoming messages so that partitions
+            // that are blocked sending to each other cannot deadlock
+            ring->writePos.store(writePos, std::memory_order_release);
+            wakeUp(getHeader(destination));
+            if (!bufferIncomingMessages())
+                waitABit(waitCounter);
+            continue;
+        }
+        size_t n = std::min(space, length);
+        size_t offset = (size_t)writePos & (ringSize-1);
+        size_t n1 = std::min(n, ringSize - offset);
+        memcpy(ringData + offset, src, n1);
+        memcpy(ringData, src + n1, n - n1);
+        writePos += n;
+        src += n;
+        length -= n;
+    }
+    ring->writePos.store(writePos, std::memory_order_release);
+}
+
+size_t cSharedMemoryCommunications::readBytes(Ring *ring, void *data, size_t length)
+{
+    // never blocks; returns the number of bytes read
+    uint64_t readPos = ring->readPos.load(std::memory_order_relaxed);
+    size_t available = (size_t)(ring->writePos.load(std::memory_order_acquire) - readPos);
+    size_t n = std::min(available, length);
+    if (n == 0)
+        return 0;
+    const char *ringData = ring->getData();
+    size_t offset = (size_t)readPos & (ringSize-1);
+    size_t n1 = std::min(n, ringSize - offset);
+    memcpy(data, ringData + offset, n1);
+    memcpy((char *)data + n1, ringData, n - n1);
+    ring->readPos.store(readPos + n, std::memory_order_release);  // frees up space for the sender
+    return n;
+}
+
+void cSharedMemoryCommunications::send(cCommBuffer *buffer, int tag, int destination)
+{
+    cMemCommBuffer *b = (cMemCommBuffer *)buffer;
+    Ring *ring = getRing(destination, myProcId);
+
+    MessageHeader mh;
+    mh.tag = tag;
+    mh.contentLength = b->getMessageSize();
+    writeBytes(destination, ring, &mh, sizeof(mh));
+    writeBytes(destination, ring, b->getBuffer(), mh.contentLength);
+    wakeUp(getHeader(destination));
+}
+
+bool cSharedMemoryCommunications::bufferIncomingMessages()
+{
+    bool received = false;
+    int receivedTag, sourceProcId;
+    cMemCommBuffer *buffer = (cMemCommBuffer *)createCommBuffer();
+    while (doReceive(buffer, receivedTag, sourceProcId)) {
+        receivedBuffers.push_back({receivedTag, sourceProcId, buffer});
+        buffer = (cMemCommBuffer *)createCommBuffer();
+        received = true;
+    }
+    recycleCommBuffer(buffer);
+    return received;
+}
+
+bool cSharedMemoryCommunications::receive(int filtTag, cCommBuffer *buffer, int& receivedTag, int& sourceProcId, bool blocking)
+{
+    // return one from the previously buffered ones, if exist
+    for (auto it = receivedBuffers.begin(); it != receivedBuffers.end(); ++it) {
+        if (it->receivedTag == filtTag || filtTag == PARSIM_ANY_TAG) {
+            receivedTag = it->receivedTag;
+            sourceProcId = it->sourceProcId;
+            ((cMemCommBuffer*)buffer)->swap(it->buffer);
+            recycleCommBuffer(it->buffer);
+            receivedBuffers.erase(it);
+            return true;
+        }
+    }
+
+    // receive from the rings; if blocking, spin for a while (yielding the CPU
+    // in the second half, in case partitions share CPU cores), then go to sleep
+    bool recv = doReceive(buffer, receivedTag, sourceProcId);
+    for (int k = 0; !recv && blocking && k < SPIN_COUNT; k++) {
+        if (k < SPIN_COUNT/2)
+            cpuRelax();
+        else
+            sched_yield();
+        recv = doReceive(buffer, receivedTag, sourceProcId);
+    }
+    if (!recv && blocking) {
+        SegmentHeader *header = getHeader(myProcId);
+        header->sleeping.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        unsigned int seq = header->wakeupSeq.load(std::memory_order_seq_cst);
+        recv = doReceive(buffer, receivedTag, sourceProcId);
+        if (!recv) {
+            sleep(header, seq);
+            recv = doReceive(buffer, receivedTag, sourceProcId);
+        }
+        header->sleeping.store(0, std::memory_order_relaxed);
+    }
+
+    // if received one with a wrong tag, store it for later and return false
+    if (recv && filtTag != PARSIM_ANY_TAG && filtTag != receivedTag) {
+        cMemCommBuffer *copy = (cMemCommBuffer *)createCommBuffer();
+        ((cMemCommBuffer*)buffer)->swap(copy);
+        receivedBuffers.push_back({receivedTag, sourceProcId, copy});
+        return false;
+    }
+    return recv;
+}
+
+bool cSharedMemoryCommunications::readMessage(int sourceProcId)
+{
+    // continue assembling the message from the given partition; a message may
+    // arrive in several parts if it is larger than the free space in the ring
+    Ring *ring = getRing(myProcId, sourceProcId);
+    PartialMessage& pm = partialMessages[sourceProcId];
+    if (pm.headerBytes < sizeof(MessageHeader)) {
+        pm.headerBytes += readBytes(ring, (char *)&pm.header + pm.headerBytes, sizeof(MessageHeader) - pm.headerBytes);
+        if (pm.headerBytes < sizeof(MessageHeader))
+            return false;
+        if (!pm.buffer)
+            pm.buffer = (cMemCommBuffer *)createCommBuffer();
+        pm.buffer->reset();
+        pm.buffer->allocateAtLeast(pm.header.contentLength);
+        pm.buffer->setMessageSize(pm.header.contentLength);
+        pm.contentBytes = 0;
+    }
+    size_t contentLength = pm.header.contentLength;
+    pm.contentBytes += readBytes(ring, pm.buffer->getBuffer() + pm.contentBytes, contentLength - pm.contentBytes);
+    return pm.contentBytes == contentLength;
+}
+
+bool cSharedMemoryCommunications::doReceive(cCommBuffer *buffer, int& receivedTag, int& sourceProcId)
+{
+    cMemCommBuffer *b = (cMemCommBuffer *)buffer;
+
+    rrBase = (rrBase+1)%numPartitions;
+    for (int k = 0; k < numPartitions; k++) {
+        int i = (rrBase+k)%numPartitions;  // shift by rrBase for Round-Robin query
+        if (i == myProcId)
+            continue;
+        Ring *ring = getRing(myProcId, i);
+        if (ring->writePos.load(std::memory_order_acquire) == ring->readPos.load(std::memory_order_relaxed))
+            continue;
+        if (!readMessage(i))
+            continue;
+
+        // hand over the message; the memory area of the caller's buffer will be reused
+        PartialMessage& pm = partialMessages[i];
+        b->swap(pm.buffer);
+        pm.buffer->reset();
+        pm.headerBytes = 0;
+        sourceProcId = i;
+        receivedTag = pm.header.tag;
+        return true;
+    }
+    return false;
+}
+
+bool cSharedMemoryCommunications::receiveBlocking(int filtTag, cCommBuffer *buffer, int& receivedTag, int& sourceProcId)
+{
+    // receive() sleeps for max SLEEP_TIMEOUT_MS, so the user interface
+    // gets a chance to process events in the meantime
+    while (!receive(filtTag, buffer, receivedTag, sourceProcId, true)) {
+        if (getEnvir()->idle())
+            return false;
+    }
+    return true;
+}
+
+bool cSharedMemoryCommunications::receiveNonblocking(int filtTag, cCommBuffer *buffer, int& receivedTag, int& sourceProcId)
+{
+    return receive(filtTag, buffer, receivedTag, sourceProcId, false);
+}
+
+}  // namespace omnetpp
+
+#endif /* !_WIN32 */
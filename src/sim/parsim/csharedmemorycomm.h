@@ -0,0 +1,177 @@
+//=========================================================================
+//  CSHAREDMEMORYCOMM.H - part of
+//
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2003-2017 Andras Varga
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+
+#ifndef __OMNETPP_CSHAREDMEMORYCOMM_H
+#define __OMNETPP_CSHAREDMEMORYCOMM_H
+
+#include <list>
+#include <vector>
+#include <string>
+#include "omnetpp/cparsimcomm.h"
+
+namespace omnetpp {
+
+class cMemCommBuffer;
+
+/**
+ * @brief Implementation of the communications layer for partitions that run
+ * on the same host, using shared memory.
+ *
+ * Every partition creates a shared memory segment for its incoming messages
+ * at initialization time, and maps the segments of all other partitions.
+ * A segment contains one single-producer single-consumer ring buffer per
+ * sender partition, so sending and receiving messages does not require
+ * locking or system calls. A receiver that waits for messages spins for
+ * a while, and then goes to sleep (on Linux, using a futex) until a sender
+ * wakes it up.
+ *
+ * Partitions are started as separate processes, with the same "-p" command
+ * line option as with cNamedPipeCommunications. On Linux, segments are created
+ * in /dev/shm; on other systems, in memory-mapped files in the "comm/"
+ * directory. See the parsim-sharedmemorycommunications-prefix and
+ * parsim-sharedmemorycommunications-buffer-size configuration options.
+ * Segments left behind by a crashed run are recognized (their creator process
+ * no longer exists) and replaced. Not available on Windows.
+ *
+ * @ingroup Parsim
+ */
+class SIM_API cSharedMemoryCommunications : public cParsimCommunications
+{
+  protected:
+    struct SegmentHeader;
+    struct Ring;
+    struct MessageHeader {int tag; int contentLength;};
+
+    int numPartitions;
+    int myProcId;
+
+    // configuration
+    std::string prefix;
+    size_t ringSize;        // size of the data area of each ring buffer; power of 2
+    size_t segmentSize;
+
+    // segments[i] is the mapped segment of partition i; our incoming
+    // messages arrive into segments[myProcId]
+    std::vector<char *> segments;
+    int rrBase;
+
+    // messages being received, one per sender partition
+    struct PartialMessage {
+        MessageHeader header;
+        size_t headerBytes = 0;
+        size_t contentBytes = 0;
+        cMemCommBuffer *buffer = nullptr;
+    };
+    std::vector<PartialMessage> partialMessages;
+
+    // reordering buffer needed because of tag filtering support (filtTag)
+    struct ReceivedBuffer {int receivedTag; int sourceProcId; cMemCommBuffer *buffer;};
+    std::list<ReceivedBuffer> receivedBuffers;
+
+    // recycled buffers, to avoid reallocating their memory areas
+    std::vector<cMemCommBuffer *> freeBuffers;
+
+  protected:
+    std::string getSegmentName(int procId) const;
+    char *createSegment(const char *fname);
+    char *openSegment(const char *fname);
+    SegmentHeader *getHeader(int procId) const;
+    Ring *getRing(int procId, int senderProcId) const;
+
+    void writeBytes(int destination, Ring *ring, const void *data, size_t length);
+    size_t readBytes(Ring *ring, void *data, size_t length);
+    bool readMessage(int sourceProcId);
+    void wakeUp(SegmentHeader *header);
+    void sleep(SegmentHeader *header, unsigned int seq);
+
+    bool bufferIncomingMessages();  // moves incoming messages into receivedBuffers
+
+    // common impl. for receiveBlocking() and receiveNonblocking()
+    bool receive(int filtTag, cCommBuffer *buffer, int& receivedTag, int& sourceProcId, bool blocking);
+    bool doReceive(cCommBuffer *buffer, int& receivedTag, int& sourceProcId);
+
+  public:
+    /**
+     * Constructor.
+     */
+    cSharedMemoryCommunications();
+
+    /**
+     * Destructor.
+     */
+    virtual ~cSharedMemoryCommunications();
+
+    /** @name Redefined methods from cParsimCommunications */
+    //@{
+    /**
+     * Init the library. Here we create our own shared memory segment,
+     * and map the segments of the other partitions.
+     */
+    virtual void init(int numPartitions) override;
+
+    /**
+     * Shutdown the communications library. Unmaps the segments, and removes
+     * our own one.
+     */
+    virtual void shutdown() override;
+
+    /**
+     * Returns total number of partitions.
+     */
+    virtual int getNumPartitions() const override;
+
+    /**
+     * Returns the id of this partition.
+     */
+    virtual int getProcId() const override;
+
+    /**
+     * Creates an empty buffer of type cMemCommBuffer. Recycled buffers
+     * are reused.
+     */
+    virtual cCommBuffer *createCommBuffer() override;
+
+    /**
+     * Recycle communication buffer after use.
+     */
+    virtual void recycleCommBuffer(cCommBuffer *buffer) override;
+
+    /**
+     * Sends packed data with given tag to destination.
+     */
+    virtual void send(cCommBuffer *buffer, int tag, int destination) override;
+
+    /**
+     * Receives packed data, and also returns tag and source procId.
+     * Normally returns true; false is returned if blocking was interrupted by the user.
+     */
+    virtual bool receiveBlocking(int filtTag, cCommBuffer *buffer, int& receivedTag, int& sourceProcId) override;
+
+    /**
+     * Receives packed data, and also returns tag and source procId.
+     * Call is non-blocking -- it returns true if something has been
+     * received, false otherwise.
+     */
+    virtual bool receiveNonblocking(int filtTag, cCommBuffer *buffer,  int& receivedTag, int& sourceProcId) override;
+    //@}
+};
+
+}  // namespace omnetpp
+
+
+#endif
+
@@ -0,0 +1,86 @@
+//
+// Measures dup() throughput of packets with and without @copyOnWrite fields.
+// Copies share the fields of a @copyOnWrite packet until one of them is
+// modified, so broadcasting a packet does not copy its arrays.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <omnetpp.h>
+#include "dupperf_m.h"
+
+using namespace omnetpp;
+
+class DupPerf : public cSimpleModule
+{
+  protected:
+    long numDups = 0;
+    double elapsedSecs = 0;
+
+  protected:
+    template<typename T> void runRound();
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+};
+
+Define_Module(DupPerf);
+
+void DupPerf::initialize()
+{
+    scheduleAt(0, new cMessage("Round"));
+}
+
+template<typename T>
+void DupPerf::runRound()
+{
+    int numDuplicates = par("numDuplicates");
+    int arraySize = par("arraySize");
+    double modifyProbability = par("modifyProbability");
+
+    T *packet = new T("Update");
+    packet->setOriginator(getFullPath().c_str());
+    packet->setDestinationsArraySize(arraySize);
+    packet->setCostsArraySize(arraySize);
+    for (int i = 0; i < arraySize; i++) {
+        packet->setDestinations(i, i);
+        packet->setCosts(i, uniform(0, 1));
+    }
+
+    // make copies, e.g. for broadcasting or for a retransmission queue
+    std::vector<T *> copies;
+    for (int i = 0; i < numDuplicates; i++) {
+        T *copy = packet->dup();
+        if (uniform(0, 1) < modifyProbability)
+            copy->setSequenceNumber(i);
+        copies.push_back(copy);
+    }
+    numDups += numDuplicates;
+
+    for (T *copy : copies)
+        delete copy;
+    delete packet;
+}
+
+void DupPerf::handleMessage(cMessage *msg)
+{
+    bool copyOnWrite = par("copyOnWrite");
+    int numRounds = par("numRounds");
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numRounds; i++) {
+        if (copyOnWrite)
+            runRound<SharedRoutingPacket>();
+        else
+            runRound<RoutingPacket>();
+    }
+    elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    delete msg;
+}
+
+void DupPerf::finish()
+{
+    printf("Duplicated %ld packets in %.3fs, %.0f dups/sec%s\n", numDups, elapsedSecs,
+           elapsedSecs > 0 ? numDups / elapsedSecs : 0, par("copyOnWrite").boolValue() ? " (copy-on-write)" : "");
+}
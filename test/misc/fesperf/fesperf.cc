@@ -0,0 +1,17 @@
+#include "fesperf.h"
+
+Define_Module(FesPerf);
+
+
+void FesPerf::initialize()
+{
+    holdTime = &par("holdTime");
+    int numEvents = par("numEvents");
+    for (int i = 0; i < numEvents; i++)
+        scheduleAt(holdTime->doubleValue(), new cMessage("event"));
+}
+
+void FesPerf::handleMessage(cMessage *msg)
+{
+    scheduleAt(simTime() + holdTime->doubleValue(), msg);
+}
@@ -0,0 +1,21 @@
+#ifndef __FESPERF_H_
+#define __FESPERF_H_
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+/**
+ * Classic "hold" model for measuring FES performance: it keeps a fixed number
+ * of events in the FES, and every event reschedules itself.
+ */
+class FesPerf : public cSimpleModule
+{
+  protected:
+    cPar *holdTime;
+  protected:
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+};
+
+#endif
@@ -14,6 +14,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <fcntl.h>
 #include <common/lcgrandom.h>
 #include <common/exception.h>
@@ -33,10 +34,11 @@ int parseLineNumber(char *line)
     return !line || *line == '\r' || *line == '\n' ? -1 : atol(line);
 }
 
-void testFileReader(const char *file, long numberOfLines, int numberOfSeeks, int numberOfReadLines)
+void testFileReader(const char *file, long numberOfLines, int numberOfSeeks, int numberOfReadLines, bool memoryMapped)
 {
     _setmode(_fileno(stdout), _O_BINARY);
     FileReader fileReader(file);
+    fileReader.setMemoryMapped(memoryMapped, false);
     LCGRandom random;
     int64_t fileSize = fileReader.getFileSize();
 
@@ -114,6 +116,48 @@ void testFileReader(const char *file, long numberOfLines, int numberOfSeeks, int
     }
 }
 
+void appendLines(const char *file, long from, long to)
+{
+    FILE *f = fopen(file, "ab");
+    if (!f)
+        throw opp_runtime_error("*** Cannot open '%s' for writing\n", file);
+    for (long i = from; i < to; i++)
+        fprintf(f, "%ld line\n", i);
+    fclose(f);
+}
+
+// reads a memory mapped file that grows during reading: the reader must switch to the buffer and return the appended lines
+void testGrowingFile(const char *file)
+{
+    remove(file);
+    appendLines(file, 0, 1000);
+
+    FileReader fileReader(file);
+    fileReader.setMemoryMapped(true);
+    fileReader.getFirstLineBufferPointer();
+    if (!fileReader.isMemoryMapped())
+        throw opp_runtime_error("*** File is not memory mapped\n");
+
+    long expectedLineNumber = 0;
+    char *line;
+    for (int i = 1; i < 500; i++) {
+        line = fileReader.getNextLineBufferPointer();
+        if (parseLineNumber(line) != ++expectedLineNumber)
+            throw opp_runtime_error("*** Line number %ld expected before appending\n", expectedLineNumber);
+    }
+
+    appendLines(file, 1000, 2000);
+
+    while ((line = fileReader.getNextLineBufferPointer()) != nullptr)
+        if (parseLineNumber(line) != ++expectedLineNumber)
+            throw opp_runtime_error("*** Line number %ld expected after appending\n", expectedLineNumber);
+    if (expectedLineNumber != 1999)
+        throw opp_runtime_error("*** Appended lines not read, last line number: %ld\n", expectedLineNumber);
+    if (fileReader.isMemoryMapped())
+        throw opp_runtime_error("*** File is still memory mapped after it has grown\n");
+    printf("Read %ld lines\n", expectedLineNumber + 1);
+}
+
 void usage(char *message)
 {
     if (message)
@@ -121,20 +165,27 @@ void usage(char *message)
 
     fprintf(stderr, ""
                     "Usage:\n"
-                    "   filereadertest <input-file-name> <number-of-lines> <number-of-seeks> <number-of-read-lines-per-seek>\n"
+                    "   filereadertest <input-file-name> <number-of-lines> <number-of-seeks> <number-of-read-lines-per-seek> [mapped]\n"
+                    "   filereadertest -grow <output-file-name>\n"
             );
 }
 
 int main(int argc, char **argv)
 {
     try {
-        if (argc < 5) {
+        if (argc == 3 && !strcmp(argv[1], "-grow")) {
+            testGrowingFile(argv[2]);
+            printf("PASS\n");
+
+            return 0;
+        }
+        else if (argc < 5) {
             usage("Not enough arguments specified");
 
             return -1;
         }
         else {
-            testFileReader(argv[1], atol(argv[2]), atoi(argv[3]), atoi(argv[4]));
+            testFileReader(argv[1], atol(argv[2]), atoi(argv[3]), atoi(argv[4]), argc > 5 && !strcmp(argv[5], "mapped"));
             printf("PASS\n");
 
             return 0;
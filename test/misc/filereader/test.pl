@@ -59,6 +59,32 @@ sub test
    {
       print("FAIL: Reader test on $fileName\n\n");
    }
+
+   $mappedResultFileName = $fileName;
+   $mappedResultFileName =~ s/^(.*)\//results\/mapped-/;
+
+   if (system("${progdir}filereadertest $fileName $numberOfLines $numberOfSeeks $numberOfReadLines mapped > $mappedResultFileName") == 0)
+   {
+      print("PASS: Memory mapped reader test on $fileName\n\n");
+   }
+   else
+   {
+      print("FAIL: Memory mapped reader test on $fileName\n\n");
+   }
+}
+
+sub growingFileTest
+{
+   my($fileName) = @_;
+
+   if (system("${progdir}filereadertest -grow $fileName") == 0)
+   {
+      print("PASS: Growing memory mapped file test on $fileName\n\n");
+   }
+   else
+   {
+      print("FAIL: Growing memory mapped file test on $fileName\n\n");
+   }
 }
 
 sub generateContent
@@ -163,5 +189,7 @@ generateAndTest("generated/large-big-lines.txt",  1E+8, 32768, 100, 100);
 # uncomment this if you want to test it with GByte files
 #generateAndTest("generated/huge-big-lines.txt",   5E+9, 32768, 100, 100);
 
+growingFileTest("results/growing.txt");
+
 concurrentTest("results/concurrent_small.txt", 1, 100);
 concurrentTest("results/concurrent_large.txt", 10, 10000);
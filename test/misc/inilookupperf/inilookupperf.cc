@@ -0,0 +1,142 @@
+//=========================================================================
+//  INILOOKUPPERF.CC - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+//
+// Measures parameter and per-object config lookups in a large synthetic
+// configuration, the way network setup performs them: every parameter of
+// every module of a network with a host[] vector is looked up. The ini file
+// has a few thousand wildcard entries: settings for individual hosts (like
+// "**.host[17].app[0].destAddress") and groups of hosts, and defaults.
+//
+// Usage: inilookupperf [<numHosts> [<numConfiguredHosts>]]
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <functional>
+#include <omnetpp.h>
+#include <envir/inifilereader.h>
+#include <envir/sectionbasedconfig.h>
+
+using namespace omnetpp;
+using namespace omnetpp::envir;
+
+static void generate(const char *fileName, int numConfiguredHosts)
+{
+    FILE *f = fopen(fileName, "w");
+    if (!f)
+        throw cRuntimeError("Cannot open '%s' for write", fileName);
+    fprintf(f, "[General]\nnetwork = Net\n");
+    for (int i = 0; i < numConfiguredHosts; i++) {
+        fprintf(f, "**.host[%d].app[0].destAddress = \"host[%d]\"\n", i, (i+1) % numConfiguredHosts);
+        fprintf(f, "**.host[%d].app[*].sendInterval = %dms\n", i, 10 + i % 50);
+        fprintf(f, "**.host[%d].nic.mac.address = \"10:00:00:00:%02x:%02x\"\n", i, i / 256, i % 256);
+    }
+    for (int i = 0; i < numConfiguredHosts; i += 100) {
+        fprintf(f, "**.host[%d..%d].app[*].packetLength = %dB\n", i, i + 99, 100 + i);
+        fprintf(f, "**.host[%d..%d].nic.*.bitrate = %dMbps\n", i, i + 99, 10 + i);
+        fprintf(f, "**.host[%d..%d].app[*].throughput.result-recording-modes = +vector\n", i, i + 99);
+    }
+    fprintf(f, "**.app[*].destAddress = \"\"\n");
+    fprintf(f, "**.app[*].sendInterval = 1s\n");
+    fprintf(f, "**.app[*].packetLength = 1000B\n");
+    fprintf(f, "**.app[*].startTime = uniform(0s,1s)\n");
+    fprintf(f, "**.mac.address = \"auto\"\n");
+    fprintf(f, "**.mac.queueLength = 100\n");
+    fprintf(f, "**.bitrate = 100Mbps\n");
+    fprintf(f, "**.phy.txPower = 1mW\n");
+    fprintf(f, "**.throughput.result-recording-modes = -\n");
+    fclose(f);
+}
+
+static void measure(const char *label, long count, std::function<long()> f)
+{
+    auto begin = std::chrono::steady_clock::now();
+    long found = f();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    printf("  %-36s %8.3fs  %10.0f/s  (%ld of %ld found)\n", label, seconds, count / seconds, found, count);
+}
+
+int main(int argc, char **argv)
+{
+    int numHosts = argc > 1 ? atoi(argv[1]) : 10000;
+    int numConfiguredHosts = argc > 2 ? atoi(argv[2]) : 1000;
+    const char *fileName = "inilookupperf.ini";
+
+    try {
+        generate(fileName, numConfiguredHosts);
+        InifileReader *ini = new InifileReader();
+        ini->readFile(fileName);
+        SectionBasedConfiguration config;
+        config.setConfigurationReader(ini);
+        printf("%d hosts, %d entries in the ini file\n", numHosts, ini->getNumEntries(0));
+
+        measure("activateConfig()", 1, [&]() {
+            config.activateConfig("General", 0);
+            return 1;
+        });
+
+        // the modules and parameters of a host
+        struct Module { const char *path; std::vector<const char *> params; };
+        std::vector<Module> modules = {
+            {"", {"numApps"}},
+            {".app[0]", {"destAddress", "sendInterval", "packetLength", "startTime"}},
+            {".app[1]", {"destAddress", "sendInterval", "packetLength", "startTime"}},
+            {".nic", {"bitrate"}},
+            {".nic.mac", {"address", "queueLength", "bitrate"}},
+            {".nic.phy", {"bitrate", "txPower"}},
+        };
+        long numLookups = 0;
+        for (auto& module : modules)
+            numLookups += numHosts * module.params.size();
+        std::vector<std::string> hostPaths;
+        for (int i = 0; i < numHosts; i++)
+            hostPaths.push_back("Net.host[" + std::to_string(i) + "]");
+
+        measure("getParameterValue()", numLookups, [&]() {
+            long found = 0;
+            std::string path;
+            for (auto& hostPath : hostPaths) {
+                for (auto& module : modules) {
+                    path = hostPath + module.path;
+                    for (const char *param : module.params)
+                        if (config.getParameterValue(path.c_str(), param, true))
+                            found++;
+                }
+            }
+            return found;
+        });
+
+        measure("getPerObjectConfigValue()", 2L * numHosts, [&]() {
+            long found = 0;
+            std::string path;
+            for (auto& hostPath : hostPaths) {
+                for (const char *app : {".app[0]", ".app[1]"}) {
+                    path = hostPath + app + ".throughput";
+                    if (config.getPerObjectConfigValue(path.c_str(), "result-recording-modes"))
+                        found++;
+                }
+            }
+            return found;
+        });
+    }
+    catch (std::exception& e) {
+        fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
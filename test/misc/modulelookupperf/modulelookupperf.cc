@@ -0,0 +1,84 @@
+//
+// Measures submodule lookups by name and index, and by module path, in a
+// network with a large host[] vector. Lookups used to walk the submodule
+// list, making network setup quadratic when every host looks up its peers.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+class Node : public cSimpleModule
+{
+};
+
+Define_Module(Node);
+
+class LookupTester : public cSimpleModule
+{
+  protected:
+    virtual int numInitStages() const override {return 2;}
+    virtual void initialize(int stage) override;
+    template<typename F> void measure(const char *label, int count, F f);
+};
+
+Define_Module(LookupTester);
+
+template<typename F>
+void LookupTester::measure(const char *label, int count, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("  %-40s %8.3fs  %10.0f/s\n", label, secs, count / secs);
+}
+
+void LookupTester::initialize(int stage)
+{
+    if (stage != 1)
+        return;
+
+    cModule *network = getParentModule();
+    int numHosts = network->par("numHosts");
+    long found = 0;
+    char path[64];
+
+    measure("getSubmodule(\"host\", i)", numHosts, [&]() {
+        for (int i = 0; i < numHosts; i++)
+            found += network->getSubmodule("host", i) != nullptr;
+    });
+    measure("getSubmodule(\"host\", i)->getSubmodule()", numHosts, [&]() {
+        for (int i = 0; i < numHosts; i++)
+            found += network->getSubmodule("host", i)->getSubmodule("nic") != nullptr;
+    });
+    measure("getModuleByPath(\"^.host[i].nic\")", numHosts, [&]() {
+        for (int i = 0; i < numHosts; i++) {
+            snprintf(path, sizeof(path), "^.host[%d].nic", i);
+            found += getModuleByPath(path) != nullptr;
+        }
+    });
+    measure("getSimulation()->getModuleByPath()", numHosts, [&]() {
+        for (int i = 0; i < numHosts; i++) {
+            snprintf(path, sizeof(path), "ModuleLookupPerf.host[%d].app", i);
+            found += getSimulation()->getModuleByPath(path) != nullptr;
+        }
+    });
+
+    // dynamic creation interleaved with lookups, e.g. a scenario manager adding nodes
+    cModuleType *nodeType = cModuleType::get("Node");
+    measure("create() + getSubmodule()", numHosts, [&]() {
+        for (int i = 0; i < numHosts; i++) {
+            nodeType->create("dyn", network, numHosts, i);
+            found += network->getSubmodule("dyn", i) != nullptr;
+        }
+    });
+    measure("deleteModule()", numHosts, [&]() {
+        for (int i = numHosts - 1; i >= 0; i--)
+            network->getSubmodule("dyn", i)->deleteModule();
+    });
+
+    if (found != 5L * numHosts)
+        throw cRuntimeError("Lookup failed: found %ld modules instead of %ld", found, 5L * numHosts);
+}
@@ -0,0 +1,112 @@
+//
+// Measures emit() from modules deep in the module hierarchy, with listeners
+// at the top of the hierarchy only (typical of statistics collectors), and
+// at every level. emit() used to look up the signal in the listener table of
+// every ancestor; now each component caches the list of its ancestors that
+// have listeners for the signal.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+class Emitter : public cSimpleModule
+{
+};
+
+Define_Module(Emitter);
+
+class CountingListener : public cListener
+{
+  public:
+    long count = 0;
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, intval_t value, cObject *details) override {count++;}
+};
+
+class SignalTester : public cSimpleModule
+{
+  protected:
+    virtual void initialize() override;
+    template<typename F> void measure(const char *label, long count, F f);
+};
+
+Define_Module(SignalTester);
+
+template<typename F>
+void SignalTester::measure(const char *label, long count, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("  %-40s %8.3fs  %10.0f/s\n", label, secs, count / secs);
+}
+
+void SignalTester::initialize()
+{
+    cModule *network = getParentModule();
+    int numHosts = network->par("numHosts");
+    long numEmits = par("numEmits");
+
+    // the emitters, and 20 signals the network-level listener is subscribed to
+    std::vector<cModule *> emitters;
+    for (int i = 0; i < numHosts; i++) {
+        cModule *nic = network->getSubmodule("host", i)->getSubmodule("nic");
+        emitters.push_back(nic->getSubmodule("mac"));
+        emitters.push_back(nic->getSubmodule("phy"));
+    }
+    std::vector<simsignal_t> signals;
+    for (int i = 0; i < 20; i++)
+        signals.push_back(registerSignal(("signal" + std::to_string(i)).c_str()));
+
+    CountingListener listener;
+    long expected = 0;
+    for (simsignal_t signal : signals)
+        network->subscribe(signal, &listener);
+
+    long n = numEmits / emitters.size() / signals.size();
+    long total = n * emitters.size() * signals.size();
+    measure("emit(), listener at the network", total, [&]() {
+        for (long k = 0; k < n; k++)
+            for (cModule *emitter : emitters)
+                for (simsignal_t signal : signals)
+                    emitter->emit(signal, k);
+    });
+    expected += total;
+
+    // also at every level below the network: 4 listeners per emit
+    for (cModule *emitter : emitters)
+        for (cModule *mod = emitter; mod != network; mod = mod->getParentModule())
+            if (!mod->isSubscribed(signals[0], &listener))
+                mod->subscribe(signals[0], &listener);
+    measure("emit(), listeners at every level", n * emitters.size() * 4, [&]() {
+        for (long k = 0; k < n; k++)
+            for (cModule *emitter : emitters)
+                emitter->emit(signals[0], k);
+    });
+    expected += n * emitters.size() * 4;
+
+    // subscribing and unsubscribing between emits invalidates the cached lists
+    measure("emit() with subscription changes", total, [&]() {
+        for (long k = 0; k < n; k++) {
+            for (cModule *emitter : emitters)
+                for (simsignal_t signal : signals)
+                    emitter->emit(signal, k);
+            network->unsubscribe(signals[1], &listener);
+            network->subscribe(signals[1], &listener);
+        }
+    });
+    expected += total + 3 * n * emitters.size();
+
+    if (listener.count != expected)
+        throw cRuntimeError("Listener received %ld signals instead of %ld", listener.count, expected);
+
+    for (cModule *emitter : emitters)
+        for (cModule *mod = emitter; mod != network; mod = mod->getParentModule())
+            if (mod->isSubscribed(signals[0], &listener))
+                mod->unsubscribe(signals[0], &listener);
+    for (simsignal_t signal : signals)
+        network->unsubscribe(signal, &listener);
+}
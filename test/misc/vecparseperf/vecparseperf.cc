@@ -0,0 +1,155 @@
+//=========================================================================
+//  VECPARSEPERF.CC - part of
+//                  OMNeT++/OMNEST
+//           Discrete System Simulation in C++
+//
+//=========================================================================
+
+/*--------------------------------------------------------------*
+  Copyright (C) 2006-2017 OpenSim Ltd.
+
+  This file is distributed WITHOUT ANY WARRANTY. See the file
+  `license' for details on this and other legal matters.
+*--------------------------------------------------------------*/
+
+//
+// Measures the throughput of the stages of parsing a text (version 3)
+// output vector file: line splitting, tokenizing, number parsing, indexing
+// and reading all data through the index. If the file does not exist, it is
+// generated first.
+//
+// Usage: vecparseperf [<file.vec> [<sizeInMB>]]
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <functional>
+#include <common/exception.h>
+#include <common/filereader.h>
+#include <common/linetokenizer.h>
+#include <common/lcgrandom.h>
+#include <common/fileutil.h>
+#include <scave/scaveutils.h>
+#include <scave/vectorfileindexer.h>
+#include <scave/indexedvectorfilereader.h>
+#include <scave/indexfileutils.h>
+
+using namespace omnetpp;
+using namespace omnetpp::common;
+using namespace omnetpp::scave;
+
+static void generate(const char *fileName, int64_t size)
+{
+    const int numVectors = 40;
+    FILE *f = fopen(fileName, "w");
+    if (!f)
+        throw opp_runtime_error("Cannot open '%s' for write", fileName);
+    fprintf(f, "version 3\nrun vecparseperf-1\nattr network Net\n\n");
+    for (int i = 0; i < numVectors; i++)
+        fprintf(f, "vector %d Net.host[%d] vec%d:vector ETV\nattr unit s\n", i, i/4, i%4);
+
+    // data lines come in blocks, like with the buffering done by the vector file writer
+    LCGRandom random;
+    int64_t eventNumber = 0;
+    double t = 0;
+    while (ftell(f) < size) {
+        for (int i = 0; i < 100; i++) {
+            int vectorId = random.draw(numVectors);
+            int count = 20 + random.draw(200);
+            for (int j = 0; j < count; j++) {
+                eventNumber += 1 + random.draw(10);
+                t += random.next01() * 0.001;
+                double value = (vectorId % 4 == 0) ? (double)random.draw(100) : random.next01() * 1000;
+                fprintf(f, "%d\t%" PRId64 "\t%.12g\t%.14g\n", vectorId, eventNumber, t, value);
+            }
+        }
+    }
+    fclose(f);
+}
+
+static void measure(const char *label, int64_t bytes, std::function<int64_t()> f)
+{
+    auto begin = std::chrono::steady_clock::now();
+    int64_t count = f();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    printf("%-28s %8.1f MB/s  (%.2fs, %" PRId64 ")\n", label, bytes / seconds / 1e6, seconds, count);
+}
+
+int main(int argc, char **argv)
+{
+    const char *fileName = argc > 1 ? argv[1] : "vecparseperf.vec";
+    int64_t size = (argc > 2 ? atol(argv[2]) : 1024) * 1024 * 1024;
+
+    try {
+        if (!fileExists(fileName)) {
+            printf("Generating %s...\n", fileName);
+            generate(fileName, size);
+        }
+
+        FileReader sizeReader(fileName);
+        int64_t bytes = sizeReader.getFileSize();
+        printf("File size: %.1f MB\n", bytes / 1e6);
+
+        measure("line splitting", bytes, [&]() {
+            FileReader reader(fileName);
+            reader.setMemoryMapped(true);
+            int64_t n = 0;
+            while (reader.getNextLineBufferPointer())
+                n++;
+            return n;
+        });
+
+        measure("line splitting+tokenizing", bytes, [&]() {
+            FileReader reader(fileName);
+            reader.setMemoryMapped(true);
+            LineTokenizer tokenizer;
+            int64_t n = 0;
+            char *line;
+            while ((line = reader.getNextLineBufferPointer()))
+                n += tokenizer.tokenize(line, reader.getCurrentLineLength());
+            return n;
+        });
+
+        measure("...+number parsing", bytes, [&]() {
+            FileReader reader(fileName);
+            reader.setMemoryMapped(true);
+            LineTokenizer tokenizer;
+            int64_t n = 0;
+            char *line;
+            while ((line = reader.getNextLineBufferPointer())) {
+                int numTokens = tokenizer.tokenize(line, reader.getCurrentLineLength());
+                char **tokens = tokenizer.tokens();
+                int vectorId;
+                int64_t eventNumber;
+                simultime_t t;
+                double value;
+                if (numTokens == 4 && parseInt(tokens[0], vectorId) && parseInt64(tokens[1], eventNumber) &&
+                        parseSimtime(tokens[2], t) && parseDouble(tokens[3], value))
+                    n++;
+            }
+            return n;
+        });
+
+        measure("indexing", bytes, [&]() {
+            VectorFileIndexer().generateIndex(fileName);
+            return (int64_t)1;
+        });
+
+        measure("reading via index", bytes, [&]() {
+            int64_t n = 0;
+            IndexedVectorFileReader reader(fileName, true, [&n](int, const std::vector<VectorDatum>& data) { n += data.size(); });
+            std::set<int> vectorIds;
+            for (int i = 0; i < 40; i++)
+                vectorIds.insert(i);
+            reader.collectEntries(vectorIds);
+            return n;
+        });
+        removeFile(IndexFileUtils::getIndexFileName(fileName).c_str(), "index file");
+    }
+    catch (std::exception& e) {
+        fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -414,6 +414,7 @@ ADD_CPTR_EQUALS_AND_HASHCODE(Run);
 ADD_CPTR_EQUALS_AND_HASHCODE(FileRun);
 ADD_CPTR_EQUALS_AND_HASHCODE(ResultItem);
 CHECK_RESULTFILE_FORMAT_EXCEPTION(ResultFileManager::loadFile)
+CHECK_RESULTFILE_FORMAT_EXCEPTION(ResultFileManager::loadFiles)
 
 } } // namespaces
 
@@ -512,7 +513,11 @@ namespace omnetpp { namespace scave {
 
 namespace omnetpp { namespace scave {
 %ignore readVectorsIntoArrays;
+%ignore readVectorsInGroups;
+%ignore readDownsampledVectorsIntoArrays;
+%ignore VectorGroupConsumer;
 %newobject readVectorsIntoArrays2;
+%newobject readDownsampledVectorsIntoArrays2;
 
 } } // namespaces
 
@@ -42,6 +42,9 @@ public class ResultFileManagerEx extends ResultFileManager {
     public static int SKIP_IF_LOCKED = ResultFileManager.LoadFlags.SKIP_IF_LOCKED.swigValue(); // don't load (this is the default)
     public static int IGNORE_LOCK_FILE = ResultFileManager.LoadFlags.IGNORE_LOCK_FILE.swigValue(); // pretend lock file doesn't exist
     public static int VERBOSE = ResultFileManager.LoadFlags.VERBOSE.swigValue(); // print on stdout what it's doing
+    // How to use the cache files (.sci) of scalar files
+    public static int IGNORE_SCALAR_CACHE = ResultFileManager.LoadFlags.IGNORE_SCALAR_CACHE.swigValue(); // always parse the scalar file, neither read nor write its cache file
+    public static int READ_ONLY_SCALAR_CACHE = ResultFileManager.LoadFlags.READ_ONLY_SCALAR_CACHE.swigValue(); // read the cache file if up to date, but do not create or update it
 
     /*-------------------------------------------
      *               Writer methods
@@ -360,7 +360,7 @@ public class InputsTree extends TreeViewer {
                     return ScavePlugin.getCachedImage(ScaveImages.IMG_VECFILE);
                 else if (path.endsWith(".sca"))
                     return ScavePlugin.getCachedImage(ScaveImages.IMG_SCAFILE);
-                else if (path.endsWith(".vci"))
+                else if (path.endsWith(".vci") || path.endsWith(".vcs") || path.endsWith(".sci"))
                     return ScavePlugin.getCachedImage(ScaveImages.IMG_VCIFILE);
                 else
                     return ScavePlugin.getCachedImage(ScaveImages.IMG_SCAVEFILE);